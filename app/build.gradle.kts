@@ -27,7 +27,10 @@ android {
                 cppFlags("-std=c++17", "-O3", "-ffast-math")
                 arguments(
                     "-DANDROID_ARM_NEON=ON",
-                    "-DANDROID_STL=c++_shared"
+                    "-DANDROID_STL=c++_shared",
+                    // GPU inference backends, e.g. ./gradlew assembleRelease -PwhisperVulkan=ON
+                    "-DWHISPER_ANDROID_VULKAN=${project.findProperty("whisperVulkan") ?: "OFF"}",
+                    "-DWHISPER_ANDROID_OPENCL=${project.findProperty("whisperOpenCl") ?: "OFF"}"
                 )
             }
         }
@@ -0,0 +1,51 @@
+#include "accelerator.h"
+
+#include <android/log.h>
+#include <ggml-backend.h>
+
+#define LOG_TAG "Accelerator"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+std::vector<AcceleratorDevice> probe_accelerators() {
+    std::vector<AcceleratorDevice> devices;
+    // whisper only offloads to GPU-type devices, counted in registry order
+    for (size_t i = 0; i < ggml_backend_dev_count(); ++i) {
+        ggml_backend_dev_t dev = ggml_backend_dev_get(i);
+        if (ggml_backend_dev_type(dev) != GGML_BACKEND_DEVICE_TYPE_GPU) {
+            continue;
+        }
+        AcceleratorDevice device;
+        const char* name = ggml_backend_dev_name(dev);
+        const char* description = ggml_backend_dev_description(dev);
+        device.name = name != nullptr ? name : "";
+        device.description = description != nullptr ? description : "";
+        ggml_backend_dev_memory(dev, &device.memory_free, &device.memory_total);
+        devices.push_back(std::move(device));
+    }
+    return devices;
+}
+
+whisper_context_params backend_context_params(InferenceBackend backend, int gpu_device) {
+    whisper_context_params params = whisper_context_default_params();
+    params.use_gpu = false;
+    params.gpu_device = 0;
+
+    if (backend == InferenceBackend::Gpu) {
+        const size_t n_devices = probe_accelerators().size();
+        if (gpu_device >= 0 && static_cast<size_t>(gpu_device) < n_devices) {
+            params.use_gpu = true;
+            params.gpu_device = gpu_device;
+        } else {
+            LOGI("GPU device %d not available (%zu found), using CPU", gpu_device, n_devices);
+        }
+    }
+    return params;
+}
+
+const char* backend_name(InferenceBackend backend) {
+    switch (backend) {
+        case InferenceBackend::Cpu: return "cpu";
+        case InferenceBackend::Gpu: return "gpu";
+    }
+    return "unknown";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** Order must match InferenceBackend in InferenceAccelerators.kt. */
+enum class InferenceBackend : int {
+    Cpu = 0,
+    Gpu,  // ggml's Vulkan or OpenCL backend, whichever the build includes
+};
+
+/** A GPU device ggml can run whisper on. */
+struct AcceleratorDevice {
+    std::string name;         // backend device name, e.g. "Vulkan0"
+    std::string description;  // driver's device name
+    size_t memory_free = 0;
+    size_t memory_total = 0;
+};
+
+/**
+ * GPU devices registered with ggml, in the order whisper numbers them for
+ * whisper_context_params::gpu_device. Always empty in CPU-only builds
+ * (WHISPER_ANDROID_VULKAN and WHISPER_ANDROID_OPENCL off).
+ */
+std::vector<AcceleratorDevice> probe_accelerators();
+
+/**
+ * Context parameters for running on backend. A GPU request for a device
+ * that doesn't exist gives CPU parameters, so callers can pass the
+ * caller's preference straight through.
+ */
+whisper_context_params backend_context_params(InferenceBackend backend, int gpu_device);
+
+const char* backend_name(InferenceBackend backend);
@@ -0,0 +1,199 @@
+#include "audio_kernels.h"
+
+#include <android/log.h>
+#include <cmath>
+
+#if AUDIO_KERNELS_HAVE_NEON
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#define LOG_TAG "AudioKernels"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr float kPcm16Scale = 1.0f / 32768.0f;
+
+// ---------------------------------------------------------------------------
+// Scalar reference kernels
+// ---------------------------------------------------------------------------
+
+void pcm16_to_float_scalar(const int16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<float>(in[i]) * kPcm16Scale;
+    }
+}
+
+double sum_squares_scalar(const float* in, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(in[i]) * in[i];
+    }
+    return sum;
+}
+
+float abs_max_scalar(const float* in, size_t n) {
+    float max_val = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        float abs_val = std::abs(in[i]);
+        if (abs_val > max_val) {
+            max_val = abs_val;
+        }
+    }
+    return max_val;
+}
+
+void scale_scalar(const float* in, float* out, size_t n, float gain) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i] * gain;
+    }
+}
+
+float dot_scalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+const AudioKernels kScalarKernels = {
+    "scalar",
+    pcm16_to_float_scalar,
+    sum_squares_scalar,
+    abs_max_scalar,
+    scale_scalar,
+    dot_scalar,
+};
+
+#if AUDIO_KERNELS_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// NEON kernels
+// ---------------------------------------------------------------------------
+
+void pcm16_to_float_neon(const int16_t* in, float* out, size_t n) {
+    const float32x4_t scale = vdupq_n_f32(kPcm16Scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int16x8_t a = vld1q_s16(in + i);
+        int16x8_t b = vld1q_s16(in + i + 8);
+        vst1q_f32(out + i,      vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a))), scale));
+        vst1q_f32(out + i + 4,  vmulq_f32(vcvtq_f32_s32(vmovl_high_s16(a)), scale));
+        vst1q_f32(out + i + 8,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(b))), scale));
+        vst1q_f32(out + i + 12, vmulq_f32(vcvtq_f32_s32(vmovl_high_s16(b)), scale));
+    }
+    pcm16_to_float_scalar(in + i, out + i, n - i);
+}
+
+double sum_squares_neon(const float* in, size_t n) {
+    // Four independent accumulators hide FMA latency. Partial sums are folded
+    // into a double every block so long buffers don't lose float precision.
+    constexpr size_t kBlock = 4096;
+    double total = 0.0;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f);
+        float32x4_t acc3 = vdupq_n_f32(0.0f);
+        size_t block_end = (n - i > kBlock) ? i + kBlock : n;
+        for (; i + 16 <= block_end; i += 16) {
+            float32x4_t v0 = vld1q_f32(in + i);
+            float32x4_t v1 = vld1q_f32(in + i + 4);
+            float32x4_t v2 = vld1q_f32(in + i + 8);
+            float32x4_t v3 = vld1q_f32(in + i + 12);
+            acc0 = vfmaq_f32(acc0, v0, v0);
+            acc1 = vfmaq_f32(acc1, v1, v1);
+            acc2 = vfmaq_f32(acc2, v2, v2);
+            acc3 = vfmaq_f32(acc3, v3, v3);
+        }
+        total += vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    }
+    return total + sum_squares_scalar(in + i, n - i);
+}
+
+float abs_max_neon(const float* in, size_t n) {
+    float32x4_t max0 = vdupq_n_f32(0.0f);
+    float32x4_t max1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        max0 = vmaxq_f32(max0, vabsq_f32(vld1q_f32(in + i)));
+        max1 = vmaxq_f32(max1, vabsq_f32(vld1q_f32(in + i + 4)));
+    }
+    float max_val = vmaxvq_f32(vmaxq_f32(max0, max1));
+    float tail = abs_max_scalar(in + i, n - i);
+    return tail > max_val ? tail : max_val;
+}
+
+void scale_neon(const float* in, float* out, size_t n, float gain) {
+    const float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t v0 = vld1q_f32(in + i);
+        float32x4_t v1 = vld1q_f32(in + i + 4);
+        vst1q_f32(out + i, vmulq_f32(v0, g));
+        vst1q_f32(out + i + 4, vmulq_f32(v1, g));
+    }
+    scale_scalar(in + i, out + i, n - i, gain);
+}
+
+float dot_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i),      vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4),  vld1q_f32(b + i + 4));
+        acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8),  vld1q_f32(b + i + 8));
+        acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    float sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    return sum + dot_scalar(a + i, b + i, n - i);
+}
+
+const AudioKernels kNeonKernels = {
+    "neon",
+    pcm16_to_float_neon,
+    sum_squares_neon,
+    abs_max_neon,
+    scale_neon,
+    dot_neon,
+};
+
+bool cpu_has_neon() {
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+}
+
+#endif // AUDIO_KERNELS_HAVE_NEON
+
+const AudioKernels& select_kernels() {
+    const AudioKernels* neon = audio_kernels_neon();
+    const AudioKernels& selected = neon != nullptr ? *neon : kScalarKernels;
+    LOGI("Using %s audio kernels", selected.name);
+    return selected;
+}
+
+} // namespace
+
+const AudioKernels& audio_kernels() {
+    static const AudioKernels& kernels = select_kernels();
+    return kernels;
+}
+
+const AudioKernels& audio_kernels_scalar() {
+    return kScalarKernels;
+}
+
+const AudioKernels* audio_kernels_neon() {
+#if AUDIO_KERNELS_HAVE_NEON
+    static const bool supported = cpu_has_neon();
+    return supported ? &kNeonKernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
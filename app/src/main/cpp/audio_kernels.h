@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Vectorized audio kernels shared by the JNI layer.
+ *
+ * Every kernel has a portable scalar implementation and, on arm64 builds
+ * with ARM_NEON enabled, a NEON implementation. The implementation is
+ * chosen once at runtime from the CPU's hardware capabilities; callers go
+ * through audio_kernels() and never reference a specific variant.
+ */
+
+#if defined(ARM_NEON) && defined(__ARM_NEON)
+#define AUDIO_KERNELS_HAVE_NEON 1
+#else
+#define AUDIO_KERNELS_HAVE_NEON 0
+#endif
+
+struct AudioKernels {
+    const char* name;
+
+    /** out[i] = in[i] / 32768 */
+    void (*pcm16_to_float)(const int16_t* in, float* out, size_t n);
+
+    /** Sum of in[i]^2, accumulated in double precision */
+    double (*sum_squares)(const float* in, size_t n);
+
+    /** max(|in[i]|), 0 for an empty buffer */
+    float (*abs_max)(const float* in, size_t n);
+
+    /** out[i] = in[i] * gain; in and out may alias */
+    void (*scale)(const float* in, float* out, size_t n, float gain);
+
+    /** Sum of a[i] * b[i] */
+    float (*dot)(const float* a, const float* b, size_t n);
+};
+
+/** Kernels selected for the current CPU. */
+const AudioKernels& audio_kernels();
+
+/** Portable reference implementation, always available. */
+const AudioKernels& audio_kernels_scalar();
+
+/** NEON implementation, or nullptr when unsupported by the build or CPU. */
+const AudioKernels* audio_kernels_neon();
@@ -1,15 +1,326 @@
 #include <jni.h>
 #include <android/log.h>
+#include "audio_kernels.h"
+#include "biquad_filter.h"
+#include "capture_pipeline.h"
+#include "jni_arrays.h"
+#include "lookahead_agc.h"
+#include "perf_stats.h"
+#include "recording_store.h"
+#include "resampler.h"
+#include "spectral_denoiser.h"
+#include "vad.h"
+#include "waveform_pyramid.h"
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <cstdint>
+#include <optional>
 
 #define LOG_TAG "AudioProcessor"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 
+namespace {
+
+// PCM16 samples converted per block in the fused pipeline
+constexpr size_t kPipelineBlock = 2048;
+
+/**
+ * Second-order Butterworth high-pass used by the one-shot entry points.
+ */
+BiquadFilterBank make_high_pass(float cutoff_freq, jint sample_rate) {
+    FilterBankParams params;
+    params.sample_rate = sample_rate;
+    params.high_pass_hz = cutoff_freq;
+    BiquadFilterBank filter(params);
+    if (!filter.is_valid()) {
+        LOGE("Invalid high-pass filter: cutoff=%.1f, sampleRate=%d", cutoff_freq, sample_rate);
+    }
+    return filter;
+}
+
+FilterBankParams filter_params(jint sample_rate, jfloat high_pass_hz, jint high_pass_order,
+                               jfloat notch_hz, jfloat notch_q, jfloat pre_emphasis) {
+    FilterBankParams params;
+    params.sample_rate = sample_rate;
+    params.high_pass_hz = high_pass_hz;
+    params.high_pass_order = high_pass_order;
+    params.notch_hz = notch_hz;
+    params.notch_q = notch_q;
+    params.pre_emphasis = pre_emphasis;
+    return params;
+}
+
+AgcParams agc_params(jint sample_rate, jfloat target_level, jfloat attack_ms, jfloat release_ms,
+                     jfloat max_gain) {
+    AgcParams params;
+    params.sample_rate = sample_rate;
+    params.target_level = target_level;
+    params.attack_ms = attack_ms;
+    params.release_ms = release_ms;
+    params.max_gain = max_gain;
+    return params;
+}
+
+/**
+ * Run an in-place float stage over a PCM16 array and return the result as
+ * a new PCM16 array, rounded and clamped to 16 bits.
+ */
+template <typename Process>
+jshortArray process_pcm16(JNIEnv* env, jshortArray pcm_data, Process&& process) {
+    const jsize length = env->GetArrayLength(pcm_data);
+    jshort* pcm = get_array_elements(env, pcm_data);
+    if (pcm == nullptr) {
+        LOGE("Failed to get PCM data");
+        return nullptr;
+    }
+    std::vector<float> samples(static_cast<size_t>(length));
+    {
+        ScopedStageTimer timer(Stage::Convert);
+        audio_kernels().pcm16_to_float(pcm, samples.data(), samples.size());
+    }
+    release_array_elements(env, pcm_data, pcm, JNI_ABORT);
+
+    process(samples.data(), samples.size());
+
+    jshortArray result = env->NewShortArray(length);
+    if (result == nullptr) {
+        LOGE("Failed to create PCM array");
+        return nullptr;
+    }
+    auto* out = static_cast<jshort*>(env->GetPrimitiveArrayCritical(result, nullptr));
+    if (out == nullptr) {
+        LOGE("Failed to get PCM output array");
+        return nullptr;
+    }
+    {
+        ScopedStageTimer timer(Stage::Convert);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const float scaled = std::min(std::max(samples[i] * 32768.0f, -32768.0f), 32767.0f);
+            out[i] = static_cast<jshort>(std::lrintf(scaled));
+        }
+    }
+    env->ReleasePrimitiveArrayCritical(result, out, 0);
+    return result;
+}
+
+/**
+ * Fused PCM16 -> float -> resample -> high-pass pipeline.
+ *
+ * The input is streamed in small blocks: each block is converted into a
+ * stack buffer, pushed through the polyphase resampler straight into the
+ * output, and filtered there while still in cache. Only the output buffer
+ * is full length.
+ *
+ * @param high_pass Filter at target_rate, or nullptr to skip filtering
+ * @param peak Receives the peak absolute value of the output (for normalization)
+ * @return false if the output did not come out at exactly out_length samples
+ */
+bool fused_convert_resample_filter(
+    const jshort* pcm,
+    jsize source_length,
+    jint source_rate,
+    jint target_rate,
+    BiquadFilterBank* high_pass,
+    float* out,
+    jsize out_length,
+    float& peak) {
+
+    const AudioKernels& kernels = audio_kernels();
+
+    if (source_rate == target_rate && high_pass == nullptr) {
+        // Nothing to resample or filter: vectorized conversion and peak scan
+        ScopedStageTimer timer(Stage::Convert);
+        kernels.pcm16_to_float(pcm, out, out_length);
+        peak = kernels.abs_max(out, out_length);
+        return true;
+    }
+
+    StreamingResampler resampler(source_rate, target_rate);
+    float block[kPipelineBlock];
+    peak = 0.0f;
+    size_t written = 0;
+
+    auto finish_block = [&](size_t produced) {
+        float* chunk = out + written;
+        if (high_pass != nullptr) {
+            ScopedStageTimer timer(Stage::Filter);
+            high_pass->process(chunk, produced);
+        }
+        peak = std::max(peak, kernels.abs_max(chunk, produced));
+        written += produced;
+    };
+
+    for (size_t pos = 0; pos < static_cast<size_t>(source_length); pos += kPipelineBlock) {
+        const size_t count = std::min(kPipelineBlock, static_cast<size_t>(source_length) - pos);
+        {
+            ScopedStageTimer timer(Stage::Convert);
+            kernels.pcm16_to_float(pcm + pos, block, count);
+        }
+        size_t produced;
+        {
+            ScopedStageTimer timer(Stage::Resample);
+            produced = resampler.process(block, count, out + written);
+        }
+        finish_block(produced);
+    }
+    size_t tail;
+    {
+        ScopedStageTimer timer(Stage::Resample);
+        tail = resampler.flush(out + written);
+    }
+    finish_block(tail);
+
+    if (written != static_cast<size_t>(out_length)) {
+        LOGE("Fused pipeline produced %zu samples, expected %d", written, out_length);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Native state behind a Kotlin StreamingResampler handle.
+ */
+struct ResamplerHandle {
+    StreamingResampler resampler;
+    std::vector<float> scratch;
+
+    ResamplerHandle(int source_rate, int target_rate)
+        : resampler(source_rate, target_rate) {}
+};
+
+/**
+ * Scale samples in place so the given peak maps to target_level.
+ */
+void apply_peak_normalization(float* data, size_t n, float peak, float target_level) {
+    if (peak > 0.0f) {
+        ScopedStageTimer timer(Stage::Normalize);
+        audio_kernels().scale(data, data, n, target_level / peak);
+    }
+}
+
+/**
+ * Resolve a caller-supplied direct ByteBuffer to a typed pointer.
+ *
+ * The buffer must be direct, hold at least count elements of T from offset 0
+ * (position and limit are ignored) and be suitably aligned. Data is read and
+ * written in native byte order.
+ */
+template <typename T>
+T* direct_buffer(JNIEnv* env, jobject buffer, jint count, const char* name) {
+    if (buffer == nullptr || count < 0) {
+        LOGE("Invalid %s buffer (count=%d)", name, count);
+        return nullptr;
+    }
+
+    void* address = env->GetDirectBufferAddress(buffer);
+    if (address == nullptr) {
+        LOGE("%s buffer is not a direct ByteBuffer", name);
+        return nullptr;
+    }
+
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (capacity < static_cast<jlong>(count) * static_cast<jlong>(sizeof(T))) {
+        LOGE("%s buffer too small: %lld bytes for %d samples",
+             name, static_cast<long long>(capacity), count);
+        return nullptr;
+    }
+
+    if (reinterpret_cast<uintptr_t>(address) % alignof(T) != 0) {
+        LOGE("%s buffer is misaligned", name);
+        return nullptr;
+    }
+
+    return static_cast<T*>(address);
+}
+
+jfloatArray to_float_array(JNIEnv* env, const float* data, size_t length) {
+    jfloatArray array = env->NewFloatArray(static_cast<jsize>(length));
+    if (array == nullptr) {
+        LOGE("Failed to create float array");
+        return nullptr;
+    }
+    ScopedStageTimer timer(Stage::JniCopy);
+    env->SetFloatArrayRegion(array, 0, static_cast<jsize>(length), data);
+    return array;
+}
+
+/**
+ * Run the VAD and flatten the regions as [start0, end0, start1, end1, ...].
+ * min_level is the absolute RMS below which frames never count as speech.
+ */
+jintArray detect_regions(JNIEnv* env, const float* audio, size_t length, jint sample_rate, jfloat min_level) {
+    VadParams params;
+    params.sample_rate = sample_rate;
+    if (min_level > 0.0f) {
+        params.min_energy_db = 20.0f * std::log10(min_level);
+    }
+
+    VoiceActivityDetector vad(params);
+    if (!vad.is_valid()) {
+        LOGE("Invalid VAD parameters: %d Hz", sample_rate);
+        return nullptr;
+    }
+    std::vector<SpeechRegion> regions;
+    {
+        ScopedStageTimer timer(Stage::Vad);
+        regions = vad.detect(audio, length);
+    }
+
+    std::vector<jint> flat;
+    flat.reserve(regions.size() * 2);
+    for (const SpeechRegion& region : regions) {
+        flat.push_back(static_cast<jint>(region.start));
+        flat.push_back(static_cast<jint>(region.end));
+    }
+
+    jintArray array = env->NewIntArray(static_cast<jsize>(flat.size()));
+    if (array == nullptr) {
+        LOGE("Failed to create region array");
+        return nullptr;
+    }
+    env->SetIntArrayRegion(array, 0, static_cast<jsize>(flat.size()), flat.data());
+    return array;
+}
+
+/**
+ * Summarize [start, end) of a pyramid into caller-owned arrays; the point
+ * count is the shortest array. Returns points written, or -1 on error.
+ */
+jint query_waveform(JNIEnv* env, const WaveformPyramid& pyramid, jlong start, jlong end,
+                    jfloatArray min_out, jfloatArray max_out, jfloatArray rms_out) {
+    if (start < 0 || end < start || min_out == nullptr || max_out == nullptr || rms_out == nullptr) {
+        LOGE("Invalid waveform query [%lld, %lld)", static_cast<long long>(start), static_cast<long long>(end));
+        return -1;
+    }
+    const jsize points = std::min({env->GetArrayLength(min_out), env->GetArrayLength(max_out),
+                                   env->GetArrayLength(rms_out)});
+
+    auto* mins = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(min_out, nullptr));
+    auto* maxs = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(max_out, nullptr));
+    auto* rms = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(rms_out, nullptr));
+    const bool ok = mins != nullptr && maxs != nullptr && rms != nullptr;
+    size_t written = 0;
+    if (ok) {
+        written = pyramid.query(static_cast<uint64_t>(start), static_cast<uint64_t>(end),
+                                static_cast<size_t>(points), mins, maxs, rms);
+    }
+    if (rms != nullptr) env->ReleasePrimitiveArrayCritical(rms_out, rms, 0);
+    if (maxs != nullptr) env->ReleasePrimitiveArrayCritical(max_out, maxs, 0);
+    if (mins != nullptr) env->ReleasePrimitiveArrayCritical(min_out, mins, 0);
+    if (!ok) {
+        LOGE("Failed to get waveform arrays");
+        return -1;
+    }
+    return static_cast<jint>(written);
+}
+
+} // namespace
+
 extern "C" {
 
 /**
@@ -24,7 +335,7 @@ Java_com_app_whisper_native_AudioProcessor_pcm16ToFloat(
     jshortArray pcm_data) {
     
     jsize length = env->GetArrayLength(pcm_data);
-    jshort* pcm = env->GetShortArrayElements(pcm_data, nullptr);
+    jshort* pcm = get_array_elements(env, pcm_data);
     
     if (pcm == nullptr) {
         LOGE("Failed to get PCM data");
@@ -34,27 +345,27 @@ Java_com_app_whisper_native_AudioProcessor_pcm16ToFloat(
     // Create float array
     jfloatArray float_array = env->NewFloatArray(length);
     if (float_array == nullptr) {
-        env->ReleaseShortArrayElements(pcm_data, pcm, JNI_ABORT);
+        release_array_elements(env, pcm_data, pcm, JNI_ABORT);
         LOGE("Failed to create float array");
         return nullptr;
     }
     
-    jfloat* float_data = env->GetFloatArrayElements(float_array, nullptr);
+    jfloat* float_data = get_array_elements(env, float_array);
     if (float_data == nullptr) {
-        env->ReleaseShortArrayElements(pcm_data, pcm, JNI_ABORT);
+        release_array_elements(env, pcm_data, pcm, JNI_ABORT);
         LOGE("Failed to get float array elements");
         return nullptr;
     }
     
     // Convert PCM16 to float
-    const float scale = 1.0f / 32768.0f;
-    for (jsize i = 0; i < length; ++i) {
-        float_data[i] = static_cast<float>(pcm[i]) * scale;
+    {
+        ScopedStageTimer timer(Stage::Convert);
+        audio_kernels().pcm16_to_float(pcm, float_data, length);
     }
     
     // Release arrays
-    env->ReleaseFloatArrayElements(float_array, float_data, 0);
-    env->ReleaseShortArrayElements(pcm_data, pcm, JNI_ABORT);
+    release_array_elements(env, float_array, float_data, 0);
+    release_array_elements(env, pcm_data, pcm, JNI_ABORT);
     
     LOGD("Converted %d PCM16 samples to float", length);
     return float_array;
@@ -62,7 +373,7 @@ Java_com_app_whisper_native_AudioProcessor_pcm16ToFloat(
 
 /**
  * Resample audio data to target sample rate
- * Simple linear interpolation resampling
+ * Polyphase windowed-sinc resampling with cached filter banks
  */
 JNIEXPORT jfloatArray JNICALL
 Java_com_app_whisper_native_AudioProcessor_resampleAudio(
@@ -76,9 +387,14 @@ Java_com_app_whisper_native_AudioProcessor_resampleAudio(
         // No resampling needed, return copy
         return audio_data;
     }
+
+    if (source_rate <= 0 || target_rate <= 0) {
+        LOGE("Invalid sample rates: source=%d, target=%d", source_rate, target_rate);
+        return nullptr;
+    }
     
     jsize source_length = env->GetArrayLength(audio_data);
-    jfloat* source_audio = env->GetFloatArrayElements(audio_data, nullptr);
+    jfloat* source_audio = get_array_elements(env, audio_data);
     
     if (source_audio == nullptr) {
         LOGE("Failed to get source audio data");
@@ -86,42 +402,33 @@ Java_com_app_whisper_native_AudioProcessor_resampleAudio(
     }
     
     // Calculate target length
-    double ratio = static_cast<double>(target_rate) / static_cast<double>(source_rate);
-    jsize target_length = static_cast<jsize>(source_length * ratio);
+    jsize target_length = static_cast<jsize>(
+        resampled_length(source_length, source_rate, target_rate));
     
     // Create target array
     jfloatArray target_array = env->NewFloatArray(target_length);
     if (target_array == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, source_audio, JNI_ABORT);
+        release_array_elements(env, audio_data, source_audio, JNI_ABORT);
         LOGE("Failed to create target array");
         return nullptr;
     }
     
-    jfloat* target_audio = env->GetFloatArrayElements(target_array, nullptr);
+    jfloat* target_audio = get_array_elements(env, target_array);
     if (target_audio == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, source_audio, JNI_ABORT);
+        release_array_elements(env, audio_data, source_audio, JNI_ABORT);
         LOGE("Failed to get target array elements");
         return nullptr;
     }
     
-    // Linear interpolation resampling
-    for (jsize i = 0; i < target_length; ++i) {
-        double source_index = static_cast<double>(i) / ratio;
-        jsize index = static_cast<jsize>(source_index);
-        double fraction = source_index - index;
-        
-        if (index >= source_length - 1) {
-            target_audio[i] = source_audio[source_length - 1];
-        } else {
-            // Linear interpolation
-            target_audio[i] = source_audio[index] * (1.0f - fraction) + 
-                             source_audio[index + 1] * fraction;
-        }
+    // Band-limited polyphase resampling
+    {
+        ScopedStageTimer timer(Stage::Resample);
+        resample_buffer(source_audio, source_length, source_rate, target_rate, target_audio);
     }
     
     // Release arrays
-    env->ReleaseFloatArrayElements(target_array, target_audio, 0);
-    env->ReleaseFloatArrayElements(audio_data, source_audio, JNI_ABORT);
+    release_array_elements(env, target_array, target_audio, 0);
+    release_array_elements(env, audio_data, source_audio, JNI_ABORT);
     
     LOGI("Resampled audio from %d Hz to %d Hz (%d -> %d samples)", 
          source_rate, target_rate, source_length, target_length);
@@ -140,8 +447,13 @@ Java_com_app_whisper_native_AudioProcessor_highPassFilter(
     jfloat cutoff_freq,
     jint sample_rate) {
     
+    BiquadFilterBank high_pass = make_high_pass(cutoff_freq, sample_rate);
+    if (!high_pass.is_valid()) {
+        return nullptr;
+    }
+
     jsize length = env->GetArrayLength(audio_data);
-    jfloat* audio = env->GetFloatArrayElements(audio_data, nullptr);
+    jfloat* audio = get_array_elements(env, audio_data);
     
     if (audio == nullptr) {
         LOGE("Failed to get audio data");
@@ -151,36 +463,86 @@ Java_com_app_whisper_native_AudioProcessor_highPassFilter(
     // Create output array
     jfloatArray filtered_array = env->NewFloatArray(length);
     if (filtered_array == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+        release_array_elements(env, audio_data, audio, JNI_ABORT);
         LOGE("Failed to create filtered array");
         return nullptr;
     }
     
-    jfloat* filtered = env->GetFloatArrayElements(filtered_array, nullptr);
+    jfloat* filtered = get_array_elements(env, filtered_array);
     if (filtered == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+        release_array_elements(env, audio_data, audio, JNI_ABORT);
         LOGE("Failed to get filtered array elements");
         return nullptr;
     }
     
-    // Simple high-pass filter (first-order)
-    const float dt = 1.0f / sample_rate;
-    const float rc = 1.0f / (2.0f * M_PI * cutoff_freq);
-    const float alpha = rc / (rc + dt);
-    
-    filtered[0] = audio[0];
-    for (jsize i = 1; i < length; ++i) {
-        filtered[i] = alpha * (filtered[i-1] + audio[i] - audio[i-1]);
+    {
+        ScopedStageTimer timer(Stage::Filter);
+        std::memcpy(filtered, audio, static_cast<size_t>(length) * sizeof(jfloat));
+        high_pass.process(filtered, static_cast<size_t>(length));
     }
     
     // Release arrays
-    env->ReleaseFloatArrayElements(filtered_array, filtered, 0);
-    env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+    release_array_elements(env, filtered_array, filtered, 0);
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
     
     LOGD("Applied high-pass filter with cutoff %.1f Hz", cutoff_freq);
     return filtered_array;
 }
 
+/**
+ * Spectral subtraction noise suppression over a whole PCM16 buffer.
+ * strength runs from 0 (unchanged) to 1 (strongest).
+ */
+JNIEXPORT jshortArray JNICALL
+Java_com_app_whisper_native_AudioProcessor_reduceNoisePcm16(
+    JNIEnv* env,
+    jobject /* this */,
+    jshortArray pcm_data,
+    jfloat strength) {
+
+    if (!(strength >= 0.0f && strength <= 1.0f)) {
+        LOGE("Invalid noise suppression strength: %.2f", strength);
+        return nullptr;
+    }
+    SpectralDenoiser denoiser(strength);
+    if (!denoiser.is_valid()) {
+        LOGE("Failed to create noise suppressor");
+        return nullptr;
+    }
+
+    return process_pcm16(env, pcm_data, [&](float* samples, size_t n) {
+        ScopedStageTimer timer(Stage::Denoise);
+        denoiser.process_buffer(samples, n);
+    });
+}
+
+/**
+ * Look-ahead automatic gain control over a whole PCM16 buffer.
+ */
+JNIEXPORT jshortArray JNICALL
+Java_com_app_whisper_native_AudioProcessor_automaticGainControlPcm16(
+    JNIEnv* env,
+    jobject /* this */,
+    jshortArray pcm_data,
+    jint sample_rate,
+    jfloat target_level,
+    jfloat attack_ms,
+    jfloat release_ms,
+    jfloat max_gain) {
+
+    LookaheadAgc agc(agc_params(sample_rate, target_level, attack_ms, release_ms, max_gain));
+    if (!agc.is_valid()) {
+        LOGE("Invalid AGC parameters: %d Hz, target=%.3f, attack=%.1f ms, release=%.1f ms, maxGain=%.1f",
+             sample_rate, target_level, attack_ms, release_ms, max_gain);
+        return nullptr;
+    }
+
+    return process_pcm16(env, pcm_data, [&](float* samples, size_t n) {
+        ScopedStageTimer timer(Stage::Normalize);
+        agc.process_buffer(samples, n);
+    });
+}
+
 /**
  * Normalize audio amplitude to prevent clipping
  */
@@ -192,7 +554,7 @@ Java_com_app_whisper_native_AudioProcessor_normalizeAudio(
     jfloat target_level) {
     
     jsize length = env->GetArrayLength(audio_data);
-    jfloat* audio = env->GetFloatArrayElements(audio_data, nullptr);
+    jfloat* audio = get_array_elements(env, audio_data);
     
     if (audio == nullptr) {
         LOGE("Failed to get audio data");
@@ -200,44 +562,39 @@ Java_com_app_whisper_native_AudioProcessor_normalizeAudio(
     }
     
     // Find maximum absolute value
-    float max_val = 0.0f;
-    for (jsize i = 0; i < length; ++i) {
-        float abs_val = std::abs(audio[i]);
-        if (abs_val > max_val) {
-            max_val = abs_val;
-        }
-    }
+    float max_val = audio_kernels().abs_max(audio, length);
     
     if (max_val == 0.0f) {
         // Silent audio, return as-is
-        env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+        release_array_elements(env, audio_data, audio, JNI_ABORT);
         return audio_data;
     }
     
     // Create normalized array
     jfloatArray normalized_array = env->NewFloatArray(length);
     if (normalized_array == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+        release_array_elements(env, audio_data, audio, JNI_ABORT);
         LOGE("Failed to create normalized array");
         return nullptr;
     }
     
-    jfloat* normalized = env->GetFloatArrayElements(normalized_array, nullptr);
+    jfloat* normalized = get_array_elements(env, normalized_array);
     if (normalized == nullptr) {
-        env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+        release_array_elements(env, audio_data, audio, JNI_ABORT);
         LOGE("Failed to get normalized array elements");
         return nullptr;
     }
     
     // Normalize to target level
     float scale = target_level / max_val;
-    for (jsize i = 0; i < length; ++i) {
-        normalized[i] = audio[i] * scale;
+    {
+        ScopedStageTimer timer(Stage::Normalize);
+        audio_kernels().scale(audio, normalized, length, scale);
     }
     
     // Release arrays
-    env->ReleaseFloatArrayElements(normalized_array, normalized, 0);
-    env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
+    release_array_elements(env, normalized_array, normalized, 0);
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
     
     LOGD("Normalized audio: max %.3f -> %.3f (scale: %.3f)", max_val, target_level, scale);
     return normalized_array;
@@ -253,23 +610,1179 @@ Java_com_app_whisper_native_AudioProcessor_calculateRMS(
     jfloatArray audio_data) {
     
     jsize length = env->GetArrayLength(audio_data);
-    jfloat* audio = env->GetFloatArrayElements(audio_data, nullptr);
+    jfloat* audio = get_array_elements(env, audio_data);
     
     if (audio == nullptr) {
         LOGE("Failed to get audio data");
         return 0.0f;
     }
     
-    double sum_squares = 0.0;
-    for (jsize i = 0; i < length; ++i) {
-        sum_squares += audio[i] * audio[i];
-    }
+    double sum_squares = audio_kernels().sum_squares(audio, length);
     
     float rms = std::sqrt(sum_squares / length);
     
-    env->ReleaseFloatArrayElements(audio_data, audio, JNI_ABORT);
-    
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
+
     return rms;
 }
 
+/**
+ * Complete Whisper preprocessing in a single native call.
+ * Runs PCM16 conversion, resampling, optional high-pass filtering and
+ * optional peak normalization with one output allocation and no
+ * intermediate arrays.
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_app_whisper_native_AudioProcessor_preprocessPcm16(
+    JNIEnv* env,
+    jobject /* this */,
+    jshortArray pcm_data,
+    jint source_rate,
+    jint target_rate,
+    jboolean apply_filtering,
+    jfloat cutoff_freq,
+    jboolean apply_normalization,
+    jfloat target_level) {
+
+    if (source_rate <= 0 || target_rate <= 0) {
+        LOGE("Invalid sample rates: source=%d, target=%d", source_rate, target_rate);
+        return nullptr;
+    }
+
+    jsize source_length = env->GetArrayLength(pcm_data);
+    jsize target_length = static_cast<jsize>(
+        resampled_length(source_length, source_rate, target_rate));
+    if (source_length == 0 || target_length == 0) {
+        LOGE("Audio too short to preprocess: %d samples", source_length);
+        return nullptr;
+    }
+
+    std::optional<BiquadFilterBank> high_pass;
+    if (apply_filtering == JNI_TRUE) {
+        high_pass.emplace(make_high_pass(cutoff_freq, target_rate));
+        if (!high_pass->is_valid()) {
+            return nullptr;
+        }
+    }
+
+    jshort* pcm = get_array_elements(env, pcm_data);
+    if (pcm == nullptr) {
+        LOGE("Failed to get PCM data");
+        return nullptr;
+    }
+
+    jfloatArray output_array = env->NewFloatArray(target_length);
+    if (output_array == nullptr) {
+        release_array_elements(env, pcm_data, pcm, JNI_ABORT);
+        LOGE("Failed to create output array");
+        return nullptr;
+    }
+
+    jfloat* output = get_array_elements(env, output_array);
+    if (output == nullptr) {
+        release_array_elements(env, pcm_data, pcm, JNI_ABORT);
+        LOGE("Failed to get output array elements");
+        return nullptr;
+    }
+
+    float peak = 0.0f;
+    const bool converted = fused_convert_resample_filter(
+        pcm, source_length, source_rate, target_rate,
+        high_pass ? &*high_pass : nullptr,
+        output, target_length, peak);
+
+    // The input is no longer needed; release it before the normalization pass
+    release_array_elements(env, pcm_data, pcm, JNI_ABORT);
+    if (!converted) {
+        release_array_elements(env, output_array, output, JNI_ABORT);
+        env->DeleteLocalRef(output_array);
+        return nullptr;
+    }
+
+    // Peak normalization needs the global maximum, so it is applied in place
+    if (apply_normalization == JNI_TRUE) {
+        apply_peak_normalization(output, target_length, peak, target_level);
+    }
+
+    release_array_elements(env, output_array, output, 0);
+
+    LOGD("Preprocessed %d samples at %d Hz -> %d samples at %d Hz (filter=%d, normalize=%d)",
+         source_length, source_rate, target_length, target_rate,
+         apply_filtering, apply_normalization);
+
+    return output_array;
+}
+
+// ---------------------------------------------------------------------------
+// Direct ByteBuffer variants
+//
+// These operate on caller-owned direct buffers through GetDirectBufferAddress,
+// so no Java array is pinned, copied or allocated. Sample counts are passed
+// explicitly; functions returning jint report the number of samples written,
+// or -1 on error.
+// ---------------------------------------------------------------------------
+
+/**
+ * Convert PCM16 samples in a direct buffer to floats in another direct buffer.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioProcessor_pcm16ToFloatDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject pcm_buffer,
+    jint sample_count,
+    jobject float_buffer) {
+
+    auto* pcm = direct_buffer<jshort>(env, pcm_buffer, sample_count, "PCM");
+    auto* out = direct_buffer<jfloat>(env, float_buffer, sample_count, "output");
+    if (pcm == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    ScopedStageTimer timer(Stage::Convert);
+    audio_kernels().pcm16_to_float(pcm, out, sample_count);
+    return sample_count;
+}
+
+/**
+ * Resample floats from one direct buffer into another.
+ * The output buffer must hold floor(sample_count * target_rate / source_rate) floats.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioProcessor_resampleAudioDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject input_buffer,
+    jint sample_count,
+    jint source_rate,
+    jint target_rate,
+    jobject output_buffer) {
+
+    if (source_rate <= 0 || target_rate <= 0) {
+        LOGE("Invalid sample rates: source=%d, target=%d", source_rate, target_rate);
+        return -1;
+    }
+
+    jint target_length = static_cast<jint>(
+        resampled_length(sample_count, source_rate, target_rate));
+
+    auto* in = direct_buffer<jfloat>(env, input_buffer, sample_count, "input");
+    auto* out = direct_buffer<jfloat>(env, output_buffer, target_length, "output");
+    if (in == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    if (source_rate == target_rate) {
+        if (in != out) {
+            std::memmove(out, in, static_cast<size_t>(sample_count) * sizeof(float));
+        }
+        return sample_count;
+    }
+
+    ScopedStageTimer timer(Stage::Resample);
+    return static_cast<jint>(resample_buffer(in, sample_count, source_rate, target_rate, out));
+}
+
+/**
+ * Apply the Butterworth high-pass filter in place on a direct float buffer.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioProcessor_highPassFilterDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject audio_buffer,
+    jint sample_count,
+    jfloat cutoff_freq,
+    jint sample_rate) {
+
+    if (cutoff_freq <= 0.0f || sample_rate <= 0) {
+        LOGE("Invalid filter parameters: cutoff=%.1f, sampleRate=%d", cutoff_freq, sample_rate);
+        return JNI_FALSE;
+    }
+
+    auto* audio = direct_buffer<jfloat>(env, audio_buffer, sample_count, "audio");
+    if (audio == nullptr) {
+        return JNI_FALSE;
+    }
+
+    BiquadFilterBank high_pass = make_high_pass(cutoff_freq, sample_rate);
+    if (!high_pass.is_valid()) {
+        return JNI_FALSE;
+    }
+    ScopedStageTimer timer(Stage::Filter);
+    high_pass.process(audio, sample_count);
+    return JNI_TRUE;
+}
+
+/**
+ * Peak-normalize a direct float buffer in place.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioProcessor_normalizeAudioDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject audio_buffer,
+    jint sample_count,
+    jfloat target_level) {
+
+    auto* audio = direct_buffer<jfloat>(env, audio_buffer, sample_count, "audio");
+    if (audio == nullptr) {
+        return JNI_FALSE;
+    }
+
+    float peak = audio_kernels().abs_max(audio, sample_count);
+    apply_peak_normalization(audio, sample_count, peak, target_level);
+    return JNI_TRUE;
+}
+
+/**
+ * RMS energy of a direct float buffer.
+ */
+JNIEXPORT jfloat JNICALL
+Java_com_app_whisper_native_AudioProcessor_calculateRMSDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject audio_buffer,
+    jint sample_count) {
+
+    auto* audio = direct_buffer<jfloat>(env, audio_buffer, sample_count, "audio");
+    if (audio == nullptr || sample_count == 0) {
+        return 0.0f;
+    }
+
+    return static_cast<float>(std::sqrt(audio_kernels().sum_squares(audio, sample_count) / sample_count));
+}
+
+/**
+ * Fused Whisper preprocessing from a direct PCM16 buffer into a direct float
+ * buffer. The output must hold floor(sample_count * target_rate / source_rate)
+ * floats.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioProcessor_preprocessPcm16Direct(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject pcm_buffer,
+    jint sample_count,
+    jint source_rate,
+    jint target_rate,
+    jboolean apply_filtering,
+    jfloat cutoff_freq,
+    jboolean apply_normalization,
+    jfloat target_level,
+    jobject output_buffer) {
+
+    if (source_rate <= 0 || target_rate <= 0) {
+        LOGE("Invalid sample rates: source=%d, target=%d", source_rate, target_rate);
+        return -1;
+    }
+
+    jint target_length = static_cast<jint>(
+        resampled_length(sample_count, source_rate, target_rate));
+    if (sample_count == 0 || target_length == 0) {
+        LOGE("Audio too short to preprocess: %d samples", sample_count);
+        return -1;
+    }
+
+    auto* pcm = direct_buffer<jshort>(env, pcm_buffer, sample_count, "PCM");
+    auto* out = direct_buffer<jfloat>(env, output_buffer, target_length, "output");
+    if (pcm == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    std::optional<BiquadFilterBank> high_pass;
+    if (apply_filtering == JNI_TRUE) {
+        high_pass.emplace(make_high_pass(cutoff_freq, target_rate));
+        if (!high_pass->is_valid()) {
+            return -1;
+        }
+    }
+
+    float peak = 0.0f;
+    if (!fused_convert_resample_filter(
+            pcm, sample_count, source_rate, target_rate,
+            high_pass ? &*high_pass : nullptr,
+            out, target_length, peak)) {
+        return -1;
+    }
+
+    if (apply_normalization == JNI_TRUE) {
+        apply_peak_normalization(out, target_length, peak, target_level);
+    }
+
+    return target_length;
+}
+
+/**
+ * Detect speech regions with the frame-based VAD.
+ * Returns sample offsets flattened as [start0, end0, start1, end1, ...].
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_app_whisper_native_AudioProcessor_detectSpeechRegions(
+    JNIEnv* env,
+    jobject /* this */,
+    jfloatArray audio_data,
+    jint sample_rate,
+    jfloat min_level) {
+
+    jsize length = env->GetArrayLength(audio_data);
+    jfloat* audio = get_array_elements(env, audio_data);
+    if (audio == nullptr) {
+        LOGE("Failed to get audio data");
+        return nullptr;
+    }
+
+    jintArray result = detect_regions(env, audio, length, sample_rate, min_level);
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
+    return result;
+}
+
+/**
+ * Detect speech regions in a direct float buffer.
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_app_whisper_native_AudioProcessor_detectSpeechRegionsDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject audio_buffer,
+    jint sample_count,
+    jint sample_rate,
+    jfloat min_level) {
+
+    auto* audio = direct_buffer<jfloat>(env, audio_buffer, sample_count, "audio");
+    if (audio == nullptr) {
+        return nullptr;
+    }
+
+    return detect_regions(env, audio, sample_count, sample_rate, min_level);
+}
+
+/**
+ * Create a streaming resampler that keeps filter state between chunks.
+ * Returns 0 for unsupported rates.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_StreamingResampler_nativeCreate(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint source_rate,
+    jint target_rate) {
+
+    auto* handle = new ResamplerHandle(source_rate, target_rate);
+    if (!handle->resampler.is_valid()) {
+        LOGE("Unsupported resampler rates: %d -> %d", source_rate, target_rate);
+        delete handle;
+        return 0;
+    }
+
+    LOGD("Created streaming resampler %d -> %d Hz", source_rate, target_rate);
+    return reinterpret_cast<jlong>(handle);
+}
+
+/**
+ * Push one chunk through a streaming resampler.
+ * Returns the output available so far (possibly empty).
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_app_whisper_native_StreamingResampler_nativeProcess(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloatArray audio_data) {
+
+    auto* handle = reinterpret_cast<ResamplerHandle*>(handle_ptr);
+    if (handle == nullptr) {
+        LOGE("Invalid resampler handle");
+        return nullptr;
+    }
+
+    jsize length = env->GetArrayLength(audio_data);
+    jfloat* audio = get_array_elements(env, audio_data);
+    if (audio == nullptr) {
+        LOGE("Failed to get audio data");
+        return nullptr;
+    }
+
+    handle->scratch.resize(handle->resampler.max_output(length));
+    size_t produced;
+    {
+        ScopedStageTimer timer(Stage::Resample);
+        produced = handle->resampler.process(audio, length, handle->scratch.data());
+    }
+
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
+
+    return to_float_array(env, handle->scratch.data(), produced);
+}
+
+/**
+ * Drain the remaining filter tail of a streaming resampler.
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_app_whisper_native_StreamingResampler_nativeFlush(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* handle = reinterpret_cast<ResamplerHandle*>(handle_ptr);
+    if (handle == nullptr) {
+        LOGE("Invalid resampler handle");
+        return nullptr;
+    }
+
+    handle->scratch.resize(handle->resampler.max_output(0));
+    size_t produced = handle->resampler.flush(handle->scratch.data());
+
+    return to_float_array(env, handle->scratch.data(), produced);
+}
+
+/**
+ * Reset a streaming resampler so it can start a new stream.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_StreamingResampler_nativeReset(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* handle = reinterpret_cast<ResamplerHandle*>(handle_ptr);
+    if (handle != nullptr) {
+        handle->resampler.reset();
+    }
+}
+
+/**
+ * Destroy a streaming resampler.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_StreamingResampler_nativeRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    delete reinterpret_cast<ResamplerHandle*>(handle_ptr);
+}
+
+/**
+ * Create a capture pipeline and start its worker thread.
+ * capacity is the input ring size in samples at source_rate.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeCreate(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint source_rate,
+    jint capacity) {
+
+    if (capacity <= 0) {
+        LOGE("Invalid capture buffer capacity: %d", capacity);
+        return 0;
+    }
+
+    auto* pipeline = new CapturePipeline(source_rate, static_cast<size_t>(capacity));
+    if (!pipeline->is_valid()) {
+        LOGE("Unsupported capture sample rate: %d", source_rate);
+        delete pipeline;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(pipeline);
+}
+
+/**
+ * Enqueue PCM16 from a direct buffer. Called on the capture thread; never
+ * blocks. Returns the number of samples accepted or -1 on error.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeWrite(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jobject pcm_buffer,
+    jint sample_count) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    auto* pcm = direct_buffer<jshort>(env, pcm_buffer, sample_count, "PCM");
+    if (pipeline == nullptr || pcm == nullptr) {
+        return -1;
+    }
+
+    return static_cast<jint>(pipeline->write(pcm, sample_count));
+}
+
+/**
+ * Dequeue processed 16 kHz samples into a float array.
+ * Returns the number of samples copied.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeRead(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloatArray output) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return -1;
+    }
+
+    jsize capacity = env->GetArrayLength(output);
+    auto* out = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(output, nullptr));
+    if (out == nullptr) {
+        LOGE("Failed to get output array");
+        return -1;
+    }
+
+    size_t read = pipeline->read_processed(out, capacity);
+    env->ReleasePrimitiveArrayCritical(output, out, 0);
+    return static_cast<jint>(read);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeIsSpeechActive(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    return pipeline != nullptr && pipeline->speech_active() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Samples dropped because either ring was full.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeDroppedSamples(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return 0;
+    }
+    return static_cast<jlong>(pipeline->dropped_input() + pipeline->dropped_output());
+}
+
+/**
+ * Processed 16 kHz samples emitted so far, including ones not yet read.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeProcessedSamples(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    return pipeline != nullptr ? static_cast<jlong>(pipeline->waveform().sample_count()) : 0;
+}
+
+/**
+ * Min/max/RMS of processed samples [start, end) at the arrays' resolution.
+ * Returns the number of points written or -1 on error.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeWaveform(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jlong start,
+    jlong end,
+    jfloatArray min_out,
+    jfloatArray max_out,
+    jfloatArray rms_out) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return -1;
+    }
+    return query_waveform(env, pipeline->waveform(), start, end, min_out, max_out, rms_out);
+}
+
+/**
+ * Replace the capture conditioning filters (applied at 16 kHz).
+ * Returns false and keeps the current filters for invalid parameters.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeSetFilter(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloat high_pass_hz,
+    jint high_pass_order,
+    jfloat notch_hz,
+    jfloat notch_q,
+    jfloat pre_emphasis) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return JNI_FALSE;
+    }
+    const FilterBankParams params =
+        filter_params(0, high_pass_hz, high_pass_order, notch_hz, notch_q, pre_emphasis);
+    if (!pipeline->set_filter(params)) {
+        LOGE("Invalid capture filter: highPass=%.1f/%d, notch=%.1f, preEmphasis=%.2f",
+             high_pass_hz, high_pass_order, notch_hz, pre_emphasis);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/**
+ * Set capture noise suppression strength; 0 disables it.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeSetNoiseSuppression(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloat strength) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return JNI_FALSE;
+    }
+    if (!pipeline->set_noise_suppression(strength)) {
+        LOGE("Invalid noise suppression strength: %.2f", strength);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/**
+ * Set capture AGC; a non-positive target level disables it.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeSetAutoGain(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloat target_level,
+    jfloat attack_ms,
+    jfloat release_ms,
+    jfloat max_gain) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline == nullptr) {
+        return JNI_FALSE;
+    }
+    if (target_level <= 0.0f) {
+        return pipeline->set_agc(nullptr) ? JNI_TRUE : JNI_FALSE;
+    }
+    const AgcParams params = agc_params(0, target_level, attack_ms, release_ms, max_gain);
+    if (!pipeline->set_agc(&params)) {
+        LOGE("Invalid capture AGC: target=%.3f, attack=%.1f ms, release=%.1f ms, maxGain=%.1f",
+             target_level, attack_ms, release_ms, max_gain);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/**
+ * Drain pending input, flush the resampler and stop the worker.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeStop(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pipeline = reinterpret_cast<CapturePipeline*>(handle_ptr);
+    if (pipeline != nullptr) {
+        pipeline->stop();
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_AudioCaptureBuffer_nativeRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    delete reinterpret_cast<CapturePipeline*>(handle_ptr);
+}
+
+/**
+ * Create a stateful biquad filter bank. Returns 0 for invalid parameters.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_BiquadFilterBank_nativeCreate(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint sample_rate,
+    jfloat high_pass_hz,
+    jint high_pass_order,
+    jfloat notch_hz,
+    jfloat notch_q,
+    jfloat pre_emphasis) {
+
+    auto* filter = new BiquadFilterBank(
+        filter_params(sample_rate, high_pass_hz, high_pass_order, notch_hz, notch_q, pre_emphasis));
+    if (!filter->is_valid()) {
+        LOGE("Invalid filter bank: %d Hz, highPass=%.1f/%d, notch=%.1f, preEmphasis=%.2f",
+             sample_rate, high_pass_hz, high_pass_order, notch_hz, pre_emphasis);
+        delete filter;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(filter);
+}
+
+/**
+ * Filter the first count samples of a float array in place.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_BiquadFilterBank_nativeProcess(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloatArray samples,
+    jint count) {
+
+    auto* filter = reinterpret_cast<BiquadFilterBank*>(handle_ptr);
+    if (filter == nullptr || count < 0 || count > env->GetArrayLength(samples)) {
+        LOGE("Invalid filter call (count=%d)", count);
+        return JNI_FALSE;
+    }
+
+    auto* data = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(samples, nullptr));
+    if (data == nullptr) {
+        LOGE("Failed to get filter samples");
+        return JNI_FALSE;
+    }
+    {
+        ScopedStageTimer timer(Stage::Filter);
+        filter->process(data, static_cast<size_t>(count));
+    }
+    env->ReleasePrimitiveArrayCritical(samples, data, 0);
+    return JNI_TRUE;
+}
+
+/**
+ * Filter count floats of a direct buffer in place.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_BiquadFilterBank_nativeProcessDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jobject buffer,
+    jint count) {
+
+    auto* filter = reinterpret_cast<BiquadFilterBank*>(handle_ptr);
+    auto* data = direct_buffer<jfloat>(env, buffer, count, "filter");
+    if (filter == nullptr || data == nullptr) {
+        return JNI_FALSE;
+    }
+    ScopedStageTimer timer(Stage::Filter);
+    filter->process(data, static_cast<size_t>(count));
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_BiquadFilterBank_nativeReset(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* filter = reinterpret_cast<BiquadFilterBank*>(handle_ptr);
+    if (filter != nullptr) {
+        filter->reset();
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_BiquadFilterBank_nativeRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    delete reinterpret_cast<BiquadFilterBank*>(handle_ptr);
+}
+
+/**
+ * Create a waveform pyramid with base_bin_samples samples per finest bin.
+ * Returns 0 for a non-positive bin size.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeCreate(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint base_bin_samples) {
+
+    if (base_bin_samples <= 0) {
+        LOGE("Invalid waveform bin size: %d", base_bin_samples);
+        return 0;
+    }
+    return reinterpret_cast<jlong>(new WaveformPyramid(static_cast<size_t>(base_bin_samples)));
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeAppend(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jfloatArray samples,
+    jint count) {
+
+    auto* pyramid = reinterpret_cast<WaveformPyramid*>(handle_ptr);
+    if (pyramid == nullptr || count <= 0) {
+        return;
+    }
+    if (count > env->GetArrayLength(samples)) {
+        LOGE("Waveform append of %d samples exceeds array", count);
+        return;
+    }
+
+    auto* data = static_cast<jfloat*>(env->GetPrimitiveArrayCritical(samples, nullptr));
+    if (data == nullptr) {
+        LOGE("Failed to get waveform samples");
+        return;
+    }
+    pyramid->append(data, static_cast<size_t>(count));
+    env->ReleasePrimitiveArrayCritical(samples, data, JNI_ABORT);
+}
+
+/**
+ * Append float samples from a direct buffer.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeAppendDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jobject buffer,
+    jint count) {
+
+    auto* pyramid = reinterpret_cast<WaveformPyramid*>(handle_ptr);
+    auto* data = direct_buffer<jfloat>(env, buffer, count, "waveform");
+    if (pyramid != nullptr && data != nullptr) {
+        pyramid->append(data, static_cast<size_t>(count));
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeSampleCount(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pyramid = reinterpret_cast<WaveformPyramid*>(handle_ptr);
+    return pyramid != nullptr ? static_cast<jlong>(pyramid->sample_count()) : 0;
+}
+
+/**
+ * Min/max/RMS of samples [start, end) at the arrays' resolution.
+ * Returns the number of points written or -1 on error.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeQuery(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jlong start,
+    jlong end,
+    jfloatArray min_out,
+    jfloatArray max_out,
+    jfloatArray rms_out) {
+
+    auto* pyramid = reinterpret_cast<WaveformPyramid*>(handle_ptr);
+    if (pyramid == nullptr) {
+        LOGE("Invalid waveform handle");
+        return -1;
+    }
+    return query_waveform(env, *pyramid, start, end, min_out, max_out, rms_out);
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeReset(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* pyramid = reinterpret_cast<WaveformPyramid*>(handle_ptr);
+    if (pyramid != nullptr) {
+        pyramid->reset();
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WaveformPyramid_nativeRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    delete reinterpret_cast<WaveformPyramid*>(handle_ptr);
+}
+
+// ---------------------------------------------------------------------------
+// Recording files
+// ---------------------------------------------------------------------------
+
+/**
+ * Write samples and segments as a recording file. starts, ends and texts
+ * are parallel arrays, one entry per segment.
+ * Returns the codec the audio was stored with or -1 on error.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeWrite(
+    JNIEnv* env,
+    jclass /* clazz */,
+    jstring path,
+    jfloatArray samples,
+    jint sample_rate,
+    jlongArray starts,
+    jlongArray ends,
+    jobjectArray texts,
+    jboolean compress) {
+
+    ScopedUtfChars file(env, path);
+    if (file.get() == nullptr || samples == nullptr) {
+        LOGE("Invalid recording arguments");
+        return -1;
+    }
+    const jsize n_segments = texts != nullptr ? env->GetArrayLength(texts) : 0;
+    if (n_segments > 0 && (starts == nullptr || ends == nullptr || env->GetArrayLength(starts) < n_segments ||
+                           env->GetArrayLength(ends) < n_segments)) {
+        LOGE("Segment arrays don't match: %d texts", n_segments);
+        return -1;
+    }
+
+    std::vector<StoredSegment> segments(static_cast<size_t>(n_segments));
+    if (n_segments > 0) {
+        std::vector<jlong> t0(static_cast<size_t>(n_segments));
+        std::vector<jlong> t1(static_cast<size_t>(n_segments));
+        env->GetLongArrayRegion(starts, 0, n_segments, t0.data());
+        env->GetLongArrayRegion(ends, 0, n_segments, t1.data());
+        for (jsize i = 0; i < n_segments; ++i) {
+            auto text = static_cast<jstring>(env->GetObjectArrayElement(texts, i));
+            ScopedUtfChars chars(env, text);
+            segments[i].t0_ms = t0[i];
+            segments[i].t1_ms = t1[i];
+            if (chars.get() != nullptr) {
+                segments[i].text = chars.get();
+            }
+            env->DeleteLocalRef(text);
+        }
+    }
+
+    const jsize length = env->GetArrayLength(samples);
+    std::vector<float> audio(static_cast<size_t>(length));
+    if (!copy_array_region(env, samples, length, audio.data())) {
+        LOGE("Failed to copy recording samples");
+        return -1;
+    }
+
+    RecordingWriteParams params;
+    params.sample_rate = sample_rate;
+    params.compress = compress == JNI_TRUE;
+    return write_recording(file.get(), audio.data(), audio.size(), segments, params);
+}
+
+/**
+ * Map a recording file. Returns 0 if it is missing or invalid.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeOpen(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring path) {
+
+    ScopedUtfChars file(env, path);
+    if (file.get() == nullptr) {
+        return 0;
+    }
+    auto* reader = new RecordingReader();
+    if (!reader->open(file.get())) {
+        delete reader;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(reader);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeSampleRate(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    return reader != nullptr ? static_cast<jint>(reader->header().sample_rate) : 0;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeDurationMs(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    return reader != nullptr ? static_cast<jlong>(reader->duration_ms()) : 0;
+}
+
+/**
+ * Start and end times of every segment, flattened as [t0_0, t1_0, t0_1, ...].
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeSegmentTimes(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    if (reader == nullptr) {
+        LOGE("Invalid recording handle");
+        return nullptr;
+    }
+    const size_t n = reader->header().n_segments;
+    std::vector<jlong> times(n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        times[i * 2] = reader->segment(i).t0_ms;
+        times[i * 2 + 1] = reader->segment(i).t1_ms;
+    }
+
+    jlongArray array = env->NewLongArray(static_cast<jsize>(times.size()));
+    if (array == nullptr) {
+        LOGE("Failed to create segment times array");
+        return nullptr;
+    }
+    env->SetLongArrayRegion(array, 0, static_cast<jsize>(times.size()), times.data());
+    return array;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeSegmentText(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jint index) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    if (reader == nullptr || index < 0 || static_cast<uint32_t>(index) >= reader->header().n_segments) {
+        LOGE("Invalid segment index: %d", index);
+        return nullptr;
+    }
+    const RecordingSegment& segment = reader->segment(static_cast<size_t>(index));
+    const std::string text(reader->segment_text(static_cast<size_t>(index)), segment.text_size);
+    return env->NewStringUTF(text.c_str());
+}
+
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeFindSegment(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr,
+    jlong time_ms) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    return reader != nullptr ? reader->find_segment(time_ms) : -1;
+}
+
+/**
+ * Indices of the segments containing query, in time order.
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeSearch(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jstring query) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    ScopedUtfChars chars(env, query);
+    if (reader == nullptr || chars.get() == nullptr) {
+        LOGE("Invalid recording search");
+        return nullptr;
+    }
+    std::vector<int> hits;
+    reader->search(chars.get(), hits);
+
+    jintArray array = env->NewIntArray(static_cast<jsize>(hits.size()));
+    if (array == nullptr) {
+        LOGE("Failed to create search results array");
+        return nullptr;
+    }
+    env->SetIntArrayRegion(array, 0, static_cast<jsize>(hits.size()), hits.data());
+    return array;
+}
+
+/**
+ * Decode the audio in [start_ms, end_ms). Returns nullptr on error.
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeReadRange(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_ptr,
+    jlong start_ms,
+    jlong end_ms) {
+
+    auto* reader = reinterpret_cast<RecordingReader*>(handle_ptr);
+    if (reader == nullptr) {
+        LOGE("Invalid recording handle");
+        return nullptr;
+    }
+    std::vector<float> samples;
+    if (!reader->read_range(start_ms, end_ms, samples)) {
+        LOGE("Failed to decode recording range %lld-%lld ms", static_cast<long long>(start_ms),
+             static_cast<long long>(end_ms));
+        return nullptr;
+    }
+
+    jfloatArray array = env->NewFloatArray(static_cast<jsize>(samples.size()));
+    if (array == nullptr) {
+        LOGE("Failed to create recording samples array");
+        return nullptr;
+    }
+    env->SetFloatArrayRegion(array, 0, static_cast<jsize>(samples.size()), samples.data());
+    return array;
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_RecordingFile_nativeRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong handle_ptr) {
+
+    delete reinterpret_cast<RecordingReader*>(handle_ptr);
+}
+
+// ---------------------------------------------------------------------------
+// Native stage statistics
+// ---------------------------------------------------------------------------
+
+/**
+ * Totals of every stage in Stage order, flattened as
+ * [count0, totalNs0, maxNs0, count1, ...].
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_app_whisper_native_NativeStats_nativeSnapshot(
+    JNIEnv* env,
+    jobject /* this */) {
+
+    StageStats stats[kStageCount];
+    snapshot_stage_stats(stats);
+
+    jlong flat[kStageCount * 3];
+    for (int i = 0; i < kStageCount; ++i) {
+        flat[i * 3] = static_cast<jlong>(stats[i].count);
+        flat[i * 3 + 1] = static_cast<jlong>(stats[i].total_ns);
+        flat[i * 3 + 2] = static_cast<jlong>(stats[i].max_ns);
+    }
+
+    jlongArray array = env->NewLongArray(kStageCount * 3);
+    if (array == nullptr) {
+        LOGE("Failed to create stats array");
+        return nullptr;
+    }
+    env->SetLongArrayRegion(array, 0, kStageCount * 3, flat);
+    return array;
+}
+
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_NativeStats_nativeReset(
+    JNIEnv* /* env */,
+    jobject /* this */) {
+
+    reset_stage_stats();
+}
+
 } // extern "C"
@@ -0,0 +1,271 @@
+#include "batch_transcriber.h"
+
+#include <android/log.h>
+#include <whisper.h>
+
+#include <cstdint>
+
+#include "core_arbiter.h"
+#include "perf_stats.h"
+#include "wav_reader.h"
+
+#define LOG_TAG "BatchTranscriber"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kWhisperSampleRate = WHISPER_SAMPLE_RATE;
+
+} // namespace
+
+BatchTranscriber::BatchTranscriber(std::shared_ptr<SharedModel> model, BatchParams params,
+                                   BatchResultCallback on_result)
+    : model_(std::move(model)), params_(std::move(params)), on_result_(std::move(on_result)) {
+    state_ = whisper_init_state(model_->ctx);
+    if (state_ == nullptr) {
+        LOGE("Failed to create batch decoder state");
+    }
+    for (Slot& slot : slots_) {
+        free_slots_.push_back(&slot);
+    }
+    prepare_thread_ = std::thread(&BatchTranscriber::prepare_loop, this);
+    decode_thread_ = std::thread(&BatchTranscriber::decode_loop, this);
+}
+
+BatchTranscriber::~BatchTranscriber() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cancelled_ = true;
+        jobs_.clear();
+    }
+    abort_.store(true, std::memory_order_relaxed);
+    cv_.notify_all();
+    prepare_thread_.join();
+    decode_thread_.join();
+    if (state_ != nullptr) {
+        whisper_free_state(state_);
+    }
+}
+
+bool BatchTranscriber::submit(BatchJob job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_) {
+            return false;
+        }
+        jobs_.push_back(std::move(job));
+        ++pending_;
+    }
+    cv_.notify_all();
+    return true;
+}
+
+void BatchTranscriber::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_) {
+            return;
+        }
+        LOGI("Cancelling batch with %zu jobs outstanding", pending_);
+        cancelled_ = true;
+        jobs_.clear();
+        while (!ready_slots_.empty()) {
+            free_slots_.push_back(ready_slots_.front());
+            ready_slots_.pop_front();
+        }
+    }
+    abort_.store(true, std::memory_order_relaxed);
+    cv_.notify_all();
+}
+
+size_t BatchTranscriber::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_ ? 0 : pending_;
+}
+
+bool BatchTranscriber::should_abort(void* user_data) {
+    return static_cast<BatchTranscriber*>(user_data)->abort_.load(std::memory_order_relaxed);
+}
+
+void BatchTranscriber::prepare_loop() {
+    for (;;) {
+        BatchJob job;
+        Slot* slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || (!jobs_.empty() && !free_slots_.empty()); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            slot = free_slots_.front();
+            free_slots_.pop_front();
+        }
+
+        prepare(job, *slot);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cancelled_) {
+                free_slots_.push_back(slot);
+            } else {
+                ready_slots_.push_back(slot);
+            }
+        }
+        cv_.notify_all();
+    }
+}
+
+void BatchTranscriber::decode_loop() {
+    for (;;) {
+        Slot* slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !ready_slots_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            slot = ready_slots_.front();
+            ready_slots_.pop_front();
+        }
+
+        text_.clear();
+        int status = slot->status;
+        if (status == kBatchOk && slot->n_samples > 0) {
+            status = decode(*slot);
+        }
+        const int64_t id = slot->id;
+        std::vector<float>().swap(slot->owned);
+
+        bool report;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_.push_back(slot);
+            report = !cancelled_;
+        }
+        cv_.notify_all();
+
+        if (report) {
+            on_result_(id, status, text_.c_str());
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+    }
+}
+
+void BatchTranscriber::prepare(BatchJob& job, Slot& slot) {
+    ScratchArena& scratch = slot.scratch;
+    scratch.reset();
+    slot.id = job.id;
+    slot.status = kBatchOk;
+    slot.samples = nullptr;
+    slot.n_samples = 0;
+
+    const float* samples;
+    size_t n_samples;
+    int sample_rate;
+    if (!job.path.empty()) {
+        // Sized from what the file holds, not the header: recorders that never
+        // finalized it leave data_size at 0 or 0xFFFFFFFF
+        PcmFileReader reader;
+        if (!reader.open(job.path.c_str())) {
+            LOGE("Cannot read %s", job.path.c_str());
+            slot.status = kBatchLoadFailed;
+            return;
+        }
+        const uint64_t frames = reader.frames_left();
+        float* audio = frames <= SIZE_MAX / sizeof(float)
+                           ? scratch.allocate<float>(static_cast<size_t>(frames))
+                           : nullptr;
+        if (audio == nullptr) {
+            LOGE("Cannot hold %llu frames of %s", static_cast<unsigned long long>(frames), job.path.c_str());
+            slot.status = kBatchLoadFailed;
+            return;
+        }
+        samples = audio;
+        n_samples = reader.read(audio, static_cast<size_t>(frames));
+        sample_rate = reader.info().sample_rate;
+    } else {
+        slot.owned = std::move(job.samples);
+        samples = slot.owned.data();
+        n_samples = slot.owned.size();
+        sample_rate = job.sample_rate;
+    }
+
+    if (sample_rate != kWhisperSampleRate && n_samples > 0) {
+        ScopedStageTimer timer(Stage::Resample);
+        if (resampler_ == nullptr || resampler_rate_ != sample_rate) {
+            resampler_.reset(new StreamingResampler(sample_rate, kWhisperSampleRate));
+            resampler_rate_ = sample_rate;
+        }
+        float* resampled = scratch.allocate<float>(resampled_length(n_samples, sample_rate, kWhisperSampleRate));
+        if (!resampler_->is_valid() || resampled == nullptr) {
+            LOGE("Cannot resample job %lld from %d Hz", static_cast<long long>(job.id), sample_rate);
+            slot.status = kBatchLoadFailed;
+            return;
+        }
+        n_samples = resample_buffer(*resampler_, samples, n_samples, resampled);
+        samples = resampled;
+    }
+
+    if (params_.trim_silence) {
+        {
+            ScopedStageTimer timer(Stage::Vad);
+            vad_.detect(samples, n_samples, regions_);
+        }
+        const size_t voiced_length = speech_length(regions_);
+        if (voiced_length == 0) {
+            n_samples = 0;  // reported as an empty transcript without decoding
+        } else if (voiced_length < n_samples) {
+            if (float* voiced = scratch.allocate<float>(voiced_length)) {
+                n_samples = compact_speech(samples, regions_, voiced);
+                samples = voiced;
+            }
+        }
+    }
+
+    slot.samples = samples;
+    slot.n_samples = n_samples;
+}
+
+int BatchTranscriber::decode(const Slot& slot) {
+    if (state_ == nullptr) {
+        return kBatchDecodeFailed;
+    }
+
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.translate = params_.translate;
+    wparams.language = params_.language.c_str();
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+    wparams.abort_callback = should_abort;
+    wparams.abort_callback_user_data = this;
+
+    int result;
+    {
+        CoreLease lease(params_.n_threads);
+        wparams.n_threads = lease.threads();
+        result = timed_whisper_full(model_->ctx, state_, wparams, slot.samples, static_cast<int>(slot.n_samples));
+    }
+    if (result != 0) {
+        LOGE("Batch job %lld failed with error code: %d", static_cast<long long>(slot.id), result);
+        return kBatchDecodeFailed;
+    }
+
+    const int n_segments = whisper_full_n_segments_from_state(state_);
+    for (int i = 0; i < n_segments; ++i) {
+        const char* text = whisper_full_get_segment_text_from_state(state_, i);
+        if (text != nullptr) {
+            text_ += text;
+            if (i < n_segments - 1) {
+                text_ += ' ';
+            }
+        }
+    }
+    return kBatchOk;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "model_cache.h"
+#include "resampler.h"
+#include "scratch_arena.h"
+#include "vad.h"
+
+struct BatchParams {
+    std::string language = "auto";
+    bool translate = false;
+    bool trim_silence = true;
+    int n_threads = 1;
+};
+
+/** One queued transcription: either in-memory samples or a WAV file path. */
+struct BatchJob {
+    int64_t id = 0;
+    std::string path;            // read as 16-bit PCM WAV when non-empty
+    std::vector<float> samples;  // used when path is empty
+    int sample_rate = 16000;
+};
+
+/** Result codes passed to the result callback. */
+enum BatchStatus : int {
+    kBatchOk = 0,
+    kBatchLoadFailed = -1,    // file unreadable or not a supported WAV
+    kBatchDecodeFailed = -2,  // whisper_full returned an error
+};
+
+/**
+ * Called once per job, in submission order, on the decode thread.
+ * text is only valid for the duration of the call.
+ */
+using BatchResultCallback = std::function<void(int64_t id, int status, const char* text)>;
+
+/**
+ * Transcribes a queue of jobs on a shared model with two threads: a prepare
+ * thread that loads, resamples and VAD-trims job N+1 while the decode
+ * thread runs whisper_full on job N. Jobs move between the two through a
+ * pair of slots, each with its own scratch arena, so preprocessing and
+ * inference overlap without per-job allocation once the arenas are warm.
+ *
+ * The decode thread runs on the batch's own whisper_state, so one-shot and
+ * streaming transcriptions on the same model run alongside it, each
+ * leasing its threads from core_arbiter().
+ */
+class BatchTranscriber {
+public:
+    BatchTranscriber(std::shared_ptr<SharedModel> model, BatchParams params, BatchResultCallback on_result);
+
+    /** Cancels outstanding jobs and joins both threads. */
+    ~BatchTranscriber();
+
+    BatchTranscriber(const BatchTranscriber&) = delete;
+    BatchTranscriber& operator=(const BatchTranscriber&) = delete;
+
+    /** Queue a job. Returns false once the batch has been cancelled. */
+    bool submit(BatchJob job);
+
+    /**
+     * Drop queued jobs and abort the decode in progress. Jobs dropped this
+     * way get no callback.
+     */
+    void cancel();
+
+    /** Jobs submitted whose callback has not run yet. */
+    size_t pending() const;
+
+private:
+    static constexpr int kSlotCount = 2;
+
+    /** A prepared job waiting for, or going through, the decoder. */
+    struct Slot {
+        ScratchArena scratch;
+        std::vector<float> owned;  // the job's own samples, kept alive while decoding
+        int64_t id = 0;
+        int status = kBatchOk;
+        const float* samples = nullptr;
+        size_t n_samples = 0;
+    };
+
+    void prepare_loop();
+    void decode_loop();
+    void prepare(BatchJob& job, Slot& slot);
+    int decode(const Slot& slot);
+
+    static bool should_abort(void* user_data);
+
+    std::shared_ptr<SharedModel> model_;
+    BatchParams params_;
+    BatchResultCallback on_result_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<BatchJob> jobs_;
+    std::deque<Slot*> free_slots_;
+    std::deque<Slot*> ready_slots_;
+    size_t pending_ = 0;
+    bool cancelled_ = false;
+    bool stopping_ = false;
+    std::atomic<bool> abort_{false};
+    Slot slots_[kSlotCount];
+
+    // Owned by the prepare thread
+    std::unique_ptr<StreamingResampler> resampler_;
+    int resampler_rate_ = 0;
+    VoiceActivityDetector vad_;
+    std::vector<SpeechRegion> regions_;
+
+    // Owned by the decode thread
+    whisper_state* state_ = nullptr;
+    std::string text_;
+
+    std::thread prepare_thread_;
+    std::thread decode_thread_;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+/**
+ * Helpers shared by the on-device executables in bench/: timing, a JSON
+ * writer for their reports, WAV fixture loading and peak RSS.
+ */
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "wav_reader.h"
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/** Minimal JSON writer; values are appended in order, commas are handled. */
+class JsonWriter {
+public:
+    explicit JsonWriter(FILE* out) : out_(out) {}
+
+    void begin_object(const char* key = nullptr) { open(key, '{'); }
+    void end_object() { close('}'); }
+    void begin_array(const char* key = nullptr) { open(key, '['); }
+    void end_array() { close(']'); }
+
+    void field(const char* key, const std::string& value) {
+        separator(key);
+        write_string(value);
+    }
+    void field(const char* key, const char* value) { field(key, std::string(value)); }
+    void field(const char* key, double value) {
+        separator(key);
+        if (std::isfinite(value)) {
+            std::fprintf(out_, "%.6g", value);
+        } else {
+            std::fputs("null", out_);
+        }
+    }
+    void field(const char* key, long long value) {
+        separator(key);
+        std::fprintf(out_, "%lld", value);
+    }
+    void field(const char* key, bool value) {
+        separator(key);
+        std::fputs(value ? "true" : "false", out_);
+    }
+
+    void finish() { std::fputc('\n', out_); }
+
+private:
+    void open(const char* key, char bracket) {
+        separator(key);
+        std::fputc(bracket, out_);
+        first_.push_back(true);
+    }
+
+    void close(char bracket) {
+        first_.pop_back();
+        std::fputc(bracket, out_);
+    }
+
+    void separator(const char* key) {
+        if (!first_.empty()) {
+            if (!first_.back()) {
+                std::fputc(',', out_);
+            }
+            first_.back() = false;
+        }
+        if (key != nullptr) {
+            write_string(key);
+            std::fputc(':', out_);
+        }
+    }
+
+    void write_string(const std::string& s) {
+        std::fputc('"', out_);
+        for (unsigned char c : s) {
+            switch (c) {
+                case '"': std::fputs("\\\"", out_); break;
+                case '\\': std::fputs("\\\\", out_); break;
+                case '\n': std::fputs("\\n", out_); break;
+                case '\r': std::fputs("\\r", out_); break;
+                case '\t': std::fputs("\\t", out_); break;
+                default:
+                    if (c < 0x20) {
+                        std::fprintf(out_, "\\u%04x", c);
+                    } else {
+                        std::fputc(c, out_);
+                    }
+            }
+        }
+        std::fputc('"', out_);
+    }
+
+    FILE* out_;
+    std::vector<bool> first_;
+};
+
+/** 16-bit PCM WAV contents, downmixed to mono float. */
+struct WavFile {
+    int sample_rate = 0;
+    std::vector<float> samples;
+};
+
+inline bool read_wav(const std::string& path, WavFile& wav) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::unique_ptr<FILE, int (*)(FILE*)> guard(file, std::fclose);
+
+    WavInfo info;
+    if (!read_wav_header(file, info)) {
+        std::fprintf(stderr, "%s: not a 16-bit PCM WAV file\n", path.c_str());
+        return false;
+    }
+    wav.sample_rate = info.sample_rate;
+    wav.samples.resize(info.frames());
+    wav.samples.resize(read_wav_frames(file, info, wav.samples.data(), wav.samples.size()));
+    return !wav.samples.empty();
+}
+
+/**
+ * Restart peak RSS tracking, so peak_rss_kb() covers only what runs next.
+ * Returns false where the kernel doesn't allow it; the peak then stays the
+ * process lifetime's.
+ */
+inline bool reset_peak_rss() {
+    FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fputs("5", file) >= 0;
+    return std::fclose(file) == 0 && written;
+}
+
+/** Peak resident set size of this process since start or the last reset, in kilobytes. */
+inline long long peak_rss_kb() {
+    if (FILE* file = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long long kb = -1;
+        while (std::fgets(line, sizeof(line), file) != nullptr) {
+            if (std::sscanf(line, "VmHWM: %lld kB", &kb) == 1) {
+                break;
+            }
+        }
+        std::fclose(file);
+        if (kb >= 0) {
+            return kb;
+        }
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return static_cast<long long>(usage.ru_maxrss);  // kilobytes on Linux
+}
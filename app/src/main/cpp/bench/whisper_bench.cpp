@@ -0,0 +1,374 @@
+/**
+ * On-device benchmark for the native audio path and whisper inference.
+ *
+ * Runs every audio kernel over a range of buffer sizes for each available
+ * implementation (scalar and NEON), times the resampler, FFT and VAD
+ * stages, and, when a model and WAV fixtures are given, measures the full
+ * PCM16 -> 16 kHz -> VAD -> whisper_full pipeline. Results are written as a
+ * single JSON document so runs can be diffed between releases.
+ *
+ * Usage (see scripts/run_bench.sh):
+ *   whisper_bench [--model PATH] [--threads N] [--language CODE] [--gpu N]
+ *                 [--min-time-ms N] [--output FILE] [fixture.wav ...]
+ *
+ * --gpu runs the model on that GPU device when the build has a GPU backend,
+ * and on the CPU otherwise; the backend used is reported per fixture.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <whisper.h>
+
+#include "accelerator.h"
+#include "audio_kernels.h"
+#include "bench/bench_common.h"
+#include "cpu_topology.h"
+#include "fft.h"
+#include "model_cache.h"
+#include "resampler.h"
+#include "vad.h"
+#include "wav_reader.h"
+
+namespace {
+
+constexpr int kWhisperSampleRate = 16000;
+constexpr size_t kKernelSizes[] = {256, 1024, 4096, 16384, 65536};
+constexpr int kResampleRates[] = {44100, 48000};
+
+struct Options {
+    std::string model_path;
+    std::string language = "en";
+    std::string output_path;
+    std::vector<std::string> fixtures;
+    int n_threads = 0;          // 0 = one per big core
+    int gpu_device = -1;        // -1 = CPU
+    double min_time_ms = 200.0; // minimum measured time per benchmark
+};
+
+// Results are folded into this so the optimizer can't drop benchmarked calls
+volatile double g_sink = 0.0;
+
+/**
+ * Average time of one call to fn, in nanoseconds. The iteration count
+ * doubles until a batch takes at least min_time_ms.
+ */
+template <typename F>
+double time_per_call_ns(F&& fn, double min_time_ms) {
+    fn();  // warm caches and lazy initialization
+    for (size_t iterations = 1;; iterations *= 2) {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        const double ms = elapsed_ms(start);
+        if (ms >= min_time_ms || iterations >= (size_t{1} << 30)) {
+            return ms * 1e6 / static_cast<double>(iterations);
+        }
+    }
+}
+
+void write_throughput(JsonWriter& json, size_t samples, double ns_per_call) {
+    const double ns_per_sample = ns_per_call / static_cast<double>(samples);
+    json.field("samples", static_cast<long long>(samples));
+    json.field("ns_per_sample", ns_per_sample);
+    json.field("samples_per_sec", 1e9 / ns_per_sample);
+}
+
+void bench_kernels(JsonWriter& json, const Options& options) {
+    std::vector<const AudioKernels*> variants = {&audio_kernels_scalar()};
+    if (const AudioKernels* neon = audio_kernels_neon()) {
+        variants.push_back(neon);
+    }
+
+    const size_t max_size = kKernelSizes[sizeof(kKernelSizes) / sizeof(kKernelSizes[0]) - 1];
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pcm_dist(-32768, 32767);
+    std::vector<int16_t> pcm(max_size);
+    for (int16_t& s : pcm) {
+        s = static_cast<int16_t>(pcm_dist(rng));
+    }
+    std::vector<float> a(max_size);
+    std::vector<float> b(max_size);
+    audio_kernels_scalar().pcm16_to_float(pcm.data(), a.data(), max_size);
+    std::reverse_copy(a.begin(), a.end(), b.begin());
+    std::vector<float> out(max_size);
+
+    json.begin_array("kernels");
+    for (const AudioKernels* kernels : variants) {
+        for (size_t n : kKernelSizes) {
+            struct Case {
+                const char* name;
+                double ns;
+            };
+            const Case cases[] = {
+                {"pcm16_to_float", time_per_call_ns([&] {
+                     kernels->pcm16_to_float(pcm.data(), out.data(), n);
+                     g_sink = g_sink + out[n - 1];
+                 }, options.min_time_ms)},
+                {"sum_squares", time_per_call_ns([&] {
+                     g_sink = g_sink + kernels->sum_squares(a.data(), n);
+                 }, options.min_time_ms)},
+                {"abs_max", time_per_call_ns([&] {
+                     g_sink = g_sink + kernels->abs_max(a.data(), n);
+                 }, options.min_time_ms)},
+                {"scale", time_per_call_ns([&] {
+                     kernels->scale(a.data(), out.data(), n, 0.5f);
+                     g_sink = g_sink + out[n - 1];
+                 }, options.min_time_ms)},
+                {"dot", time_per_call_ns([&] {
+                     g_sink = g_sink + kernels->dot(a.data(), b.data(), n);
+                 }, options.min_time_ms)},
+            };
+
+            for (const Case& c : cases) {
+                json.begin_object();
+                json.field("kernel", c.name);
+                json.field("impl", kernels->name);
+                write_throughput(json, n, c.ns);
+                json.end_object();
+            }
+        }
+    }
+    json.end_array();
+}
+
+void bench_stages(JsonWriter& json, const Options& options) {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+
+    json.begin_array("stages");
+
+    // One second of input per call, as the capture pipeline sees it in blocks
+    for (int rate : kResampleRates) {
+        std::vector<float> in(static_cast<size_t>(rate));
+        for (float& s : in) {
+            s = noise(rng);
+        }
+        std::vector<float> out(resampled_length(in.size(), rate, kWhisperSampleRate) + 64);
+        const double ns = time_per_call_ns([&] {
+            g_sink = g_sink + static_cast<double>(
+                resample_buffer(in.data(), in.size(), rate, kWhisperSampleRate, out.data()));
+        }, options.min_time_ms);
+
+        json.begin_object();
+        json.field("stage", "resample");
+        json.field("source_rate", static_cast<long long>(rate));
+        write_throughput(json, in.size(), ns);
+        json.end_object();
+    }
+
+    for (size_t n : {size_t{512}, size_t{1024}}) {
+        std::shared_ptr<const FftPlan> plan = get_fft_plan(n);
+        std::vector<float> in(n);
+        for (float& s : in) {
+            s = noise(rng);
+        }
+        std::vector<std::complex<float>> work(plan->bins());
+        std::vector<float> power(plan->bins());
+        const double ns = time_per_call_ns([&] {
+            plan->power_spectrum(in.data(), work.data(), power.data());
+            g_sink = g_sink + power[1];
+        }, options.min_time_ms);
+
+        json.begin_object();
+        json.field("stage", "fft_power_spectrum");
+        write_throughput(json, n, ns);
+        json.end_object();
+    }
+
+    {
+        // Ten seconds of noise with a tone burst so both VAD branches run
+        std::vector<float> audio(static_cast<size_t>(kWhisperSampleRate) * 10);
+        for (size_t i = 0; i < audio.size(); ++i) {
+            audio[i] = noise(rng) * 0.05f;
+            if (i > audio.size() / 3 && i < audio.size() * 2 / 3) {
+                audio[i] += 0.3f * std::sin(2.0f * static_cast<float>(M_PI) * 220.0f * i / kWhisperSampleRate);
+            }
+        }
+        VoiceActivityDetector vad;
+        const double ns = time_per_call_ns([&] {
+            g_sink = g_sink + static_cast<double>(vad.detect(audio.data(), audio.size()).size());
+        }, options.min_time_ms);
+
+        json.begin_object();
+        json.field("stage", "vad_detect");
+        write_throughput(json, audio.size(), ns);
+        json.end_object();
+    }
+
+    json.end_array();
+}
+
+void bench_transcription(JsonWriter& json, const Options& options) {
+    json.begin_array("transcription");
+    if (options.model_path.empty() || options.fixtures.empty()) {
+        json.end_array();
+        return;
+    }
+
+    const whisper_context_params cparams = options.gpu_device >= 0
+        ? backend_context_params(InferenceBackend::Gpu, options.gpu_device)
+        : backend_context_params(InferenceBackend::Cpu, 0);
+    const auto load_start = Clock::now();
+    std::shared_ptr<SharedModel> model = acquire_model(options.model_path, cparams);
+    const double load_ms = elapsed_ms(load_start);
+    if (model == nullptr) {
+        std::fprintf(stderr, "Failed to load model %s\n", options.model_path.c_str());
+        json.end_array();
+        return;
+    }
+
+    const int n_threads = options.n_threads > 0
+                              ? options.n_threads
+                              : std::max<int>(1, static_cast<int>(cpu_topology().big_cores.size()));
+
+    for (const std::string& fixture : options.fixtures) {
+        WavFile wav;
+        if (!read_wav(fixture, wav)) {
+            continue;
+        }
+        const double audio_ms = 1000.0 * static_cast<double>(wav.samples.size()) / wav.sample_rate;
+
+        // Same steps transcribeAudio performs
+        const auto preprocess_start = Clock::now();
+        std::vector<float> samples = std::move(wav.samples);
+        if (wav.sample_rate != kWhisperSampleRate) {
+            std::vector<float> resampled(resampled_length(samples.size(), wav.sample_rate, kWhisperSampleRate));
+            resampled.resize(resample_buffer(samples.data(), samples.size(), wav.sample_rate,
+                                             kWhisperSampleRate, resampled.data()));
+            samples.swap(resampled);
+        }
+        const double preprocess_ms = elapsed_ms(preprocess_start);
+
+        const auto vad_start = Clock::now();
+        VoiceActivityDetector vad;
+        std::vector<SpeechRegion> regions = vad.detect(samples.data(), samples.size());
+        std::vector<float> voiced(speech_length(regions));
+        voiced.resize(compact_speech(samples.data(), regions, voiced.data()));
+        const double vad_ms = elapsed_ms(vad_start);
+
+        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        wparams.n_threads = n_threads;
+        wparams.language = options.language.c_str();
+        wparams.print_progress = false;
+        wparams.print_timestamps = false;
+        wparams.print_realtime = false;
+        wparams.print_special = false;
+
+        std::string text;
+        int status = 0;
+        const auto whisper_start = Clock::now();
+        if (!voiced.empty()) {
+            std::lock_guard<std::mutex> lock(model->mutex);
+            ScopedBigCoreAffinity affinity(n_threads);
+            status = whisper_full(model->ctx, wparams, voiced.data(), static_cast<int>(voiced.size()));
+            for (int i = 0; status == 0 && i < whisper_full_n_segments(model->ctx); ++i) {
+                text += whisper_full_get_segment_text(model->ctx, i);
+            }
+        }
+        const double whisper_ms = elapsed_ms(whisper_start);
+        const double total_ms = preprocess_ms + vad_ms + whisper_ms;
+
+        json.begin_object();
+        json.field("fixture", fixture);
+        json.field("sample_rate", static_cast<long long>(wav.sample_rate));
+        json.field("audio_ms", audio_ms);
+        json.field("voiced_ms", 1000.0 * static_cast<double>(voiced.size()) / kWhisperSampleRate);
+        json.field("threads", static_cast<long long>(n_threads));
+        json.field("backend", cparams.use_gpu ? "gpu" : "cpu");
+        json.field("model_load_ms", load_ms);
+        json.field("preprocess_ms", preprocess_ms);
+        json.field("vad_ms", vad_ms);
+        json.field("whisper_ms", whisper_ms);
+        json.field("total_ms", total_ms);
+        json.field("rtf", total_ms / audio_ms);
+        json.field("ok", status == 0);
+        json.field("text", text);
+        json.end_object();
+    }
+    json.end_array();
+}
+
+bool parse_args(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "--model" && (v = value())) {
+            options.model_path = v;
+        } else if (arg == "--threads" && (v = value())) {
+            options.n_threads = std::atoi(v);
+        } else if (arg == "--gpu" && (v = value())) {
+            options.gpu_device = std::atoi(v);
+        } else if (arg == "--language" && (v = value())) {
+            options.language = v;
+        } else if (arg == "--min-time-ms" && (v = value())) {
+            options.min_time_ms = std::max(1.0, std::atof(v));
+        } else if (arg == "--output" && (v = value())) {
+            options.output_path = v;
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.fixtures.push_back(arg);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--model PATH] [--threads N] [--language CODE] [--gpu N]\n"
+                         "          [--min-time-ms N] [--output FILE] [fixture.wav ...]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        return 2;
+    }
+
+    FILE* out = stdout;
+    if (!options.output_path.empty()) {
+        out = std::fopen(options.output_path.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", options.output_path.c_str());
+            return 1;
+        }
+    }
+
+    const CpuTopology& topology = cpu_topology();
+    JsonWriter json(out);
+    json.begin_object();
+    json.field("whisper_system_info", whisper_print_system_info());
+
+    json.begin_object("device");
+    json.field("cpus", static_cast<long long>(topology.n_cpus));
+    json.field("big_cores", static_cast<long long>(topology.big_cores.size()));
+    json.field("kernels", audio_kernels().name);
+    json.end_object();
+
+    bench_kernels(json, options);
+    bench_stages(json, options);
+    bench_transcription(json, options);
+
+    json.field("peak_rss_kb", peak_rss_kb());
+    json.end_object();
+    json.finish();
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
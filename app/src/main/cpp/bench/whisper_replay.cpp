@@ -0,0 +1,701 @@
+/**
+ * Replay harness and regression gate for the native capture and streaming
+ * path.
+ *
+ * Each WAV fixture is written as PCM16 into a CapturePipeline at its own
+ * rate in 10 ms blocks, the way the recorder feeds AudioCaptureBuffer, so
+ * it goes through the production ring buffer, resampler, conditioning
+ * filters and online VAD. The processed audio is decoded by a WhisperStream
+ * with WhisperNative.startStreaming's defaults, as streamAttach wires it.
+ *
+ * The replay is deterministic. A write that finds the ring full is retried
+ * instead of dropped, and processed audio reaches the decoder in fixed
+ * 100 ms pushes whatever block sizes the worker delivers, so every run
+ * decodes the same windows. With --realtime the writes are paced at
+ * capture speed and a full ring drops samples, as in a live recording.
+ * That mode measures how far committed segments lag the audio instead of
+ * throughput.
+ *
+ * A fixture's reference transcript is read from the .txt file next to it
+ * (clip.wav -> clip.txt) and scored as word error rate. With --baseline,
+ * WER, real-time factor, p95 decode latency and peak RSS are compared with
+ * a stored run. The exit status is 1 when any of them regresses past its
+ * threshold, or a decode fails or drops audio. --write-baseline stores this
+ * run's values for later runs with the same model, device and flags.
+ *
+ * Usage (see scripts/run_replay.sh):
+ *   whisper_replay --model PATH [--threads N] [--language CODE] [--realtime]
+ *                  [--high-pass HZ] [--notch HZ] [--denoise S] [--agc LEVEL]
+ *                  [--baseline FILE] [--write-baseline FILE]
+ *                  [--max-wer-delta D] [--max-rtf-regression R]
+ *                  [--max-latency-regression R] [--max-rss-regression R]
+ *                  [--output FILE] fixture.wav ...
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <whisper.h>
+
+#include "accelerator.h"
+#include "audio_kernels.h"
+#include "bench/bench_common.h"
+#include "capture_pipeline.h"
+#include "cpu_topology.h"
+#include "model_cache.h"
+#include "perf_stats.h"
+#include "whisper_stream.h"
+
+namespace {
+
+constexpr int kWhisperSampleRate = 16000;
+constexpr int kCaptureBlockMs = 10;
+constexpr int kCaptureCapacitySeconds = 4;  // AudioCaptureBuffer's default ring
+constexpr size_t kDecoderPush = kWhisperSampleRate / 10;
+
+// WhisperNative.STREAM_WINDOW_MS and STREAM_STEP_MS
+constexpr int kStreamWindowMs = 10000;
+constexpr int kStreamStepMs = 2000;
+
+struct Options {
+    std::string model_path;
+    std::string language = "en";
+    std::string output_path;
+    std::string baseline_path;
+    std::string write_baseline_path;
+    std::vector<std::string> fixtures;
+    int n_threads = 0;  // 0 = one per big core
+    bool realtime = false;
+    float high_pass_hz = 0.0f;
+    float notch_hz = 0.0f;
+    float denoise = 0.0f;
+    float agc_level = 0.0f;
+    double max_wer_delta = 0.02;          // absolute
+    double max_rtf_regression = 0.15;     // relative to the baseline
+    double max_latency_regression = 0.25;
+    double max_rss_regression = 0.10;
+};
+
+/** Stored values of one fixture; NaN or -1 where the baseline run had none. */
+struct Baseline {
+    double wer = NAN;
+    double rtf = NAN;
+    double decode_p95_ms = NAN;
+    long long peak_rss_kb = -1;
+};
+
+/** Metrics of one fixture's replay. */
+struct ReplayResult {
+    std::string fixture;  // file name, the baseline key
+    double audio_ms = 0.0;
+    double wall_ms = 0.0;
+    double rtf = NAN;
+    double decode_p50_ms = NAN;
+    double decode_p95_ms = NAN;
+    double decode_max_ms = NAN;
+    double lag_p95_ms = NAN;
+    double wer = NAN;
+    long long ref_words = -1;
+    long long peak_rss_kb = -1;
+    long long dropped = 0;
+    long long decodes = 0;
+    long long final_segments = 0;
+    bool ok = false;
+    bool has_baseline = false;
+    std::string text;
+    StageStats stages[kStageCount];
+    std::vector<std::string> regressions;
+};
+
+std::string file_name(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/** clip.wav -> clip.txt, next to the fixture. */
+std::string reference_path(const std::string& fixture) {
+    const size_t slash = fixture.find_last_of('/');
+    const size_t dot = fixture.find_last_of('.');
+    const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (has_extension ? fixture.substr(0, dot) : fixture) + ".txt";
+}
+
+bool read_text_file(const std::string& path, std::string& out) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.append(buffer, n);
+    }
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * Lowercased words of text. Anything but ASCII letters, digits,
+ * apostrophes and non-ASCII bytes separates words, so punctuation and
+ * whitespace differences don't count as errors.
+ */
+std::vector<std::string> normalized_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '\'' || c >= 0x80) {
+            word += static_cast<char>(std::tolower(c));
+        } else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+/** Word-level Levenshtein distance: substitutions, insertions and deletions. */
+size_t word_edits(const std::vector<std::string>& ref, const std::vector<std::string>& hyp) {
+    std::vector<size_t> prev(hyp.size() + 1);
+    std::vector<size_t> cur(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); ++j) {
+        prev[j] = j;
+    }
+    for (size_t i = 1; i <= ref.size(); ++i) {
+        cur[0] = i;
+        for (size_t j = 1; j <= hyp.size(); ++j) {
+            const size_t substitution = prev[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            cur[j] = std::min({substitution, prev[j] + 1, cur[j - 1] + 1});
+        }
+        prev.swap(cur);
+    }
+    return prev[hyp.size()];
+}
+
+/** Nearest-rank percentile p in [0, 1]; NaN for no values. */
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return NAN;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::min(std::max<size_t>(rank, 1), values.size()) - 1];
+}
+
+/**
+ * Decoder side of a replay: receives the pipeline's processed blocks on its
+ * worker thread and pushes them into the stream in fixed-size pieces.
+ */
+class DecoderFeed {
+public:
+    DecoderFeed(WhisperStream& stream, bool realtime, Clock::time_point start)
+        : stream_(stream), realtime_(realtime), start_(start) {}
+
+    void receive(const float* samples, size_t n) {
+        pending_.insert(pending_.end(), samples, samples + n);
+        size_t offset = 0;
+        while (pending_.size() - offset >= kDecoderPush) {
+            push(pending_.data() + offset, kDecoderPush);
+            offset += kDecoderPush;
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+
+    /** Push the remainder and decode it as final; call once the pipeline has stopped. */
+    void finish() {
+        if (!pending_.empty()) {
+            push(pending_.data(), pending_.size());
+            pending_.clear();
+        }
+        timed([this] { return stream_.finish(segments_); });
+    }
+
+    bool failed() const { return failed_; }
+    const std::string& text() const { return text_; }
+    long long final_segments() const { return final_segments_; }
+    const std::vector<double>& decode_ms() const { return decode_ms_; }
+    const std::vector<double>& lag_ms() const { return lag_ms_; }
+
+private:
+    void push(const float* samples, size_t n) {
+        timed([&] { return stream_.push(samples, n, segments_); });
+    }
+
+    template <typename F>
+    void timed(F&& call) {
+        if (failed_) {
+            return;
+        }
+        const uint64_t decodes = stream_.stats().decodes;
+        const auto call_start = Clock::now();
+        failed_ = !call();
+        if (stream_.stats().decodes != decodes) {
+            decode_ms_.push_back(elapsed_ms(call_start));
+        }
+        collect();
+    }
+
+    void collect() {
+        for (const StreamSegment& segment : segments_) {
+            if (!segment.is_final) {
+                continue;
+            }
+            if (!segment.text.empty()) {
+                if (!text_.empty()) {
+                    text_ += ' ';
+                }
+                text_ += segment.text;
+            }
+            ++final_segments_;
+            if (realtime_) {
+                // Paced writes put the audio at end_ms into the ring end_ms after the start
+                lag_ms_.push_back(elapsed_ms(start_) - static_cast<double>(segment.end_ms));
+            }
+        }
+        segments_.clear();
+    }
+
+    WhisperStream& stream_;
+    const bool realtime_;
+    const Clock::time_point start_;
+    std::vector<float> pending_;
+    std::vector<StreamSegment> segments_;
+    std::vector<double> decode_ms_;
+    std::vector<double> lag_ms_;
+    std::string text_;
+    long long final_segments_ = 0;
+    bool failed_ = false;
+};
+
+bool configure_pipeline(CapturePipeline& pipeline, const Options& options) {
+    if (options.high_pass_hz > 0.0f || options.notch_hz > 0.0f) {
+        FilterBankParams params;
+        params.high_pass_hz = options.high_pass_hz;
+        params.notch_hz = options.notch_hz;
+        if (!pipeline.set_filter(params)) {
+            std::fprintf(stderr, "Invalid filter: high-pass %.1f Hz, notch %.1f Hz\n",
+                         options.high_pass_hz, options.notch_hz);
+            return false;
+        }
+    }
+    if (options.denoise > 0.0f && !pipeline.set_noise_suppression(options.denoise)) {
+        std::fprintf(stderr, "Invalid noise suppression strength %.2f\n", options.denoise);
+        return false;
+    }
+    if (options.agc_level > 0.0f) {
+        AgcParams params;
+        params.target_level = options.agc_level;
+        if (!pipeline.set_agc(&params)) {
+            std::fprintf(stderr, "Invalid AGC target level %.3f\n", options.agc_level);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool replay_fixture(const Options& options, whisper_context* ctx, int n_threads, const std::string& path,
+                    ReplayResult& result) {
+    result.fixture = file_name(path);
+
+    WavFile wav;
+    if (!read_wav(path, wav)) {
+        return false;
+    }
+    std::vector<int16_t> pcm(wav.samples.size());
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        const float scaled = std::round(wav.samples[i] * 32768.0f);
+        pcm[i] = static_cast<int16_t>(std::clamp(scaled, -32768.0f, 32767.0f));
+    }
+    result.audio_ms = 1000.0 * static_cast<double>(pcm.size()) / wav.sample_rate;
+
+    reset_peak_rss();
+    reset_stage_stats();
+
+    CapturePipeline pipeline(wav.sample_rate, static_cast<size_t>(wav.sample_rate) * kCaptureCapacitySeconds);
+    if (!pipeline.is_valid()) {
+        std::fprintf(stderr, "%s: unsupported sample rate %d\n", path.c_str(), wav.sample_rate);
+        return false;
+    }
+    if (!configure_pipeline(pipeline, options)) {
+        return false;
+    }
+
+    WhisperStreamParams params;
+    params.sample_rate = kWhisperSampleRate;
+    params.window_ms = kStreamWindowMs;
+    params.step_ms = kStreamStepMs;
+    params.n_threads = n_threads;
+    params.language = options.language;
+    WhisperStream stream(ctx, params);
+    if (!stream.is_valid()) {
+        std::fprintf(stderr, "Failed to create streaming session\n");
+        return false;
+    }
+
+    const auto start = Clock::now();
+    DecoderFeed feed(stream, options.realtime, start);
+    pipeline.set_sink([&feed](const float* samples, size_t n) { feed.receive(samples, n); });
+
+    // The processed ring is drained like the app's reader so it never fills
+    std::vector<float> processed(static_cast<size_t>(kWhisperSampleRate));
+    const size_t block = std::max<size_t>(static_cast<size_t>(wav.sample_rate) * kCaptureBlockMs / 1000, 1);
+    for (size_t offset = 0; offset < pcm.size();) {
+        const size_t n = std::min(block, pcm.size() - offset);
+        if (options.realtime) {
+            std::this_thread::sleep_until(
+                start + std::chrono::microseconds(static_cast<int64_t>(offset) * 1000000 / wav.sample_rate));
+        }
+        size_t accepted = pipeline.write(pcm.data() + offset, n);
+        if (options.realtime) {
+            result.dropped += static_cast<long long>(n - accepted);
+        }
+        while (accepted < n && !options.realtime) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            accepted += pipeline.write(pcm.data() + offset + accepted, n - accepted);
+        }
+        // The decoder runs on the sink thread; unpaced, wait for it rather
+        // than let its queue overflow
+        while (!options.realtime && pipeline.sink_pending() > kWhisperSampleRate) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (pipeline.read_processed(processed.data(), processed.size()) > 0) {
+        }
+        offset += n;
+    }
+    pipeline.stop();  // drains the rings through the sink and joins both threads
+    result.dropped += static_cast<long long>(pipeline.dropped_sink());
+    feed.finish();
+    result.wall_ms = elapsed_ms(start);
+
+    const WhisperStreamStats stats = stream.stats();
+    result.decodes = static_cast<long long>(stats.decodes);
+    // Paced replay takes as long as the audio, so only decoding is compared to it
+    result.rtf = options.realtime ? static_cast<double>(stats.total_decode_ns) / 1e6 / result.audio_ms
+                                  : result.wall_ms / result.audio_ms;
+    result.decode_p50_ms = percentile(feed.decode_ms(), 0.50);
+    result.decode_p95_ms = percentile(feed.decode_ms(), 0.95);
+    result.decode_max_ms = percentile(feed.decode_ms(), 1.0);
+    result.lag_p95_ms = percentile(feed.lag_ms(), 0.95);
+    result.final_segments = feed.final_segments();
+    result.text = feed.text();
+    result.ok = !feed.failed();
+    result.peak_rss_kb = peak_rss_kb();
+    snapshot_stage_stats(result.stages);
+
+    std::string reference;
+    if (read_text_file(reference_path(path), reference)) {
+        const std::vector<std::string> ref = normalized_words(reference);
+        result.ref_words = static_cast<long long>(ref.size());
+        if (!ref.empty()) {
+            result.wer = static_cast<double>(word_edits(ref, normalized_words(result.text))) /
+                         static_cast<double>(ref.size());
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> split_tabs(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (size_t tab; (tab = line.find('\t', start)) != std::string::npos; start = tab + 1) {
+        fields.push_back(line.substr(start, tab - start));
+    }
+    fields.push_back(line.substr(start));
+    return fields;
+}
+
+/**
+ * Read a baseline written by write_baselines(): one tab-separated line per
+ * fixture with name, WER, RTF, p95 decode ms and peak RSS kB; # starts a
+ * comment.
+ */
+bool load_baselines(const std::string& path, std::map<std::string, Baseline>& out) {
+    std::string contents;
+    if (!read_text_file(path, contents)) {
+        std::fprintf(stderr, "Cannot read baseline %s\n", path.c_str());
+        return false;
+    }
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos) {
+            end = contents.size();
+        }
+        const std::string line = contents.substr(start, end - start);
+        start = end + 1;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const std::vector<std::string> fields = split_tabs(line);
+        if (fields.size() < 5) {
+            std::fprintf(stderr, "Malformed baseline line: %s\n", line.c_str());
+            return false;
+        }
+        Baseline baseline;
+        baseline.wer = std::strtod(fields[1].c_str(), nullptr);
+        baseline.rtf = std::strtod(fields[2].c_str(), nullptr);
+        baseline.decode_p95_ms = std::strtod(fields[3].c_str(), nullptr);
+        baseline.peak_rss_kb = std::strtoll(fields[4].c_str(), nullptr, 10);
+        out[fields[0]] = baseline;
+    }
+    return true;
+}
+
+bool write_baselines(const std::string& path, const std::vector<ReplayResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot write baseline %s\n", path.c_str());
+        return false;
+    }
+    std::fputs("# fixture\twer\trtf\tdecode_p95_ms\tpeak_rss_kb\n", file);
+    for (const ReplayResult& result : results) {
+        if (result.ok) {
+            std::fprintf(file, "%s\t%.6g\t%.6g\t%.6g\t%lld\n", result.fixture.c_str(), result.wer, result.rtf,
+                         result.decode_p95_ms, result.peak_rss_kb);
+        }
+    }
+    return std::fclose(file) == 0;
+}
+
+void add_regression(ReplayResult& result, const char* metric, double value, double limit) {
+    char message[160];
+    std::snprintf(message, sizeof(message), "%s %.4g exceeds %.4g", metric, value, limit);
+    result.regressions.push_back(message);
+}
+
+/** Fill result.regressions from failures and from limits relative to baseline. */
+void check_regressions(const Options& options, const Baseline* baseline, ReplayResult& result) {
+    if (!result.ok) {
+        result.regressions.push_back("replay failed");
+    }
+    if (result.dropped > 0) {
+        add_regression(result, "dropped samples", static_cast<double>(result.dropped), 0.0);
+    }
+    if (baseline == nullptr) {
+        return;
+    }
+    result.has_baseline = true;
+
+    // NaN on either side, e.g. a fixture without a reference, skips the check
+    const double wer_limit = baseline->wer + options.max_wer_delta;
+    if (result.wer > wer_limit) {
+        add_regression(result, "wer", result.wer, wer_limit);
+    }
+    const double rtf_limit = baseline->rtf * (1.0 + options.max_rtf_regression);
+    if (result.rtf > rtf_limit) {
+        add_regression(result, "rtf", result.rtf, rtf_limit);
+    }
+    const double latency_limit = baseline->decode_p95_ms * (1.0 + options.max_latency_regression);
+    if (result.decode_p95_ms > latency_limit) {
+        add_regression(result, "decode_p95_ms", result.decode_p95_ms, latency_limit);
+    }
+    if (baseline->peak_rss_kb > 0 && result.peak_rss_kb > 0) {
+        const double rss_limit = static_cast<double>(baseline->peak_rss_kb) * (1.0 + options.max_rss_regression);
+        if (static_cast<double>(result.peak_rss_kb) > rss_limit) {
+            add_regression(result, "peak_rss_kb", static_cast<double>(result.peak_rss_kb), rss_limit);
+        }
+    }
+}
+
+void write_result(JsonWriter& json, const ReplayResult& result) {
+    json.begin_object();
+    json.field("fixture", result.fixture);
+    json.field("ok", result.ok);
+    json.field("audio_ms", result.audio_ms);
+    json.field("wall_ms", result.wall_ms);
+    json.field("rtf", result.rtf);
+    json.field("decodes", result.decodes);
+    json.field("decode_p50_ms", result.decode_p50_ms);
+    json.field("decode_p95_ms", result.decode_p95_ms);
+    json.field("decode_max_ms", result.decode_max_ms);
+    json.field("lag_p95_ms", result.lag_p95_ms);
+    json.field("dropped_samples", result.dropped);
+    json.field("peak_rss_kb", result.peak_rss_kb);
+    json.field("ref_words", result.ref_words);
+    json.field("wer", result.wer);
+    json.field("final_segments", result.final_segments);
+    json.field("text", result.text);
+
+    json.begin_object("stages");
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageStats& stage = result.stages[i];
+        if (stage.count == 0) {
+            continue;
+        }
+        json.begin_object(stage_name(static_cast<Stage>(i)));
+        json.field("count", static_cast<long long>(stage.count));
+        json.field("total_ms", static_cast<double>(stage.total_ns) / 1e6);
+        json.field("max_ms", static_cast<double>(stage.max_ns) / 1e6);
+        json.end_object();
+    }
+    json.end_object();
+
+    json.field("baseline", result.has_baseline);
+    json.begin_array("regressions");
+    for (const std::string& regression : result.regressions) {
+        json.field(nullptr, regression);
+    }
+    json.end_array();
+    json.end_object();
+}
+
+bool parse_args(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "--model" && (v = value())) {
+            options.model_path = v;
+        } else if (arg == "--threads" && (v = value())) {
+            options.n_threads = std::atoi(v);
+        } else if (arg == "--language" && (v = value())) {
+            options.language = v;
+        } else if (arg == "--realtime") {
+            options.realtime = true;
+        } else if (arg == "--high-pass" && (v = value())) {
+            options.high_pass_hz = static_cast<float>(std::atof(v));
+        } else if (arg == "--notch" && (v = value())) {
+            options.notch_hz = static_cast<float>(std::atof(v));
+        } else if (arg == "--denoise" && (v = value())) {
+            options.denoise = static_cast<float>(std::atof(v));
+        } else if (arg == "--agc" && (v = value())) {
+            options.agc_level = static_cast<float>(std::atof(v));
+        } else if (arg == "--baseline" && (v = value())) {
+            options.baseline_path = v;
+        } else if (arg == "--write-baseline" && (v = value())) {
+            options.write_baseline_path = v;
+        } else if (arg == "--max-wer-delta" && (v = value())) {
+            options.max_wer_delta = std::atof(v);
+        } else if (arg == "--max-rtf-regression" && (v = value())) {
+            options.max_rtf_regression = std::atof(v);
+        } else if (arg == "--max-latency-regression" && (v = value())) {
+            options.max_latency_regression = std::atof(v);
+        } else if (arg == "--max-rss-regression" && (v = value())) {
+            options.max_rss_regression = std::atof(v);
+        } else if (arg == "--output" && (v = value())) {
+            options.output_path = v;
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.fixtures.push_back(arg);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s --model PATH [--threads N] [--language CODE] [--realtime]\n"
+                         "          [--high-pass HZ] [--notch HZ] [--denoise S] [--agc LEVEL]\n"
+                         "          [--baseline FILE] [--write-baseline FILE]\n"
+                         "          [--max-wer-delta D] [--max-rtf-regression R]\n"
+                         "          [--max-latency-regression R] [--max-rss-regression R]\n"
+                         "          [--output FILE] fixture.wav ...\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    if (options.model_path.empty() || options.fixtures.empty()) {
+        std::fprintf(stderr, "%s: a model and at least one fixture are required\n", argv[0]);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        return 2;
+    }
+
+    std::map<std::string, Baseline> baselines;
+    if (!options.baseline_path.empty() && !load_baselines(options.baseline_path, baselines)) {
+        return 2;
+    }
+
+    std::shared_ptr<SharedModel> model =
+        acquire_model(options.model_path, backend_context_params(InferenceBackend::Cpu, 0));
+    if (model == nullptr) {
+        std::fprintf(stderr, "Failed to load model %s\n", options.model_path.c_str());
+        return 1;
+    }
+    const int n_threads = options.n_threads > 0
+                              ? options.n_threads
+                              : std::max<int>(1, static_cast<int>(cpu_topology().big_cores.size()));
+
+    std::vector<ReplayResult> results;
+    bool passed = true;
+    for (const std::string& fixture : options.fixtures) {
+        results.emplace_back();
+        ReplayResult& result = results.back();
+        if (!replay_fixture(options, model->ctx, n_threads, fixture, result)) {
+            result.fixture = file_name(fixture);
+            result.ok = false;
+        }
+        const auto baseline = baselines.find(result.fixture);
+        check_regressions(options, baseline != baselines.end() ? &baseline->second : nullptr, result);
+        for (const std::string& regression : result.regressions) {
+            std::fprintf(stderr, "%s: %s\n", result.fixture.c_str(), regression.c_str());
+        }
+        passed = passed && result.regressions.empty();
+    }
+
+    FILE* out = stdout;
+    if (!options.output_path.empty()) {
+        out = std::fopen(options.output_path.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", options.output_path.c_str());
+            return 1;
+        }
+    }
+
+    const CpuTopology& topology = cpu_topology();
+    JsonWriter json(out);
+    json.begin_object();
+    json.field("whisper_system_info", whisper_print_system_info());
+
+    json.begin_object("device");
+    json.field("cpus", static_cast<long long>(topology.n_cpus));
+    json.field("big_cores", static_cast<long long>(topology.big_cores.size()));
+    json.field("kernels", audio_kernels().name);
+    json.end_object();
+
+    json.begin_object("config");
+    json.field("model", options.model_path);
+    json.field("threads", static_cast<long long>(n_threads));
+    json.field("language", options.language);
+    json.field("realtime", options.realtime);
+    json.field("high_pass_hz", static_cast<double>(options.high_pass_hz));
+    json.field("notch_hz", static_cast<double>(options.notch_hz));
+    json.field("denoise", static_cast<double>(options.denoise));
+    json.field("agc_level", static_cast<double>(options.agc_level));
+    json.end_object();
+
+    json.begin_array("fixtures");
+    for (const ReplayResult& result : results) {
+        write_result(json, result);
+    }
+    json.end_array();
+
+    json.field("passed", passed);
+    json.end_object();
+    json.finish();
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    if (!options.write_baseline_path.empty() && !write_baselines(options.write_baseline_path, results)) {
+        return 1;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include "biquad_filter.h"
+#include "audio_kernels.h"
+
+#include <cmath>
+
+#if AUDIO_KERNELS_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr size_t kLanes = BiquadFilterBank::kMaxSections;
+constexpr float kPi = 3.14159265358979f;
+
+// Q of the sections of 2nd and 4th order Butterworth high-pass filters
+constexpr float kButterworthQ2[] = {0.70710678f};
+constexpr float kButterworthQ4[] = {0.54119610f, 1.30656296f};
+
+bool in_band(float hz, int sample_rate) {
+    return hz > 0.0f && hz < 0.5f * static_cast<float>(sample_rate);
+}
+
+} // namespace
+
+BiquadFilterBank::BiquadFilterBank(const FilterBankParams& params) {
+    // Unused lanes pass samples through untouched
+    for (size_t k = 0; k < kLanes; ++k) {
+        b0_[k] = 1.0f;
+        b1_[k] = b2_[k] = a1_[k] = a2_[k] = 0.0f;
+    }
+    reset();
+
+    const int rate = params.sample_rate;
+    if (rate <= 0) {
+        valid_ = false;
+        return;
+    }
+
+    if (params.high_pass_hz > 0.0f) {
+        if (!in_band(params.high_pass_hz, rate) || (params.high_pass_order != 2 && params.high_pass_order != 4)) {
+            valid_ = false;
+            return;
+        }
+        const float w0 = 2.0f * kPi * params.high_pass_hz / static_cast<float>(rate);
+        const float cos_w0 = std::cos(w0);
+        const float* qs = params.high_pass_order == 2 ? kButterworthQ2 : kButterworthQ4;
+        for (int i = 0; i < params.high_pass_order / 2; ++i) {
+            const float alpha = std::sin(w0) / (2.0f * qs[i]);
+            const float a0 = 1.0f + alpha;
+            const float b = (1.0f + cos_w0) / 2.0f / a0;
+            add_section(b, -2.0f * b, b, -2.0f * cos_w0 / a0, (1.0f - alpha) / a0);
+        }
+    }
+
+    if (params.notch_hz > 0.0f) {
+        if (!in_band(params.notch_hz, rate) || params.notch_q <= 0.0f) {
+            valid_ = false;
+            return;
+        }
+        const float w0 = 2.0f * kPi * params.notch_hz / static_cast<float>(rate);
+        const float alpha = std::sin(w0) / (2.0f * params.notch_q);
+        const float a0 = 1.0f + alpha;
+        const float a1 = -2.0f * std::cos(w0) / a0;
+        add_section(1.0f / a0, a1, 1.0f / a0, a1, (1.0f - alpha) / a0);
+    }
+
+    if (params.pre_emphasis != 0.0f) {
+        if (params.pre_emphasis < 0.0f || params.pre_emphasis >= 1.0f) {
+            valid_ = false;
+            return;
+        }
+        add_section(1.0f, -params.pre_emphasis, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+void BiquadFilterBank::add_section(float b0, float b1, float b2, float a1, float a2) {
+    b0_[sections_] = b0;
+    b1_[sections_] = b1;
+    b2_[sections_] = b2;
+    a1_[sections_] = a1;
+    a2_[sections_] = a2;
+    ++sections_;
+}
+
+void BiquadFilterBank::reset() {
+    for (size_t k = 0; k < kLanes; ++k) {
+        s1_[k] = 0.0f;
+        s2_[k] = 0.0f;
+    }
+}
+
+void BiquadFilterBank::process_section(size_t k, float* data, size_t n) {
+    const float b0 = b0_[k], b1 = b1_[k], b2 = b2_[k], a1 = a1_[k], a2 = a2_[k];
+    float s1 = s1_[k], s2 = s2_[k];
+    for (size_t i = 0; i < n; ++i) {
+        const float x = data[i];
+        const float y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        data[i] = y;
+    }
+    s1_[k] = s1;
+    s2_[k] = s2;
+}
+
+void BiquadFilterBank::process(float* data, size_t n) {
+    if (!valid_ || sections_ == 0 || n == 0) {
+        return;
+    }
+
+    // Short chunks and single sections gain nothing from the wavefront
+    constexpr size_t kDepth = kLanes - 1;
+    if (sections_ == 1 || n < 4 * kLanes) {
+        for (size_t k = 0; k < sections_; ++k) {
+            process_section(k, data, n);
+        }
+        return;
+    }
+
+    // Prologue: bring section k up to sample kDepth - 1 - k. The copy keeps
+    // data[0, kDepth) as raw input for the wavefront's lane 0.
+    alignas(16) float lag[kLanes];
+    float head[kDepth];
+    for (size_t i = 0; i < kDepth; ++i) {
+        head[i] = data[i];
+    }
+    for (size_t k = 0; k < kDepth; ++k) {
+        process_section(k, head, kDepth - k);
+        lag[k] = head[kDepth - 1 - k];
+    }
+    lag[kDepth] = 0.0f;
+
+    // Wavefront: at step t lane k filters sample t - k, fed by lane k - 1's
+    // output from step t - 1; the last lane's output is final for t - kDepth
+#if AUDIO_KERNELS_HAVE_NEON
+    const float32x4_t b0 = vld1q_f32(b0_), b1 = vld1q_f32(b1_), b2 = vld1q_f32(b2_);
+    const float32x4_t a1 = vld1q_f32(a1_), a2 = vld1q_f32(a2_);
+    float32x4_t s1 = vld1q_f32(s1_), s2 = vld1q_f32(s2_);
+    float32x4_t y = vld1q_f32(lag);
+    for (size_t t = kDepth; t < n; ++t) {
+        const float32x4_t x = vextq_f32(vdupq_n_f32(data[t]), y, 3);
+        y = vfmaq_f32(s1, b0, x);
+        s1 = vfmsq_f32(vfmaq_f32(s2, b1, x), a1, y);
+        s2 = vfmsq_f32(vmulq_f32(b2, x), a2, y);
+        data[t - kDepth] = vgetq_lane_f32(y, 3);
+    }
+    vst1q_f32(s1_, s1);
+    vst1q_f32(s2_, s2);
+    vst1q_f32(lag, y);
+#else
+    for (size_t t = kDepth; t < n; ++t) {
+        float x[kLanes];
+        x[0] = data[t];
+        for (size_t k = 1; k < kLanes; ++k) {
+            x[k] = lag[k - 1];
+        }
+        for (size_t k = 0; k < kLanes; ++k) {
+            const float y = b0_[k] * x[k] + s1_[k];
+            s1_[k] = b1_[k] * x[k] - a1_[k] * y + s2_[k];
+            s2_[k] = b2_[k] * x[k] - a2_[k] * y;
+            lag[k] = y;
+        }
+        data[t - kDepth] = lag[kDepth];
+    }
+#endif
+
+    // Epilogue: section k still owes samples n - k .. n - 1. tail[j] holds
+    // sample n - kDepth + j, each section's input seeded from the lane
+    // before it and filtered in place.
+    float tail[kDepth];
+    for (size_t k = 1; k < kLanes; ++k) {
+        const size_t first = kDepth - k;
+        tail[first] = lag[k - 1];
+        process_section(k, tail + first, k);
+    }
+    for (size_t j = 0; j < kDepth; ++j) {
+        data[n - kDepth + j] = tail[j];
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Speech conditioning filters for the streaming front end.
+ */
+struct FilterBankParams {
+    int sample_rate = 16000;
+    float high_pass_hz = 80.0f;   // Butterworth high-pass corner; 0 disables
+    int high_pass_order = 2;      // 2 or 4
+    float notch_hz = 0.0f;        // mains hum (50 or 60 Hz); 0 disables
+    float notch_q = 30.0f;
+    float pre_emphasis = 0.0f;    // y[n] = x[n] - k * x[n-1]; 0 disables, 0.97 is typical
+};
+
+/**
+ * Cascade of up to kMaxSections biquads (transposed direct form II) with
+ * state carried across calls: feeding a stream in chunks of any size gives
+ * exactly the output of filtering it in one call, so it can sit inline in
+ * the capture pipeline. Sections run high-pass, then notch, then
+ * pre-emphasis.
+ *
+ * process() filters in place. Each sample depends on the previous one, so
+ * the cascade is vectorized across sections instead of across samples:
+ * lane k of a 4-wide register runs section k one sample behind lane k - 1,
+ * and unused lanes hold pass-through sections. A few samples at each end
+ * of a call run section by section so no latency is added.
+ *
+ * Not thread-safe; one instance per stream.
+ */
+class BiquadFilterBank {
+public:
+    static constexpr size_t kMaxSections = 4;
+
+    explicit BiquadFilterBank(const FilterBankParams& params);
+
+    /** False when a frequency is outside (0, Nyquist) or the order is unsupported. */
+    bool is_valid() const { return valid_; }
+
+    /** Active sections; 0 when every stage is disabled. */
+    size_t section_count() const { return sections_; }
+
+    void process(float* data, size_t n);
+
+    /** Clear the filter history so a new stream can start. */
+    void reset();
+
+private:
+    void add_section(float b0, float b1, float b2, float a1, float a2);
+    void process_section(size_t k, float* data, size_t n);
+
+    // Coefficients and state per lane, normalized so a0 = 1
+    alignas(16) float b0_[kMaxSections];
+    alignas(16) float b1_[kMaxSections];
+    alignas(16) float b2_[kMaxSections];
+    alignas(16) float a1_[kMaxSections];
+    alignas(16) float a2_[kMaxSections];
+    alignas(16) float s1_[kMaxSections];
+    alignas(16) float s2_[kMaxSections];
+    size_t sections_ = 0;
+    bool valid_ = true;
+};
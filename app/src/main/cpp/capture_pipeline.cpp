@@ -0,0 +1,308 @@
+#include "capture_pipeline.h"
+#include "audio_kernels.h"
+#include "perf_stats.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cstring>
+
+#define LOG_TAG "CapturePipeline"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kOutputRate = 16000;
+// Input samples drained per worker iteration (~64 ms at 16 kHz)
+constexpr size_t kDrainBlock = 1024;
+// Processed audio the sink may fall behind by before its samples are dropped
+constexpr size_t kSinkQueueSamples = kOutputRate * 10;
+// Samples handed to the sink per call (~256 ms)
+constexpr size_t kSinkBlock = 4096;
+
+FilterBankParams disabled_filter() {
+    FilterBankParams params;
+    params.sample_rate = kOutputRate;
+    params.high_pass_hz = 0.0f;
+    return params;
+}
+
+} // namespace
+
+CapturePipeline::CapturePipeline(int source_rate, size_t capacity_samples)
+    : input_(capacity_samples),
+      output_(resampled_length(capacity_samples, source_rate, kOutputRate) + kDrainBlock),
+      resampler_(source_rate, kOutputRate),
+      float_block_(kDrainBlock),
+      vad_frame_(vad_.frame_size()),
+      waveform_(kOutputRate / 100),
+      filter_(disabled_filter()),
+      sink_ring_(kSinkQueueSamples),
+      sink_block_(kSinkBlock) {
+    resampled_.resize(resampler_.max_output(kDrainBlock));
+    sem_init(&wake_, 0, 0);
+    sem_init(&sink_wake_, 0, 0);
+    worker_ = std::thread(&CapturePipeline::run, this);
+    sink_worker_ = std::thread(&CapturePipeline::run_sink, this);
+    LOGI("Capture pipeline started: %d Hz, %zu sample ring", source_rate, input_.capacity());
+}
+
+CapturePipeline::~CapturePipeline() {
+    stop();
+    sem_destroy(&wake_);
+    sem_destroy(&sink_wake_);
+}
+
+size_t CapturePipeline::write(const int16_t* pcm, size_t n) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    const size_t written = input_.write(pcm, n);
+    if (written < n) {
+        dropped_input_.fetch_add(n - written, std::memory_order_relaxed);
+    }
+    sem_post(&wake_);
+    return written;
+}
+
+size_t CapturePipeline::read_processed(float* out, size_t n) {
+    return output_.read(out, n);
+}
+
+void CapturePipeline::set_sink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    drain_sink_locked();
+    sink_ = std::move(sink);
+    sink_attached_.store(static_cast<bool>(sink_), std::memory_order_release);
+}
+
+bool CapturePipeline::set_filter(const FilterBankParams& params) {
+    FilterBankParams resolved = params;
+    resolved.sample_rate = kOutputRate;
+    BiquadFilterBank filter(resolved);
+    if (!filter.is_valid()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(conditioning_mutex_);
+    pending_filter_ = filter;
+    conditioning_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool CapturePipeline::set_noise_suppression(float strength) {
+    if (!(strength >= 0.0f && strength <= 1.0f)) {
+        return false;
+    }
+    std::unique_ptr<SpectralDenoiser> denoiser;
+    if (strength > 0.0f) {
+        denoiser = std::make_unique<SpectralDenoiser>(strength);
+        if (!denoiser->is_valid()) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(conditioning_mutex_);
+    pending_denoiser_ = std::move(denoiser);
+    conditioning_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool CapturePipeline::set_agc(const AgcParams* params) {
+    std::unique_ptr<LookaheadAgc> agc;
+    if (params != nullptr) {
+        AgcParams resolved = *params;
+        resolved.sample_rate = kOutputRate;
+        agc = std::make_unique<LookaheadAgc>(resolved);
+        if (!agc->is_valid()) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(conditioning_mutex_);
+    pending_agc_ = std::move(agc);
+    conditioning_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void CapturePipeline::stop() {
+    std::call_once(stop_once_, [this] {
+        running_.store(false, std::memory_order_relaxed);
+        sem_post(&wake_);
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+
+        // The worker has queued its last block, so the sink sees all of it
+        sink_running_.store(false, std::memory_order_release);
+        sem_post(&sink_wake_);
+        if (sink_worker_.joinable()) {
+            sink_worker_.join();
+        }
+
+        const uint64_t dropped = dropped_input_.load() + dropped_output_.load();
+        if (dropped > 0) {
+            LOGW("Capture pipeline dropped %llu samples", static_cast<unsigned long long>(dropped));
+        }
+        if (dropped_sink_.load() > 0) {
+            LOGW("Capture sink fell behind by %llu samples",
+                 static_cast<unsigned long long>(dropped_sink_.load()));
+        }
+    });
+}
+
+void CapturePipeline::run() {
+    std::vector<int16_t> block(kDrainBlock);
+    for (;;) {
+        sem_wait(&wake_);
+
+        size_t got;
+        while ((got = input_.read(block.data(), block.size())) > 0) {
+            process_block(block.data(), got);
+        }
+
+        // running_ is cleared before the final post, so everything written
+        // before stop() has been drained by the time this is seen
+        if (!running_.load(std::memory_order_relaxed)) {
+            while ((got = input_.read(block.data(), block.size())) > 0) {
+                process_block(block.data(), got);
+            }
+            resampled_.resize(std::max(resampled_.size(), resampler_.max_output(0)));
+            emit(resampled_.data(), resampler_.flush(resampled_.data()));
+            flush_conditioning();
+            return;
+        }
+    }
+}
+
+void CapturePipeline::process_block(const int16_t* pcm, size_t n) {
+    {
+        ScopedStageTimer timer(Stage::Convert);
+        audio_kernels().pcm16_to_float(pcm, float_block_.data(), n);
+    }
+    size_t produced;
+    {
+        ScopedStageTimer timer(Stage::Resample);
+        produced = resampler_.process(float_block_.data(), n, resampled_.data());
+    }
+    emit(resampled_.data(), produced);
+}
+
+void CapturePipeline::emit(float* samples, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    if (conditioning_pending_.load(std::memory_order_acquire)) {
+        apply_pending_conditioning();
+    }
+    if (filter_.section_count() > 0) {
+        ScopedStageTimer timer(Stage::Filter);
+        filter_.process(samples, n);
+    }
+    if (denoiser_) {
+        ScopedStageTimer timer(Stage::Denoise);
+        denoiser_->process(samples, n);
+    }
+    if (agc_) {
+        ScopedStageTimer timer(Stage::Normalize);
+        agc_->process(samples, n);
+    }
+    deliver(samples, n);
+}
+
+void CapturePipeline::apply_pending_conditioning() {
+    std::lock_guard<std::mutex> lock(conditioning_mutex_);
+    if (pending_filter_) {
+        filter_ = *pending_filter_;
+        pending_filter_.reset();
+    }
+    if (pending_denoiser_) {
+        denoiser_ = std::move(*pending_denoiser_);
+        pending_denoiser_.reset();
+    }
+    if (pending_agc_) {
+        agc_ = std::move(*pending_agc_);
+        pending_agc_.reset();
+    }
+    conditioning_pending_.store(false, std::memory_order_relaxed);
+}
+
+void CapturePipeline::flush_conditioning() {
+    // Audio still held in the denoiser and AGC delay lines; the denoiser's
+    // tail goes through the AGC like any other block
+    std::vector<float> tail;
+    if (denoiser_) {
+        tail.resize(denoiser_->latency());
+        denoiser_->flush(tail.data());
+        if (agc_) {
+            agc_->process(tail.data(), tail.size());
+        }
+        deliver(tail.data(), tail.size());
+    }
+    if (agc_) {
+        tail.resize(agc_->latency());
+        agc_->flush(tail.data());
+        deliver(tail.data(), tail.size());
+    }
+}
+
+void CapturePipeline::deliver(const float* samples, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    // Online VAD over whole frames; a partial frame waits for the next block
+    const size_t frame = vad_frame_.size();
+    size_t offset = 0;
+    while (frame > 0 && offset < n) {
+        const size_t take = std::min(frame - vad_fill_, n - offset);
+        std::memcpy(vad_frame_.data() + vad_fill_, samples + offset, take * sizeof(float));
+        vad_fill_ += take;
+        offset += take;
+        if (vad_fill_ == frame) {
+            ScopedStageTimer timer(Stage::Vad);
+            speech_active_.store(vad_.push_frame(vad_frame_.data()), std::memory_order_relaxed);
+            vad_fill_ = 0;
+        }
+    }
+
+    waveform_.append(samples, n);
+
+    const size_t written = output_.write(samples, n);
+    if (written < n) {
+        dropped_output_.fetch_add(n - written, std::memory_order_relaxed);
+    }
+
+    if (sink_attached_.load(std::memory_order_acquire)) {
+        const size_t queued = sink_ring_.write(samples, n);
+        if (queued < n) {
+            dropped_sink_.fetch_add(n - queued, std::memory_order_relaxed);
+        }
+        sem_post(&sink_wake_);
+    }
+}
+
+void CapturePipeline::run_sink() {
+    for (;;) {
+        sem_wait(&sink_wake_);
+        const bool running = sink_running_.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex_);
+            drain_sink_locked();
+        }
+        if (!running) {
+            return;
+        }
+    }
+}
+
+void CapturePipeline::drain_sink_locked() {
+    size_t got;
+    while ((got = sink_ring_.read(sink_block_.data(), sink_block_.size())) > 0) {
+        if (sink_) {
+            sink_(sink_block_.data(), got);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <semaphore.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "biquad_filter.h"
+#include "lookahead_agc.h"
+#include "resampler.h"
+#include "spectral_denoiser.h"
+#include "spsc_ring_buffer.h"
+#include "vad.h"
+#include "waveform_pyramid.h"
+
+/**
+ * Real-time capture front end.
+ *
+ * The capture thread pushes PCM16 into a lock-free SPSC ring and posts a
+ * semaphore; nothing on that path locks, allocates or touches the heap.
+ * A native worker thread drains the ring in blocks, converts to float,
+ * resamples to 16 kHz, applies the optional conditioning stages (filters,
+ * noise suppression, AGC) in place, runs the online VAD and then
+ *   - writes the processed audio to a second SPSC ring for one consumer
+ *     (the Kotlin side reads it for waveform and final transcription), and
+ *   - queues it on a third SPSC ring for an optional sink, which a sink
+ *     thread of its own calls; this is how streaming transcription is fed
+ *     without a round trip through Kotlin, and
+ *   - appends it to a waveform pyramid (10 ms base bins) that the
+ *     visualizer queries at any zoom without reading samples back.
+ *
+ * When a ring is full the newest samples are dropped and counted rather
+ * than blocking the producer. A sink slower than real time, such as a
+ * streaming decode, therefore only loses its own audio: the worker never
+ * waits for it, so the input and processed rings keep draining.
+ */
+class CapturePipeline {
+public:
+    /** Called on the sink thread with processed 16 kHz audio, in order. */
+    using Sink = std::function<void(const float* samples, size_t n)>;
+
+    CapturePipeline(int source_rate, size_t capacity_samples);
+    ~CapturePipeline();
+
+    CapturePipeline(const CapturePipeline&) = delete;
+    CapturePipeline& operator=(const CapturePipeline&) = delete;
+
+    bool is_valid() const { return resampler_.is_valid(); }
+
+    /** Capture thread: enqueue samples. Returns the count accepted. */
+    size_t write(const int16_t* pcm, size_t n);
+
+    /** Single consumer: dequeue up to n processed samples. */
+    size_t read_processed(float* out, size_t n);
+
+    /**
+     * Replace the sink. Audio already queued is first handed to the old
+     * sink on the calling thread; waits for an in-flight sink call to
+     * return.
+     */
+    void set_sink(Sink sink);
+
+    /** Processed samples queued for the sink and not yet handed to it. */
+    size_t sink_pending() const { return sink_ring_.size(); }
+
+    /**
+     * Replace the conditioning filters (sample_rate is forced to 16 kHz).
+     * Takes effect at the worker's next block with fresh filter state.
+     * Returns false and keeps the current filters if params are invalid.
+     */
+    bool set_filter(const FilterBankParams& params);
+
+    /**
+     * Enable spectral noise suppression at strength (0, 1], or disable it
+     * with 0. Adds SpectralDenoiser::latency() samples of delay while on,
+     * so switching it mid-stream inserts or drops that much audio; set it
+     * before the first write. Returns false for a strength outside [0, 1].
+     */
+    bool set_noise_suppression(float strength);
+
+    /**
+     * Enable look-ahead AGC (sample_rate is forced to 16 kHz), or disable
+     * it with a null params. Adds the look-ahead as delay while on, with
+     * the same caveat as set_noise_suppression().
+     * Returns false and keeps the current AGC if params are invalid.
+     */
+    bool set_agc(const AgcParams* params);
+
+    /**
+     * Drain all pending input through the worker and the sink, flush the
+     * resampler tail and join both threads. Further writes are ignored.
+     * Idempotent.
+     */
+    void stop();
+
+    bool speech_active() const { return speech_active_.load(std::memory_order_relaxed); }
+    uint64_t dropped_input() const { return dropped_input_.load(std::memory_order_relaxed); }
+    uint64_t dropped_output() const { return dropped_output_.load(std::memory_order_relaxed); }
+    /** Samples the sink never saw because it fell behind. */
+    uint64_t dropped_sink() const { return dropped_sink_.load(std::memory_order_relaxed); }
+
+    /** Level summary of every processed sample; safe to query from any thread. */
+    const WaveformPyramid& waveform() const { return waveform_; }
+
+private:
+    void run();
+    void process_block(const int16_t* pcm, size_t n);
+    void emit(float* samples, size_t n);
+    void apply_pending_conditioning();
+    void flush_conditioning();
+    void deliver(const float* samples, size_t n);
+    void run_sink();
+    void drain_sink_locked();
+
+    SpscRingBuffer<int16_t> input_;
+    SpscRingBuffer<float> output_;
+
+    // Worker-only state
+    StreamingResampler resampler_;
+    VoiceActivityDetector vad_;
+    std::vector<float> float_block_;
+    std::vector<float> resampled_;
+    std::vector<float> vad_frame_;
+    size_t vad_fill_ = 0;
+    WaveformPyramid waveform_;
+    BiquadFilterBank filter_;
+    std::unique_ptr<SpectralDenoiser> denoiser_;
+    std::unique_ptr<LookaheadAgc> agc_;
+
+    // Stage changes waiting for the worker to pick them up; an engaged
+    // optional holding nullptr disables that stage
+    std::mutex conditioning_mutex_;
+    std::optional<BiquadFilterBank> pending_filter_;
+    std::optional<std::unique_ptr<SpectralDenoiser>> pending_denoiser_;
+    std::optional<std::unique_ptr<LookaheadAgc>> pending_agc_;
+    std::atomic<bool> conditioning_pending_{false};
+
+    // The sink ring's consumer is whoever holds sink_mutex_: the sink
+    // thread, or set_sink handing queued audio to the sink it replaces
+    SpscRingBuffer<float> sink_ring_;
+    std::mutex sink_mutex_;
+    Sink sink_;
+    std::vector<float> sink_block_;
+    std::atomic<bool> sink_attached_{false};
+    sem_t sink_wake_;
+    std::atomic<bool> sink_running_{true};
+    std::atomic<uint64_t> dropped_sink_{0};
+
+    sem_t wake_;
+    std::atomic<bool> running_{true};
+    std::atomic<bool> speech_active_{false};
+    std::atomic<uint64_t> dropped_input_{0};
+    std::atomic<uint64_t> dropped_output_{0};
+    std::once_flag stop_once_;
+    std::thread worker_;
+    std::thread sink_worker_;
+};
@@ -0,0 +1,73 @@
+#include "core_arbiter.h"
+
+#include <android/log.h>
+#include <algorithm>
+
+#define LOG_TAG "CoreArbiter"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+CoreArbiter::CoreArbiter(int budget) : budget_(std::max(budget, 1)) {}
+
+void CoreArbiter::set_budget(int budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = std::max(budget, 1);
+    LOGI("Core budget set to %d threads", budget_);
+}
+
+int CoreArbiter::budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+int CoreArbiter::in_use() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_use_;
+}
+
+int CoreArbiter::acquire(int requested, bool allow_pinning, bool& pin) {
+    requested = std::max(requested, 1);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int available = budget_ - in_use_;
+    const int fair_share = (budget_ + leases_) / (leases_ + 1);  // rounded up
+    const int granted = std::clamp(std::min(available, fair_share), 1, requested);
+
+    const int big_cores = static_cast<int>(cpu_topology().big_cores.size());
+    pin = allow_pinning && pinned_ + granted <= big_cores;
+
+    in_use_ += granted;
+    ++leases_;
+    if (pin) {
+        pinned_ += granted;
+    }
+    if (granted < requested) {
+        LOGD("Leased %d of %d threads, %d leases share %d", granted, requested, leases_, budget_);
+    }
+    return granted;
+}
+
+void CoreArbiter::release(int threads, bool pinned) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_use_ = std::max(in_use_ - threads, 0);
+    leases_ = std::max(leases_ - 1, 0);
+    if (pinned) {
+        pinned_ = std::max(pinned_ - threads, 0);
+    }
+}
+
+CoreArbiter& core_arbiter() {
+    static CoreArbiter arbiter(cpu_topology().n_cpus);
+    return arbiter;
+}
+
+CoreLease::CoreLease(int requested, bool allow_pinning) {
+    threads_ = core_arbiter().acquire(requested, allow_pinning, pinned_);
+    if (pinned_) {
+        affinity_.reset(new ScopedBigCoreAffinity(threads_));
+    }
+}
+
+CoreLease::~CoreLease() {
+    affinity_.reset();
+    core_arbiter().release(threads_, pinned_);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "cpu_topology.h"
+
+/**
+ * Process-wide budget of compute threads shared by every decode, so
+ * sessions running at once on the same or different models split the
+ * cores instead of each spawning its full thread count.
+ *
+ * Each whisper_full call leases its threads for the duration of the call.
+ * A lease gets what it asks for, capped by the threads left in the budget
+ * and by a fair share, the budget divided among the leases including the
+ * new one. It never gets less than one thread and never waits. A session
+ * that started alone with every core gets its fair share back on its next
+ * call, which for streaming is a few seconds away.
+ *
+ * Leases are pinned to the big cores while the pinned threads fit on
+ * them. Later ones run unpinned, so the scheduler places them on whatever
+ * cores are free.
+ *
+ * Thread-safe.
+ */
+class CoreArbiter {
+public:
+    explicit CoreArbiter(int budget);
+
+    /** Change the budget; leases already granted keep their threads. */
+    void set_budget(int budget);
+    int budget() const;
+
+    /** Threads currently leased. */
+    int in_use() const;
+
+    /**
+     * Lease up to requested threads. pin is set when the lease should be
+     * pinned to the big cores.
+     *
+     * @return Threads granted, at least 1
+     */
+    int acquire(int requested, bool allow_pinning, bool& pin);
+
+    /** Return threads granted by acquire(). */
+    void release(int threads, bool pinned);
+
+private:
+    mutable std::mutex mutex_;
+    int budget_;
+    int in_use_ = 0;
+    int leases_ = 0;
+    int pinned_ = 0;  // threads of leases pinned to the big cores
+};
+
+/** The arbiter for this process; its budget defaults to every core. */
+CoreArbiter& core_arbiter();
+
+/**
+ * Threads leased from core_arbiter() for the scope, with the calling thread
+ * pinned to the big cores when the lease is, so ggml's workers spawned
+ * inside whisper_full inherit the mask.
+ */
+class CoreLease {
+public:
+    /**
+     * @param requested Threads wanted, e.g. the context's thread count
+     * @param allow_pinning False for work that spreads over every core
+     */
+    explicit CoreLease(int requested, bool allow_pinning = true);
+    ~CoreLease();
+
+    CoreLease(const CoreLease&) = delete;
+    CoreLease& operator=(const CoreLease&) = delete;
+
+    int threads() const { return threads_; }
+
+private:
+    int threads_ = 0;
+    bool pinned_ = false;
+    std::unique_ptr<ScopedBigCoreAffinity> affinity_;
+};
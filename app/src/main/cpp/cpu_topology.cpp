@@ -0,0 +1,105 @@
+#include "cpu_topology.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+#define LOG_TAG "CpuTopology"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// Cores at or above this fraction of the fastest core count as big
+constexpr double kBigCoreThreshold = 0.5;
+
+int read_int_file(const char* path) {
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+        return -1;
+    }
+    int value = -1;
+    if (std::fscanf(file, "%d", &value) != 1) {
+        value = -1;
+    }
+    std::fclose(file);
+    return value;
+}
+
+int read_core_capacity(int cpu) {
+    char path[128];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu);
+    int capacity = read_int_file(path);
+    if (capacity > 0) {
+        return capacity;
+    }
+
+    // Older kernels don't expose cpu_capacity; max frequency is a usable proxy
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    return read_int_file(path);
+}
+
+CpuTopology detect_topology() {
+    CpuTopology topology;
+    topology.n_cpus = static_cast<int>(sysconf(_SC_NPROCESSORS_CONF));
+    if (topology.n_cpus <= 0) {
+        topology.n_cpus = 1;
+    }
+
+    int max_capacity = 0;
+    topology.capacities.resize(topology.n_cpus);
+    for (int cpu = 0; cpu < topology.n_cpus; ++cpu) {
+        topology.capacities[cpu] = read_core_capacity(cpu);
+        max_capacity = std::max(max_capacity, topology.capacities[cpu]);
+    }
+
+    if (max_capacity > 0) {
+        const int threshold = static_cast<int>(max_capacity * kBigCoreThreshold);
+        for (int cpu = 0; cpu < topology.n_cpus; ++cpu) {
+            if (topology.capacities[cpu] >= threshold) {
+                topology.big_cores.push_back(cpu);
+            }
+        }
+    }
+
+    LOGI("Detected %d CPUs, %zu big cores (max capacity %d)",
+         topology.n_cpus, topology.big_cores.size(), max_capacity);
+    return topology;
+}
+
+} // namespace
+
+const CpuTopology& cpu_topology() {
+    static const CpuTopology topology = detect_topology();
+    return topology;
+}
+
+ScopedBigCoreAffinity::ScopedBigCoreAffinity(int n_threads) {
+    const CpuTopology& topology = cpu_topology();
+    if (!topology.is_heterogeneous() ||
+        n_threads > static_cast<int>(topology.big_cores.size())) {
+        return;
+    }
+
+    if (sched_getaffinity(0, sizeof(previous_), &previous_) != 0) {
+        return;
+    }
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : topology.big_cores) {
+        CPU_SET(cpu, &mask);
+    }
+
+    pinned_ = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+    if (pinned_) {
+        LOGD("Pinned %d compute threads to %zu big cores", n_threads, topology.big_cores.size());
+    }
+}
+
+ScopedBigCoreAffinity::~ScopedBigCoreAffinity() {
+    if (pinned_) {
+        sched_setaffinity(0, sizeof(previous_), &previous_);
+    }
+}
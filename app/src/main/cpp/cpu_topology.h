@@ -0,0 +1,49 @@
+#pragma once
+
+#include <sched.h>
+#include <vector>
+
+/**
+ * CPU cluster detection for big.LITTLE / DynamIQ SoCs.
+ *
+ * Per-core capacity is read from /sys/devices/system/cpu/cpuN/cpu_capacity
+ * (falling back to cpufreq/cpuinfo_max_freq). Cores at or above half of
+ * the highest capacity are treated as performance ("big") cores.
+ */
+struct CpuTopology {
+    int n_cpus = 0;
+    std::vector<int> capacities;
+    std::vector<int> big_cores;
+
+    /** True when the SoC has distinct clusters worth pinning to. */
+    bool is_heterogeneous() const {
+        return !big_cores.empty() && static_cast<int>(big_cores.size()) < n_cpus;
+    }
+};
+
+/** Topology of the current device, detected once and cached. */
+const CpuTopology& cpu_topology();
+
+/**
+ * Restricts the calling thread to the big cores for its lifetime and
+ * restores the previous affinity on destruction.
+ *
+ * Threads created while the guard is active inherit the mask, which is how
+ * ggml's compute workers spawned inside whisper_full end up on big cores.
+ * Pinning is skipped on homogeneous SoCs and when more threads are
+ * requested than there are big cores, since that would oversubscribe them.
+ */
+class ScopedBigCoreAffinity {
+public:
+    explicit ScopedBigCoreAffinity(int n_threads);
+    ~ScopedBigCoreAffinity();
+
+    ScopedBigCoreAffinity(const ScopedBigCoreAffinity&) = delete;
+    ScopedBigCoreAffinity& operator=(const ScopedBigCoreAffinity&) = delete;
+
+    bool is_pinned() const { return pinned_; }
+
+private:
+    cpu_set_t previous_;
+    bool pinned_ = false;
+};
@@ -0,0 +1,172 @@
+#include "encoder_cache.h"
+
+#include "perf_stats.h"
+
+#include <android/log.h>
+
+#include <cstring>
+
+#define LOG_TAG "EncoderCache"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+/**
+ * Encoder callback of a decode on a cached encoding. Only the first pass
+ * covers the cached window; a later one, after a decode that ended early,
+ * encodes from a new offset.
+ */
+struct EncoderReuse {
+    const CachedEncoding* encoding;
+    uint64_t key;
+    int n_passes = 0;
+    whisper_encoder_begin_callback chained = nullptr;
+    void* chained_user_data = nullptr;
+};
+
+bool reuse_encoding(whisper_context* ctx, whisper_state* state, void* user_data) {
+    auto* reuse = static_cast<EncoderReuse*>(user_data);
+    if (reuse->chained != nullptr && !reuse->chained(ctx, state, reuse->chained_user_data)) {
+        return false;
+    }
+#ifdef WHISPER_ANDROID_ENCODER_REUSE
+    if (reuse->n_passes == 0 && reuse->encoding->key == reuse->key) {
+        whisper_state_reuse_encoding(state);
+    }
+#endif
+    ++reuse->n_passes;
+    return true;
+}
+
+/**
+ * Rough size of a whisper_state: self and cross attention KV in F16, plus
+ * the encoder's activations and the decoder's logits, which dominate
+ * whisper's compute buffers.
+ */
+size_t estimate_state_bytes(whisper_context* ctx) {
+    const size_t n_audio_ctx = whisper_model_n_audio_ctx(ctx);
+    const size_t n_audio_state = whisper_model_n_audio_state(ctx);
+    const size_t n_text_ctx = whisper_model_n_text_ctx(ctx);
+    const size_t n_text_state = whisper_model_n_text_state(ctx);
+    const size_t n_text_layer = whisper_model_n_text_layer(ctx);
+    const size_t n_vocab = whisper_model_n_vocab(ctx);
+
+    const size_t kv = 2 * sizeof(uint16_t) * n_text_layer * n_text_state * (n_audio_ctx + n_text_ctx);
+    const size_t compute = sizeof(float) * (32 * n_audio_ctx * n_audio_state + n_text_ctx * n_vocab);
+    return kv + compute;
+}
+
+} // namespace
+
+CachedEncoding::~CachedEncoding() {
+    if (state != nullptr) {
+        whisper_free_state(state);
+    }
+}
+
+EncoderCache::EncoderCache(whisper_context* ctx) : ctx_(ctx), entry_bytes_(estimate_state_bytes(ctx)) {}
+
+uint64_t EncoderCache::hash_audio(const float* samples, size_t n) {
+    uint64_t hash = kFnvOffset ^ n;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &samples[i], sizeof(bits));
+        hash = (hash ^ bits) * kFnvPrime;
+    }
+    return hash;
+}
+
+bool EncoderCache::is_enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_bytes_ >= entry_bytes_;
+}
+
+std::shared_ptr<CachedEncoding> EncoderCache::find(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if ((*it)->key == key) {
+            entries_.splice(entries_.begin(), entries_, it);
+            return entries_.front();
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<CachedEncoding> EncoderCache::create() {
+    {
+        // Recycle the oldest state rather than allocate another one
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!entries_.empty() && (entries_.size() + 1) * entry_bytes_ > capacity_bytes_ &&
+            entries_.back().use_count() == 1) {
+            std::shared_ptr<CachedEncoding> entry = std::move(entries_.back());
+            entries_.pop_back();
+            entry->key = 0;
+            entry->lang_id = -1;
+            return entry;
+        }
+    }
+
+    auto entry = std::make_shared<CachedEncoding>();
+    entry->state = whisper_init_state(ctx_);
+    if (entry->state == nullptr) {
+        LOGE("Failed to create encoder cache state");
+        return nullptr;
+    }
+    return entry;
+}
+
+void EncoderCache::insert(std::shared_ptr<CachedEncoding> entry, uint64_t key, int lang_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->key = key;
+    entry->lang_id = lang_id;
+    entries_.remove_if([key](const auto& cached) { return cached->key == key; });
+    entries_.push_front(std::move(entry));
+    trim_locked(capacity_bytes_);
+    LOGD("Cached encoding %016llx, %zu entries", static_cast<unsigned long long>(key), entries_.size());
+}
+
+void EncoderCache::set_capacity(size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_bytes_ = max_bytes;
+    trim_locked(max_bytes);
+}
+
+size_t EncoderCache::trim(size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return trim_locked(max_bytes);
+}
+
+size_t EncoderCache::trim_locked(size_t max_bytes) {
+    size_t freed = 0;
+    while (!entries_.empty() && entries_.size() * entry_bytes_ > max_bytes) {
+        entries_.pop_back();  // a decode still holding it frees it when done
+        freed += entry_bytes_;
+    }
+    return freed;
+}
+
+size_t EncoderCache::size_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size() * entry_bytes_;
+}
+
+int decode_cached(whisper_context* ctx, CachedEncoding& encoding, uint64_t key, whisper_full_params params) {
+    if (params.language == nullptr || std::strcmp(params.language, "auto") == 0) {
+        if (encoding.lang_id >= 0) {
+            params.language = whisper_lang_str(encoding.lang_id);
+        }
+    }
+
+    EncoderReuse reuse{&encoding, key};
+    reuse.chained = params.encoder_begin_callback;
+    reuse.chained_user_data = params.encoder_begin_callback_user_data;
+    params.encoder_begin_callback = reuse_encoding;
+    params.encoder_begin_callback_user_data = &reuse;
+
+    // No samples: whisper_full decodes from the mel already in the state
+    return timed_whisper_full(ctx, encoding.state, params, nullptr, 0);
+}
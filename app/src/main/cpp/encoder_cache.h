@@ -0,0 +1,99 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * An encoder pass kept for reuse: a whisper_state whose cross-attention
+ * KV cache holds the encoding of one input of at most 30 s.
+ */
+struct CachedEncoding {
+    whisper_state* state = nullptr;
+    uint64_t key = 0;
+    int lang_id = -1;  // language whisper detected on the first pass, -1 if none
+    std::mutex mutex;  // held while decoding on state
+
+    CachedEncoding() = default;
+    ~CachedEncoding();
+
+    CachedEncoding(const CachedEncoding&) = delete;
+    CachedEncoding& operator=(const CachedEncoding&) = delete;
+};
+
+/**
+ * LRU cache of encoder passes for one model, so re-transcribing the same
+ * audio with another language, translate setting or prompt runs only the
+ * decoder.
+ *
+ * Entries are keyed by a hash of the 16 kHz samples that reached the
+ * encoder; the model is implied by the cache, which lives on its
+ * SharedModel. Each entry is a whole whisper_state (KV caches plus compute
+ * buffers), far larger than the encoder output alone, so the cache is
+ * bounded by an estimate of that size and is empty (disabled) until given
+ * a capacity. Entries are shared_ptrs: one evicted or trimmed while a
+ * decode uses it is freed when the decode finishes, and one from create()
+ * is private to its caller until inserted.
+ *
+ * Thread-safe. Decoding on a cached entry needs that entry's mutex, not
+ * the model's.
+ */
+class EncoderCache {
+public:
+    explicit EncoderCache(whisper_context* ctx);
+
+    static uint64_t hash_audio(const float* samples, size_t n);
+
+    /** Estimated memory of one entry. */
+    size_t entry_bytes() const { return entry_bytes_; }
+
+    /** Whether at least one entry fits. */
+    bool is_enabled() const;
+
+    std::shared_ptr<CachedEncoding> find(uint64_t key);
+
+    /**
+     * An entry to encode into, not yet cached: the least recently used one
+     * when the cache is full and nobody holds it, otherwise a new state.
+     * Returns nullptr if no state could be created.
+     */
+    std::shared_ptr<CachedEncoding> create();
+
+    /** Cache an entry whose state holds the encoding of key. */
+    void insert(std::shared_ptr<CachedEncoding> entry, uint64_t key, int lang_id);
+
+    /** Set the capacity and evict down to it. */
+    void set_capacity(size_t max_bytes);
+
+    /** Evict least recently used entries until at most max_bytes remain. Returns bytes freed. */
+    size_t trim(size_t max_bytes);
+
+    size_t size_bytes() const;
+
+private:
+    size_t trim_locked(size_t max_bytes);
+
+    whisper_context* ctx_;
+    size_t entry_bytes_;
+    mutable std::mutex mutex_;
+    std::list<std::shared_ptr<CachedEncoding>> entries_;  // most recently used first
+    size_t capacity_bytes_ = 0;
+};
+
+/**
+ * Run whisper_full on a cached encoding with the same params as the pass
+ * that filled it, so the text matches a miss exactly: the state's mel is
+ * reused, an auto language becomes the one detected on the first pass, and
+ * an encoder_begin_callback keeps the cached encoder output instead of
+ * encoding again when the entry still holds the mel of key. Without
+ * encoder reuse in the whisper build (WHISPER_ANDROID_ENCODER_REUSE) the
+ * encoder runs again, on the cached mel. The caller holds encoding.mutex.
+ *
+ * @return whisper_full's result
+ */
+int decode_cached(whisper_context* ctx, CachedEncoding& encoding, uint64_t key, whisper_full_params params);
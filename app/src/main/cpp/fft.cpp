@@ -0,0 +1,185 @@
+#include "fft.h"
+
+#include <android/log.h>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#define LOG_TAG "FFT"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+size_t odd_factor(size_t n) {
+    while (n != 0 && (n & 1) == 0) {
+        n >>= 1;
+    }
+    return n;
+}
+
+std::complex<float> unit_root(size_t k, size_t n) {
+    const double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+    return {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+}
+
+} // namespace
+
+FftPlan::FftPlan(size_t n) : n_(n), half_(n / 2), odd_(odd_factor(n)) {
+    const size_t leaves = half_ / odd_;
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < leaves) {
+        ++bits;
+    }
+
+    bit_reverse_.resize(leaves);
+    for (size_t i = 0; i < leaves; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    leaf_roots_.resize(odd_);
+    for (size_t j = 0; j < odd_; ++j) {
+        leaf_roots_[j] = unit_root(j, odd_);
+    }
+
+    twiddles_.resize(half_ / 2);
+    for (size_t k = 0; k < twiddles_.size(); ++k) {
+        twiddles_[k] = unit_root(k, half_);
+    }
+
+    split_.resize(half_ / 2 + 1);
+    for (size_t k = 0; k < split_.size(); ++k) {
+        split_[k] = unit_root(k, n_);
+    }
+}
+
+void FftPlan::forward(const float* in, std::complex<float>* out) const {
+    // Even/odd samples packed as one complex sequence; std::complex<float>
+    // is layout-compatible with float[2]
+    transform_half(reinterpret_cast<const std::complex<float>*>(in), out);
+
+    // Split the half-size transform into the real spectrum. Bins k and
+    // half - k depend on the same pair of values, so they're done together.
+    const std::complex<float> z0 = out[0];
+    out[0] = {z0.real() + z0.imag(), 0.0f};
+    out[half_] = {z0.real() - z0.imag(), 0.0f};
+
+    const std::complex<float> minus_half_i(0.0f, -0.5f);
+    for (size_t k = 1; k <= half_ / 2; ++k) {
+        const std::complex<float> zk = out[k];
+        const std::complex<float> zc = std::conj(out[half_ - k]);
+        const std::complex<float> even = 0.5f * (zk + zc);
+        const std::complex<float> odd = minus_half_i * (zk - zc);
+        const std::complex<float> rotated = split_[k] * odd;
+
+        out[half_ - k] = std::conj(even - rotated);
+        out[k] = even + rotated;
+    }
+}
+
+void FftPlan::inverse(const std::complex<float>* in, std::complex<float>* work, float* out) const {
+    // Undo the split: z[k] = even + i * odd, where even and rotated odd are
+    // the half sum and difference of X[k] and conj(X[half - k]). The
+    // conjugate of z goes into work so a forward transform inverts it.
+    for (size_t k = 0; k < half_; ++k) {
+        const std::complex<float> xk = in[k];
+        const std::complex<float> xc = std::conj(in[half_ - k]);
+        const std::complex<float> even = 0.5f * (xk + xc);
+        // e^{-2*pi*i*k/n}; split_ covers k <= half / 2, the rest by symmetry
+        const std::complex<float> root = k <= half_ / 2 ? split_[k] : -std::conj(split_[half_ - k]);
+        const std::complex<float> odd = std::conj(root) * (0.5f * (xk - xc));
+        work[k] = std::conj(even + std::complex<float>(-odd.imag(), odd.real()));
+    }
+
+    auto* z = reinterpret_cast<std::complex<float>*>(out);
+    transform_half(work, z);
+
+    const float scale = 1.0f / static_cast<float>(half_);
+    for (size_t i = 0; i < half_; ++i) {
+        z[i] = std::conj(z[i]) * scale;
+    }
+}
+
+void FftPlan::transform_half(const std::complex<float>* in, std::complex<float>* out) const {
+    // Inputs in bit-reversed order
+    if (odd_ == 1) {
+        for (size_t i = 0; i < half_; ++i) {
+            out[bit_reverse_[i]] = in[i];
+        }
+    } else {
+        // Leaf b is the direct m-point DFT of the subsequence starting at
+        // bit_reverse_[b] with stride half / m, read straight from the input
+        const size_t leaves = bit_reverse_.size();
+        for (size_t b = 0; b < leaves; ++b) {
+            const size_t first = bit_reverse_[b];
+            std::complex<float>* leaf = out + b * odd_;
+            for (size_t k = 0; k < odd_; ++k) {
+                std::complex<float> sum(0.0f, 0.0f);
+                size_t root = 0;
+                for (size_t q = 0; q < odd_; ++q) {
+                    const size_t i = first + q * leaves;
+                    sum += in[i] * leaf_roots_[root];
+                    root += k;
+                    if (root >= odd_) {
+                        root -= odd_;
+                    }
+                }
+                leaf[k] = sum;
+            }
+        }
+    }
+
+    // Iterative radix-2 decimation in time
+    for (size_t len = 2 * odd_; len <= half_; len <<= 1) {
+        const size_t half_len = len / 2;
+        const size_t stride = half_ / len;
+        for (size_t i = 0; i < half_; i += len) {
+            std::complex<float>* a = out + i;
+            std::complex<float>* b = a + half_len;
+            for (size_t j = 0; j < half_len; ++j) {
+                const std::complex<float> v = b[j] * twiddles_[j * stride];
+                b[j] = a[j] - v;
+                a[j] += v;
+            }
+        }
+    }
+}
+
+void FftPlan::power_spectrum(const float* in, std::complex<float>* work, float* power) const {
+    forward(in, work);
+    const size_t n_bins = bins();
+    for (size_t k = 0; k < n_bins; ++k) {
+        power[k] = std::norm(work[k]);
+    }
+}
+
+std::shared_ptr<const FftPlan> get_fft_plan(size_t n) {
+    if (n < 4 || (n & 1) != 0 || odd_factor(n) > kMaxFftOddFactor) {
+        LOGE("Unsupported FFT size: %zu", n);
+        return nullptr;
+    }
+
+    static std::mutex cache_mutex;
+    static std::map<size_t, std::shared_ptr<const FftPlan>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(n);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    auto plan = std::make_shared<const FftPlan>(n);
+    cache.emplace(n, plan);
+    return plan;
+}
+
+std::vector<float> hann_window(size_t n) {
+    std::vector<float> window(n);
+    for (size_t i = 0; i < n; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * static_cast<double>(i) / n));
+    }
+    return window;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Real-input FFT of a fixed even size n = 2^k * m, with m a small odd factor
+ * (m = 1 for powers of two; Whisper's 400-point frame has m = 25).
+ *
+ * The n-point real transform is computed as an n/2-point complex FFT over
+ * the even/odd sample pairs followed by a split step. The complex transform
+ * does direct m-point DFTs on the decimated subsequences and combines them
+ * with radix-2 stages. Bit-reversal indices and twiddles are computed once
+ * at construction; inverse() runs the same transform on the conjugated
+ * spectrum. The plan is immutable afterwards, so one instance can be
+ * shared by any number of threads through get_fft_plan().
+ */
+class FftPlan {
+public:
+    explicit FftPlan(size_t n);
+
+    size_t size() const { return n_; }
+    size_t bins() const { return n_ / 2 + 1; }
+
+    /**
+     * Transform n real samples into n/2 + 1 complex bins.
+     * out must hold bins() values and is also used as the work buffer.
+     */
+    void forward(const float* in, std::complex<float>* out) const;
+
+    /** Convenience wrapper returning |X[k]|^2 for the n/2 + 1 bins. */
+    void power_spectrum(const float* in, std::complex<float>* work, float* power) const;
+
+    /**
+     * Transform n/2 + 1 bins of a real signal's spectrum back into n
+     * samples, scaled so inverse(forward(x)) == x. work must hold n/2
+     * values and must not alias in or out.
+     */
+    void inverse(const std::complex<float>* in, std::complex<float>* work, float* out) const;
+
+private:
+    /** n/2-point complex DFT; in and out must not alias. */
+    void transform_half(const std::complex<float>* in, std::complex<float>* out) const;
+
+    size_t n_;
+    size_t half_;
+    size_t odd_;                                 // m: size of the direct DFTs
+    std::vector<size_t> bit_reverse_;            // over the half_ / odd_ leaves
+    std::vector<std::complex<float>> leaf_roots_;  // e^{-2*pi*i*j/m}, j < m
+    std::vector<std::complex<float>> twiddles_;  // n/2-point transform
+    std::vector<std::complex<float>> split_;     // e^{-2*pi*i*k/n}, k < n/2
+};
+
+/** Largest odd factor get_fft_plan() accepts; the direct DFTs cost m^2. */
+constexpr size_t kMaxFftOddFactor = 25;
+
+/**
+ * Get (or build and cache) the plan for size n.
+ * Thread-safe; returns nullptr when n < 4, n is odd, or the odd factor of n
+ * exceeds kMaxFftOddFactor.
+ */
+std::shared_ptr<const FftPlan> get_fft_plan(size_t n);
+
+/** Periodic Hann window of length n, as used for STFT analysis. */
+std::vector<float> hann_window(size_t n);
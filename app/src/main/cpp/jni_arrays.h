@@ -0,0 +1,63 @@
+#pragma once
+
+#include <jni.h>
+
+#include "perf_stats.h"
+
+/**
+ * Java array pin/release wrappers that account their cost to
+ * Stage::JniCopy. ART may copy instead of pinning, so this is where JNI
+ * overhead shows up for the array-based natives.
+ */
+
+inline jshort* get_array_elements(JNIEnv* env, jshortArray array) {
+    ScopedStageTimer timer(Stage::JniCopy);
+    return env->GetShortArrayElements(array, nullptr);
+}
+
+inline jfloat* get_array_elements(JNIEnv* env, jfloatArray array) {
+    ScopedStageTimer timer(Stage::JniCopy);
+    return env->GetFloatArrayElements(array, nullptr);
+}
+
+inline void release_array_elements(JNIEnv* env, jshortArray array, jshort* elements, jint mode) {
+    ScopedStageTimer timer(Stage::JniCopy);
+    env->ReleaseShortArrayElements(array, elements, mode);
+}
+
+inline void release_array_elements(JNIEnv* env, jfloatArray array, jfloat* elements, jint mode) {
+    ScopedStageTimer timer(Stage::JniCopy);
+    env->ReleaseFloatArrayElements(array, elements, mode);
+}
+
+/** Copy a whole Java float array into native memory the caller owns. */
+inline bool copy_array_region(JNIEnv* env, jfloatArray array, jsize length, jfloat* out) {
+    ScopedStageTimer timer(Stage::JniCopy);
+    env->GetFloatArrayRegion(array, 0, length, out);
+    return !env->ExceptionCheck();
+}
+
+/**
+ * Java string held as modified UTF-8 for the scope, nullptr for a null string.
+ */
+class ScopedUtfChars {
+public:
+    ScopedUtfChars(JNIEnv* env, jstring string)
+        : env_(env), string_(string), chars_(string != nullptr ? env->GetStringUTFChars(string, nullptr) : nullptr) {}
+
+    ~ScopedUtfChars() {
+        if (chars_ != nullptr) {
+            env_->ReleaseStringUTFChars(string_, chars_);
+        }
+    }
+
+    ScopedUtfChars(const ScopedUtfChars&) = delete;
+    ScopedUtfChars& operator=(const ScopedUtfChars&) = delete;
+
+    const char* get() const { return chars_; }
+
+private:
+    JNIEnv* env_;
+    jstring string_;
+    const char* chars_;
+};
@@ -0,0 +1,109 @@
+#include "lookahead_agc.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kEnvelopeMs = 80.0f;
+constexpr float kMinPeak = 1e-9f;
+
+float smoothing_coeff(float time_ms, int sample_rate) {
+    return 1.0f - std::exp(-1000.0f / (time_ms * static_cast<float>(sample_rate)));
+}
+
+} // namespace
+
+LookaheadAgc::LookaheadAgc(const AgcParams& params) : params_(params) {
+    valid_ = params.sample_rate > 0 && params.target_level > 0.0f && params.attack_ms > 0.0f &&
+             params.release_ms > 0.0f && params.lookahead_ms >= 0.0f && params.min_gain > 0.0f &&
+             params.max_gain >= params.min_gain && params.ceiling > 0.0f;
+    if (!valid_) {
+        return;
+    }
+
+    attack_coeff_ = smoothing_coeff(params.attack_ms, params.sample_rate);
+    release_coeff_ = smoothing_coeff(params.release_ms, params.sample_rate);
+    envelope_coeff_ = smoothing_coeff(kEnvelopeMs, params.sample_rate);
+
+    const size_t lookahead = std::max<size_t>(
+        1, static_cast<size_t>(std::lround(params.lookahead_ms * params.sample_rate / 1000.0f)));
+    delay_.resize(lookahead);
+    peak_index_.resize(lookahead + 1);
+    peak_value_.resize(lookahead + 1);
+    tail_.resize(lookahead);
+    reset();
+}
+
+void LookaheadAgc::reset() {
+    std::fill(delay_.begin(), delay_.end(), 0.0f);
+    peak_head_ = 0;
+    peak_size_ = 0;
+    position_ = 0;
+    mean_square_ = 0.0f;
+    gain_ = 1.0f;
+}
+
+void LookaheadAgc::process(float* data, size_t n) {
+    if (!valid_) {
+        return;
+    }
+    const size_t lookahead = delay_.size();
+    const size_t ring = peak_index_.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        const float x = data[i];
+        float& slot = delay_[position_ % lookahead];
+        const float out = slot;
+        slot = x;
+
+        // Sliding maximum of |x| over the samples still in the delay line,
+        // including the one leaving now
+        const float magnitude = std::fabs(x);
+        while (peak_size_ > 0 && peak_value_[(peak_head_ + peak_size_ - 1) % ring] <= magnitude) {
+            --peak_size_;
+        }
+        const size_t back = (peak_head_ + peak_size_) % ring;
+        peak_index_[back] = position_;
+        peak_value_[back] = magnitude;
+        ++peak_size_;
+        while (peak_index_[peak_head_] + lookahead < position_) {
+            peak_head_ = (peak_head_ + 1) % ring;
+            --peak_size_;
+        }
+        const float peak = peak_value_[peak_head_];
+        ++position_;
+
+        mean_square_ += envelope_coeff_ * (x * x - mean_square_);
+        const float rms = std::sqrt(mean_square_);
+        float target = gain_;
+        if (rms > params_.gate_level) {
+            target = std::min(std::max(params_.target_level / rms, params_.min_gain), params_.max_gain);
+        }
+        gain_ += (target < gain_ ? attack_coeff_ : release_coeff_) * (target - gain_);
+
+        // Cap immediately so the gain is already down when the peak leaves
+        gain_ = std::min(gain_, params_.ceiling / std::max(peak, kMinPeak));
+        data[i] = out * gain_;
+    }
+}
+
+void LookaheadAgc::flush(float* out) {
+    std::fill(out, out + latency(), 0.0f);
+    process(out, latency());
+}
+
+void LookaheadAgc::process_buffer(float* data, size_t n) {
+    if (!valid_) {
+        return;
+    }
+    reset();
+    process(data, n);
+    flush(tail_.data());
+
+    const size_t delay = latency();
+    for (size_t i = 0; i < n; ++i) {
+        const size_t src = i + delay;
+        data[i] = src < n ? data[src] : tail_[src - n];
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct AgcParams {
+    int sample_rate = 16000;
+    float target_level = 0.1f;   // RMS the gain steers towards, full scale = 1
+    float attack_ms = 10.0f;     // gain reduction time constant
+    float release_ms = 500.0f;   // gain recovery time constant
+    float lookahead_ms = 10.0f;
+    float min_gain = 0.1f;
+    float max_gain = 10.0f;
+    float gate_level = 0.001f;   // RMS below which the gain is held, not raised
+    float ceiling = 0.99f;       // output peak limit
+};
+
+/**
+ * Look-ahead automatic gain control.
+ *
+ * An RMS envelope (80 ms window) sets the gain that would bring the input to
+ * target_level, clamped to [min_gain, max_gain]; below gate_level the gain
+ * is held so silence and room noise aren't pumped up. The gain then
+ * follows that target with the attack time when falling and the release
+ * time when rising.
+ *
+ * Output is delayed by the look-ahead. The gain is additionally capped
+ * at ceiling / peak, where peak is the largest sample in that window, so
+ * it has already dropped when a transient reaches the output instead of
+ * clipping it; a sliding-window maximum keeps that O(1) per sample.
+ *
+ * process() works in place, flush() returns the final latency() samples
+ * and process_buffer() hides the delay for a whole buffer. Nothing
+ * allocates after construction.
+ *
+ * Not thread-safe; one instance per stream.
+ */
+class LookaheadAgc {
+public:
+    explicit LookaheadAgc(const AgcParams& params);
+
+    bool is_valid() const { return valid_; }
+
+    size_t latency() const { return delay_.size(); }
+
+    void process(float* data, size_t n);
+
+    /** Emit the last latency() samples of the stream into out. */
+    void flush(float* out);
+
+    /** Reset, then level all of data in place with no delay. */
+    void process_buffer(float* data, size_t n);
+
+    void reset();
+
+private:
+    AgcParams params_;
+    float attack_coeff_ = 0.0f;
+    float release_coeff_ = 0.0f;
+    float envelope_coeff_ = 0.0f;
+    bool valid_ = false;
+
+    std::vector<float> delay_;          // look-ahead ring of input samples
+    std::vector<uint64_t> peak_index_;  // monotonic deque of sample indices, ring of delay_ size + 1
+    std::vector<float> peak_value_;
+    size_t peak_head_ = 0;
+    size_t peak_size_ = 0;
+    uint64_t position_ = 0;
+
+    std::vector<float> tail_;           // flush() output for process_buffer()
+    float mean_square_ = 0.0f;
+    float gain_ = 1.0f;
+};
@@ -0,0 +1,313 @@
+#include "media_decoder.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaExtractor.h>
+#include <media/NdkMediaFormat.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "wav_reader.h"
+
+#define LOG_TAG "MediaDecoder"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// About 2.7 s of 48 kHz mono between the decoder and the consumer
+constexpr size_t kRingSamples = 1 << 17;
+
+constexpr int64_t kDequeueTimeoutUs = 10000;
+
+// AMEDIAFORMAT_KEY_PCM_ENCODING needs API 28; the key itself is stable
+constexpr const char* kKeyPcmEncoding = "pcm-encoding";
+constexpr int32_t kEncodingPcmFloat = 4;  // AudioFormat.ENCODING_PCM_FLOAT
+
+bool is_audio_mime(const char* mime) {
+    return mime != nullptr && std::strncmp(mime, "audio/", 6) == 0;
+}
+
+} // namespace
+
+MediaDecoder::MediaDecoder() : ring_(kRingSamples) {}
+
+MediaDecoder::~MediaDecoder() {
+    stopping_.store(true, std::memory_order_release);
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    release();
+}
+
+void MediaDecoder::release() {
+    if (codec_ != nullptr) {
+        AMediaCodec_stop(codec_);
+        AMediaCodec_delete(codec_);
+        codec_ = nullptr;
+    }
+    if (extractor_ != nullptr) {
+        AMediaExtractor_delete(extractor_);
+        extractor_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool MediaDecoder::open(const char* path) {
+    if (thread_.joinable()) {
+        LOGE("Decoder already open");
+        return false;
+    }
+
+    fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        LOGE("Cannot open %s: %s", path, std::strerror(errno));
+        release();
+        return false;
+    }
+
+    extractor_ = AMediaExtractor_new();
+    if (extractor_ == nullptr ||
+        AMediaExtractor_setDataSourceFd(extractor_, fd_, 0, static_cast<off64_t>(st.st_size)) != AMEDIA_OK) {
+        LOGE("No extractor for %s", path);
+        release();
+        return false;
+    }
+
+    // First audio track the platform has a decoder for
+    const size_t n_tracks = AMediaExtractor_getTrackCount(extractor_);
+    for (size_t i = 0; i < n_tracks && codec_ == nullptr; ++i) {
+        AMediaFormat* format = AMediaExtractor_getTrackFormat(extractor_, i);
+        const char* mime = nullptr;
+        if (format == nullptr || !AMediaFormat_getString(format, AMEDIAFORMAT_KEY_MIME, &mime) ||
+            !is_audio_mime(mime)) {
+            if (format != nullptr) {
+                AMediaFormat_delete(format);
+            }
+            continue;
+        }
+
+        codec_ = AMediaCodec_createDecoderByType(mime);
+        if (codec_ != nullptr && AMediaCodec_configure(codec_, format, nullptr, nullptr, 0) == AMEDIA_OK &&
+            AMediaExtractor_selectTrack(extractor_, i) == AMEDIA_OK) {
+            int32_t rate = 0;
+            int32_t channels = 0;
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &rate);
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channels);
+            AMediaFormat_getInt64(format, AMEDIAFORMAT_KEY_DURATION, &duration_us_);
+            LOGI("Decoding track %zu: %s, %d Hz, %d channels", i, mime, rate, channels);
+        } else {
+            LOGE("No usable decoder for track %zu (%s)", i, mime);
+            if (codec_ != nullptr) {
+                AMediaCodec_delete(codec_);
+                codec_ = nullptr;
+            }
+        }
+        AMediaFormat_delete(format);
+    }
+
+    if (codec_ == nullptr) {
+        LOGE("No decodable audio track in %s", path);
+        release();
+        return false;
+    }
+    if (AMediaCodec_start(codec_) != AMEDIA_OK) {
+        LOGE("Failed to start decoder");
+        AMediaCodec_delete(codec_);
+        codec_ = nullptr;
+        release();
+        return false;
+    }
+
+    thread_ = std::thread(&MediaDecoder::decode_loop, this);
+
+    // The output format, rather than the track's, says what read() returns
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return format_ready_ || done_.load(std::memory_order_acquire); });
+    return format_ready_ && sample_rate_ > 0;
+}
+
+void MediaDecoder::decode_loop() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (!input_done_ && !queue_input()) {
+            finish(true);
+            return;
+        }
+        const int status = drain_output();
+        if (status != 0) {
+            finish(status < 0);
+            return;
+        }
+    }
+    finish(false);
+}
+
+bool MediaDecoder::queue_input() {
+    // Don't wait here: when the codec has no free input, output is pending
+    const ssize_t index = AMediaCodec_dequeueInputBuffer(codec_, 0);
+    if (index < 0) {
+        return true;
+    }
+
+    size_t capacity = 0;
+    uint8_t* buffer = AMediaCodec_getInputBuffer(codec_, static_cast<size_t>(index), &capacity);
+    const ssize_t size = buffer != nullptr ? AMediaExtractor_readSampleData(extractor_, buffer, capacity) : -1;
+    if (size < 0) {
+        input_done_ = true;
+        return AMediaCodec_queueInputBuffer(codec_, static_cast<size_t>(index), 0, 0, 0,
+                                            AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) == AMEDIA_OK;
+    }
+
+    const int64_t pts = AMediaExtractor_getSampleTime(extractor_);
+    if (AMediaCodec_queueInputBuffer(codec_, static_cast<size_t>(index), 0, static_cast<size_t>(size),
+                                     static_cast<uint64_t>(pts), 0) != AMEDIA_OK) {
+        LOGE("Failed to queue input at %lld us", static_cast<long long>(pts));
+        return false;
+    }
+    AMediaExtractor_advance(extractor_);
+    return true;
+}
+
+int MediaDecoder::drain_output() {
+    AMediaCodecBufferInfo info;
+    const ssize_t index = AMediaCodec_dequeueOutputBuffer(codec_, &info, kDequeueTimeoutUs);
+    if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+        update_output_format();
+        return 0;
+    }
+    if (index == AMEDIACODEC_INFO_TRY_AGAIN_LATER || index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+        return 0;
+    }
+    if (index < 0) {
+        LOGE("Decoder error: %zd", index);
+        return -1;
+    }
+    if (!format_ready_) {
+        update_output_format();
+    }
+
+    size_t capacity = 0;
+    const uint8_t* buffer = AMediaCodec_getOutputBuffer(codec_, static_cast<size_t>(index), &capacity);
+    bool written = true;
+    if (buffer != nullptr && info.size > 0 && channels_ > 0) {
+        const uint8_t* data = buffer + info.offset;
+        const size_t channels = static_cast<size_t>(channels_);
+        const size_t frame_bytes = (float_output_ ? sizeof(float) : sizeof(int16_t)) * channels;
+        const size_t frames = static_cast<size_t>(info.size) / frame_bytes;
+        mono_.resize(frames);
+
+        if (float_output_) {
+            const float* pcm = reinterpret_cast<const float*>(data);
+            const float scale = 1.0f / static_cast<float>(channels);
+            for (size_t i = 0; i < frames; ++i) {
+                float sum = 0.0f;
+                for (size_t c = 0; c < channels; ++c) {
+                    sum += pcm[i * channels + c];
+                }
+                mono_[i] = sum * scale;
+            }
+        } else {
+            downmix_pcm16(reinterpret_cast<const int16_t*>(data), frames, channels, mono_.data());
+        }
+        written = write_ring(mono_.data(), frames);
+    }
+    AMediaCodec_releaseOutputBuffer(codec_, static_cast<size_t>(index), false);
+
+    if (!written) {
+        return 1;  // stopping
+    }
+    return (info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0 ? 1 : 0;
+}
+
+void MediaDecoder::update_output_format() {
+    AMediaFormat* format = AMediaCodec_getOutputFormat(codec_);
+    if (format == nullptr) {
+        return;
+    }
+    int32_t rate = 0;
+    int32_t channels = 0;
+    int32_t encoding = 0;
+    AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &rate);
+    AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channels);
+    AMediaFormat_getInt32(format, kKeyPcmEncoding, &encoding);
+    AMediaFormat_delete(format);
+
+    channels_ = channels;
+    float_output_ = encoding == kEncodingPcmFloat;
+
+    if (format_ready_) {
+        if (rate != sample_rate_) {
+            LOGE("Output rate changed from %d to %d Hz; keeping %d", sample_rate_, rate, sample_rate_);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sample_rate_ = rate;
+        format_ready_ = true;
+    }
+    cv_.notify_all();
+    LOGI("Decoder output: %d Hz, %d channels, %s", rate, channels, float_output_ ? "float" : "PCM16");
+}
+
+bool MediaDecoder::write_ring(const float* samples, size_t n) {
+    while (n > 0) {
+        const size_t written = ring_.write(samples, n);
+        samples += written;
+        n -= written;
+        if (written > 0) {
+            // Taking the mutex orders this with a reader about to wait
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cv_.notify_all();
+        }
+        if (n > 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return stopping_.load(std::memory_order_acquire) || ring_.size() < ring_.capacity();
+            });
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MediaDecoder::finish(bool failed) {
+    failed_.store(failed, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+}
+
+size_t MediaDecoder::read(float* out, size_t max_frames) {
+    if (!thread_.joinable() || max_frames == 0) {
+        return 0;
+    }
+    for (;;) {
+        const size_t got = ring_.read(out, max_frames);
+        if (got > 0) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cv_.notify_all();
+            return got;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (done_.load(std::memory_order_acquire) && ring_.size() == 0) {
+            return 0;
+        }
+        cv_.wait(lock, [this] { return done_.load(std::memory_order_acquire) || ring_.size() > 0; });
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring_buffer.h"
+
+struct AMediaCodec;
+struct AMediaExtractor;
+
+/**
+ * Decodes the first audio track of a compressed file (AAC/m4a, Opus, MP3,
+ * FLAC, ... whatever the platform's extractors and codecs support) with
+ * the NDK AMediaExtractor / AMediaCodec APIs.
+ *
+ * A native thread drives the codec and writes mono float PCM, downmixed
+ * from the codec's interleaved output, into an SPSC ring; read() drains it
+ * on the consumer side. Decoding therefore overlaps whatever the consumer
+ * does with the audio, and no PCM passes through Java. The decoder blocks
+ * while the ring is full, so memory stays at the ring's capacity.
+ */
+class MediaDecoder {
+public:
+    MediaDecoder();
+
+    /** Stops the decode thread and releases the codec. */
+    ~MediaDecoder();
+
+    MediaDecoder(const MediaDecoder&) = delete;
+    MediaDecoder& operator=(const MediaDecoder&) = delete;
+
+    /**
+     * Open path, start decoding and wait for the codec to report its output
+     * format. Returns false when the file has no decodable audio track.
+     */
+    bool open(const char* path);
+
+    /** Output sample rate; may differ from the track's (e.g. HE-AAC). */
+    int sample_rate() const { return sample_rate_; }
+
+    /** Track duration from the container, or 0 when it doesn't say. */
+    int64_t duration_us() const { return duration_us_; }
+
+    /**
+     * Read up to max_frames mono frames, waiting while the decoder is
+     * behind. Returns 0 once everything has been read or decoding failed.
+     */
+    size_t read(float* out, size_t max_frames);
+
+    /** True if decoding stopped on a codec or extractor error. */
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+    void decode_loop();
+    bool queue_input();
+    int drain_output();  // -1 on error, 1 at the end of the stream, else 0
+    void update_output_format();
+    bool write_ring(const float* samples, size_t n);
+    void finish(bool failed);
+    void release();
+
+    int fd_ = -1;
+    AMediaExtractor* extractor_ = nullptr;
+    AMediaCodec* codec_ = nullptr;
+    int sample_rate_ = 0;
+    int64_t duration_us_ = 0;
+    int channels_ = 0;
+    bool float_output_ = false;
+    bool input_done_ = false;
+
+    SpscRingBuffer<float> ring_;
+    std::vector<float> mono_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool format_ready_ = false;
+    std::atomic<bool> done_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
@@ -0,0 +1,245 @@
+#include "mel_frontend.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include "perf_stats.h"
+
+#define LOG_TAG "MelFrontend"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+constexpr size_t kBins = kMelFrameSize / 2 + 1;
+constexpr size_t kReflect = kMelFrameSize / 2;  // padding before the first frame
+
+// whisper_pcm_to_mel pads 30 seconds of silence after the audio
+constexpr size_t kPadFrames = 30 * kSampleRate / kMelHop;
+
+// log10 of whisper's power floor, the value of every all-silent frame
+constexpr float kSilenceLog = -10.0f;
+
+// Slaney mel scale: linear below 1 kHz, logarithmic above
+constexpr double kMelLinearStep = 200.0 / 3.0;
+constexpr double kMelLogStartHz = 1000.0;
+constexpr double kMelLogStart = kMelLogStartHz / kMelLinearStep;
+const double kMelLogStep = std::log(6.4) / 27.0;
+
+double hz_to_mel(double hz) {
+    if (hz < kMelLogStartHz) {
+        return hz / kMelLinearStep;
+    }
+    return kMelLogStart + std::log(hz / kMelLogStartHz) / kMelLogStep;
+}
+
+double mel_to_hz(double mel) {
+    if (mel < kMelLogStart) {
+        return mel * kMelLinearStep;
+    }
+    return kMelLogStartHz * std::exp(kMelLogStep * (mel - kMelLogStart));
+}
+
+std::shared_ptr<const MelFilterbank> build_filterbank(int n_mel) {
+    // Band edges evenly spaced in mel from 0 Hz to Nyquist
+    const double max_mel = hz_to_mel(kSampleRate / 2.0);
+    std::vector<double> edges(n_mel + 2);
+    for (int i = 0; i < n_mel + 2; ++i) {
+        edges[i] = mel_to_hz(max_mel * i / (n_mel + 1));
+    }
+
+    auto bank = std::make_shared<MelFilterbank>();
+    bank->n_mel = n_mel;
+    bank->filters.resize(n_mel);
+    for (int m = 0; m < n_mel; ++m) {
+        const double lower = edges[m];
+        const double centre = edges[m + 1];
+        const double upper = edges[m + 2];
+        const double norm = 2.0 / (upper - lower);  // Slaney area normalization
+
+        MelFilterbank::Filter& filter = bank->filters[m];
+        for (size_t k = 0; k < kBins; ++k) {
+            const double hz = static_cast<double>(k) * kSampleRate / kMelFrameSize;
+            const double rise = (hz - lower) / (centre - lower);
+            const double fall = (upper - hz) / (upper - centre);
+            const double weight = std::max(0.0, std::min(rise, fall)) * norm;
+            if (weight <= 0.0) {
+                if (!filter.weights.empty()) {
+                    break;
+                }
+                continue;
+            }
+            if (filter.weights.empty()) {
+                filter.first_bin = k;
+            }
+            filter.weights.push_back(static_cast<float>(weight));
+        }
+    }
+    return bank;
+}
+
+} // namespace
+
+std::shared_ptr<const MelFilterbank> get_mel_filterbank(int n_mel) {
+    if (n_mel <= 0) {
+        LOGE("Invalid mel band count: %d", n_mel);
+        return nullptr;
+    }
+
+    static std::mutex cache_mutex;
+    static std::map<int, std::shared_ptr<const MelFilterbank>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(n_mel);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<const MelFilterbank> bank = build_filterbank(n_mel);
+    cache.emplace(n_mel, bank);
+    return bank;
+}
+
+MelFrontend::MelFrontend(int n_mel)
+    : n_mel_(std::max(n_mel, 1)),
+      plan_(get_fft_plan(kMelFrameSize)),
+      filterbank_(get_mel_filterbank(n_mel)),
+      window_(hann_window(kMelFrameSize)),
+      windowed_(kMelFrameSize),
+      spectrum_(kBins),
+      power_(kBins) {}
+
+void MelFrontend::reset() {
+    head_.clear();
+    pending_.clear();
+    primed_ = false;
+    frames_.clear();
+    window_samples_ = 0;
+}
+
+void MelFrontend::append(const float* samples, size_t n) {
+    if (!is_valid() || n == 0) {
+        return;
+    }
+    ScopedStageTimer timer(Stage::Mel);
+    window_samples_ += n;
+
+    if (!primed_) {
+        head_.insert(head_.end(), samples, samples + n);
+        if (head_.size() <= kReflect) {
+            return;  // the reflect padding needs kReflect + 1 samples
+        }
+        // Same padding as whisper: padded[i] = audio[kReflect - i]
+        pending_.resize(kReflect);
+        std::reverse_copy(head_.begin() + 1, head_.begin() + 1 + kReflect, pending_.begin());
+        pending_.insert(pending_.end(), head_.begin(), head_.end());
+        head_.clear();
+        primed_ = true;
+    } else {
+        pending_.insert(pending_.end(), samples, samples + n);
+    }
+
+    size_t consumed = 0;
+    while (pending_.size() - consumed >= kMelFrameSize) {
+        const size_t offset = frames_.size();
+        frames_.resize(offset + n_mel_);
+        compute_frame(pending_.data() + consumed, kMelFrameSize, frames_.data() + offset);
+        consumed += kMelHop;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + consumed);
+}
+
+void MelFrontend::drop_frames(size_t n) {
+    n = std::min(n, window_samples_ / kMelHop);
+    const size_t cached = cached_frames();
+    const size_t from_cache = std::min(n, cached);
+    frames_.erase(frames_.begin(), frames_.begin() + from_cache * n_mel_);
+
+    // Frames that were never computed: skip their audio instead
+    const size_t skipped = std::min((n - from_cache) * kMelHop, primed_ ? pending_.size() : head_.size());
+    std::vector<float>& buffer = primed_ ? pending_ : head_;
+    buffer.erase(buffer.begin(), buffer.begin() + skipped);
+
+    window_samples_ -= n * kMelHop;
+}
+
+int MelFrontend::window_mel(std::vector<float>& out, int& n_len) {
+    const size_t n_mel = static_cast<size_t>(n_mel_);
+    const size_t cached = cached_frames();
+    const size_t total = window_samples_ / kMelHop + kPadFrames;
+    n_len = static_cast<int>(total);
+
+    // Frames still waiting on future samples see zeros past the end, as
+    // whisper's padding gives them. Before the stream is primed the reflect
+    // padding is built from whatever audio exists.
+    const float* padded = pending_.data();
+    size_t padded_size = pending_.size();
+    if (!primed_) {
+        tail_.assign(kReflect, 0.0f);
+        for (size_t i = 0; i < kReflect; ++i) {
+            if (kReflect - i < head_.size()) {
+                tail_[i] = head_[kReflect - i];
+            }
+        }
+        tail_.insert(tail_.end(), head_.begin(), head_.end());
+        padded = tail_.data();
+        padded_size = head_.empty() ? 0 : tail_.size();
+    }
+
+    const size_t open = padded_size == 0 ? 0 : (padded_size + kMelHop - 1) / kMelHop;
+    const size_t computed = cached + open;
+    frames_.resize((cached + open) * n_mel);
+    {
+        ScopedStageTimer timer(Stage::Mel);
+        for (size_t f = 0; f < open; ++f) {
+            const size_t start = f * kMelHop;
+            compute_frame(padded + start, padded_size - start, frames_.data() + (cached + f) * n_mel);
+        }
+    }
+
+    float max_log = computed < total ? kSilenceLog : -INFINITY;
+    for (float value : frames_) {
+        max_log = std::max(max_log, value);
+    }
+    const float min_log = max_log - 8.0f;
+
+    out.resize(n_mel * total);
+    for (size_t m = 0; m < n_mel; ++m) {
+        float* row = out.data() + m * total;
+        for (size_t f = 0; f < computed; ++f) {
+            row[f] = (std::max(frames_[f * n_mel + m], min_log) + 4.0f) / 4.0f;
+        }
+        std::fill(row + computed, row + total, (std::max(kSilenceLog, min_log) + 4.0f) / 4.0f);
+    }
+
+    // The open frames change as audio arrives; only complete ones stay cached
+    frames_.resize(cached * n_mel);
+
+    const int64_t covered = 1 + (static_cast<int64_t>(window_samples_) - static_cast<int64_t>(kReflect)) /
+                                    static_cast<int64_t>(kMelHop);
+    return static_cast<int>(std::max<int64_t>(covered, 0));
+}
+
+void MelFrontend::compute_frame(const float* padded, size_t available, float* log_mel) {
+    const size_t n = std::min(available, kMelFrameSize);
+    for (size_t i = 0; i < n; ++i) {
+        windowed_[i] = window_[i] * padded[i];
+    }
+    std::fill(windowed_.begin() + n, windowed_.end(), 0.0f);
+
+    plan_->power_spectrum(windowed_.data(), spectrum_.data(), power_.data());
+
+    for (int m = 0; m < n_mel_; ++m) {
+        const MelFilterbank::Filter& filter = filterbank_->filters[m];
+        const float* power = power_.data() + filter.first_bin;
+        float sum = 0.0f;
+        for (size_t k = 0; k < filter.weights.size(); ++k) {
+            sum += filter.weights[k] * power[k];
+        }
+        log_mel[m] = std::log10(std::max(sum, 1e-10f));
+    }
+}
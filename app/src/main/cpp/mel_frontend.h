@@ -0,0 +1,108 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "fft.h"
+
+/** Whisper's STFT: 25 ms Hann frames every 10 ms at 16 kHz. */
+constexpr size_t kMelFrameSize = 400;
+constexpr size_t kMelHop = 160;
+
+/**
+ * Slaney-style mel filterbank over the kMelFrameSize / 2 + 1 power bins,
+ * the same filters librosa generates for Whisper's checkpoints. Rows are
+ * sparse, so each keeps only the span of bins it covers.
+ */
+struct MelFilterbank {
+    struct Filter {
+        size_t first_bin = 0;
+        std::vector<float> weights;  // bins first_bin .. first_bin + weights.size()
+    };
+
+    int n_mel = 0;
+    std::vector<Filter> filters;
+};
+
+/**
+ * Get (or build and cache) the filterbank for n_mel bands (80, or 128 for
+ * large-v3). Thread-safe; returns nullptr when n_mel is not positive.
+ */
+std::shared_ptr<const MelFilterbank> get_mel_filterbank(int n_mel);
+
+/**
+ * Incremental log-mel spectrogram in the exact form whisper_pcm_to_mel
+ * produces, for feeding whisper_set_mel.
+ *
+ * The window, filterbank and FFT plan are built once and shared. Audio is
+ * appended as it arrives and each frame's log power is computed once, when
+ * its last sample lands; frames are cached until drop_frames() removes them
+ * from the front. window_mel() then only has to fill in the two or three
+ * frames still waiting on future samples, pad, and normalize, so a sliding
+ * window re-decoded every step costs no frontend work for the audio it has
+ * already seen.
+ *
+ * Like whisper, the first frame of the stream is reflect-padded. After
+ * frames are dropped, the new first frame is centred on real audio that
+ * preceded it instead, which is what whisper would see with no cut at all.
+ *
+ * Not thread-safe; one instance per stream.
+ */
+class MelFrontend {
+public:
+    explicit MelFrontend(int n_mel);
+
+    bool is_valid() const { return plan_ != nullptr && filterbank_ != nullptr; }
+    int n_mel() const { return n_mel_; }
+
+    /** Append 16 kHz mono audio and compute every frame it completes. */
+    void append(const float* samples, size_t n);
+
+    /** Frames cached so far, counted from the current window start. */
+    size_t cached_frames() const { return frames_.size() / n_mel_; }
+
+    /**
+     * Drop the first n frames (n * kMelHop samples) of the window. Dropping
+     * audio that has not been appended yet is clamped to what has.
+     */
+    void drop_frames(size_t n);
+
+    /** Forget all audio, as for a new stream. */
+    void reset();
+
+    /**
+     * Write the window's normalized mel in whisper's [n_mel][n_len] layout,
+     * padded with 30 seconds of silence frames as whisper_pcm_to_mel does so
+     * the encoder sees the same input. Returns the frame count covering the
+     * audio itself (whisper's n_len_org), which bounds decoding through
+     * duration_ms; n_len receives the padded length to pass to
+     * whisper_set_mel.
+     */
+    int window_mel(std::vector<float>& out, int& n_len);
+
+private:
+    /** Log10 power of the frame starting at padded[0], zero past available. */
+    void compute_frame(const float* padded, size_t available, float* log_mel);
+
+    int n_mel_;
+    std::shared_ptr<const FftPlan> plan_;
+    std::shared_ptr<const MelFilterbank> filterbank_;
+    std::vector<float> window_;
+
+    // Padded audio from the start of the next uncomputed frame. Until the
+    // reflect padding can be built, raw audio waits in head_ instead.
+    std::vector<float> head_;
+    std::vector<float> pending_;
+    bool primed_ = false;
+
+    std::vector<float> frames_;  // frame-major log10 mel, [frame][n_mel]
+    size_t window_samples_ = 0;  // audio appended since the window start
+
+    std::vector<float> windowed_;
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<float> power_;
+    std::vector<float> tail_;
+};
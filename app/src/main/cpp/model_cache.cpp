@@ -0,0 +1,281 @@
+#include "model_cache.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#define LOG_TAG "ModelCache"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// Unreferenced models kept loaded in case they are reopened
+constexpr size_t kMaxIdleModels = 1;
+
+// warm_up_model: whisper rejects less than a second of audio, and 64
+// encoder positions (1.28 s) cover it instead of the full 1500
+constexpr int kWarmupSamples = WHISPER_SAMPLE_RATE + WHISPER_SAMPLE_RATE / 10;
+constexpr int kWarmupAudioCtx = 64;
+
+/** Read cursor over a mapped model file, driven by whisper_model_loader. */
+struct MappedReader {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+};
+
+size_t mapped_read(void* ctx, void* output, size_t read_size) {
+    auto* reader = static_cast<MappedReader*>(ctx);
+    const size_t n = std::min(read_size, reader->size - reader->offset);
+    std::memcpy(output, reader->data + reader->offset, n);
+    reader->offset += n;
+    return n;
+}
+
+bool mapped_eof(void* ctx) {
+    auto* reader = static_cast<MappedReader*>(ctx);
+    return reader->offset >= reader->size;
+}
+
+void mapped_close(void* /* ctx */) {
+    // The mapping is owned and unmapped by load_mapped_model
+}
+
+struct CacheEntry {
+    std::shared_ptr<SharedModel> model;
+    uint64_t last_used = 0;
+};
+
+std::mutex cache_mutex;
+std::map<std::string, CacheEntry> cache;
+uint64_t use_clock = 0;
+size_t encoder_cache_capacity = 0;
+
+std::string cache_key(const std::string& path, const whisper_context_params& params) {
+    return params.use_gpu ? path + "#gpu" + std::to_string(params.gpu_device) : path;
+}
+
+bool is_idle(const CacheEntry& entry) {
+    return entry.model.use_count() == 1;  // only the cache holds it
+}
+
+/** Drop idle entries beyond max_idle. Caller holds cache_mutex. */
+size_t trim_locked(size_t max_idle, std::vector<std::shared_ptr<SharedModel>>& freed) {
+    std::vector<std::map<std::string, CacheEntry>::iterator> idle;
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (is_idle(it->second)) {
+            idle.push_back(it);
+        }
+    }
+    if (idle.size() <= max_idle) {
+        return 0;
+    }
+
+    std::sort(idle.begin(), idle.end(), [](const auto& a, const auto& b) {
+        return a->second.last_used < b->second.last_used;
+    });
+    const size_t n_free = idle.size() - max_idle;
+    for (size_t i = 0; i < n_free; ++i) {
+        freed.push_back(std::move(idle[i]->second.model));
+        cache.erase(idle[i]);
+    }
+    return n_free;
+}
+
+} // namespace
+
+SharedModel::~SharedModel() {
+    encoder_cache.reset();  // its states reference ctx
+    if (ctx != nullptr) {
+        LOGI("Freeing cached model: %s", path.c_str());
+        whisper_free(ctx);
+    }
+}
+
+whisper_context* load_mapped_model(const char* path, whisper_context_params params) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Failed to open model %s: %s", path, strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOGE("Invalid model file: %s", path);
+        close(fd);
+        return nullptr;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps the file referenced
+    if (data == MAP_FAILED) {
+        LOGE("Failed to map model %s: %s", path, strerror(errno));
+        return whisper_init_from_file_with_params(path, params);
+    }
+
+    // Tensors are read front to back exactly once
+    madvise(data, size, MADV_SEQUENTIAL);
+    madvise(data, size, MADV_WILLNEED);
+
+    MappedReader reader{static_cast<const uint8_t*>(data), size, 0};
+    whisper_model_loader loader;
+    loader.context = &reader;
+    loader.read = mapped_read;
+    loader.eof = mapped_eof;
+    loader.close = mapped_close;
+
+    whisper_context* ctx = whisper_init_with_params(&loader, params);
+    munmap(data, size);
+    return ctx;
+}
+
+bool prefetch_model_file(const char* path) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Failed to open model %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOGE("Invalid model file: %s", path);
+        close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOGE("Failed to map model %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    // Readahead lands in the page cache, which outlives the mapping
+    const bool advised = madvise(data, size, MADV_WILLNEED) == 0;
+    munmap(data, size);
+    LOGI("Prefetching model: %s (%zu bytes)", path, size);
+    return advised;
+}
+
+bool warm_up_model(whisper_context* ctx, int n_threads) {
+    std::vector<float> silence(kWarmupSamples, 0.0f);
+
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads = n_threads;
+    wparams.audio_ctx = kWarmupAudioCtx;
+    wparams.max_tokens = 1;
+    wparams.single_segment = true;
+    wparams.no_context = true;
+    wparams.no_timestamps = true;
+    wparams.language = "en";  // skip language detection
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+
+    // Not timed_whisper_full: the warmup isn't part of any stage
+    const int result = whisper_full(ctx, wparams, silence.data(), static_cast<int>(silence.size()));
+    whisper_reset_timings(ctx);
+    if (result != 0) {
+        LOGE("Warmup decode failed with error code: %d", result);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<SharedModel> acquire_model(const std::string& path, const whisper_context_params& params) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        LOGE("Model file not found: %s", path.c_str());
+        return nullptr;
+    }
+
+    std::vector<std::shared_ptr<SharedModel>> freed;  // destroyed after the lock is dropped
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    const std::string key = cache_key(path, params);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        const SharedModel& cached = *it->second.model;
+        if (cached.file_size == st.st_size && cached.file_mtime == st.st_mtime) {
+            it->second.last_used = ++use_clock;
+            LOGI("Reusing cached model: %s (%ld holders)", path.c_str(), it->second.model.use_count());
+            return it->second.model;
+        }
+
+        // The file was replaced; current holders keep the old weights
+        LOGI("Model file changed, reloading: %s", path.c_str());
+        freed.push_back(std::move(it->second.model));
+        cache.erase(it);
+    }
+
+    whisper_context* ctx = load_mapped_model(path.c_str(), params);
+    if (ctx == nullptr) {
+        LOGE("Failed to load model: %s", path.c_str());
+        return nullptr;
+    }
+
+    auto model = std::make_shared<SharedModel>();
+    model->ctx = ctx;
+    model->path = path;
+    model->file_size = st.st_size;
+    model->file_mtime = st.st_mtime;
+    model->on_gpu = params.use_gpu;
+    model->encoder_cache = std::make_unique<EncoderCache>(ctx);
+    model->encoder_cache->set_capacity(encoder_cache_capacity);
+    cache[key] = CacheEntry{model, ++use_clock};
+
+    trim_locked(kMaxIdleModels, freed);
+    LOGI("Loaded model: %s (%lld bytes, %s, %zu cached)",
+         path.c_str(), static_cast<long long>(st.st_size), params.use_gpu ? "gpu" : "cpu", cache.size());
+    return model;
+}
+
+size_t trim_model_cache(size_t max_idle) {
+    std::vector<std::shared_ptr<SharedModel>> freed;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return trim_locked(max_idle, freed);
+}
+
+size_t cached_model_count() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return cache.size();
+}
+
+void set_encoder_cache_capacity(size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    encoder_cache_capacity = max_bytes;
+    for (auto& [key, entry] : cache) {
+        entry.model->encoder_cache->set_capacity(max_bytes);
+    }
+}
+
+size_t trim_encoder_caches(size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    size_t freed = 0;
+    for (auto& [key, entry] : cache) {
+        freed += entry.model->encoder_cache->trim(max_bytes);
+    }
+    return freed;
+}
+
+size_t encoder_cache_bytes() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    size_t total = 0;
+    for (const auto& [key, entry] : cache) {
+        total += entry.model->encoder_cache->size_bytes();
+    }
+    return total;
+}
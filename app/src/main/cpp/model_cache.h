@@ -0,0 +1,100 @@
+#pragma once
+
+#include "encoder_cache.h"
+
+#include <whisper.h>
+
+#include <sys/types.h>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * A loaded whisper model, shared by every JNI context opened on the same
+ * file. Contexts, streams and batches decode on whisper_states of their
+ * own; mutex guards the default state, which warmup decodes on. Each
+ * encoder cache entry has a mutex of its own.
+ */
+struct SharedModel {
+    whisper_context* ctx = nullptr;
+    std::string path;
+    off_t file_size = 0;
+    time_t file_mtime = 0;
+    bool on_gpu = false;      // loaded with use_gpu
+    bool verified = false;    // has completed a decode; guarded by mutex
+    std::unique_ptr<EncoderCache> encoder_cache;
+    std::mutex mutex;
+
+    SharedModel() = default;
+    ~SharedModel();
+
+    SharedModel(const SharedModel&) = delete;
+    SharedModel& operator=(const SharedModel&) = delete;
+};
+
+/**
+ * Load a model through a read-only memory mapping of the file instead of
+ * whisper.cpp's buffered stream reads. The mapping is advised sequential
+ * and unmapped once the tensors have been copied out, so its pages stay in
+ * the shared page cache and are reclaimable by the kernel.
+ *
+ * @return The context, or nullptr on failure
+ */
+whisper_context* load_mapped_model(const char* path, whisper_context_params params);
+
+/**
+ * Ask the kernel to start reading a model file into the page cache
+ * (madvise MADV_WILLNEED on a transient mapping) without loading it, so a
+ * later load_mapped_model finds its pages resident. Returns immediately;
+ * the reads complete in the background.
+ */
+bool prefetch_model_file(const char* path);
+
+/**
+ * Run one tiny decode, a second of silence through a shortened encoder and
+ * a single decoder step, so ggml's kernels, thread pool and compute buffers
+ * are initialized before the first real transcription. Whisper's timings
+ * are reset afterwards. The caller holds the model's mutex.
+ */
+bool warm_up_model(whisper_context* ctx, int n_threads);
+
+/**
+ * Reference-counted model cache keyed by path and GPU device, so the same
+ * file loaded for CPU and for GPU are separate entries.
+ *
+ * Returns the already loaded model when the file is unchanged (same size
+ * and mtime), so reopening a model after a screen or session change costs
+ * nothing. A model stays cached while anyone holds it; once the last holder
+ * lets go it is kept idle, up to kMaxIdleModels, in case it is reopened.
+ *
+ * @return The model, or nullptr if it could not be loaded
+ */
+std::shared_ptr<SharedModel> acquire_model(const std::string& path, const whisper_context_params& params);
+
+/**
+ * Free idle cached models beyond max_idle, least recently acquired first.
+ *
+ * @return Number of models freed
+ */
+size_t trim_model_cache(size_t max_idle);
+
+/** Models currently cached, in use or idle. */
+size_t cached_model_count();
+
+/**
+ * Set the memory each model's encoder cache may use, in bytes. Applies to
+ * loaded models and to those loaded later; 0 disables the caches.
+ */
+void set_encoder_cache_capacity(size_t max_bytes);
+
+/**
+ * Evict cached encodings until each model's cache holds at most max_bytes.
+ *
+ * @return Bytes freed
+ */
+size_t trim_encoder_caches(size_t max_bytes);
+
+/** Memory held by cached encodings across all models. */
+size_t encoder_cache_bytes();
@@ -0,0 +1,105 @@
+#include "packed_result.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr int64_t kSamplesPerTick = WHISPER_SAMPLE_RATE / 100;  // whisper times are in 10 ms ticks
+
+int32_t text_length(const char* text) {
+    return text != nullptr ? static_cast<int32_t>(std::strlen(text)) : 0;
+}
+
+/** Whisper ticks on the decoded audio to milliseconds on the original. */
+int32_t to_ms(int64_t ticks, const std::vector<SpeechRegion>* regions) {
+    if (ticks < 0) {
+        ticks = 0;
+    }
+    if (regions == nullptr) {
+        return static_cast<int32_t>(ticks * 10);
+    }
+    const size_t position = expand_speech_position(*regions, static_cast<size_t>(ticks * kSamplesPerTick));
+    return static_cast<int32_t>(static_cast<int64_t>(position) * 1000 / WHISPER_SAMPLE_RATE);
+}
+
+} // namespace
+
+size_t pack_result(whisper_context* ctx, whisper_state* state, const std::vector<SpeechRegion>* regions,
+                   std::vector<uint8_t>& out) {
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    const whisper_token eot = whisper_token_eot(ctx);
+
+    // Size everything first so out is resized once
+    int32_t n_tokens = 0;
+    int32_t text_bytes = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        text_bytes += text_length(whisper_full_get_segment_text_from_state(state, i));
+        const int segment_tokens = whisper_full_n_tokens_from_state(state, i);
+        for (int j = 0; j < segment_tokens; ++j) {
+            if (whisper_full_get_token_id_from_state(state, i, j) < eot) {
+                ++n_tokens;
+                text_bytes += text_length(whisper_full_get_token_text_from_state(ctx, state, i, j));
+            }
+        }
+    }
+
+    const size_t segments_offset = sizeof(PackedHeader);
+    const size_t tokens_offset = segments_offset + sizeof(PackedSegment) * static_cast<size_t>(n_segments);
+    const size_t text_offset = tokens_offset + sizeof(PackedToken) * static_cast<size_t>(n_tokens);
+    const size_t total = text_offset + static_cast<size_t>(text_bytes);
+    out.resize(total);
+    uint8_t* base = out.data();
+
+    const PackedHeader header = {kPackedResultVersion, n_segments, n_tokens, text_bytes};
+    std::memcpy(base, &header, sizeof(header));
+
+    // Segment texts fill the front of the blob, token texts follow
+    int32_t segment_text = 0;
+    int32_t token_text = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        token_text += text_length(whisper_full_get_segment_text_from_state(state, i));
+    }
+
+    int32_t token_index = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        const char* text = whisper_full_get_segment_text_from_state(state, i);
+        PackedSegment segment;
+        segment.start_ms = to_ms(whisper_full_get_segment_t0_from_state(state, i), regions);
+        segment.end_ms = to_ms(whisper_full_get_segment_t1_from_state(state, i), regions);
+        segment.first_token = token_index;
+        segment.text_offset = segment_text;
+        segment.text_length = text_length(text);
+        if (segment.text_length > 0) {
+            std::memcpy(base + text_offset + segment_text, text, static_cast<size_t>(segment.text_length));
+        }
+        segment_text += segment.text_length;
+
+        const int segment_tokens = whisper_full_n_tokens_from_state(state, i);
+        for (int j = 0; j < segment_tokens; ++j) {
+            const whisper_token_data data = whisper_full_get_token_data_from_state(state, i, j);
+            if (data.id >= eot) {
+                continue;
+            }
+            const char* piece = whisper_full_get_token_text_from_state(ctx, state, i, j);
+            PackedToken token;
+            token.id = data.id;
+            token.start_ms = to_ms(data.t0, regions);
+            token.end_ms = to_ms(data.t1, regions);
+            token.probability = data.p;
+            token.text_offset = token_text;
+            token.text_length = text_length(piece);
+            if (token.text_length > 0) {
+                std::memcpy(base + text_offset + token_text, piece, static_cast<size_t>(token.text_length));
+            }
+            token_text += token.text_length;
+
+            std::memcpy(base + tokens_offset + sizeof(PackedToken) * static_cast<size_t>(token_index),
+                        &token, sizeof(token));
+            ++token_index;
+        }
+        segment.n_tokens = token_index - segment.first_token;
+        std::memcpy(base + segments_offset + sizeof(PackedSegment) * static_cast<size_t>(i), &segment,
+                    sizeof(segment));
+    }
+    return total;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "vad.h"
+
+/**
+ * Flat, native-endian encoding of a transcription for Kotlin's
+ * PackedTranscription, which reads it in place from a direct ByteBuffer:
+ *
+ *   PackedHeader
+ *   PackedSegment[n_segments]
+ *   PackedToken[n_tokens]        segments' tokens back to back
+ *   text bytes[text_bytes]       UTF-8, not terminated
+ *
+ * All text lives in the trailing blob: first every segment's text, then
+ * every token's, in token order. A run of tokens is therefore one
+ * contiguous byte range, so a word is decoded from its bytes in one go even
+ * when a BPE token splits a multi-byte character. Special tokens are left
+ * out. Times are milliseconds from the start of the input audio.
+ *
+ * The record layouts are mirrored by PackedTranscription.kt; bump
+ * kPackedResultVersion on any change.
+ */
+constexpr int32_t kPackedResultVersion = 1;
+
+struct PackedHeader {
+    int32_t version;
+    int32_t n_segments;
+    int32_t n_tokens;
+    int32_t text_bytes;
+};
+
+struct PackedSegment {
+    int32_t start_ms;
+    int32_t end_ms;
+    int32_t first_token;
+    int32_t n_tokens;
+    int32_t text_offset;  // into the text blob
+    int32_t text_length;
+};
+
+struct PackedToken {
+    int32_t id;
+    int32_t start_ms;
+    int32_t end_ms;
+    float probability;
+    int32_t text_offset;
+    int32_t text_length;
+};
+
+static_assert(sizeof(PackedHeader) == 16, "PackedHeader layout is shared with Kotlin");
+static_assert(sizeof(PackedSegment) == 24, "PackedSegment layout is shared with Kotlin");
+static_assert(sizeof(PackedToken) == 24, "PackedToken layout is shared with Kotlin");
+
+/**
+ * Encode the result of the last whisper_full on state into out, replacing
+ * its contents but keeping its capacity.
+ *
+ * Token times need wparams.token_timestamps. When the decoded audio was
+ * compact_speech output, pass its regions so times map back to the
+ * original; otherwise pass nullptr.
+ *
+ * @return Encoded size in bytes
+ */
+size_t pack_result(whisper_context* ctx, whisper_state* state, const std::vector<SpeechRegion>* regions,
+                   std::vector<uint8_t>& out);
@@ -0,0 +1,177 @@
+#include "parallel_transcriber.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "perf_stats.h"
+
+#define LOG_TAG "ParallelTranscriber"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kWhisperSampleRate = WHISPER_SAMPLE_RATE;
+
+struct SharedWork {
+    whisper_context* ctx;
+    const ParallelParams* params;
+    const float* samples;
+    const std::vector<ChunkSpan>* chunks;
+    std::vector<std::vector<TimedSegment>> results;  // indexed by chunk
+    std::atomic<size_t> next{0};
+    size_t total_samples = 0;
+    std::atomic<size_t> completed{0};
+    std::atomic<size_t> completed_samples{0};
+    std::atomic<bool> failed{false};
+};
+
+bool should_abort(void* user_data) {
+    const auto* work = static_cast<SharedWork*>(user_data);
+    TranscriptionControl* control = work->params->control;
+    return work->failed.load(std::memory_order_relaxed) ||
+           (control != nullptr && TranscriptionControl::should_abort(control));
+}
+
+void run_worker(SharedWork& work) {
+    whisper_state* state = whisper_init_state(work.ctx);
+    if (state == nullptr) {
+        // Out of memory for another state: the other workers take its share
+        LOGE("Failed to create a decoder state");
+        return;
+    }
+
+    const ParallelParams& params = *work.params;
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads = params.n_threads;
+    wparams.language = params.language.c_str();
+    wparams.translate = params.translate;
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+    wparams.abort_callback = should_abort;
+    wparams.abort_callback_user_data = &work;
+
+    for (;;) {
+        const size_t index = work.next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= work.chunks->size() || work.failed.load(std::memory_order_relaxed)) {
+            break;
+        }
+        const ChunkSpan& chunk = (*work.chunks)[index];
+
+        int result;
+        {
+            ScopedStageTimer timer(Stage::WhisperFull);
+            result = whisper_full_with_state(work.ctx, state, wparams, work.samples + chunk.start,
+                                             static_cast<int>(chunk.end - chunk.start));
+        }
+        if (result != 0) {
+            if (params.control != nullptr && params.control->cancelled()) {
+                LOGI("Chunk %zu cancelled", index);
+            } else if (!work.failed.load(std::memory_order_relaxed)) {
+                LOGE("Chunk %zu failed with error code: %d", index, result);
+            }
+            work.failed.store(true, std::memory_order_relaxed);
+            break;
+        }
+
+        // Segment timestamps are in 10 ms units relative to the chunk
+        const int64_t offset_ms = static_cast<int64_t>(chunk.start) * 1000 / kWhisperSampleRate;
+        std::vector<TimedSegment>& segments = work.results[index];
+        const int n_segments = whisper_full_n_segments_from_state(state);
+        segments.reserve(n_segments);
+        for (int i = 0; i < n_segments; ++i) {
+            TimedSegment segment;
+            const char* text = whisper_full_get_segment_text_from_state(state, i);
+            segment.text = text != nullptr ? text : "";
+            segment.start_ms = offset_ms + whisper_full_get_segment_t0_from_state(state, i) * 10;
+            segment.end_ms = offset_ms + whisper_full_get_segment_t1_from_state(state, i) * 10;
+            segments.push_back(std::move(segment));
+        }
+        work.completed.fetch_add(1, std::memory_order_relaxed);
+        const size_t done = work.completed_samples.fetch_add(chunk.end - chunk.start, std::memory_order_relaxed) +
+                            (chunk.end - chunk.start);
+        if (params.control != nullptr) {
+            params.control->set_progress(static_cast<float>(done) / static_cast<float>(work.total_samples));
+        }
+    }
+
+    whisper_free_state(state);
+}
+
+} // namespace
+
+void plan_chunks(const std::vector<SpeechRegion>& regions, size_t target_samples, size_t max_samples,
+                 std::vector<ChunkSpan>& chunks) {
+    chunks.clear();
+    max_samples = std::max(max_samples, std::max<size_t>(target_samples, 1));
+
+    ChunkSpan current;
+    bool open = false;
+    for (const SpeechRegion& region : regions) {
+        if (open && current.end - current.start < target_samples && region.end - current.start <= max_samples) {
+            current.end = region.end;
+            continue;
+        }
+        if (open) {
+            chunks.push_back(current);
+        }
+        current.start = region.start;
+        current.end = region.end;
+        open = true;
+
+        while (current.end - current.start > max_samples) {
+            chunks.push_back({current.start, current.start + max_samples});
+            current.start += max_samples;
+        }
+    }
+    if (open) {
+        chunks.push_back(current);
+    }
+}
+
+bool transcribe_chunks(whisper_context* ctx, const ParallelParams& params, const float* samples,
+                       const std::vector<ChunkSpan>& chunks, std::vector<TimedSegment>& out) {
+    if (ctx == nullptr || chunks.empty()) {
+        return ctx != nullptr;
+    }
+
+    SharedWork work;
+    work.ctx = ctx;
+    work.params = &params;
+    work.samples = samples;
+    work.chunks = &chunks;
+    work.results.resize(chunks.size());
+    for (const ChunkSpan& chunk : chunks) {
+        work.total_samples += chunk.end - chunk.start;
+    }
+
+    const size_t n_workers = std::min(static_cast<size_t>(std::max(params.n_states, 1)), chunks.size());
+    LOGI("Decoding %zu chunks on %zu states, %d threads each", chunks.size(), n_workers, params.n_threads);
+
+    // The calling thread is one of the workers
+    std::vector<std::thread> helpers;
+    helpers.reserve(n_workers - 1);
+    for (size_t i = 1; i < n_workers; ++i) {
+        helpers.emplace_back(run_worker, std::ref(work));
+    }
+    run_worker(work);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    if (work.completed.load(std::memory_order_relaxed) != chunks.size()) {
+        return false;  // a chunk failed, or no state could be created at all
+    }
+    for (std::vector<TimedSegment>& segments : work.results) {
+        for (TimedSegment& segment : segments) {
+            out.push_back(std::move(segment));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "transcription_control.h"
+#include "vad.h"
+
+/** Half-open span [start, end) of audio decoded as one independent chunk. */
+struct ChunkSpan {
+    size_t start = 0;
+    size_t end = 0;
+};
+
+/** A segment with timestamps in milliseconds from the start of the audio. */
+struct TimedSegment {
+    std::string text;
+    int64_t start_ms = 0;
+    int64_t end_ms = 0;
+};
+
+struct ParallelParams {
+    std::string language = "auto";
+    bool translate = false;
+    int n_states = 2;               // decoder states running at once
+    int n_threads = 1;              // compute threads per state
+    int target_chunk_ms = 120000;   // chunks close at the first pause after this
+    int max_chunk_ms = 180000;      // continuous speech is cut hard here
+    TranscriptionControl* control = nullptr;  // cancels and reports progress, may be null
+};
+
+/**
+ * Group speech regions into chunks for parallel decoding.
+ *
+ * Consecutive regions join the current chunk until it reaches
+ * target_samples, so every cut falls in a pause the VAD found and the
+ * silence between chunks is skipped. A region longer than max_samples is
+ * split at fixed points as a last resort.
+ */
+void plan_chunks(const std::vector<SpeechRegion>& regions, size_t target_samples, size_t max_samples,
+                 std::vector<ChunkSpan>& chunks);
+
+/**
+ * Decode chunks of one recording concurrently on a single model.
+ *
+ * Each worker gets its own whisper_state from whisper_init_state, so the
+ * weights are loaded once and shared while the KV caches and compute
+ * buffers are per worker; workers pull the next chunk from a shared index,
+ * which keeps them busy when chunk lengths differ. The default state is
+ * never touched, so callers don't need the model mutex. Segments are
+ * appended to out in audio order with timestamps offset by their chunk
+ * start.
+ *
+ * The states only live for the call. A worker that can't get a state (out
+ * of memory) leaves its share to the others; if any chunk fails the
+ * remaining ones are aborted and false is returned. A cancel on
+ * params.control aborts every chunk the same way; its progress advances as
+ * chunks complete, by the share of the chunked audio they hold.
+ */
+bool transcribe_chunks(whisper_context* ctx, const ParallelParams& params, const float* samples,
+                       const std::vector<ChunkSpan>& chunks, std::vector<TimedSegment>& out);
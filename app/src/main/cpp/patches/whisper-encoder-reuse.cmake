@@ -0,0 +1,46 @@
+# Apply whisper-encoder-reuse.patch to the whisper.cpp checkout at
+# WHISPER_CPP_DIR, so a cached encoding can skip the encoder inside
+# whisper_full (encoder_cache.h).
+#
+# The checkout is written at most once: later configures find the patch
+# applied with a read-only reverse check and leave it alone. A revision the
+# patch doesn't fit stops the configure; regenerate the patch against it, or
+# configure with -DWHISPER_ENCODER_REUSE=OFF to build unpatched, with encoder
+# cache hits encoding again.
+
+option(WHISPER_ENCODER_REUSE "Patch whisper.cpp so encoder cache hits skip the encoder" ON)
+
+if(WHISPER_ENCODER_REUSE)
+    find_package(Git REQUIRED)
+    set(WHISPER_ENCODER_REUSE_PATCH ${CMAKE_CURRENT_LIST_DIR}/whisper-encoder-reuse.patch)
+
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} apply --reverse --check ${WHISPER_ENCODER_REUSE_PATCH}
+        WORKING_DIRECTORY ${WHISPER_CPP_DIR}
+        RESULT_VARIABLE WHISPER_ENCODER_REUSE_MISSING
+        OUTPUT_QUIET ERROR_QUIET)
+
+    if(WHISPER_ENCODER_REUSE_MISSING)
+        # Check before applying so a partial fit never leaves the checkout half patched
+        execute_process(
+            COMMAND ${GIT_EXECUTABLE} apply --check ${WHISPER_ENCODER_REUSE_PATCH}
+            WORKING_DIRECTORY ${WHISPER_CPP_DIR}
+            RESULT_VARIABLE WHISPER_ENCODER_REUSE_RESULT
+            ERROR_VARIABLE WHISPER_ENCODER_REUSE_ERROR)
+        if(WHISPER_ENCODER_REUSE_RESULT EQUAL 0)
+            execute_process(
+                COMMAND ${GIT_EXECUTABLE} apply ${WHISPER_ENCODER_REUSE_PATCH}
+                WORKING_DIRECTORY ${WHISPER_CPP_DIR}
+                RESULT_VARIABLE WHISPER_ENCODER_REUSE_RESULT
+                ERROR_VARIABLE WHISPER_ENCODER_REUSE_ERROR)
+        endif()
+        if(NOT WHISPER_ENCODER_REUSE_RESULT EQUAL 0)
+            message(FATAL_ERROR
+                "whisper-encoder-reuse.patch does not apply to ${WHISPER_CPP_DIR}:\n"
+                "${WHISPER_ENCODER_REUSE_ERROR}"
+                "Regenerate the patch for this revision, or configure with "
+                "-DWHISPER_ENCODER_REUSE=OFF to build without encoder reuse.")
+        endif()
+        message(STATUS "Applied whisper-encoder-reuse.patch to ${WHISPER_CPP_DIR}")
+    endif()
+endif()
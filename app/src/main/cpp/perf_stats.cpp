@@ -0,0 +1,261 @@
+#include "perf_stats.h"
+
+#include <android/trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kStageNames[kStageCount] = {
+    "jni_copy",
+    "convert",
+    "resample",
+    "filter",
+    "denoise",
+    "normalize",
+    "vad",
+    "mel",
+    "encode",
+    "decode",
+    "whisper_full",
+};
+
+// Trace section names, prefixed so they group together in Perfetto
+const char* const kTraceNames[kStageCount] = {
+    "whisper:jni_copy",
+    "whisper:convert",
+    "whisper:resample",
+    "whisper:filter",
+    "whisper:denoise",
+    "whisper:normalize",
+    "whisper:vad",
+    "whisper:mel",
+    "whisper:encode",
+    "whisper:decode",
+    "whisper:whisper_full",
+};
+
+struct StageCounters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+
+    void add(uint64_t duration_ns) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+        uint64_t current = max_ns.load(std::memory_order_relaxed);
+        while (duration_ns > current &&
+               !max_ns.compare_exchange_weak(current, duration_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    void merge(const StageCounters& other) {
+        const uint64_t n = other.count.load(std::memory_order_relaxed);
+        if (n == 0) {
+            return;
+        }
+        count.fetch_add(n, std::memory_order_relaxed);
+        total_ns.fetch_add(other.total_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        const uint64_t other_max = other.max_ns.load(std::memory_order_relaxed);
+        uint64_t current = max_ns.load(std::memory_order_relaxed);
+        while (other_max > current &&
+               !max_ns.compare_exchange_weak(current, other_max, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset() {
+        count.store(0, std::memory_order_relaxed);
+        total_ns.store(0, std::memory_order_relaxed);
+        max_ns.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Padded so neighbouring threads' blocks never share a line
+struct alignas(64) ThreadStats {
+    StageCounters stages[kStageCount];
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadStats*> live;
+    ThreadStats retired;  // totals of threads that have exited
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();  // outlives thread_local destructors
+    return *instance;
+}
+
+/** Registers the calling thread's block on first use and retires it on exit. */
+struct ThreadStatsSlot {
+    ThreadStats* stats;
+
+    ThreadStatsSlot() : stats(new ThreadStats()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(stats);
+    }
+
+    ~ThreadStatsSlot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (int i = 0; i < kStageCount; ++i) {
+            r.retired.stages[i].merge(stats->stages[i]);
+        }
+        r.live.erase(std::remove(r.live.begin(), r.live.end(), stats), r.live.end());
+        delete stats;
+    }
+};
+
+ThreadStats& thread_stats() {
+    thread_local ThreadStatsSlot slot;
+    return *slot.stats;
+}
+
+uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+/**
+ * State shared with the encoder and logits callbacks during one whisper_full.
+ * An encoder pass runs from its encoder_begin_callback to the first
+ * decoder step after it, which is when whisper first filters logits.
+ */
+struct WhisperRunProbe {
+    Clock::time_point start;
+    int64_t first_encode_ns = -1;
+    Clock::time_point encode_start;
+    bool encoding = false;
+    uint64_t encode_ns = 0;
+    whisper_encoder_begin_callback chained = nullptr;
+    void* chained_user_data = nullptr;
+    whisper_logits_filter_callback chained_logits = nullptr;
+    void* chained_logits_user_data = nullptr;
+};
+
+bool on_encoder_begin(whisper_context* ctx, whisper_state* state, void* user_data) {
+    auto* probe = static_cast<WhisperRunProbe*>(user_data);
+    probe->encode_start = Clock::now();
+    if (probe->first_encode_ns < 0) {
+        probe->first_encode_ns = static_cast<int64_t>(nanos_since(probe->start));
+    }
+    probe->encoding = true;
+    return probe->chained == nullptr || probe->chained(ctx, state, probe->chained_user_data);
+}
+
+void on_logits(whisper_context* ctx, whisper_state* state, const whisper_token_data* tokens, int n_tokens,
+               float* logits, void* user_data) {
+    auto* probe = static_cast<WhisperRunProbe*>(user_data);
+    if (probe->encoding) {
+        probe->encode_ns += nanos_since(probe->encode_start);
+        probe->encoding = false;
+    }
+    if (probe->chained_logits != nullptr) {
+        probe->chained_logits(ctx, state, tokens, n_tokens, logits, probe->chained_logits_user_data);
+    }
+}
+
+} // namespace
+
+const char* stage_name(Stage stage) {
+    const int i = static_cast<int>(stage);
+    return i >= 0 && i < kStageCount ? kStageNames[i] : "unknown";
+}
+
+void record_stage(Stage stage, uint64_t duration_ns) {
+    const int i = static_cast<int>(stage);
+    if (i >= 0 && i < kStageCount) {
+        thread_stats().stages[i].add(duration_ns);
+    }
+}
+
+void snapshot_stage_stats(StageStats out[kStageCount]) {
+    ThreadStats total;
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (int i = 0; i < kStageCount; ++i) {
+            total.stages[i].merge(r.retired.stages[i]);
+            for (const ThreadStats* stats : r.live) {
+                total.stages[i].merge(stats->stages[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < kStageCount; ++i) {
+        out[i].count = total.stages[i].count.load(std::memory_order_relaxed);
+        out[i].total_ns = total.stages[i].total_ns.load(std::memory_order_relaxed);
+        out[i].max_ns = total.stages[i].max_ns.load(std::memory_order_relaxed);
+    }
+}
+
+void reset_stage_stats() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int i = 0; i < kStageCount; ++i) {
+        r.retired.stages[i].reset();
+        for (ThreadStats* stats : r.live) {
+            stats->stages[i].reset();
+        }
+    }
+}
+
+ScopedStageTimer::ScopedStageTimer(Stage stage)
+    : stage_(stage), traced_(ATrace_isEnabled()), start_(Clock::now()) {
+    if (traced_) {
+        ATrace_beginSection(kTraceNames[static_cast<int>(stage)]);
+    }
+}
+
+ScopedStageTimer::~ScopedStageTimer() {
+    record_stage(stage_, nanos_since(start_));
+    if (traced_) {
+        ATrace_endSection();
+    }
+}
+
+int timed_whisper_full(whisper_context* ctx, whisper_state* state, whisper_full_params params,
+                       const float* samples, int n_samples) {
+    WhisperRunProbe probe;
+    probe.chained = params.encoder_begin_callback;
+    probe.chained_user_data = params.encoder_begin_callback_user_data;
+    probe.chained_logits = params.logits_filter_callback;
+    probe.chained_logits_user_data = params.logits_filter_callback_user_data;
+    params.encoder_begin_callback = on_encoder_begin;
+    params.encoder_begin_callback_user_data = &probe;
+    params.logits_filter_callback = on_logits;
+    params.logits_filter_callback_user_data = &probe;
+
+    int result;
+    uint64_t total_ns;
+    {
+        ScopedStageTimer timer(Stage::WhisperFull);
+        probe.start = Clock::now();
+        result = state != nullptr ? whisper_full_with_state(ctx, state, params, samples, n_samples)
+                                  : whisper_full(ctx, params, samples, n_samples);
+        total_ns = nanos_since(probe.start);
+    }
+
+    if (probe.first_encode_ns < 0) {
+        record_stage(Stage::Mel, total_ns);  // failed or aborted before encoding
+        return result;
+    }
+    if (probe.encoding) {
+        probe.encode_ns += nanos_since(probe.encode_start);  // ended inside an encoder pass
+    }
+
+    const uint64_t mel_ns = static_cast<uint64_t>(probe.first_encode_ns);
+    const uint64_t rest_ns = total_ns > mel_ns ? total_ns - mel_ns : 0;
+    const uint64_t encode_ns = std::min(probe.encode_ns, rest_ns);
+
+    record_stage(Stage::Mel, mel_ns);
+    record_stage(Stage::Encode, encode_ns);
+    record_stage(Stage::Decode, rest_ns - encode_ns);
+    return result;
+}
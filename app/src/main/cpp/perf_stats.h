@@ -0,0 +1,82 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Hot-path timing for the native audio and inference stages.
+ *
+ * Each thread records into its own block of atomic counters, so recording
+ * never takes a lock and threads never contend on a cache line. Blocks are
+ * registered on a thread's first sample and folded into a shared total when
+ * the thread exits; snapshot_stage_stats() sums all of them.
+ *
+ * ScopedStageTimer additionally emits an ATrace section named after the
+ * stage while systrace/Perfetto tracing is enabled.
+ */
+
+/** Order must match NativeStage in NativeStats.kt. */
+enum class Stage : int {
+    JniCopy = 0,  // pinning, copying and releasing Java arrays
+    Convert,      // PCM16 -> float
+    Resample,
+    Filter,
+    Denoise,      // spectral noise suppression
+    Normalize,    // peak normalization and AGC
+    Vad,
+    Mel,          // MelFrontend work, and whisper_full time before the first encoder pass
+    Encode,
+    Decode,       // everything after the mel in whisper_full that isn't encoding
+    WhisperFull,
+    Count
+};
+
+constexpr int kStageCount = static_cast<int>(Stage::Count);
+
+/** Counters of one stage, summed over all threads. */
+struct StageStats {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+const char* stage_name(Stage stage);
+
+/** Add one sample of duration_ns to the calling thread's block. */
+void record_stage(Stage stage, uint64_t duration_ns);
+
+/** Current totals for every stage, indexed by Stage. */
+void snapshot_stage_stats(StageStats out[kStageCount]);
+
+/** Zero every thread's counters. */
+void reset_stage_stats();
+
+/** Records the lifetime of the scope as one sample of a stage. */
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(Stage stage);
+    ~ScopedStageTimer();
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    Stage stage_;
+    bool traced_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * whisper_full on state, or on the context's default state when state is
+ * nullptr, with its time split into the Mel, Encode and Decode stages.
+ *
+ * The mel is whatever happens before the first encoder_begin_callback; each
+ * encoder pass lasts until the first decoder step after it, when whisper
+ * first filters logits, and decode is the remainder. Callbacks already set
+ * in params are still invoked.
+ */
+int timed_whisper_full(whisper_context* ctx, whisper_state* state, whisper_full_params params,
+                       const float* samples, int n_samples);
@@ -0,0 +1,585 @@
+#include "recording_store.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaFormat.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "audio_kernels.h"
+#include "resampler.h"
+#include "wav_reader.h"
+
+#define LOG_TAG "RecordingStore"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr const char* kOpusMime = "audio/opus";
+constexpr const char* kKeyCodecConfig = "csd-0";
+
+constexpr int64_t kDequeueTimeoutUs = 10000;
+
+// Give up on a codec that produces nothing for this many dequeue timeouts
+// after all input was queued
+constexpr int kMaxIdleDequeues = 200;
+
+// AMEDIAFORMAT_KEY_PCM_ENCODING needs API 28; the key itself is stable
+constexpr const char* kKeyPcmEncoding = "pcm-encoding";
+constexpr int32_t kEncodingPcmFloat = 4;  // AudioFormat.ENCODING_PCM_FLOAT
+
+/** Stops and deletes a codec when it goes out of scope. */
+class ScopedCodec {
+public:
+    explicit ScopedCodec(AMediaCodec* codec) : codec_(codec) {}
+
+    ~ScopedCodec() {
+        if (codec_ != nullptr) {
+            if (started_) {
+                AMediaCodec_stop(codec_);
+            }
+            AMediaCodec_delete(codec_);
+        }
+    }
+
+    ScopedCodec(const ScopedCodec&) = delete;
+    ScopedCodec& operator=(const ScopedCodec&) = delete;
+
+    AMediaCodec* get() const { return codec_; }
+
+    bool start(AMediaFormat* format, uint32_t flags) {
+        const bool ok = AMediaCodec_configure(codec_, format, nullptr, nullptr, flags) == AMEDIA_OK &&
+                        AMediaCodec_start(codec_) == AMEDIA_OK;
+        AMediaFormat_delete(format);
+        started_ = ok;
+        return ok;
+    }
+
+private:
+    AMediaCodec* codec_;
+    bool started_ = false;
+};
+
+int16_t to_pcm16(float sample) {
+    return static_cast<int16_t>(std::lround(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+}
+
+void append_u16(std::vector<uint8_t>& out, size_t value) {
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+/**
+ * Encode one chunk with the platform Opus encoder into size-prefixed
+ * packets. config receives the encoder's codec-specific data.
+ */
+bool encode_opus(const float* samples, size_t n, int sample_rate, int bitrate, std::vector<uint8_t>& payload,
+                 std::vector<uint8_t>& config) {
+    ScopedCodec codec(AMediaCodec_createEncoderByType(kOpusMime));
+    if (codec.get() == nullptr) {
+        return false;
+    }
+    AMediaFormat* format = AMediaFormat_new();
+    AMediaFormat_setString(format, AMEDIAFORMAT_KEY_MIME, kOpusMime);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, sample_rate);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, 1);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_BIT_RATE, bitrate);
+    if (!codec.start(format, AMEDIACODEC_CONFIGURE_FLAG_ENCODE)) {
+        LOGE("Failed to start Opus encoder at %d Hz", sample_rate);
+        return false;
+    }
+
+    size_t fed = 0;
+    bool input_done = false;
+    int idle = 0;
+    while (true) {
+        if (!input_done) {
+            const ssize_t index = AMediaCodec_dequeueInputBuffer(codec.get(), 0);
+            if (index >= 0) {
+                size_t capacity = 0;
+                uint8_t* buffer = AMediaCodec_getInputBuffer(codec.get(), static_cast<size_t>(index), &capacity);
+                if (buffer == nullptr) {
+                    return false;
+                }
+                const size_t frames = std::min(n - fed, capacity / sizeof(int16_t));
+                for (size_t i = 0; i < frames; ++i) {
+                    const int16_t pcm = to_pcm16(samples[fed + i]);
+                    std::memcpy(buffer + i * sizeof(int16_t), &pcm, sizeof(pcm));
+                }
+                const uint64_t pts = static_cast<uint64_t>(fed) * 1000000 / static_cast<uint64_t>(sample_rate);
+                fed += frames;
+                input_done = fed == n;
+                if (AMediaCodec_queueInputBuffer(codec.get(), static_cast<size_t>(index), 0,
+                                                 frames * sizeof(int16_t), pts,
+                                                 input_done ? AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM : 0) !=
+                    AMEDIA_OK) {
+                    LOGE("Failed to queue encoder input");
+                    return false;
+                }
+            }
+        }
+
+        AMediaCodecBufferInfo info;
+        const ssize_t index = AMediaCodec_dequeueOutputBuffer(codec.get(), &info, kDequeueTimeoutUs);
+        if (index == AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+            if (input_done && ++idle > kMaxIdleDequeues) {
+                LOGE("Opus encoder stalled");
+                return false;
+            }
+            continue;
+        }
+        if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED || index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+            continue;
+        }
+        if (index < 0) {
+            LOGE("Encoder error: %zd", index);
+            return false;
+        }
+        idle = 0;
+
+        size_t capacity = 0;
+        const uint8_t* buffer = AMediaCodec_getOutputBuffer(codec.get(), static_cast<size_t>(index), &capacity);
+        const size_t size = static_cast<size_t>(info.size);
+        bool ok = true;
+        if (buffer != nullptr && size > 0) {
+            const uint8_t* data = buffer + info.offset;
+            if ((info.flags & AMEDIACODEC_BUFFER_FLAG_CODEC_CONFIG) != 0) {
+                config.assign(data, data + size);
+            } else if (size <= UINT16_MAX) {
+                append_u16(payload, size);
+                payload.insert(payload.end(), data, data + size);
+            } else {
+                LOGE("Opus packet of %zu bytes", size);
+                ok = false;
+            }
+        }
+        AMediaCodec_releaseOutputBuffer(codec.get(), static_cast<size_t>(index), false);
+        if (!ok) {
+            return false;
+        }
+        if ((info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0) {
+            return true;
+        }
+    }
+}
+
+/**
+ * Decode one chunk's size-prefixed Opus packets into mono samples at the
+ * decoder's output rate, which is returned in out_rate.
+ */
+bool decode_opus(const uint8_t* payload, size_t size, const uint8_t* config, size_t config_size, int sample_rate,
+                 std::vector<float>& out, int& out_rate) {
+    ScopedCodec codec(AMediaCodec_createDecoderByType(kOpusMime));
+    if (codec.get() == nullptr) {
+        LOGE("No Opus decoder");
+        return false;
+    }
+    AMediaFormat* format = AMediaFormat_new();
+    AMediaFormat_setString(format, AMEDIAFORMAT_KEY_MIME, kOpusMime);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, sample_rate);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, 1);
+    AMediaFormat_setBuffer(format, kKeyCodecConfig, config, config_size);
+    if (!codec.start(format, 0)) {
+        LOGE("Failed to start Opus decoder");
+        return false;
+    }
+
+    out_rate = sample_rate;
+    int channels = 1;
+    bool float_output = false;
+    std::vector<float> mono;
+
+    size_t pos = 0;
+    uint64_t pts = 0;
+    bool input_done = false;
+    int idle = 0;
+    while (true) {
+        if (!input_done) {
+            const ssize_t index = AMediaCodec_dequeueInputBuffer(codec.get(), 0);
+            if (index >= 0) {
+                size_t capacity = 0;
+                uint8_t* buffer = AMediaCodec_getInputBuffer(codec.get(), static_cast<size_t>(index), &capacity);
+                size_t packet = 0;
+                if (pos + 2 <= size) {
+                    packet = payload[pos] | (static_cast<size_t>(payload[pos + 1]) << 8);
+                    if (pos + 2 + packet > size || buffer == nullptr || packet > capacity) {
+                        LOGE("Corrupt Opus chunk");
+                        return false;
+                    }
+                    std::memcpy(buffer, payload + pos + 2, packet);
+                    pos += 2 + packet;
+                }
+                input_done = pos + 2 > size;
+                if (AMediaCodec_queueInputBuffer(codec.get(), static_cast<size_t>(index), 0, packet, pts,
+                                                 input_done ? AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM : 0) !=
+                    AMEDIA_OK) {
+                    LOGE("Failed to queue decoder input");
+                    return false;
+                }
+                pts += 20000;  // nominal; the decoder doesn't rely on it
+            }
+        }
+
+        AMediaCodecBufferInfo info;
+        const ssize_t index = AMediaCodec_dequeueOutputBuffer(codec.get(), &info, kDequeueTimeoutUs);
+        if (index == AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+            if (input_done && ++idle > kMaxIdleDequeues) {
+                LOGE("Opus decoder stalled");
+                return false;
+            }
+            continue;
+        }
+        if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+            if (AMediaFormat* output = AMediaCodec_getOutputFormat(codec.get())) {
+                int32_t encoding = 0;
+                AMediaFormat_getInt32(output, AMEDIAFORMAT_KEY_SAMPLE_RATE, &out_rate);
+                AMediaFormat_getInt32(output, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channels);
+                AMediaFormat_getInt32(output, kKeyPcmEncoding, &encoding);
+                float_output = encoding == kEncodingPcmFloat;
+                AMediaFormat_delete(output);
+            }
+            continue;
+        }
+        if (index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+            continue;
+        }
+        if (index < 0) {
+            LOGE("Decoder error: %zd", index);
+            return false;
+        }
+        idle = 0;
+
+        size_t capacity = 0;
+        const uint8_t* buffer = AMediaCodec_getOutputBuffer(codec.get(), static_cast<size_t>(index), &capacity);
+        if (buffer != nullptr && info.size > 0 && channels > 0) {
+            const uint8_t* data = buffer + info.offset;
+            const size_t ch = static_cast<size_t>(channels);
+            const size_t frames = static_cast<size_t>(info.size) / ((float_output ? sizeof(float) : sizeof(int16_t)) * ch);
+            mono.resize(frames);
+            if (float_output) {
+                const float* pcm = reinterpret_cast<const float*>(data);
+                for (size_t i = 0; i < frames; ++i) {
+                    float sum = 0.0f;
+                    for (size_t c = 0; c < ch; ++c) {
+                        sum += pcm[i * ch + c];
+                    }
+                    mono[i] = sum / static_cast<float>(ch);
+                }
+            } else {
+                downmix_pcm16(reinterpret_cast<const int16_t*>(data), frames, ch, mono.data());
+            }
+            out.insert(out.end(), mono.begin(), mono.end());
+        }
+        AMediaCodec_releaseOutputBuffer(codec.get(), static_cast<size_t>(index), false);
+        if ((info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0) {
+            return true;
+        }
+    }
+}
+
+/**
+ * Encode every chunk with codec into chunks/audio. Returns false if the
+ * Opus encoder is unavailable or fails, so the caller can fall back.
+ */
+bool encode_chunks(const float* samples, size_t n, size_t chunk_samples, RecordingCodec codec,
+                   const RecordingWriteParams& params, std::vector<RecordingChunk>& chunks,
+                   std::vector<uint8_t>& audio, std::vector<uint8_t>& config) {
+    chunks.clear();
+    audio.clear();
+    config.clear();
+    std::vector<uint8_t> payload;
+    for (size_t start = 0; start < n; start += chunk_samples) {
+        const size_t count = std::min(chunk_samples, n - start);
+        RecordingChunk chunk{audio.size(), 0, static_cast<uint32_t>(count)};
+        if (codec == kRecordingOpus) {
+            payload.clear();
+            if (!encode_opus(samples + start, count, params.sample_rate, params.bitrate, payload, config)) {
+                return false;
+            }
+            audio.insert(audio.end(), payload.begin(), payload.end());
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                const int16_t pcm = to_pcm16(samples[start + i]);
+                append_u16(audio, static_cast<uint16_t>(pcm));
+            }
+        }
+        chunk.size = static_cast<uint32_t>(audio.size() - chunk.offset);
+        chunks.push_back(chunk);
+    }
+    return true;
+}
+
+bool write_all(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool in_bounds(uint64_t offset, uint64_t length, size_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+} // namespace
+
+int write_recording(const char* path, const float* samples, size_t n_samples,
+                    const std::vector<StoredSegment>& segments, const RecordingWriteParams& params) {
+    if (params.sample_rate <= 0 || params.chunk_ms <= 0) {
+        LOGE("Invalid recording parameters: %d Hz, %d ms chunks", params.sample_rate, params.chunk_ms);
+        return -1;
+    }
+    const size_t chunk_samples =
+        std::max<size_t>(1, static_cast<size_t>(params.sample_rate) * static_cast<size_t>(params.chunk_ms) / 1000);
+
+    RecordingCodec codec = params.compress ? kRecordingOpus : kRecordingPcm16;
+    std::vector<RecordingChunk> chunks;
+    std::vector<uint8_t> audio;
+    std::vector<uint8_t> config;
+    if (!encode_chunks(samples, n_samples, chunk_samples, codec, params, chunks, audio, config)) {
+        LOGI("Opus encoding unavailable, storing PCM16");
+        codec = kRecordingPcm16;
+        encode_chunks(samples, n_samples, chunk_samples, codec, params, chunks, audio, config);
+    }
+
+    // Index sorted by start time for binary search, text back to back
+    std::vector<const StoredSegment*> order;
+    order.reserve(segments.size());
+    for (const StoredSegment& segment : segments) {
+        order.push_back(&segment);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const StoredSegment* a, const StoredSegment* b) { return a->t0_ms < b->t0_ms; });
+    std::vector<RecordingSegment> index;
+    std::string text;
+    index.reserve(order.size());
+    for (const StoredSegment* segment : order) {
+        index.push_back({segment->t0_ms, segment->t1_ms, static_cast<uint32_t>(text.size()),
+                         static_cast<uint32_t>(segment->text.size())});
+        text += segment->text;
+    }
+
+    RecordingHeader header{};
+    header.magic = kRecordingMagic;
+    header.version = kRecordingVersion;
+    header.codec = codec;
+    header.sample_rate = static_cast<uint32_t>(params.sample_rate);
+    header.chunk_samples = static_cast<uint32_t>(chunk_samples);
+    header.n_chunks = static_cast<uint32_t>(chunks.size());
+    header.n_segments = static_cast<uint32_t>(index.size());
+    header.config_size = static_cast<uint32_t>(config.size());
+    header.n_samples = n_samples;
+    header.text_size = text.size();
+    header.chunks_offset = sizeof(RecordingHeader);
+    header.segments_offset = header.chunks_offset + chunks.size() * sizeof(RecordingChunk);
+    header.text_offset = header.segments_offset + index.size() * sizeof(RecordingSegment);
+    header.config_offset = header.text_offset + text.size();
+    header.audio_offset = header.config_offset + config.size();
+
+    const std::string tmp = std::string(path) + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("Failed to create %s: %s", tmp.c_str(), strerror(errno));
+        return -1;
+    }
+    const bool ok = write_all(fd, &header, sizeof(header)) &&
+                    write_all(fd, chunks.data(), chunks.size() * sizeof(RecordingChunk)) &&
+                    write_all(fd, index.data(), index.size() * sizeof(RecordingSegment)) &&
+                    write_all(fd, text.data(), text.size()) &&
+                    write_all(fd, config.data(), config.size()) &&
+                    write_all(fd, audio.data(), audio.size()) &&
+                    ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path) != 0) {
+        LOGE("Failed to write recording %s: %s", path, strerror(errno));
+        ::unlink(tmp.c_str());
+        return -1;
+    }
+
+    LOGI("Wrote recording %s: %zu samples in %zu %s chunks, %zu segments, %llu bytes", path, n_samples,
+         chunks.size(), codec == kRecordingOpus ? "Opus" : "PCM16", index.size(),
+         static_cast<unsigned long long>(header.audio_offset + audio.size()));
+    return static_cast<int>(codec);
+}
+
+RecordingReader::~RecordingReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+bool RecordingReader::open(const char* path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Failed to open recording %s: %s", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RecordingHeader)) {
+        LOGE("Invalid recording file: %s", path);
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping keeps the file referenced
+    if (data == MAP_FAILED) {
+        LOGE("Failed to map recording %s: %s", path, strerror(errno));
+        return false;
+    }
+    // Lookups jump between the index, the text and single chunks
+    madvise(data, size, MADV_RANDOM);
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = size;
+
+    const auto* header = reinterpret_cast<const RecordingHeader*>(data_);
+    if (header->magic != kRecordingMagic || header->version != kRecordingVersion) {
+        LOGE("Not a version %u recording: %s", kRecordingVersion, path);
+        return false;
+    }
+    if (header->sample_rate == 0 || header->chunk_samples == 0 ||
+        !in_bounds(header->chunks_offset, static_cast<uint64_t>(header->n_chunks) * sizeof(RecordingChunk), size) ||
+        !in_bounds(header->segments_offset, static_cast<uint64_t>(header->n_segments) * sizeof(RecordingSegment),
+                   size) ||
+        !in_bounds(header->text_offset, header->text_size, size) ||
+        !in_bounds(header->config_offset, header->config_size, size) ||
+        header->audio_offset > size || header->chunks_offset % alignof(RecordingChunk) != 0 ||
+        header->segments_offset % alignof(RecordingSegment) != 0) {
+        LOGE("Corrupt recording header: %s", path);
+        return false;
+    }
+
+    const auto* chunks = reinterpret_cast<const RecordingChunk*>(data_ + header->chunks_offset);
+    for (uint32_t i = 0; i < header->n_chunks; ++i) {
+        if (!in_bounds(chunks[i].offset, chunks[i].size, size - header->audio_offset)) {
+            LOGE("Corrupt chunk table: %s", path);
+            return false;
+        }
+    }
+    const auto* segments = reinterpret_cast<const RecordingSegment*>(data_ + header->segments_offset);
+    for (uint32_t i = 0; i < header->n_segments; ++i) {
+        if (!in_bounds(segments[i].text_offset, segments[i].text_size, header->text_size)) {
+            LOGE("Corrupt segment index: %s", path);
+            return false;
+        }
+    }
+
+    header_ = header;
+    chunks_ = chunks;
+    segments_ = segments;
+    text_ = reinterpret_cast<const char*>(data_ + header->text_offset);
+    return true;
+}
+
+int64_t RecordingReader::duration_ms() const {
+    return static_cast<int64_t>(header_->n_samples * 1000 / header_->sample_rate);
+}
+
+int RecordingReader::find_segment(int64_t time_ms) const {
+    const RecordingSegment* end = segments_ + header_->n_segments;
+    const RecordingSegment* next = std::upper_bound(
+        segments_, end, time_ms, [](int64_t t, const RecordingSegment& segment) { return t < segment.t0_ms; });
+    return next == segments_ ? -1 : static_cast<int>(next - segments_ - 1);
+}
+
+void RecordingReader::search(const char* query, std::vector<int>& out) const {
+    out.clear();
+    const size_t length = std::strlen(query);
+    if (length == 0) {
+        return;
+    }
+    const auto equal = [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    };
+    for (uint32_t i = 0; i < header_->n_segments; ++i) {
+        const char* text = segment_text(i);
+        const char* text_end = text + segments_[i].text_size;
+        if (std::search(text, text_end, query, query + length, equal) != text_end) {
+            out.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+bool RecordingReader::decode_chunk(size_t i, std::vector<float>& out) const {
+    const RecordingChunk& chunk = chunks_[i];
+    const uint8_t* payload = data_ + header_->audio_offset + chunk.offset;
+    out.clear();
+
+    if (header_->codec == kRecordingPcm16) {
+        const size_t n = std::min<size_t>(chunk.n_samples, chunk.size / sizeof(int16_t));
+        std::vector<int16_t> pcm(n);
+        std::memcpy(pcm.data(), payload, n * sizeof(int16_t));  // chunks aren't aligned
+        out.resize(chunk.n_samples, 0.0f);
+        audio_kernels().pcm16_to_float(pcm.data(), out.data(), n);
+        return true;
+    }
+    if (header_->codec != kRecordingOpus) {
+        LOGE("Unknown recording codec %u", header_->codec);
+        return false;
+    }
+
+    std::vector<float> decoded;
+    int rate = 0;
+    if (!decode_opus(payload, chunk.size, data_ + header_->config_offset, header_->config_size,
+                     static_cast<int>(header_->sample_rate), decoded, rate)) {
+        return false;
+    }
+    // The platform decoder may output 48 kHz whatever the stream's rate
+    const int sample_rate = static_cast<int>(header_->sample_rate);
+    if (rate > 0 && rate != sample_rate) {
+        out.resize(resampled_length(decoded.size(), rate, sample_rate));
+        out.resize(resample_buffer(decoded.data(), decoded.size(), rate, sample_rate, out.data()));
+    } else {
+        out.swap(decoded);
+    }
+    out.resize(chunk.n_samples, 0.0f);
+    return true;
+}
+
+bool RecordingReader::read_range(int64_t start_ms, int64_t end_ms, std::vector<float>& out) const {
+    out.clear();
+    const uint64_t rate = header_->sample_rate;
+    const uint64_t first = static_cast<uint64_t>(std::max<int64_t>(start_ms, 0)) * rate / 1000;
+    const uint64_t last = std::min<uint64_t>(static_cast<uint64_t>(std::max<int64_t>(end_ms, 0)) * rate / 1000,
+                                             header_->n_samples);
+    if (first >= last) {
+        return true;
+    }
+
+    out.reserve(last - first);
+    std::vector<float> chunk;
+    for (uint64_t c = first / header_->chunk_samples; c < header_->n_chunks; ++c) {
+        const uint64_t chunk_start = c * header_->chunk_samples;
+        if (chunk_start >= last) {
+            break;
+        }
+        if (!decode_chunk(c, chunk)) {
+            return false;
+        }
+        const uint64_t from = std::max(first, chunk_start) - chunk_start;
+        const uint64_t to = std::min<uint64_t>(last - chunk_start, chunk.size());
+        if (from < to) {
+            out.insert(out.end(), chunk.begin() + from, chunk.begin() + to);
+        }
+    }
+    return true;
+}
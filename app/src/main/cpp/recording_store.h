@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Compact on-disk recording: compressed audio in independently decodable
+ * chunks plus a binary segment index, in one little-endian file:
+ *
+ *   RecordingHeader
+ *   RecordingChunk[n_chunks]       chunk table, in time order
+ *   RecordingSegment[n_segments]   segment index, sorted by t0_ms
+ *   text bytes[text_size]          segments' UTF-8 text, not terminated
+ *   codec config[config_size]      the Opus encoder's codec-specific data
+ *   audio bytes                    chunk payloads back to back
+ *
+ * The index is read in place from a read-only mapping: opening a recording
+ * touches only the header, listing or searching its segments only the
+ * index and text, and reading a time range decodes only the chunks that
+ * overlap it.
+ *
+ * Audio is mono at the recording's sample rate (16 kHz from the app). Opus
+ * chunks are the platform encoder's packets, each prefixed by its uint16
+ * size; they need MediaCodec's Opus encoder (Android 10+), and where it is
+ * missing chunks are stored as PCM16 instead.
+ *
+ * Bump kRecordingVersion on any layout change.
+ */
+constexpr uint32_t kRecordingMagic = 0x43455257;  // "WREC"
+constexpr uint32_t kRecordingVersion = 1;
+
+enum RecordingCodec : uint32_t {
+    kRecordingPcm16 = 0,
+    kRecordingOpus = 1,
+};
+
+struct RecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t codec;
+    uint32_t sample_rate;
+    uint32_t chunk_samples;  // samples per chunk, the last may be shorter
+    uint32_t n_chunks;
+    uint32_t n_segments;
+    uint32_t config_size;
+    uint64_t n_samples;
+    uint64_t text_size;
+    uint64_t chunks_offset;  // offsets from the start of the file
+    uint64_t segments_offset;
+    uint64_t text_offset;
+    uint64_t config_offset;
+    uint64_t audio_offset;
+};
+static_assert(sizeof(RecordingHeader) == 88, "RecordingHeader layout");
+
+struct RecordingChunk {
+    uint64_t offset;  // from audio_offset
+    uint32_t size;
+    uint32_t n_samples;
+};
+static_assert(sizeof(RecordingChunk) == 16, "RecordingChunk layout");
+
+struct RecordingSegment {
+    int64_t t0_ms;
+    int64_t t1_ms;
+    uint32_t text_offset;  // from text_offset
+    uint32_t text_size;
+};
+static_assert(sizeof(RecordingSegment) == 24, "RecordingSegment layout");
+
+/** A segment to store. */
+struct StoredSegment {
+    int64_t t0_ms = 0;
+    int64_t t1_ms = 0;
+    std::string text;
+};
+
+struct RecordingWriteParams {
+    int sample_rate = 16000;
+    int chunk_ms = 5000;
+    int bitrate = 24000;  // Opus bits per second
+    bool compress = true; // false stores PCM16
+};
+
+/**
+ * Write samples and segments to path, through a temporary file renamed into
+ * place so readers never see a partial recording.
+ *
+ * @return The codec the audio was stored with, or -1 on failure
+ */
+int write_recording(const char* path, const float* samples, size_t n_samples,
+                    const std::vector<StoredSegment>& segments, const RecordingWriteParams& params);
+
+/**
+ * Read-only view of a recording file through a memory mapping.
+ * Thread-safe: every method only reads the mapping.
+ */
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    /** Map path and validate its header and tables. */
+    bool open(const char* path);
+
+    const RecordingHeader& header() const { return *header_; }
+    int64_t duration_ms() const;
+
+    const RecordingSegment& segment(size_t i) const { return segments_[i]; }
+    const char* segment_text(size_t i) const { return text_ + segments_[i].text_offset; }
+
+    /** Index of the segment playing at time_ms, the one before a gap, or -1. */
+    int find_segment(int64_t time_ms) const;
+
+    /** Indices of segments whose text contains query, ASCII case-insensitively. */
+    void search(const char* query, std::vector<int>& out) const;
+
+    /**
+     * Decode the audio in [start_ms, end_ms) into out, decoding only the
+     * chunks that overlap it.
+     */
+    bool read_range(int64_t start_ms, int64_t end_ms, std::vector<float>& out) const;
+
+private:
+    bool decode_chunk(size_t i, std::vector<float>& out) const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    const RecordingHeader* header_ = nullptr;
+    const RecordingChunk* chunks_ = nullptr;
+    const RecordingSegment* segments_ = nullptr;
+    const char* text_ = nullptr;
+};
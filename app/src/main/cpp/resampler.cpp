@@ -0,0 +1,250 @@
+#include "resampler.h"
+#include "audio_kernels.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+#define LOG_TAG "Resampler"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// Sinc zero crossings on each side of the centre, in output-rate samples
+constexpr int kZeroCrossings = 16;
+// Passband edge as a fraction of the lower Nyquist frequency
+constexpr double kRolloff = 0.92;
+// Kaiser beta giving roughly 80 dB stopband attenuation
+constexpr double kKaiserBeta = 8.0;
+// Block size used when a whole buffer is pushed through the streaming path
+constexpr size_t kBlockSize = 4096;
+
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x_sq = 0.25 * x * x;
+    for (int k = 1; k < 50; ++k) {
+        term *= half_x_sq / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+double sinc(double x) {
+    if (std::abs(x) < 1e-9) {
+        return 1.0;
+    }
+    const double px = M_PI * x;
+    return std::sin(px) / px;
+}
+
+} // namespace
+
+PolyphaseFilterBank::PolyphaseFilterBank(int source_rate, int target_rate)
+    : source_rate_(source_rate), target_rate_(target_rate) {
+
+    const int g = std::gcd(source_rate, target_rate);
+    up_ = target_rate / g;
+    down_ = source_rate / g;
+
+    // Wider filters when decimating so the cutoff stays sharp at the output rate
+    const int decimation = (down_ + up_ - 1) / up_;
+    size_t taps = static_cast<size_t>(2 * kZeroCrossings * std::max(1, decimation));
+    taps_per_phase_ = (taps + 3) & ~static_cast<size_t>(3);
+
+    const size_t total = taps_per_phase_ * up_;
+    const double center = static_cast<double>(total) / 2.0;
+    const double cutoff = kRolloff * 0.5 / std::max(up_, down_);
+    const double i0_beta = bessel_i0(kKaiserBeta);
+
+    std::vector<double> prototype(total);
+    for (size_t j = 0; j < total; ++j) {
+        const double t = static_cast<double>(j) - center;
+        const double x = t / center;
+        const double window = bessel_i0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - x * x))) / i0_beta;
+        prototype[j] = 2.0 * cutoff * sinc(2.0 * cutoff * t) * window;
+    }
+
+    // Split into phases, reverse each so taps run oldest -> newest input, and
+    // normalize every phase to unity DC gain
+    taps_.resize(total);
+    for (int p = 0; p < up_; ++p) {
+        float* dst = taps_.data() + static_cast<size_t>(p) * taps_per_phase_;
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_per_phase_; ++k) {
+            sum += prototype[p + k * up_];
+        }
+        const double norm = sum != 0.0 ? 1.0 / sum : 0.0;
+        for (size_t k = 0; k < taps_per_phase_; ++k) {
+            dst[taps_per_phase_ - 1 - k] = static_cast<float>(prototype[p + k * up_] * norm);
+        }
+    }
+
+    LOGI("Built polyphase filter bank %d -> %d Hz: L=%d, M=%d, %zu taps/phase",
+         source_rate, target_rate, up_, down_, taps_per_phase_);
+}
+
+std::shared_ptr<const PolyphaseFilterBank> get_filter_bank(int source_rate, int target_rate) {
+    if (source_rate <= 0 || target_rate <= 0) {
+        LOGE("Invalid resampler rates: %d -> %d", source_rate, target_rate);
+        return nullptr;
+    }
+
+    static std::mutex cache_mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const PolyphaseFilterBank>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto key = std::make_pair(source_rate, target_rate);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    auto bank = std::make_shared<const PolyphaseFilterBank>(source_rate, target_rate);
+    cache.emplace(key, bank);
+    return bank;
+}
+
+StreamingResampler::StreamingResampler(int source_rate, int target_rate)
+    : passthrough_(source_rate == target_rate && source_rate > 0) {
+    if (!passthrough_) {
+        bank_ = get_filter_bank(source_rate, target_rate);
+    }
+    reset();
+}
+
+void StreamingResampler::reset() {
+    input_count_ = 0;
+    output_count_ = 0;
+    if (bank_ == nullptr) {
+        return;
+    }
+
+    const int64_t taps = static_cast<int64_t>(bank_->taps_per_phase());
+    const int up = bank_->up();
+    const int down = bank_->down();
+
+    // Samples before the stream start are treated as silence
+    buffer_.assign(static_cast<size_t>(taps), 0.0f);
+    buffer_start_ = -taps;
+
+    // Delay the output by half the filter so it lines up with the input
+    const int64_t center = taps * up / 2;
+    next_base_ = center / up;
+    next_phase_ = static_cast<int>(center % up);
+    base_step_ = down / up;
+    phase_step_ = down % up;
+}
+
+size_t StreamingResampler::max_output(size_t n) const {
+    if (passthrough_) {
+        return n;
+    }
+    if (bank_ == nullptr) {
+        return 0;
+    }
+    // Covers the flush padding too, so max_output(0) bounds flush()
+    const size_t pad = bank_->taps_per_phase() / 2 + 1;
+    return ((n + pad) * bank_->up() + bank_->down() - 1) / bank_->down() + 1;
+}
+
+size_t StreamingResampler::generate(float* out, size_t limit) {
+    const AudioKernels& kernels = audio_kernels();
+    const size_t taps = bank_->taps_per_phase();
+    const int up = bank_->up();
+    const int64_t available = buffer_start_ + static_cast<int64_t>(buffer_.size());
+
+    size_t produced = 0;
+    while (produced < limit && next_base_ < available) {
+        const size_t offset = static_cast<size_t>(next_base_ - static_cast<int64_t>(taps) + 1 - buffer_start_);
+        out[produced++] = kernels.dot(buffer_.data() + offset, bank_->phase(next_phase_), taps);
+
+        next_base_ += base_step_;
+        next_phase_ += phase_step_;
+        if (next_phase_ >= up) {
+            next_phase_ -= up;
+            ++next_base_;
+        }
+    }
+    output_count_ += static_cast<int64_t>(produced);
+
+    // Drop history the next output no longer needs
+    const int64_t keep_from = next_base_ - static_cast<int64_t>(taps) + 1;
+    if (keep_from > buffer_start_) {
+        const size_t drop = std::min(buffer_.size(), static_cast<size_t>(keep_from - buffer_start_));
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(drop));
+        buffer_start_ += static_cast<int64_t>(drop);
+    }
+
+    return produced;
+}
+
+size_t StreamingResampler::process(const float* in, size_t n, float* out) {
+    if (passthrough_) {
+        std::memcpy(out, in, n * sizeof(float));
+        input_count_ += static_cast<int64_t>(n);
+        output_count_ += static_cast<int64_t>(n);
+        return n;
+    }
+    if (bank_ == nullptr || n == 0) {
+        return 0;
+    }
+
+    buffer_.insert(buffer_.end(), in, in + n);
+    input_count_ += static_cast<int64_t>(n);
+    return generate(out, SIZE_MAX);
+}
+
+size_t StreamingResampler::flush(float* out) {
+    if (passthrough_ || bank_ == nullptr) {
+        return 0;
+    }
+
+    const int64_t expected = input_count_ * bank_->up() / bank_->down();
+    if (output_count_ >= expected) {
+        return 0;
+    }
+
+    const size_t pad = bank_->taps_per_phase() / 2 + 1;
+    buffer_.insert(buffer_.end(), pad, 0.0f);
+    return generate(out, static_cast<size_t>(expected - output_count_));
+}
+
+size_t resampled_length(size_t n, int source_rate, int target_rate) {
+    if (source_rate <= 0 || target_rate <= 0) {
+        return 0;
+    }
+    if (source_rate == target_rate) {
+        return n;
+    }
+    return static_cast<size_t>(static_cast<uint64_t>(n) * target_rate / source_rate);
+}
+
+size_t resample_buffer(const float* in, size_t n, int source_rate, int target_rate, float* out) {
+    StreamingResampler resampler(source_rate, target_rate);
+    return resample_buffer(resampler, in, n, out);
+}
+
+size_t resample_buffer(StreamingResampler& resampler, const float* in, size_t n, float* out) {
+    if (!resampler.is_valid()) {
+        return 0;
+    }
+
+    resampler.reset();
+    size_t written = 0;
+    for (size_t pos = 0; pos < n; pos += kBlockSize) {
+        const size_t count = std::min(kBlockSize, n - pos);
+        written += resampler.process(in + pos, count, out + written);
+    }
+    written += resampler.flush(out + written);
+    return written;
+}
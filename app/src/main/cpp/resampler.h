@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Polyphase windowed-sinc resampler.
+ *
+ * A rational rate change source_rate -> target_rate is reduced to
+ * up/down factors L/M. The Kaiser-windowed sinc prototype is split into L
+ * phases of taps_per_phase coefficients each, stored reversed so every
+ * output sample is one contiguous dot product over the input history.
+ * Filter banks are immutable and shared through a process-wide cache keyed
+ * by (source_rate, target_rate).
+ */
+class PolyphaseFilterBank {
+public:
+    PolyphaseFilterBank(int source_rate, int target_rate);
+
+    int source_rate() const { return source_rate_; }
+    int target_rate() const { return target_rate_; }
+    int up() const { return up_; }
+    int down() const { return down_; }
+    size_t taps_per_phase() const { return taps_per_phase_; }
+
+    /** Coefficients for one phase, ordered oldest -> newest input sample. */
+    const float* phase(int p) const { return taps_.data() + static_cast<size_t>(p) * taps_per_phase_; }
+
+private:
+    int source_rate_;
+    int target_rate_;
+    int up_;
+    int down_;
+    size_t taps_per_phase_;
+    std::vector<float> taps_;
+};
+
+/**
+ * Get (or build and cache) the filter bank for a rate pair.
+ * Thread-safe; returns nullptr for invalid rates.
+ */
+std::shared_ptr<const PolyphaseFilterBank> get_filter_bank(int source_rate, int target_rate);
+
+/**
+ * Chunked resampler that carries filter history and phase across calls, so
+ * audio can be converted as it arrives with output identical to resampling
+ * the concatenated input in one go.
+ */
+class StreamingResampler {
+public:
+    StreamingResampler(int source_rate, int target_rate);
+
+    bool is_valid() const { return passthrough_ || bank_ != nullptr; }
+
+    /** Upper bound on samples produced by process() for n input samples. */
+    size_t max_output(size_t n) const;
+
+    /**
+     * Push n input samples and write the available output samples.
+     * @return Number of samples written to out (at most max_output(n))
+     */
+    size_t process(const float* in, size_t n, float* out);
+
+    /**
+     * Drain the filter tail, padding with silence, so the total output
+     * length is floor(total_input * target_rate / source_rate).
+     * @return Number of samples written to out (at most max_output(0))
+     */
+    size_t flush(float* out);
+
+    /** Forget all history; the next process() starts a new stream. */
+    void reset();
+
+private:
+    size_t generate(float* out, size_t limit);
+
+    std::shared_ptr<const PolyphaseFilterBank> bank_;
+    bool passthrough_;
+
+    // Input history; buffer_[0] holds stream sample buffer_start_.
+    std::vector<float> buffer_;
+    int64_t buffer_start_;
+    int64_t input_count_;
+
+    // Next output sample: newest input index it needs and its filter phase,
+    // advanced by fixed integer steps instead of per-sample division
+    int64_t output_count_;
+    int64_t next_base_;
+    int next_phase_;
+    int base_step_;
+    int phase_step_;
+};
+
+/**
+ * One-shot resample of a complete buffer. out must hold
+ * resampled_length(n, source_rate, target_rate) samples.
+ * @return Number of samples written
+ */
+size_t resample_buffer(const float* in, size_t n, int source_rate, int target_rate, float* out);
+
+/**
+ * resample_buffer() on an existing resampler, which is reset first. Reusing
+ * one resampler across buffers reuses its history allocation.
+ */
+size_t resample_buffer(StreamingResampler& resampler, const float* in, size_t n, float* out);
+
+/** Output length for n input samples: floor(n * target_rate / source_rate). */
+size_t resampled_length(size_t n, int source_rate, int target_rate);
@@ -0,0 +1,83 @@
+#include "scratch_arena.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#define LOG_TAG "ScratchArena"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr size_t kMinBlockSize = 256u << 10;
+
+size_t align_up(size_t value) {
+    return (value + ScratchArena::kAlignment - 1) & ~(ScratchArena::kAlignment - 1);
+}
+
+} // namespace
+
+ScratchArena::ScratchArena(size_t max_retained) : max_retained_(max_retained) {}
+
+ScratchArena::~ScratchArena() {
+    release();
+}
+
+void* ScratchArena::allocate_bytes(size_t bytes) {
+    const size_t size = align_up(std::max<size_t>(bytes, 1));
+    if (blocks_.empty() || offset_ + size > blocks_.back().size) {
+        if (!add_block(size)) {
+            return nullptr;
+        }
+    }
+
+    void* result = blocks_.back().data + offset_;
+    offset_ += size;
+    used_ += size;
+    return result;
+}
+
+bool ScratchArena::add_block(size_t min_bytes) {
+    // Geometric growth keeps the number of spills per job logarithmic
+    const size_t previous = blocks_.empty() ? 0 : blocks_.back().size;
+    const size_t size = align_up(std::max({min_bytes, previous * 2, kMinBlockSize}));
+
+    void* data = nullptr;
+    if (posix_memalign(&data, kAlignment, size) != 0) {
+        LOGE("Failed to allocate %zu byte scratch block", size);
+        return false;
+    }
+    blocks_.push_back({static_cast<uint8_t*>(data), size});
+    offset_ = 0;
+    capacity_ += size;
+    return true;
+}
+
+void ScratchArena::reset() {
+    const size_t peak = used_;
+    used_ = 0;
+    offset_ = 0;
+
+    if (peak > max_retained_) {
+        LOGD("Releasing %zu bytes after a %zu byte job", capacity_, peak);
+        release();
+        return;
+    }
+    if (blocks_.size() > 1) {
+        // Coalesce so a job of the same size fits without spilling
+        release();
+        add_block(peak);
+    }
+}
+
+void ScratchArena::release() {
+    for (const Block& block : blocks_) {
+        std::free(block.data);
+    }
+    blocks_.clear();
+    offset_ = 0;
+    used_ = 0;
+    capacity_ = 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Bump allocator for the scratch buffers of one job.
+ *
+ * allocate() hands out aligned, uninitialised memory from the current
+ * block and never frees individually; reset() rewinds everything at once.
+ * When a job spilled into extra blocks, reset() replaces them with a single
+ * block big enough for that job, so a run of similar jobs settles at one
+ * block and no heap traffic. A job whose peak exceeded max_retained has its
+ * memory returned instead of kept, so one long recording doesn't pin RSS.
+ *
+ * Not thread-safe; pointers are invalidated by reset() and release().
+ */
+class ScratchArena {
+public:
+    static constexpr size_t kAlignment = 64;  // cache line, NEON friendly
+
+    explicit ScratchArena(size_t max_retained = 32u << 20);
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /** Room for count Ts, or nullptr if the system is out of memory. */
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+    }
+
+    /** Rewind for the next job, keeping (and coalescing) the memory. */
+    void reset();
+
+    /** Free every block. */
+    void release();
+
+    size_t capacity() const { return capacity_; }
+
+    /** Bytes handed out since the last reset, including alignment padding. */
+    size_t used() const { return used_; }
+
+private:
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+
+    void* allocate_bytes(size_t bytes);
+    bool add_block(size_t min_bytes);
+
+    size_t max_retained_;
+    std::vector<Block> blocks_;
+    size_t offset_ = 0;  // into blocks_.back()
+    size_t used_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,121 @@
+#include "spectral_denoiser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Frames averaged into the first noise estimate (~125 ms)
+constexpr size_t kInitialNoiseFrames = 10;
+// Per-frame rise of the noise floor while the signal stays above it (~1.7 dB/s)
+constexpr float kNoiseRise = 1.005f;
+// Weight of the newest frame in the smoothed power
+constexpr float kPowerSmoothing = 0.3f;
+constexpr float kMinPower = 1e-12f;
+
+} // namespace
+
+SpectralDenoiser::SpectralDenoiser(float strength)
+    : plan_(get_fft_plan(kFrameSize)),
+      window_(hann_window(kFrameSize)),
+      input_(kFrameSize),
+      overlap_(kHop),
+      output_(kHop),
+      frame_(kFrameSize),
+      tail_(latency()) {
+    strength = std::min(std::max(strength, 0.0f), 1.0f);
+    over_subtraction_ = 1.0f + 3.0f * strength;
+    gain_floor_ = 1.0f - 0.9f * strength;
+
+    for (float& w : window_) {
+        w = std::sqrt(w);
+    }
+    if (plan_ != nullptr) {
+        spectrum_.resize(plan_->bins());
+        work_.resize(kFrameSize / 2);
+        smoothed_power_.resize(plan_->bins());
+        noise_.resize(plan_->bins());
+    }
+}
+
+void SpectralDenoiser::reset() {
+    std::fill(input_.begin(), input_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    std::fill(output_.begin(), output_.end(), 0.0f);
+    std::fill(smoothed_power_.begin(), smoothed_power_.end(), 0.0f);
+    std::fill(noise_.begin(), noise_.end(), 0.0f);
+    fill_ = 0;
+    frames_ = 0;
+}
+
+void SpectralDenoiser::process(float* data, size_t n) {
+    if (!is_valid()) {
+        return;
+    }
+    // A sample leaves one frame after it arrives: the hop it completes is
+    // emitted while the next hop is read
+    for (size_t i = 0; i < n; ++i) {
+        const float x = data[i];
+        data[i] = output_[fill_];
+        input_[kHop + fill_] = x;
+        if (++fill_ == kHop) {
+            process_frame();
+            fill_ = 0;
+        }
+    }
+}
+
+void SpectralDenoiser::flush(float* out) {
+    std::fill(out, out + latency(), 0.0f);
+    process(out, latency());
+}
+
+void SpectralDenoiser::process_buffer(float* data, size_t n) {
+    if (!is_valid()) {
+        return;
+    }
+    reset();
+    process(data, n);
+    flush(tail_.data());
+
+    // The stream out is latency() samples of silence, then the clean audio
+    const size_t delay = latency();
+    for (size_t i = 0; i < n; ++i) {
+        const size_t src = i + delay;
+        data[i] = src < n ? data[src] : tail_[src - n];
+    }
+}
+
+void SpectralDenoiser::process_frame() {
+    for (size_t i = 0; i < kFrameSize; ++i) {
+        frame_[i] = input_[i] * window_[i];
+    }
+    plan_->forward(frame_.data(), spectrum_.data());
+
+    const size_t bins = spectrum_.size();
+    ++frames_;
+    for (size_t k = 0; k < bins; ++k) {
+        const float power = std::norm(spectrum_[k]);
+        float& smoothed = smoothed_power_[k];
+        smoothed = frames_ == 1 ? power : smoothed + kPowerSmoothing * (power - smoothed);
+
+        float& noise = noise_[k];
+        if (frames_ <= kInitialNoiseFrames) {
+            noise += (smoothed - noise) / static_cast<float>(frames_);
+        } else {
+            noise = std::min(noise * kNoiseRise, smoothed);
+        }
+
+        const float ratio = 1.0f - over_subtraction_ * noise / std::max(smoothed, kMinPower);
+        spectrum_[k] *= std::sqrt(std::max(ratio, gain_floor_ * gain_floor_));
+    }
+
+    plan_->inverse(spectrum_.data(), work_.data(), frame_.data());
+
+    for (size_t i = 0; i < kHop; ++i) {
+        output_[i] = overlap_[i] + frame_[i] * window_[i];
+        overlap_[i] = frame_[kHop + i] * window_[kHop + i];
+    }
+    std::memcpy(input_.data(), input_.data() + kHop, kHop * sizeof(float));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "fft.h"
+
+/**
+ * Frame-based spectral subtraction noise suppressor.
+ *
+ * Audio is analysed in kFrameSize frames every kHop samples (25 ms / 12.5 ms
+ * at 16 kHz) with a square-root Hann window and the FFT plan the mel
+ * frontend already caches. Each bin's noise power is tracked as a slowly
+ * rising floor under the smoothed signal power, so it follows stationary
+ * noise (fans, traffic, hum) but not speech. Each bin is scaled by
+ *   sqrt(max(1 - over_subtraction * noise / power, floor^2)),
+ * where power is the smoothed power, not the frame's own, which keeps
+ * musical noise down; the gain itself is not smoothed further. Frames are
+ * resynthesised by weighted overlap-add.
+ *
+ * process() works in place and delays its output by latency() samples; the
+ * first latency() samples out of a fresh stream are silence and flush()
+ * returns the final latency() samples. process_buffer() hides the delay
+ * for a whole buffer. Nothing allocates after construction.
+ *
+ * Not thread-safe; one instance per stream.
+ */
+class SpectralDenoiser {
+public:
+    static constexpr size_t kFrameSize = 400;
+    static constexpr size_t kHop = kFrameSize / 2;
+
+    /** @param strength 0 (pass through) to 1 (strongest suppression) */
+    explicit SpectralDenoiser(float strength);
+
+    bool is_valid() const { return plan_ != nullptr; }
+
+    static constexpr size_t latency() { return kFrameSize; }
+
+    void process(float* data, size_t n);
+
+    /** Emit the last latency() samples of the stream into out. */
+    void flush(float* out);
+
+    /** Reset, then denoise all of data in place with no delay. */
+    void process_buffer(float* data, size_t n);
+
+    /** Forget the stream and the noise estimate. */
+    void reset();
+
+private:
+    void process_frame();
+
+    std::shared_ptr<const FftPlan> plan_;
+    std::vector<float> window_;           // sqrt-Hann; squared it sums to 1 at 50% overlap
+    float over_subtraction_;
+    float gain_floor_;
+
+    std::vector<float> input_;            // last kFrameSize input samples
+    std::vector<float> overlap_;          // second half of the previous synthesis frame
+    std::vector<float> output_;           // kHop samples ready to leave, oldest first
+    size_t fill_ = 0;                     // new input samples since the last frame
+
+    std::vector<float> frame_;
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<std::complex<float>> work_;
+    std::vector<float> smoothed_power_;
+    std::vector<float> noise_;
+    std::vector<float> tail_;             // flush() output for process_buffer()
+    size_t frames_ = 0;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Wait-free single-producer/single-consumer ring buffer for trivially
+ * copyable samples.
+ *
+ * head_ is only written by the producer and tail_ only by the consumer; each
+ * side keeps a private cached copy of the other index and only reloads it
+ * when the cache says the buffer looks full (or empty). The indices and
+ * caches sit on separate cache lines so the two threads never false-share.
+ * Indices grow monotonically and are masked on access, which lets the full
+ * capacity (a power of two) be used.
+ *
+ * write() and read() never block, lock or allocate, so they are safe to call
+ * from a real-time capture thread.
+ */
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "samples must be trivially copyable");
+
+public:
+    static constexpr size_t kCacheLine = 64;
+
+    /** Capacity is rounded up to the next power of two. */
+    explicit SpscRingBuffer(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) {
+            capacity <<= 1;
+        }
+        buffer_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * Producer: copy up to n samples in. Returns the count written, which is
+     * less than n when the consumer has fallen behind.
+     */
+    size_t write(const T* data, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        size_t free_space = capacity() - (head - producer_tail_cache_);
+        if (free_space < n) {
+            producer_tail_cache_ = tail_.load(std::memory_order_acquire);
+            free_space = capacity() - (head - producer_tail_cache_);
+        }
+
+        const size_t count = std::min(n, free_space);
+        copy_in(head, data, count);
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /** Consumer: copy up to n samples out. Returns the count read. */
+    size_t read(T* data, size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t available = consumer_head_cache_ - tail;
+        if (available < n) {
+            consumer_head_cache_ = head_.load(std::memory_order_acquire);
+            available = consumer_head_cache_ - tail;
+        }
+
+        const size_t count = std::min(n, available);
+        copy_out(tail, data, count);
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /** Samples currently readable. Exact on the consumer side, approximate elsewhere. */
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    /** Consumer: discard everything currently readable. */
+    void clear() {
+        consumer_head_cache_ = head_.load(std::memory_order_acquire);
+        tail_.store(consumer_head_cache_, std::memory_order_release);
+    }
+
+private:
+    void copy_in(size_t index, const T* data, size_t count) {
+        const size_t offset = index & mask_;
+        const size_t first = std::min(count, capacity() - offset);
+        std::memcpy(buffer_.data() + offset, data, first * sizeof(T));
+        std::memcpy(buffer_.data(), data + first, (count - first) * sizeof(T));
+    }
+
+    void copy_out(size_t index, T* data, size_t count) const {
+        const size_t offset = index & mask_;
+        const size_t first = std::min(count, capacity() - offset);
+        std::memcpy(data, buffer_.data() + offset, first * sizeof(T));
+        std::memcpy(data + first, buffer_.data(), (count - first) * sizeof(T));
+    }
+
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    alignas(kCacheLine) size_t producer_tail_cache_ = 0;
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    alignas(kCacheLine) size_t consumer_head_cache_ = 0;
+};
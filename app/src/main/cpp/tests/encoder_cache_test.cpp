@@ -0,0 +1,165 @@
+#include "encoder_cache.h"
+#include "perf_stats.h"
+#include "wav_reader.h"
+
+#include <gtest/gtest.h>
+#include <whisper.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxSamples = WHISPER_SAMPLE_RATE * 30;
+
+struct DecodeOptions {
+    const char* language;
+    bool translate;
+    const char* prompt;
+};
+
+std::vector<float> read_sample(const char* path) {
+    std::vector<float> samples;
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return samples;
+    }
+    WavInfo info;
+    if (read_wav_header(file, info) && info.sample_rate == WHISPER_SAMPLE_RATE) {
+        samples.resize(std::min(info.frames(), kMaxSamples));
+        samples.resize(read_wav_frames(file, info, samples.data(), samples.size()));
+    }
+    std::fclose(file);
+    return samples;
+}
+
+whisper_full_params decode_params(const DecodeOptions& options) {
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = 4;
+    params.print_progress = false;
+    params.print_timestamps = false;
+    params.print_realtime = false;
+    params.language = options.language;
+    params.translate = options.translate;
+    params.initial_prompt = options.prompt;
+    return params;
+}
+
+/** Segment texts joined with spaces, as transcribeAudio returns them. */
+std::string joined_text(whisper_state* state) {
+    std::string text;
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    for (int i = 0; i < n_segments; ++i) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += whisper_full_get_segment_text_from_state(state, i);
+    }
+    return text;
+}
+
+class EncoderCacheTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        const char* model = std::getenv("WHISPER_TEST_MODEL");
+        if (model == nullptr) {
+            return;
+        }
+        whisper_context_params cparams = whisper_context_default_params();
+        cparams.use_gpu = false;
+        ctx_ = whisper_init_from_file_with_params(model, cparams);
+        const char* sample = std::getenv("WHISPER_TEST_SAMPLE");
+        samples_ = new std::vector<float>(read_sample(sample != nullptr ? sample : WHISPER_TEST_SAMPLE));
+    }
+
+    static void TearDownTestSuite() {
+        if (ctx_ != nullptr) {
+            whisper_free(ctx_);
+            ctx_ = nullptr;
+        }
+        delete samples_;
+        samples_ = nullptr;
+    }
+
+    void SetUp() override {
+        if (ctx_ == nullptr) {
+            GTEST_SKIP() << "set WHISPER_TEST_MODEL to a ggml model to run";
+        }
+        ASSERT_FALSE(samples_->empty()) << "no 16 kHz sample audio";
+        cache_ = std::make_unique<EncoderCache>(ctx_);
+        cache_->set_capacity(2 * cache_->entry_bytes());
+        key_ = EncoderCache::hash_audio(samples_->data(), samples_->size());
+    }
+
+    /** Transcribe on a fresh state, as a cache miss does. */
+    std::string miss(const DecodeOptions& options, bool keep) {
+        std::shared_ptr<CachedEncoding> entry = cache_->create();
+        EXPECT_NE(entry, nullptr);
+        if (entry == nullptr) {
+            return {};
+        }
+        const int result = timed_whisper_full(ctx_, entry->state, decode_params(options), samples_->data(),
+                                              static_cast<int>(samples_->size()));
+        EXPECT_EQ(result, 0);
+        std::string text = joined_text(entry->state);
+        if (keep) {
+            const int lang_id = whisper_full_lang_id_from_state(entry->state);
+            cache_->insert(std::move(entry), key_, lang_id);
+        }
+        return text;
+    }
+
+    /** Transcribe from the cached encoding of the sample. */
+    std::string hit(const DecodeOptions& options) {
+        std::shared_ptr<CachedEncoding> entry = cache_->find(key_);
+        EXPECT_NE(entry, nullptr);
+        if (entry == nullptr) {
+            return {};
+        }
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        EXPECT_EQ(decode_cached(ctx_, *entry, key_, decode_params(options)), 0);
+        return joined_text(entry->state);
+    }
+
+    static whisper_context* ctx_;
+    static std::vector<float>* samples_;
+    std::unique_ptr<EncoderCache> cache_;
+    uint64_t key_ = 0;
+};
+
+whisper_context* EncoderCacheTest::ctx_ = nullptr;
+std::vector<float>* EncoderCacheTest::samples_ = nullptr;
+
+TEST_F(EncoderCacheTest, HitMatchesMissWithSameOptions) {
+    const DecodeOptions options{"auto", false, nullptr};
+    const std::string expected = miss(options, true);
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(hit(options), expected);
+}
+
+TEST_F(EncoderCacheTest, HitMatchesMissWithOtherOptions) {
+    miss({"auto", false, nullptr}, true);
+
+    const DecodeOptions reruns[] = {
+        {"en", false, nullptr},
+        {"en", false, "President Kennedy's inaugural address."},
+        {"de", true, nullptr},
+    };
+    for (const DecodeOptions& options : reruns) {
+        const std::string expected = miss(options, false);
+        EXPECT_EQ(hit(options), expected) << "language " << options.language;
+    }
+}
+
+TEST_F(EncoderCacheTest, RepeatedHitsAgree) {
+    const DecodeOptions options{"en", false, nullptr};
+    miss(options, true);
+    const std::string first = hit(options);
+    EXPECT_EQ(hit(options), first);
+}
+
+} // namespace
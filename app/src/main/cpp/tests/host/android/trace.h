@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for the NDK's <android/trace.h>: tracing is never enabled.
+
+inline bool ATrace_isEnabled() { return false; }
+inline void ATrace_beginSection(const char* /* section_name */) {}
+inline void ATrace_endSection() {}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Host stand-in for the NDK's <media/NdkMediaCodec.h>. No codec can be
+// created on the host, so callers take their fallback path, e.g. recordings
+// are stored as PCM16 instead of Opus.
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+#include <media/NdkMediaFormat.h>
+
+struct AMediaCodec;
+struct AMediaCrypto;
+struct ANativeWindow;
+
+struct AMediaCodecBufferInfo {
+    int32_t offset;
+    int32_t size;
+    int64_t presentationTimeUs;
+    uint32_t flags;
+};
+
+enum {
+    AMEDIACODEC_BUFFER_FLAG_CODEC_CONFIG = 2,
+    AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM = 4,
+    AMEDIACODEC_CONFIGURE_FLAG_ENCODE = 1,
+    AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED = -3,
+    AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED = -2,
+    AMEDIACODEC_INFO_TRY_AGAIN_LATER = -1,
+};
+
+inline AMediaCodec* AMediaCodec_createDecoderByType(const char*) { return nullptr; }
+inline AMediaCodec* AMediaCodec_createEncoderByType(const char*) { return nullptr; }
+
+inline media_status_t AMediaCodec_configure(AMediaCodec*, const AMediaFormat*, ANativeWindow*, AMediaCrypto*,
+                                            uint32_t) {
+    return AMEDIA_ERROR_UNSUPPORTED;
+}
+inline media_status_t AMediaCodec_start(AMediaCodec*) { return AMEDIA_ERROR_UNSUPPORTED; }
+inline media_status_t AMediaCodec_stop(AMediaCodec*) { return AMEDIA_ERROR_UNSUPPORTED; }
+inline media_status_t AMediaCodec_delete(AMediaCodec*) { return AMEDIA_ERROR_UNSUPPORTED; }
+
+inline ssize_t AMediaCodec_dequeueInputBuffer(AMediaCodec*, int64_t) { return AMEDIACODEC_INFO_TRY_AGAIN_LATER; }
+inline uint8_t* AMediaCodec_getInputBuffer(AMediaCodec*, size_t, size_t*) { return nullptr; }
+inline media_status_t AMediaCodec_queueInputBuffer(AMediaCodec*, size_t, off_t, size_t, uint64_t, uint32_t) {
+    return AMEDIA_ERROR_UNSUPPORTED;
+}
+inline ssize_t AMediaCodec_dequeueOutputBuffer(AMediaCodec*, AMediaCodecBufferInfo*, int64_t) {
+    return AMEDIACODEC_INFO_TRY_AGAIN_LATER;
+}
+inline uint8_t* AMediaCodec_getOutputBuffer(AMediaCodec*, size_t, size_t*) { return nullptr; }
+inline AMediaFormat* AMediaCodec_getOutputFormat(AMediaCodec*) { return nullptr; }
+inline media_status_t AMediaCodec_releaseOutputBuffer(AMediaCodec*, size_t, bool) {
+    return AMEDIA_ERROR_UNSUPPORTED;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-in for the NDK's <media/NdkMediaError.h>.
+
+typedef enum {
+    AMEDIA_OK = 0,
+    AMEDIA_ERROR_UNKNOWN = -10000,
+    AMEDIA_ERROR_UNSUPPORTED = AMEDIA_ERROR_UNKNOWN - 3,
+} media_status_t;
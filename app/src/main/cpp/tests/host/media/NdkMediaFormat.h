@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for the NDK's <media/NdkMediaFormat.h>. There are no
+// platform codecs on the host, so formats hold nothing and every lookup
+// misses; only what the native modules call is declared.
+
+#include <cstddef>
+#include <cstdint>
+
+#include <media/NdkMediaError.h>
+
+struct AMediaFormat {};
+
+inline const char* AMEDIAFORMAT_KEY_BIT_RATE = "bitrate";
+inline const char* AMEDIAFORMAT_KEY_CHANNEL_COUNT = "channel-count";
+inline const char* AMEDIAFORMAT_KEY_DURATION = "durationUs";
+inline const char* AMEDIAFORMAT_KEY_MIME = "mime";
+inline const char* AMEDIAFORMAT_KEY_SAMPLE_RATE = "sample-rate";
+
+inline AMediaFormat* AMediaFormat_new() { return new AMediaFormat(); }
+inline media_status_t AMediaFormat_delete(AMediaFormat* format) {
+    delete format;
+    return AMEDIA_OK;
+}
+
+inline bool AMediaFormat_getInt32(AMediaFormat*, const char*, int32_t*) { return false; }
+inline bool AMediaFormat_getInt64(AMediaFormat*, const char*, int64_t*) { return false; }
+inline bool AMediaFormat_getString(AMediaFormat*, const char*, const char**) { return false; }
+inline void AMediaFormat_setInt32(AMediaFormat*, const char*, int32_t) {}
+inline void AMediaFormat_setString(AMediaFormat*, const char*, const char*) {}
+inline void AMediaFormat_setBuffer(AMediaFormat*, const char*, const void*, size_t) {}
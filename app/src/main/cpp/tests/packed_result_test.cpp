@@ -0,0 +1,250 @@
+#include "packed_result.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// pack_result only reads decode results, so this binary doesn't link
+// whisper.cpp: the accessors it calls are defined below over a FakeResult
+// that stands in for whisper_state.
+
+namespace {
+
+constexpr whisper_token kEot = 50257;
+constexpr whisper_token kTimestamp = 50364;  // any id >= eot is special
+
+struct FakeToken {
+    whisper_token id;
+    int64_t t0;
+    int64_t t1;
+    float p;
+    const char* text;
+};
+
+struct FakeSegment {
+    int64_t t0;
+    int64_t t1;
+    const char* text;
+    std::vector<FakeToken> tokens;
+};
+
+struct FakeResult {
+    std::vector<FakeSegment> segments;
+};
+
+const FakeResult& result(whisper_state* state) {
+    return *reinterpret_cast<const FakeResult*>(state);
+}
+
+whisper_state* as_state(FakeResult& fake) {
+    return reinterpret_cast<whisper_state*>(&fake);
+}
+
+} // namespace
+
+whisper_token whisper_token_eot(struct whisper_context* /* ctx */) {
+    return kEot;
+}
+
+int whisper_full_n_segments_from_state(struct whisper_state* state) {
+    return static_cast<int>(result(state).segments.size());
+}
+
+const char* whisper_full_get_segment_text_from_state(struct whisper_state* state, int i_segment) {
+    return result(state).segments[static_cast<size_t>(i_segment)].text;
+}
+
+int64_t whisper_full_get_segment_t0_from_state(struct whisper_state* state, int i_segment) {
+    return result(state).segments[static_cast<size_t>(i_segment)].t0;
+}
+
+int64_t whisper_full_get_segment_t1_from_state(struct whisper_state* state, int i_segment) {
+    return result(state).segments[static_cast<size_t>(i_segment)].t1;
+}
+
+int whisper_full_n_tokens_from_state(struct whisper_state* state, int i_segment) {
+    return static_cast<int>(result(state).segments[static_cast<size_t>(i_segment)].tokens.size());
+}
+
+whisper_token whisper_full_get_token_id_from_state(struct whisper_state* state, int i_segment, int i_token) {
+    return result(state).segments[static_cast<size_t>(i_segment)].tokens[static_cast<size_t>(i_token)].id;
+}
+
+const char* whisper_full_get_token_text_from_state(struct whisper_context* /* ctx */, struct whisper_state* state,
+                                                   int i_segment, int i_token) {
+    return result(state).segments[static_cast<size_t>(i_segment)].tokens[static_cast<size_t>(i_token)].text;
+}
+
+whisper_token_data whisper_full_get_token_data_from_state(struct whisper_state* state, int i_segment, int i_token) {
+    const FakeToken& token =
+        result(state).segments[static_cast<size_t>(i_segment)].tokens[static_cast<size_t>(i_token)];
+    whisper_token_data data{};
+    data.id = token.id;
+    data.p = token.p;
+    data.t0 = token.t0;
+    data.t1 = token.t1;
+    return data;
+}
+
+namespace {
+
+// Field offsets PackedTranscription.kt reads the records at
+constexpr size_t kHeaderBytes = 16;
+constexpr size_t kSegmentBytes = 24;
+constexpr size_t kTokenBytes = 24;
+
+int32_t read_i32(const std::vector<uint8_t>& data, size_t offset) {
+    int32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+float read_f32(const std::vector<uint8_t>& data, size_t offset) {
+    float value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+/** Reads a packed result the way PackedTranscription does. */
+class PackedView {
+public:
+    explicit PackedView(const std::vector<uint8_t>& data) : data_(data) {}
+
+    int32_t version() const { return read_i32(data_, 0); }
+    int32_t segment_count() const { return read_i32(data_, 4); }
+    int32_t token_count() const { return read_i32(data_, 8); }
+    int32_t text_bytes() const { return read_i32(data_, 12); }
+
+    int32_t segment_field(int segment, size_t field) const {
+        return read_i32(data_, kHeaderBytes + static_cast<size_t>(segment) * kSegmentBytes + field);
+    }
+    std::string segment_text(int segment) const { return text(segment_field(segment, 16), segment_field(segment, 20)); }
+
+    size_t token_record(int token) const { return tokens_offset() + static_cast<size_t>(token) * kTokenBytes; }
+    int32_t token_field(int token, size_t field) const { return read_i32(data_, token_record(token) + field); }
+    float token_probability(int token) const { return read_f32(data_, token_record(token) + 12); }
+    std::string token_text(int token) const { return text(token_field(token, 16), token_field(token, 20)); }
+
+    size_t tokens_offset() const { return kHeaderBytes + static_cast<size_t>(segment_count()) * kSegmentBytes; }
+    size_t text_offset() const { return tokens_offset() + static_cast<size_t>(token_count()) * kTokenBytes; }
+
+private:
+    std::string text(int32_t offset, int32_t length) const {
+        return std::string(reinterpret_cast<const char*>(data_.data() + text_offset() + static_cast<size_t>(offset)),
+                           static_cast<size_t>(length));
+    }
+
+    const std::vector<uint8_t>& data_;
+};
+
+FakeResult two_segments() {
+    FakeResult fake;
+    fake.segments.push_back({0, 150, " Hello world.", {
+        {kTimestamp, 0, 0, 1.0f, "[_TT_0]"},
+        {100, 0, 80, 0.9f, " Hello"},
+        {200, 80, 140, 0.8f, " world"},
+        {13, 140, 150, 0.7f, "."},
+        {kTimestamp + 7, 150, 150, 1.0f, "[_TT_150]"},
+    }});
+    fake.segments.push_back({150, 300, " Caf\xc3\xa9", {
+        {300, 150, 220, 0.6f, " Caf"},
+        {301, 220, 300, 0.5f, "\xc3\xa9"},
+        {kEot, 300, 300, 1.0f, "[_EOT_]"},
+    }});
+    return fake;
+}
+
+TEST(PackedResultTest, LayoutMatchesPackedTranscription) {
+    EXPECT_EQ(sizeof(PackedHeader), kHeaderBytes);
+    EXPECT_EQ(offsetof(PackedHeader, version), 0u);
+    EXPECT_EQ(offsetof(PackedHeader, n_segments), 4u);
+    EXPECT_EQ(offsetof(PackedHeader, n_tokens), 8u);
+    EXPECT_EQ(offsetof(PackedHeader, text_bytes), 12u);
+
+    EXPECT_EQ(sizeof(PackedSegment), kSegmentBytes);
+    EXPECT_EQ(offsetof(PackedSegment, start_ms), 0u);
+    EXPECT_EQ(offsetof(PackedSegment, end_ms), 4u);
+    EXPECT_EQ(offsetof(PackedSegment, first_token), 8u);
+    EXPECT_EQ(offsetof(PackedSegment, n_tokens), 12u);
+    EXPECT_EQ(offsetof(PackedSegment, text_offset), 16u);
+    EXPECT_EQ(offsetof(PackedSegment, text_length), 20u);
+
+    EXPECT_EQ(sizeof(PackedToken), kTokenBytes);
+    EXPECT_EQ(offsetof(PackedToken, id), 0u);
+    EXPECT_EQ(offsetof(PackedToken, start_ms), 4u);
+    EXPECT_EQ(offsetof(PackedToken, end_ms), 8u);
+    EXPECT_EQ(offsetof(PackedToken, probability), 12u);
+    EXPECT_EQ(offsetof(PackedToken, text_offset), 16u);
+    EXPECT_EQ(offsetof(PackedToken, text_length), 20u);
+
+    EXPECT_EQ(kPackedResultVersion, 1);  // PackedTranscription.VERSION
+}
+
+TEST(PackedResultTest, PacksSegmentsAndTextTokens) {
+    FakeResult fake = two_segments();
+    std::vector<uint8_t> out;
+    const size_t size = pack_result(nullptr, as_state(fake), nullptr, out);
+    ASSERT_EQ(size, out.size());
+
+    const PackedView view(out);
+    EXPECT_EQ(view.version(), kPackedResultVersion);
+    ASSERT_EQ(view.segment_count(), 2);
+    ASSERT_EQ(view.token_count(), 5);  // special tokens are left out
+    EXPECT_EQ(size, view.text_offset() + static_cast<size_t>(view.text_bytes()));
+
+    EXPECT_EQ(view.segment_field(0, 0), 0);
+    EXPECT_EQ(view.segment_field(0, 4), 1500);
+    EXPECT_EQ(view.segment_field(0, 8), 0);
+    EXPECT_EQ(view.segment_field(0, 12), 3);
+    EXPECT_EQ(view.segment_text(0), " Hello world.");
+    EXPECT_EQ(view.segment_field(1, 0), 1500);
+    EXPECT_EQ(view.segment_field(1, 4), 3000);
+    EXPECT_EQ(view.segment_field(1, 8), 3);
+    EXPECT_EQ(view.segment_field(1, 12), 2);
+    EXPECT_EQ(view.segment_text(1), " Caf\xc3\xa9");
+
+    const char* texts[] = {" Hello", " world", ".", " Caf", "\xc3\xa9"};
+    const int32_t ids[] = {100, 200, 13, 300, 301};
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(view.token_field(i, 0), ids[i]);
+        EXPECT_EQ(view.token_text(i), texts[i]);
+    }
+    EXPECT_EQ(view.token_field(1, 4), 800);
+    EXPECT_EQ(view.token_field(1, 8), 1400);
+    EXPECT_FLOAT_EQ(view.token_probability(1), 0.8f);
+
+    // A segment's tokens are one byte range, so a split character decodes whole
+    EXPECT_EQ(view.token_field(4, 16), view.token_field(3, 16) + view.token_field(3, 20));
+}
+
+TEST(PackedResultTest, MapsTimesBackThroughSpeechRegions) {
+    // Decoded audio was 1-2 s and 3-4 s of the original, back to back
+    const std::vector<SpeechRegion> regions = {{16000, 32000}, {48000, 64000}};
+    FakeResult fake;
+    fake.segments.push_back({50, 150, " Hi", {{100, 50, 150, 0.9f, " Hi"}}});
+
+    std::vector<uint8_t> out;
+    pack_result(nullptr, as_state(fake), &regions, out);
+    const PackedView view(out);
+    EXPECT_EQ(view.segment_field(0, 0), 1500);
+    EXPECT_EQ(view.segment_field(0, 4), 3500);
+    EXPECT_EQ(view.token_field(0, 4), 1500);
+    EXPECT_EQ(view.token_field(0, 8), 3500);
+}
+
+TEST(PackedResultTest, EmptyResultIsHeaderOnly) {
+    FakeResult fake;
+    std::vector<uint8_t> out(1000, 0xff);
+    EXPECT_EQ(pack_result(nullptr, as_state(fake), nullptr, out), kHeaderBytes);
+    const PackedView view(out);
+    EXPECT_EQ(view.version(), kPackedResultVersion);
+    EXPECT_EQ(view.segment_count(), 0);
+    EXPECT_EQ(view.token_count(), 0);
+    EXPECT_EQ(view.text_bytes(), 0);
+}
+
+} // namespace
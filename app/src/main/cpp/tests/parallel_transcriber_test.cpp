@@ -0,0 +1,99 @@
+#include "parallel_transcriber.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+// Found by ADL from gtest's assertions
+bool operator==(const ChunkSpan& a, const ChunkSpan& b) {
+    return a.start == b.start && a.end == b.end;
+}
+
+std::ostream& operator<<(std::ostream& os, const ChunkSpan& chunk) {
+    return os << '[' << chunk.start << ", " << chunk.end << ')';
+}
+
+namespace {
+
+std::vector<ChunkSpan> plan(const std::vector<SpeechRegion>& regions, size_t target, size_t max) {
+    std::vector<ChunkSpan> chunks = {{1, 2}};  // stale output must be replaced
+    plan_chunks(regions, target, max, chunks);
+    return chunks;
+}
+
+// 8 units of speech every 10 units
+const std::vector<SpeechRegion> kRegions = {{0, 8}, {10, 18}, {20, 28}, {30, 38}};
+
+TEST(PlanChunksTest, NoRegionsGiveNoChunks) {
+    EXPECT_TRUE(plan({}, 100, 200).empty());
+}
+
+TEST(PlanChunksTest, JoinsRegionsUntilTargetIsReached) {
+    // A chunk takes regions while shorter than the target, then cuts in the next pause
+    EXPECT_EQ(plan(kRegions, 15, 40), (std::vector<ChunkSpan>{{0, 18}, {20, 38}}));
+    EXPECT_EQ(plan(kRegions, 100, 100), (std::vector<ChunkSpan>{{0, 38}}));
+    EXPECT_EQ(plan(kRegions, 1, 100), (std::vector<ChunkSpan>{{0, 8}, {10, 18}, {20, 28}, {30, 38}}));
+}
+
+TEST(PlanChunksTest, DoesNotJoinPastMaximum) {
+    // The third region would still fit the target but not the maximum
+    EXPECT_EQ(plan(kRegions, 20, 25), (std::vector<ChunkSpan>{{0, 18}, {20, 38}}));
+}
+
+TEST(PlanChunksTest, SplitsLongRegionAtMaximum) {
+    EXPECT_EQ(plan({{5, 105}}, 20, 30), (std::vector<ChunkSpan>{{5, 35}, {35, 65}, {65, 95}, {95, 105}}));
+    // The remainder of a split region still takes the regions after it
+    EXPECT_EQ(plan({{5, 105}, {110, 115}}, 20, 30),
+              (std::vector<ChunkSpan>{{5, 35}, {35, 65}, {65, 95}, {95, 115}}));
+}
+
+TEST(PlanChunksTest, MaximumIsAtLeastTarget) {
+    EXPECT_EQ(plan({{0, 25}}, 10, 0), (std::vector<ChunkSpan>{{0, 10}, {10, 20}, {20, 25}}));
+    EXPECT_EQ(plan({{0, 3}}, 0, 0), (std::vector<ChunkSpan>{{0, 1}, {1, 2}, {2, 3}}));
+}
+
+TEST(PlanChunksTest, ChunksCoverSpeechInOrderWithinMaximum) {
+    std::vector<SpeechRegion> regions;
+    size_t position = 0;
+    for (size_t i = 0; i < 200; ++i) {
+        const size_t speech = 1000 + (i * 7919) % 40000;  // 1.0 to 41 thousand samples
+        regions.push_back({position, position + speech});
+        position += speech + 500 + (i * 104729) % 8000;
+    }
+
+    const size_t target = 30000;
+    const size_t max = 45000;
+    const std::vector<ChunkSpan> chunks = plan(regions, target, max);
+    ASSERT_FALSE(chunks.empty());
+    EXPECT_EQ(chunks.front().start, regions.front().start);
+    EXPECT_EQ(chunks.back().end, regions.back().end);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_LT(chunks[i].start, chunks[i].end);
+        EXPECT_LE(chunks[i].end - chunks[i].start, max);
+        if (i > 0) {
+            EXPECT_LE(chunks[i - 1].end, chunks[i].start);
+        }
+    }
+
+    // Every speech sample is in a chunk, and a chunk starts at a region
+    // unless it continues a region split at the maximum
+    for (const SpeechRegion& region : regions) {
+        size_t covered = 0;
+        for (const ChunkSpan& chunk : chunks) {
+            if (chunk.start < region.end && chunk.end > region.start) {
+                covered += std::min(chunk.end, region.end) - std::max(chunk.start, region.start);
+            }
+        }
+        EXPECT_EQ(covered, region.end - region.start);
+    }
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        const bool at_region = std::any_of(regions.begin(), regions.end(), [&](const SpeechRegion& region) {
+            return region.start == chunks[i].start;
+        });
+        EXPECT_TRUE(at_region || chunks[i].start == chunks[i - 1].end) << chunks[i];
+    }
+}
+
+} // namespace
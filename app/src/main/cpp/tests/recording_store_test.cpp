@@ -0,0 +1,182 @@
+#include "recording_store.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+class RecordingStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path_ = ::testing::TempDir() + "recording_" + info->name() + ".wrec";
+
+        samples_.resize(kSampleRate * 12);
+        for (size_t i = 0; i < samples_.size(); ++i) {
+            samples_[i] = 0.5f * std::sin(static_cast<float>(i) * 0.01f);
+        }
+        segments_ = {
+            {6000, 9000, "Second segment"},
+            {0, 2500, "first words"},
+            {3000, 5500, "Then a pause"},
+        };
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+        std::remove(corrupt_path().c_str());
+    }
+
+    std::string corrupt_path() const { return path_ + ".corrupt"; }
+
+    int write(bool compress = false) {
+        RecordingWriteParams params;
+        params.sample_rate = kSampleRate;
+        params.chunk_ms = 5000;
+        params.compress = compress;
+        return write_recording(path_.c_str(), samples_.data(), samples_.size(), segments_, params);
+    }
+
+    std::vector<uint8_t> read_file() const {
+        std::vector<uint8_t> bytes;
+        FILE* file = std::fopen(path_.c_str(), "rb");
+        if (file == nullptr) {
+            return bytes;
+        }
+        std::fseek(file, 0, SEEK_END);
+        bytes.resize(static_cast<size_t>(std::ftell(file)));
+        std::fseek(file, 0, SEEK_SET);
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+        std::fclose(file);
+        return bytes;
+    }
+
+    /** Write a copy of the recording with its header edited, then try to open it. */
+    bool open_with_header(const std::function<void(RecordingHeader&)>& edit, size_t truncate_to = 0) {
+        std::vector<uint8_t> bytes = read_file();
+        EXPECT_GE(bytes.size(), sizeof(RecordingHeader));
+        RecordingHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        edit(header);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (truncate_to > 0) {
+            bytes.resize(truncate_to);
+        }
+
+        FILE* file = std::fopen(corrupt_path().c_str(), "wb");
+        EXPECT_NE(file, nullptr);
+        if (file == nullptr) {
+            return false;
+        }
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+
+        RecordingReader reader;
+        return reader.open(corrupt_path().c_str());
+    }
+
+    std::string path_;
+    std::vector<float> samples_;
+    std::vector<StoredSegment> segments_;
+};
+
+TEST_F(RecordingStoreTest, FallsBackToPcm16WithoutOpusEncoder) {
+    // The host has no platform codecs
+    EXPECT_EQ(write(true), kRecordingPcm16);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(path_.c_str()));
+    EXPECT_EQ(reader.header().codec, kRecordingPcm16);
+}
+
+TEST_F(RecordingStoreTest, RoundTripsIndexAndAudio) {
+    ASSERT_EQ(write(), kRecordingPcm16);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(path_.c_str()));
+
+    EXPECT_EQ(reader.header().n_samples, samples_.size());
+    EXPECT_EQ(reader.header().n_chunks, 3u);
+    EXPECT_EQ(reader.duration_ms(), 12000);
+
+    // Segments come back sorted by start
+    ASSERT_EQ(reader.header().n_segments, 3u);
+    EXPECT_EQ(reader.segment(0).t0_ms, 0);
+    EXPECT_EQ(std::string(reader.segment_text(0), reader.segment(0).text_size), "first words");
+    EXPECT_EQ(std::string(reader.segment_text(2), reader.segment(2).text_size), "Second segment");
+
+    std::vector<float> audio;
+    ASSERT_TRUE(reader.read_range(4500, 5500, audio));
+    ASSERT_EQ(audio.size(), static_cast<size_t>(kSampleRate));
+    for (size_t i = 0; i < audio.size(); ++i) {
+        ASSERT_NEAR(audio[i], samples_[kSampleRate * 9 / 2 + i], 1.0f / 16384) << i;
+    }
+}
+
+TEST_F(RecordingStoreTest, FindsAndSearchesSegments) {
+    ASSERT_EQ(write(), kRecordingPcm16);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(path_.c_str()));
+
+    EXPECT_EQ(reader.find_segment(-1), -1);
+    EXPECT_EQ(reader.find_segment(1000), 0);
+    EXPECT_EQ(reader.find_segment(2800), 0);  // in the gap, the segment before it
+    EXPECT_EQ(reader.find_segment(3000), 1);
+    EXPECT_EQ(reader.find_segment(20000), 2);
+
+    std::vector<int> hits;
+    reader.search("SEGMENT", hits);
+    EXPECT_EQ(hits, std::vector<int>{2});
+    reader.search("S", hits);
+    EXPECT_EQ(hits.size(), 3u);
+    reader.search("missing", hits);
+    EXPECT_TRUE(hits.empty());
+}
+
+TEST_F(RecordingStoreTest, OpenRejectsMissingAndTruncatedFiles) {
+    RecordingReader reader;
+    EXPECT_FALSE(reader.open(path_.c_str()));
+
+    ASSERT_EQ(write(), kRecordingPcm16);
+    EXPECT_FALSE(open_with_header([](RecordingHeader&) {}, sizeof(RecordingHeader) - 1));
+}
+
+TEST_F(RecordingStoreTest, OpenRejectsCorruptHeader) {
+    ASSERT_EQ(write(), kRecordingPcm16);
+    const uint64_t size = read_file().size();
+    ASSERT_TRUE(open_with_header([](RecordingHeader&) {}));
+
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.magic = 0x46464952; }));  // "RIFF"
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.version = kRecordingVersion + 1; }));
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.sample_rate = 0; }));
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.chunk_samples = 0; }));
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.n_chunks = 1u << 30; }));
+    EXPECT_FALSE(open_with_header([size](RecordingHeader& h) { h.segments_offset = size; }));
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.segments_offset += 1; }));  // misaligned
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.text_size = ~0ull; }));
+    EXPECT_FALSE(open_with_header([size](RecordingHeader& h) { h.audio_offset = size + 1; }));
+    // Offset plus length wrapping around must not pass the bounds check
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) {
+        h.text_offset = ~0ull - 1;
+        h.text_size = 4;
+    }));
+}
+
+TEST_F(RecordingStoreTest, OpenRejectsTablesPointingOutsideTheFile) {
+    ASSERT_EQ(write(), kRecordingPcm16);
+
+    // Audio starting later makes the last chunk end beyond the file
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.audio_offset += 4; }));
+
+    // A segment whose text runs past the text blob
+    EXPECT_FALSE(open_with_header([](RecordingHeader& h) { h.text_size = 4; }));
+}
+
+} // namespace
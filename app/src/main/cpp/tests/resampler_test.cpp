@@ -0,0 +1,140 @@
+#include "resampler.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> tone(size_t n, int sample_rate, double hz, float amplitude) {
+    std::vector<float> samples(n);
+    for (size_t i = 0; i < n; ++i) {
+        samples[i] = amplitude * static_cast<float>(std::sin(2.0 * kPi * hz * static_cast<double>(i) / sample_rate));
+    }
+    return samples;
+}
+
+/** Push in in chunks of chunk samples, then flush, as a capture stream does. */
+std::vector<float> stream(StreamingResampler& resampler, const std::vector<float>& in, size_t chunk) {
+    std::vector<float> out;
+    std::vector<float> block;
+    for (size_t pos = 0; pos < in.size(); pos += chunk) {
+        const size_t count = std::min(chunk, in.size() - pos);
+        block.resize(resampler.max_output(count));
+        const size_t produced = resampler.process(in.data() + pos, count, block.data());
+        EXPECT_LE(produced, block.size());
+        out.insert(out.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(produced));
+    }
+    block.resize(resampler.max_output(0));
+    const size_t tail = resampler.flush(block.data());
+    EXPECT_LE(tail, block.size());
+    out.insert(out.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(tail));
+    return out;
+}
+
+struct RatePair {
+    int source_rate;
+    int target_rate;
+};
+
+class ResamplerRateTest : public ::testing::TestWithParam<RatePair> {};
+
+TEST_P(ResamplerRateTest, StreamedLengthMatchesResampledLength) {
+    const RatePair rates = GetParam();
+    for (size_t n : {0u, 1u, 7u, 480u, 12345u, 48000u}) {
+        StreamingResampler resampler(rates.source_rate, rates.target_rate);
+        ASSERT_TRUE(resampler.is_valid());
+        const std::vector<float> out = stream(resampler, tone(n, rates.source_rate, 440.0, 0.5f), 333);
+        EXPECT_EQ(out.size(), resampled_length(n, rates.source_rate, rates.target_rate)) << n << " samples";
+    }
+}
+
+TEST_P(ResamplerRateTest, ChunkingDoesNotChangeOutput) {
+    const RatePair rates = GetParam();
+    const std::vector<float> in = tone(static_cast<size_t>(rates.source_rate) / 2, rates.source_rate, 440.0, 0.5f);
+
+    std::vector<float> expected(resampled_length(in.size(), rates.source_rate, rates.target_rate));
+    ASSERT_EQ(resample_buffer(in.data(), in.size(), rates.source_rate, rates.target_rate, expected.data()),
+              expected.size());
+
+    for (size_t chunk : {1u, 160u, 1021u}) {
+        StreamingResampler resampler(rates.source_rate, rates.target_rate);
+        const std::vector<float> out = stream(resampler, in, chunk);
+        ASSERT_EQ(out.size(), expected.size()) << "chunk " << chunk;
+        for (size_t i = 0; i < out.size(); ++i) {
+            ASSERT_NEAR(out[i], expected[i], 1e-6f) << "chunk " << chunk << ", sample " << i;
+        }
+    }
+}
+
+TEST_P(ResamplerRateTest, KeepsInBandToneLevel) {
+    const RatePair rates = GetParam();
+    const std::vector<float> in = tone(static_cast<size_t>(rates.source_rate), rates.source_rate, 1000.0, 0.5f);
+    StreamingResampler resampler(rates.source_rate, rates.target_rate);
+    const std::vector<float> out = stream(resampler, in, 4096);
+
+    // Skip the filter's settling at either end
+    double sum = 0.0;
+    const size_t margin = out.size() / 10;
+    for (size_t i = margin; i < out.size() - margin; ++i) {
+        sum += static_cast<double>(out[i]) * out[i];
+    }
+    const double rms = std::sqrt(sum / static_cast<double>(out.size() - 2 * margin));
+    EXPECT_NEAR(rms, 0.5 / std::sqrt(2.0), 0.01);
+}
+
+INSTANTIATE_TEST_SUITE_P(Rates, ResamplerRateTest,
+                         ::testing::Values(RatePair{48000, 16000}, RatePair{44100, 16000}, RatePair{22050, 16000},
+                                           RatePair{8000, 16000}, RatePair{16000, 48000}),
+                         [](const ::testing::TestParamInfo<RatePair>& info) {
+                             return std::to_string(info.param.source_rate) + "to" +
+                                    std::to_string(info.param.target_rate);
+                         });
+
+TEST(ResamplerTest, FlushWithoutInputProducesNothing) {
+    StreamingResampler resampler(48000, 16000);
+    std::vector<float> out(resampler.max_output(0));
+    EXPECT_EQ(resampler.flush(out.data()), 0u);
+}
+
+TEST(ResamplerTest, FlushTwiceProducesTheTailOnce) {
+    StreamingResampler resampler(44100, 16000);
+    const std::vector<float> in = tone(4410, 44100, 440.0, 0.5f);
+    std::vector<float> out(resampler.max_output(in.size()));
+    size_t total = resampler.process(in.data(), in.size(), out.data());
+    out.resize(resampler.max_output(0));
+    total += resampler.flush(out.data());
+    EXPECT_EQ(total, resampled_length(in.size(), 44100, 16000));
+    EXPECT_EQ(resampler.flush(out.data()), 0u);
+}
+
+TEST(ResamplerTest, ResetStartsANewStream) {
+    const std::vector<float> in = tone(4800, 48000, 440.0, 0.5f);
+    StreamingResampler fresh(48000, 16000);
+    const std::vector<float> expected = stream(fresh, in, 480);
+
+    StreamingResampler reused(48000, 16000);
+    stream(reused, tone(1234, 48000, 3000.0, 0.9f), 100);
+    reused.reset();
+    EXPECT_EQ(stream(reused, in, 480), expected);
+}
+
+TEST(ResamplerTest, SameRatePassesThrough) {
+    const std::vector<float> in = tone(1000, 16000, 440.0, 0.5f);
+    StreamingResampler resampler(16000, 16000);
+    ASSERT_TRUE(resampler.is_valid());
+    EXPECT_EQ(stream(resampler, in, 64), in);
+}
+
+TEST(ResamplerTest, RejectsInvalidRates) {
+    EXPECT_FALSE(StreamingResampler(0, 16000).is_valid());
+    EXPECT_FALSE(StreamingResampler(16000, -1).is_valid());
+    EXPECT_EQ(get_filter_bank(0, 16000), nullptr);
+    EXPECT_EQ(resampled_length(100, 0, 16000), 0u);
+}
+
+} // namespace
@@ -0,0 +1,125 @@
+#include "spsc_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(SpscRingBufferTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(SpscRingBuffer<float>(1).capacity(), 1u);
+    EXPECT_EQ(SpscRingBuffer<float>(8).capacity(), 8u);
+    EXPECT_EQ(SpscRingBuffer<float>(9).capacity(), 16u);
+    EXPECT_EQ(SpscRingBuffer<float>(1000).capacity(), 1024u);
+}
+
+TEST(SpscRingBufferTest, WrapsAroundInOrder) {
+    SpscRingBuffer<int> ring(8);
+    int next_write = 0;
+    int next_read = 0;
+    std::vector<int> block(5);
+    // 5 does not divide 8, so writes and reads straddle the end at every offset
+    for (int round = 0; round < 40; ++round) {
+        std::iota(block.begin(), block.end(), next_write);
+        ASSERT_EQ(ring.write(block.data(), block.size()), block.size());
+        next_write += 5;
+        ASSERT_EQ(ring.size(), 5u);
+
+        std::vector<int> out(5, -1);
+        ASSERT_EQ(ring.read(out.data(), out.size()), out.size());
+        for (int value : out) {
+            ASSERT_EQ(value, next_read++);
+        }
+        ASSERT_EQ(ring.size(), 0u);
+    }
+}
+
+TEST(SpscRingBufferTest, WriteStopsWhenFull) {
+    SpscRingBuffer<int> ring(8);
+    std::vector<int> data(10);
+    std::iota(data.begin(), data.end(), 0);
+    EXPECT_EQ(ring.write(data.data(), data.size()), 8u);
+    EXPECT_EQ(ring.write(data.data(), 1), 0u);
+
+    std::vector<int> out(3);
+    ASSERT_EQ(ring.read(out.data(), out.size()), 3u);
+    EXPECT_EQ(out, (std::vector<int>{0, 1, 2}));
+
+    // Only the space the read freed is taken, across the wrap
+    EXPECT_EQ(ring.write(data.data() + 8, 2), 2u);
+    EXPECT_EQ(ring.write(data.data(), 5), 1u);
+
+    out.resize(8);
+    ASSERT_EQ(ring.read(out.data(), out.size()), 8u);
+    EXPECT_EQ(out, (std::vector<int>{3, 4, 5, 6, 7, 8, 9, 0}));
+}
+
+TEST(SpscRingBufferTest, ReadStopsWhenEmpty) {
+    SpscRingBuffer<float> ring(4);
+    std::vector<float> out(4);
+    EXPECT_EQ(ring.read(out.data(), out.size()), 0u);
+    const float sample = 0.5f;
+    ring.write(&sample, 1);
+    EXPECT_EQ(ring.read(out.data(), out.size()), 1u);
+    EXPECT_EQ(out[0], 0.5f);
+}
+
+TEST(SpscRingBufferTest, ClearDiscardsReadableSamples) {
+    SpscRingBuffer<int> ring(8);
+    const int data[6] = {1, 2, 3, 4, 5, 6};
+    ring.write(data, 6);
+    ring.clear();
+    EXPECT_EQ(ring.size(), 0u);
+    EXPECT_EQ(ring.write(data, 6), 6u);
+    int out[6] = {};
+    ASSERT_EQ(ring.read(out, 6), 6u);
+    EXPECT_EQ(out[5], 6);
+}
+
+TEST(SpscRingBufferTest, ConcurrentProducerAndConsumerKeepOrder) {
+    constexpr uint32_t kTotal = 1u << 18;
+    SpscRingBuffer<uint32_t> ring(1024);
+
+    std::thread producer([&ring] {
+        uint32_t block[97];
+        uint32_t next = 0;
+        while (next < kTotal) {
+            const uint32_t count = std::min<uint32_t>(97, kTotal - next);
+            for (uint32_t i = 0; i < count; ++i) {
+                block[i] = next + i;
+            }
+            uint32_t written = 0;
+            while (written < count) {
+                const size_t n = ring.write(block + written, count - written);
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                written += static_cast<uint32_t>(n);
+            }
+            next += count;
+        }
+    });
+
+    uint32_t expected = 0;
+    bool in_order = true;
+    uint32_t block[61];
+    while (expected < kTotal) {
+        const size_t count = ring.read(block, 61);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            in_order = in_order && block[i] == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+} // namespace
@@ -0,0 +1,187 @@
+#include "vad.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+constexpr double kPi = 3.14159265358979323846;
+
+size_t at_ms(int ms) {
+    return static_cast<size_t>(ms) * kSampleRate / 1000;
+}
+
+/** Faint white noise with voiced bursts: a 150 Hz tone and its harmonics. */
+class Signal {
+public:
+    explicit Signal(int duration_ms) : samples_(at_ms(duration_ms)) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> noise(-0.002f, 0.002f);
+        for (float& sample : samples_) {
+            sample = noise(rng);
+        }
+    }
+
+    Signal& voice(int start_ms, int end_ms, float amplitude = 0.2f) {
+        for (size_t i = at_ms(start_ms); i < at_ms(end_ms); ++i) {
+            const double t = static_cast<double>(i) / kSampleRate;
+            double value = 0.0;
+            for (int harmonic = 1; harmonic <= 4; ++harmonic) {
+                value += std::sin(2.0 * kPi * 150.0 * harmonic * t) / harmonic;
+            }
+            samples_[i] += amplitude * static_cast<float>(value);
+        }
+        return *this;
+    }
+
+    const std::vector<float>& samples() const { return samples_; }
+
+private:
+    std::vector<float> samples_;
+};
+
+std::vector<SpeechRegion> detect(const Signal& signal) {
+    VoiceActivityDetector vad;
+    EXPECT_TRUE(vad.is_valid());
+    return vad.detect(signal.samples().data(), signal.samples().size());
+}
+
+TEST(VadTest, SilenceHasNoRegions) {
+    const std::vector<float> zeros(at_ms(2000), 0.0f);
+    VoiceActivityDetector vad;
+    EXPECT_TRUE(vad.detect(zeros.data(), zeros.size()).empty());
+    EXPECT_TRUE(detect(Signal(2000)).empty());
+}
+
+TEST(VadTest, InputShorterThanAFrameHasNoRegions) {
+    VoiceActivityDetector vad;
+    const std::vector<float> samples(vad.frame_size() - 1, 0.5f);
+    EXPECT_TRUE(vad.detect(samples.data(), samples.size()).empty());
+    EXPECT_TRUE(vad.detect(nullptr, 0).empty());
+}
+
+TEST(VadTest, RegionCoversVoicedSpanWithPadding) {
+    const VadParams params;
+    const auto regions = detect(Signal(3000).voice(1000, 2000));
+    ASSERT_EQ(regions.size(), 1u);
+    // Onset is found within a frame or two, then padded
+    EXPECT_GE(regions[0].start, at_ms(1000 - params.padding_ms - 2 * params.frame_ms));
+    EXPECT_LE(regions[0].start, at_ms(1000 - params.padding_ms + 2 * params.frame_ms));
+    EXPECT_GE(regions[0].end, at_ms(2000 + params.padding_ms - 2 * params.frame_ms));
+    EXPECT_LE(regions[0].end, at_ms(2000 + params.padding_ms + 2 * params.frame_ms));
+}
+
+TEST(VadTest, PaddingIsClampedToTheInput) {
+    const Signal signal = Signal(1500).voice(0, 500).voice(1200, 1500);
+    const auto regions = detect(signal);
+    ASSERT_FALSE(regions.empty());
+    EXPECT_EQ(regions.front().start, 0u);
+    EXPECT_LE(regions.back().end, signal.samples().size());
+}
+
+TEST(VadTest, ShortPauseIsBridgedLongPauseSplits) {
+    // 200 ms is inside the 300 ms hangover, 1.5 s is well past it and the padding
+    EXPECT_EQ(detect(Signal(3000).voice(500, 1200).voice(1400, 2200)).size(), 1u);
+
+    const auto regions = detect(Signal(4000).voice(500, 1000).voice(2500, 3000));
+    ASSERT_EQ(regions.size(), 2u);
+    EXPECT_LT(regions[0].end, regions[1].start);
+    EXPECT_LT(regions[0].end, at_ms(1700));
+    EXPECT_GT(regions[1].start, at_ms(2100));
+}
+
+TEST(VadTest, ClickShorterThanOnsetIsIgnored) {
+    const VadParams params;
+    EXPECT_TRUE(detect(Signal(2000).voice(1000, 1000 + params.min_speech_ms / 2)).empty());
+}
+
+TEST(VadTest, VoiceBelowMinimumLevelIsIgnored) {
+    // About -70 dBFS: clears the noise-free floor by far but not min_energy_db
+    std::vector<float> samples(at_ms(2000), 0.0f);
+    for (size_t i = at_ms(500); i < at_ms(1500); ++i) {
+        samples[i] = 0.0004f * static_cast<float>(std::sin(2.0 * kPi * 150.0 * static_cast<double>(i) / kSampleRate));
+    }
+    VoiceActivityDetector vad;
+    EXPECT_TRUE(vad.detect(samples.data(), samples.size()).empty());
+}
+
+/** Steady low-passed noise at about -40 dBFS, with a speech-range ZCR. */
+std::vector<float> rumble(int duration_ms) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+    std::vector<float> samples(at_ms(duration_ms));
+    float state = 0.0f;
+    for (float& sample : samples) {
+        state = 0.9f * state + noise(rng);
+        sample = state;
+    }
+    return samples;
+}
+
+TEST(VadTest, LeadingDigitalSilenceDoesNotPinNoiseFloor) {
+    std::vector<float> samples(at_ms(500), 0.0f);
+    const std::vector<float> noise = rumble(4000);
+    samples.insert(samples.end(), noise.begin(), noise.end());
+
+    VoiceActivityDetector vad;
+    EXPECT_TRUE(vad.detect(samples.data(), samples.size()).empty());
+
+    const size_t frame = vad.frame_size();
+    bool any_speech = false;
+    for (size_t pos = 0; pos + frame <= samples.size(); pos += frame) {
+        any_speech |= vad.push_frame(samples.data() + pos);
+    }
+    EXPECT_FALSE(any_speech);
+}
+
+TEST(VadTest, NoiseFloorCatchesUpWithRisingNoise) {
+    // Faint noise primes a low floor, then the noise steps up by ~20 dB
+    std::vector<float> samples = Signal(1000).samples();
+    const std::vector<float> noise = rumble(6000);
+    samples.insert(samples.end(), noise.begin(), noise.end());
+
+    const VadParams params;
+    VoiceActivityDetector vad(params);
+    const auto regions = vad.detect(samples.data(), samples.size());
+    EXPECT_LE(speech_length(regions), at_ms(params.noise_window_ms + params.hangover_ms + 2 * params.padding_ms));
+    EXPECT_FALSE(vad.push_frame(samples.data() + samples.size() - vad.frame_size()));
+}
+
+TEST(VadTest, OnlineModeFollowsSpeech) {
+    const Signal signal = Signal(3000).voice(1000, 2000);
+    VoiceActivityDetector vad;
+    const size_t frame = vad.frame_size();
+    std::vector<bool> speech;
+    for (size_t pos = 0; pos + frame <= signal.samples().size(); pos += frame) {
+        speech.push_back(vad.push_frame(signal.samples().data() + pos));
+    }
+    const size_t frame_ms = frame * 1000 / kSampleRate;
+    EXPECT_FALSE(speech[900 / frame_ms]);
+    EXPECT_TRUE(speech[1500 / frame_ms]);
+    EXPECT_FALSE(speech.back());
+}
+
+TEST(VadTest, CompactSpeechRoundTripsPositions) {
+    const std::vector<SpeechRegion> regions = {{100, 200}, {500, 700}};
+    EXPECT_EQ(speech_length(regions), 300u);
+
+    std::vector<float> in(1000);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<float>(i);
+    }
+    std::vector<float> out(speech_length(regions));
+    ASSERT_EQ(compact_speech(in.data(), regions, out.data()), out.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        // Every compacted sample maps back to where it came from
+        ASSERT_EQ(static_cast<size_t>(out[i]), expand_speech_position(regions, i)) << i;
+    }
+    EXPECT_EQ(expand_speech_position(regions, 300), 700u);
+    EXPECT_EQ(expand_speech_position(regions, 310), 710u);
+    EXPECT_EQ(expand_speech_position({}, 42), 42u);
+}
+
+} // namespace
@@ -0,0 +1,64 @@
+#include "transcription_control.h"
+
+#include <algorithm>
+
+namespace {
+
+// Timestamp tokens count 20 ms steps from the start of the window
+constexpr int kSamplesPerTimestamp = WHISPER_SAMPLE_RATE / 50;
+
+} // namespace
+
+void TranscriptionControl::reset() {
+    cancelled_.store(false, std::memory_order_relaxed);
+    progress_.store(0, std::memory_order_relaxed);
+}
+
+void TranscriptionControl::set_progress(float fraction) {
+    advance(static_cast<int>(std::clamp(fraction, 0.0f, 1.0f) * 1000.0f));
+}
+
+void TranscriptionControl::install(whisper_context* ctx, whisper_full_params& params, int n_samples) {
+    token_beg_ = whisper_token_beg(ctx);
+    n_samples_ = std::max(n_samples, 1);
+    window_start_ = 0;
+
+    params.abort_callback = should_abort;
+    params.abort_callback_user_data = this;
+    params.progress_callback = on_progress;
+    params.progress_callback_user_data = this;
+    params.logits_filter_callback = on_logits;
+    params.logits_filter_callback_user_data = this;
+}
+
+bool TranscriptionControl::should_abort(void* user_data) {
+    return static_cast<const TranscriptionControl*>(user_data)->cancelled();
+}
+
+void TranscriptionControl::on_progress(whisper_context* /* ctx */, whisper_state* /* state */, int progress,
+                                       void* user_data) {
+    auto* control = static_cast<TranscriptionControl*>(user_data);
+    control->window_start_ = static_cast<int>(static_cast<int64_t>(control->n_samples_) * progress / 100);
+    control->advance(progress * 10);
+}
+
+void TranscriptionControl::on_logits(whisper_context* /* ctx */, whisper_state* /* state */,
+                                     const whisper_token_data* tokens, int n_tokens, float* /* logits */,
+                                     void* user_data) {
+    auto* control = static_cast<TranscriptionControl*>(user_data);
+    for (int i = n_tokens - 1; i >= 0; --i) {
+        if (tokens[i].id > control->token_beg_) {
+            const int64_t position = control->window_start_ +
+                                     static_cast<int64_t>(tokens[i].id - control->token_beg_) * kSamplesPerTimestamp;
+            control->advance(static_cast<int>(std::min<int64_t>(position * 1000 / control->n_samples_, 1000)));
+            return;
+        }
+    }
+}
+
+void TranscriptionControl::advance(int permille) {
+    int current = progress_.load(std::memory_order_relaxed);
+    while (permille > current &&
+           !progress_.compare_exchange_weak(current, permille, std::memory_order_relaxed)) {
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <atomic>
+
+/**
+ * Cancellation flag and progress of the one-shot transcription running on
+ * a context, shared between the thread inside whisper and the threads that
+ * cancel it or poll its progress.
+ *
+ * install() hooks whisper_full's abort callback, which ggml checks between
+ * graph nodes, so a cancel stops the encoder or the current decoder step
+ * within milliseconds and whisper_full returns an error. Progress combines
+ * whisper's per-window progress with the last timestamp token decoded in
+ * the window, so a single 30 s window doesn't jump from 0 to 100%.
+ *
+ * A cancel stays set until reset(), so one that arrives before the decode
+ * starts aborts it right away.
+ */
+class TranscriptionControl {
+public:
+    /** Clear the cancel flag and progress for a new job. */
+    void reset();
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    /** Fraction of the audio decoded, 0 to 1. */
+    float progress() const { return progress_.load(std::memory_order_relaxed) / 1000.0f; }
+    void set_progress(float fraction);
+
+    /** Hook the abort, progress and logits callbacks for a decode of n_samples. */
+    void install(whisper_context* ctx, whisper_full_params& params, int n_samples);
+
+    /** ggml_abort_callback over a TranscriptionControl. */
+    static bool should_abort(void* user_data);
+
+private:
+    static void on_progress(whisper_context* ctx, whisper_state* state, int progress, void* user_data);
+    static void on_logits(whisper_context* ctx, whisper_state* state, const whisper_token_data* tokens,
+                          int n_tokens, float* logits, void* user_data);
+
+    void advance(int permille);
+
+    std::atomic<bool> cancelled_{false};
+    std::atomic<int> progress_{0};  // per mille, only increases within a job
+
+    // Written by install() and read by callbacks on the decoding thread
+    whisper_token token_beg_ = 0;
+    int n_samples_ = 0;
+    int window_start_ = 0;  // samples before the window being decoded
+};
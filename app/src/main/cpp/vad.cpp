@@ -0,0 +1,274 @@
+#include "vad.h"
+#include "audio_kernels.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#define LOG_TAG "VAD"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// Band used for spectral flatness; below it is hum, above it little voicing
+constexpr float kFlatnessLowHz = 250.0f;
+constexpr float kFlatnessHighHz = 4000.0f;
+// Percentile of frame energies used as the initial noise floor
+constexpr double kNoiseFloorPercentile = 0.1;
+constexpr float kPowerEpsilon = 1e-12f;
+
+size_t next_power_of_two(size_t n) {
+    size_t p = 4;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+int ms_to_frames(int ms, int frame_ms) {
+    return std::max(1, (ms + frame_ms - 1) / frame_ms);
+}
+
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector(const VadParams& params)
+    : params_(params),
+      frame_size_(params.sample_rate > 0 && params.frame_ms > 0
+                      ? static_cast<size_t>(params.sample_rate) * params.frame_ms / 1000
+                      : 0),
+      band_begin_(0),
+      band_end_(0),
+      min_speech_frames_(ms_to_frames(params.min_speech_ms, std::max(params.frame_ms, 1))),
+      hangover_frames_(ms_to_frames(params.hangover_ms, std::max(params.frame_ms, 1))),
+      noise_block_frames_(std::max<int>(1, ms_to_frames(params.noise_window_ms, std::max(params.frame_ms, 1)) /
+                                               static_cast<int>(kNoiseBlocks))) {
+    if (frame_size_ == 0) {
+        return;
+    }
+
+    const size_t fft_size = next_power_of_two(frame_size_);
+    plan_ = get_fft_plan(fft_size);
+    window_ = hann_window(frame_size_);
+    windowed_.assign(fft_size, 0.0f);
+    spectrum_.resize(fft_size / 2 + 1);
+    power_.resize(fft_size / 2 + 1);
+
+    const float bin_hz = static_cast<float>(params_.sample_rate) / fft_size;
+    band_begin_ = std::max<size_t>(1, static_cast<size_t>(kFlatnessLowHz / bin_hz));
+    band_end_ = std::min(power_.size(), static_cast<size_t>(kFlatnessHighHz / bin_hz) + 1);
+    if (band_end_ <= band_begin_) {
+        band_begin_ = 1;
+        band_end_ = power_.size();
+    }
+}
+
+VoiceActivityDetector::FrameFeatures VoiceActivityDetector::analyze(const float* frame) {
+    FrameFeatures features;
+
+    const double energy = audio_kernels().sum_squares(frame, frame_size_) / frame_size_;
+    features.energy_db = static_cast<float>(10.0 * std::log10(energy + kPowerEpsilon));
+
+    size_t crossings = 0;
+    for (size_t i = 1; i < frame_size_; ++i) {
+        crossings += (frame[i - 1] >= 0.0f) != (frame[i] >= 0.0f);
+    }
+    features.zcr = static_cast<float>(crossings) / frame_size_;
+
+    for (size_t i = 0; i < frame_size_; ++i) {
+        windowed_[i] = frame[i] * window_[i];
+    }
+    plan_->power_spectrum(windowed_.data(), spectrum_.data(), power_.data());
+
+    // Wiener entropy: geometric over arithmetic mean of the band's power
+    double log_sum = 0.0;
+    double sum = 0.0;
+    for (size_t k = band_begin_; k < band_end_; ++k) {
+        const double p = power_[k] + kPowerEpsilon;
+        log_sum += std::log(p);
+        sum += p;
+    }
+    const double bins = static_cast<double>(band_end_ - band_begin_);
+    features.flatness = static_cast<float>(std::exp(log_sum / bins) / (sum / bins));
+    return features;
+}
+
+VoiceActivityDetector::NoiseTracker::NoiseTracker()
+    : block_min(std::numeric_limits<float>::infinity()) {
+    block_mins.fill(std::numeric_limits<float>::infinity());
+}
+
+bool VoiceActivityDetector::classify(const FrameFeatures& frame, NoiseTracker& noise) const {
+    const bool loud = frame.energy_db > params_.min_energy_db &&
+                      frame.energy_db > noise.floor + params_.energy_margin_db;
+    const bool peaky = frame.flatness < params_.max_flatness;
+    const bool speech_zcr = frame.zcr >= params_.min_zcr && frame.zcr <= params_.max_zcr;
+    const bool voiced = loud && (peaky || speech_zcr);
+    track_noise(frame.energy_db, voiced, noise);
+    return voiced;
+}
+
+void VoiceActivityDetector::track_noise(float energy_db, bool voiced, NoiseTracker& noise) const {
+    // Digital silence would pin the floor far below the noise that follows it
+    if (energy_db < silence_db()) {
+        return;
+    }
+
+    // Track the floor on frames that aren't speech so loud passages can't raise it
+    if (energy_db < noise.floor) {
+        noise.floor = energy_db;
+    } else if (!voiced) {
+        noise.floor += params_.noise_rise_db;
+    }
+
+    // Minimum statistics: once a block completes, the floor can't sit below
+    // the quietest frame of the window, whatever the frames were classified as
+    noise.block_min = std::min(noise.block_min, energy_db);
+    if (++noise.block_frames >= noise_block_frames_) {
+        noise.block_mins[noise.next_block] = noise.block_min;
+        noise.next_block = (noise.next_block + 1) % kNoiseBlocks;
+        noise.block_min = std::numeric_limits<float>::infinity();
+        noise.block_frames = 0;
+        const float window_min = *std::min_element(noise.block_mins.begin(), noise.block_mins.end());
+        noise.floor = std::max(noise.floor, window_min);
+    }
+}
+
+bool VoiceActivityDetector::push_frame(const float* frame) {
+    if (!is_valid()) {
+        return false;
+    }
+
+    const FrameFeatures features = analyze(frame);
+    if (!stream_noise_.primed && features.energy_db >= silence_db()) {
+        stream_noise_.floor = features.energy_db;
+        stream_noise_.primed = true;
+    }
+
+    SpeechTracker& tracker = stream_tracker_;
+    // Until a frame is loud enough to prime the floor, none is loud enough to be speech
+    if (stream_noise_.primed && classify(features, stream_noise_)) {
+        ++tracker.voiced_run;
+        tracker.silent_run = 0;
+        if (tracker.voiced_run >= min_speech_frames_) {
+            tracker.in_speech = true;
+        }
+    } else {
+        tracker.voiced_run = 0;
+        if (tracker.in_speech && ++tracker.silent_run > hangover_frames_) {
+            tracker.in_speech = false;
+        }
+    }
+    return tracker.in_speech;
+}
+
+void VoiceActivityDetector::reset_stream() {
+    stream_noise_ = NoiseTracker();
+    stream_tracker_ = SpeechTracker();
+}
+
+std::vector<SpeechRegion> VoiceActivityDetector::detect(const float* samples, size_t n) {
+    std::vector<SpeechRegion> regions;
+    detect(samples, n, regions);
+    return regions;
+}
+
+void VoiceActivityDetector::detect(const float* samples, size_t n, std::vector<SpeechRegion>& merged) {
+    merged.clear();
+    if (!is_valid() || samples == nullptr || n < frame_size_) {
+        return;
+    }
+
+    const size_t n_frames = n / frame_size_;
+    features_.resize(n_frames);
+    energies_.clear();
+    for (size_t f = 0; f < n_frames; ++f) {
+        features_[f] = analyze(samples + f * frame_size_);
+        if (features_[f].energy_db >= silence_db()) {
+            energies_.push_back(features_[f].energy_db);
+        }
+    }
+
+    // The percentile skips digital silence the same way the tracking does
+    NoiseTracker noise;
+    noise.floor = silence_db();
+    if (!energies_.empty()) {
+        auto percentile = energies_.begin() + static_cast<ptrdiff_t>(energies_.size() * kNoiseFloorPercentile);
+        std::nth_element(energies_.begin(), percentile, energies_.end());
+        noise.floor = *percentile;
+    }
+
+    SpeechTracker tracker;
+    size_t region_start = 0;
+    size_t last_voiced = 0;
+    std::vector<SpeechRegion>& regions = raw_regions_;
+    regions.clear();
+
+    for (size_t f = 0; f < n_frames; ++f) {
+        if (classify(features_[f], noise)) {
+            ++tracker.voiced_run;
+            tracker.silent_run = 0;
+            last_voiced = f;
+            if (!tracker.in_speech && tracker.voiced_run >= min_speech_frames_) {
+                tracker.in_speech = true;
+                region_start = f + 1 - static_cast<size_t>(tracker.voiced_run);
+            }
+        } else {
+            tracker.voiced_run = 0;
+            if (tracker.in_speech && ++tracker.silent_run > hangover_frames_) {
+                tracker.in_speech = false;
+                regions.push_back({region_start * frame_size_, (last_voiced + 1) * frame_size_});
+            }
+        }
+    }
+    if (tracker.in_speech) {
+        regions.push_back({region_start * frame_size_, (last_voiced + 1) * frame_size_});
+    }
+
+    // Pad for context and merge regions the padding made overlap
+    const size_t padding = static_cast<size_t>(params_.sample_rate) * params_.padding_ms / 1000;
+    for (const SpeechRegion& region : regions) {
+        SpeechRegion padded{region.start > padding ? region.start - padding : 0,
+                            std::min(n, region.end + padding)};
+        if (!merged.empty() && padded.start <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, padded.end);
+        } else {
+            merged.push_back(padded);
+        }
+    }
+
+    LOGD("VAD: %zu frames, %zu regions, %zu/%zu samples voiced",
+         n_frames, merged.size(), speech_length(merged), n);
+}
+
+size_t speech_length(const std::vector<SpeechRegion>& regions) {
+    size_t total = 0;
+    for (const SpeechRegion& region : regions) {
+        total += region.end - region.start;
+    }
+    return total;
+}
+
+size_t compact_speech(const float* in, const std::vector<SpeechRegion>& regions, float* out) {
+    size_t written = 0;
+    for (const SpeechRegion& region : regions) {
+        const size_t length = region.end - region.start;
+        std::memcpy(out + written, in + region.start, length * sizeof(float));
+        written += length;
+    }
+    return written;
+}
+
+size_t expand_speech_position(const std::vector<SpeechRegion>& regions, size_t position) {
+    size_t compacted = 0;
+    for (const SpeechRegion& region : regions) {
+        const size_t length = region.end - region.start;
+        if (position < compacted + length) {
+            return region.start + (position - compacted);
+        }
+        compacted += length;
+    }
+    // At or past the end of the compacted audio
+    return regions.empty() ? position : regions.back().end + (position - compacted);
+}
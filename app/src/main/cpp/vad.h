@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "fft.h"
+
+/** Half-open span [start, end) of speech, in samples. */
+struct SpeechRegion {
+    size_t start = 0;
+    size_t end = 0;
+};
+
+struct VadParams {
+    int sample_rate = 16000;
+    int frame_ms = 20;
+    float energy_margin_db = 9.0f;   // required margin over the noise floor
+    float min_energy_db = -55.0f;    // absolute level below which nothing is speech
+    float noise_rise_db = 0.05f;     // per-frame upward drift of the noise floor
+    int noise_window_ms = 2000;      // the floor never stays below this span's quietest frame
+    float max_flatness = 0.45f;      // speech is peaky; noise is flat (-> 1)
+    float min_zcr = 0.01f;           // crossings per sample
+    float max_zcr = 0.35f;
+    int min_speech_ms = 60;          // onset needs this much consecutive speech
+    int hangover_ms = 300;           // speech continues this long after the last voiced frame
+    int padding_ms = 200;            // context kept either side of a region
+};
+
+/**
+ * Frame-based voice activity detector.
+ *
+ * Each frame is scored on three features: energy against an adaptive noise
+ * floor, zero-crossing rate, and spectral flatness over the 250 Hz - 4 kHz
+ * band. A frame is voiced when its energy clears the floor by
+ * energy_margin_db and either its spectrum is peaky or its ZCR is in the
+ * speech range. Voiced frames become regions through an onset/hangover
+ * state machine, after which regions are padded and overlapping ones merged.
+ *
+ * The noise floor starts at the 10th percentile of frame energies, drops
+ * immediately to quieter frames and rises slowly otherwise. It is also held
+ * at or above the quietest frame of the last noise_window_ms, so a floor left
+ * behind by rising noise catches up even while every frame reads as voiced.
+ * Frames more than energy_margin_db below min_energy_db (digital silence,
+ * muted input) are ignored by the floor, since they say nothing about the
+ * noise that follows. Instances hold scratch buffers and are not thread-safe.
+ */
+class VoiceActivityDetector {
+public:
+    explicit VoiceActivityDetector(const VadParams& params = VadParams());
+
+    bool is_valid() const { return plan_ != nullptr && frame_size_ > 0; }
+
+    std::vector<SpeechRegion> detect(const float* samples, size_t n);
+
+    /**
+     * detect() into a caller-owned vector. Together with the detector's own
+     * scratch this keeps its capacity, so repeated calls don't allocate once
+     * warmed up.
+     */
+    void detect(const float* samples, size_t n, std::vector<SpeechRegion>& regions);
+
+    /** Samples per analysis frame; push_frame() takes exactly this many. */
+    size_t frame_size() const { return frame_size_; }
+
+    /**
+     * Online mode: classify one frame as it arrives and return the smoothed
+     * speech state. The noise floor starts at the first tracked frame's
+     * energy instead of a percentile, since future frames aren't known.
+     */
+    bool push_frame(const float* frame);
+
+    /** Forget the online state so a new stream can start. */
+    void reset_stream();
+
+private:
+    struct FrameFeatures {
+        float energy_db;
+        float zcr;
+        float flatness;
+    };
+
+    /** Onset/hangover smoothing shared by both modes. */
+    struct SpeechTracker {
+        bool in_speech = false;
+        int voiced_run = 0;
+        int silent_run = 0;
+    };
+
+    static constexpr size_t kNoiseBlocks = 4;
+
+    /** Adaptive noise floor with minimum statistics over kNoiseBlocks blocks. */
+    struct NoiseTracker {
+        float floor = 0.0f;
+        bool primed = false;
+        float block_min;
+        int block_frames = 0;
+        size_t next_block = 0;
+        std::array<float, kNoiseBlocks> block_mins;
+
+        NoiseTracker();
+    };
+
+    FrameFeatures analyze(const float* frame);
+    bool classify(const FrameFeatures& frame, NoiseTracker& noise) const;
+    void track_noise(float energy_db, bool voiced, NoiseTracker& noise) const;
+    /** Frames below this are left out of the noise floor. */
+    float silence_db() const { return params_.min_energy_db - params_.energy_margin_db; }
+
+    VadParams params_;
+    size_t frame_size_;
+    std::shared_ptr<const FftPlan> plan_;
+    std::vector<float> window_;
+    std::vector<float> windowed_;
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<float> power_;
+    std::vector<FrameFeatures> features_;
+    std::vector<float> energies_;
+    std::vector<SpeechRegion> raw_regions_;
+    size_t band_begin_;
+    size_t band_end_;
+    int min_speech_frames_;
+    int hangover_frames_;
+    int noise_block_frames_;
+
+    NoiseTracker stream_noise_;
+    SpeechTracker stream_tracker_;
+};
+
+/** Total number of samples covered by the regions. */
+size_t speech_length(const std::vector<SpeechRegion>& regions);
+
+/**
+ * Copy only the speech regions of in to out, back to back.
+ * out must hold speech_length(regions) samples. Returns samples written.
+ */
+size_t compact_speech(const float* in, const std::vector<SpeechRegion>& regions, float* out);
+
+/**
+ * Map a sample position in compact_speech output back to the position in
+ * its input, so timestamps from trimmed audio line up with the original.
+ */
+size_t expand_speech_position(const std::vector<SpeechRegion>& regions, size_t position);
@@ -0,0 +1,235 @@
+#include "wav_reader.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "audio_kernels.h"
+
+#define LOG_TAG "WavReader"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr size_t kChunkSamples = 4096;
+
+// PcmFileReader fetches this many bytes per pread
+constexpr size_t kBlockBytes = 64 * 1024;
+
+uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+void downmix_pcm16(const int16_t* pcm, size_t frames, size_t channels, float* out) {
+    if (channels == 1) {
+        audio_kernels().pcm16_to_float(pcm, out, frames);
+        return;
+    }
+    const float scale = 1.0f / (32768.0f * static_cast<float>(channels));
+    for (size_t i = 0; i < frames; ++i) {
+        int sum = 0;
+        for (size_t c = 0; c < channels; ++c) {
+            sum += pcm[i * channels + c];
+        }
+        out[i] = static_cast<float>(sum) * scale;
+    }
+}
+
+bool is_wav_file(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t riff[12];
+    const bool wav = std::fread(riff, 1, sizeof(riff), file) == sizeof(riff) &&
+                     std::memcmp(riff, "RIFF", 4) == 0 && std::memcmp(riff + 8, "WAVE", 4) == 0;
+    std::fclose(file);
+    return wav;
+}
+
+bool read_wav_header(FILE* file, WavInfo& info) {
+    uint8_t riff[12];
+    if (std::fread(riff, 1, sizeof(riff), file) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        LOGE("Not a RIFF/WAVE file");
+        return false;
+    }
+
+    info = WavInfo();
+    for (;;) {
+        uint8_t header[8];
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
+            LOGE("WAV file has no data chunk");
+            return false;
+        }
+        const uint32_t size = le32(header + 4);
+
+        if (std::memcmp(header, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < sizeof(fmt) || std::fread(fmt, 1, sizeof(fmt), file) != sizeof(fmt)) {
+                LOGE("Truncated WAV fmt chunk");
+                return false;
+            }
+            const uint16_t format = le16(fmt);
+            const uint16_t bits = le16(fmt + 14);
+            info.channels = le16(fmt + 2);
+            info.sample_rate = static_cast<int>(le32(fmt + 4));
+            if (format != 1 || bits != 16 || info.channels < 1 || info.sample_rate <= 0) {
+                LOGE("Unsupported WAV format %u (%u bits, %d channels)", format, bits, info.channels);
+                return false;
+            }
+            std::fseek(file, static_cast<long>(size - sizeof(fmt) + (size & 1)), SEEK_CUR);
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            if (info.channels == 0) {
+                LOGE("WAV data chunk before fmt chunk");
+                return false;
+            }
+            info.data_size = size;
+            return true;
+        } else {
+            std::fseek(file, static_cast<long>(size + (size & 1)), SEEK_CUR);
+        }
+    }
+}
+
+size_t read_wav_frames(FILE* file, const WavInfo& info, float* out, size_t max_frames) {
+    const size_t channels = static_cast<size_t>(info.channels);
+    const size_t frames_per_chunk = kChunkSamples / channels;
+    if (frames_per_chunk == 0) {
+        return 0;
+    }
+
+    int16_t chunk[kChunkSamples];
+    size_t written = 0;
+    while (written < max_frames) {
+        const size_t want = std::min(frames_per_chunk, max_frames - written);
+        const size_t got = std::fread(chunk, sizeof(int16_t) * channels, want, file);
+        if (got == 0) {
+            break;
+        }
+
+        downmix_pcm16(chunk, got, channels, out + written);
+        written += got;
+        if (got < want) {
+            break;
+        }
+    }
+    return written;
+}
+
+PcmFileReader::~PcmFileReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool PcmFileReader::open(const char* path, int raw_sample_rate, int raw_channels) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    uint64_t data_offset = 0;
+    uint64_t data_size = UINT64_MAX;
+    if (raw_sample_rate > 0) {
+        if (raw_channels < 1) {
+            LOGE("Invalid raw PCM channel count: %d", raw_channels);
+            return false;
+        }
+        info_ = WavInfo();
+        info_.sample_rate = raw_sample_rate;
+        info_.channels = raw_channels;
+    } else {
+        FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) {
+            LOGE("Cannot open %s", path);
+            return false;
+        }
+        const bool parsed = read_wav_header(file, info_);
+        const long position = std::ftell(file);
+        std::fclose(file);
+        if (!parsed || position < 0) {
+            return false;
+        }
+        data_offset = static_cast<uint64_t>(position);
+        // Recorders that never finalized the header leave 0 or 0xFFFFFFFF
+        if (info_.data_size != 0 && info_.data_size != UINT32_MAX) {
+            data_size = info_.data_size;
+        }
+    }
+
+    fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        LOGE("Cannot open %s: %s", path, std::strerror(errno));
+        return false;
+    }
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    const uint64_t frame_bytes = sizeof(int16_t) * static_cast<uint64_t>(info_.channels);
+    const uint64_t file_size = static_cast<uint64_t>(st.st_size);
+    const uint64_t available = file_size > data_offset ? file_size - data_offset : 0;
+    offset_ = data_offset;
+    end_ = data_offset + std::min(data_size, available) / frame_bytes * frame_bytes;
+
+    // Whole frames only, so a block never splits one
+    const size_t frames_per_block = std::max<size_t>(kBlockBytes / frame_bytes, 1);
+    block_.resize(frames_per_block * static_cast<size_t>(info_.channels));
+    return true;
+}
+
+uint64_t PcmFileReader::frames_left() const {
+    if (fd_ < 0) {
+        return 0;
+    }
+    return (end_ - offset_) / (sizeof(int16_t) * static_cast<uint64_t>(info_.channels));
+}
+
+size_t PcmFileReader::read(float* out, size_t max_frames) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    const size_t channels = static_cast<size_t>(info_.channels);
+    const size_t frame_bytes = sizeof(int16_t) * channels;
+    const size_t frames_per_block = block_.size() / channels;
+
+    size_t written = 0;
+    while (written < max_frames && offset_ < end_) {
+        const uint64_t left = (end_ - offset_) / frame_bytes;
+        const size_t want = static_cast<size_t>(std::min<uint64_t>({frames_per_block, max_frames - written, left}));
+        const ssize_t got = pread(fd_, block_.data(), want * frame_bytes, static_cast<off_t>(offset_));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            if (got < 0) {
+                LOGE("Read failed at offset %llu: %s", static_cast<unsigned long long>(offset_),
+                     std::strerror(errno));
+            }
+            end_ = offset_;  // treat as the end of the data
+            break;
+        }
+
+        const size_t frames = static_cast<size_t>(got) / frame_bytes;
+        downmix_pcm16(block_.data(), frames, channels, out + written);
+        written += frames;
+        offset_ += frames * frame_bytes;
+        if (frames == 0) {
+            end_ = offset_;  // a torn frame at the end of the file
+            break;
+        }
+    }
+    return written;
+}
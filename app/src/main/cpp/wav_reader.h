@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/** Format of a 16-bit PCM WAV file and where its samples start. */
+struct WavInfo {
+    int sample_rate = 0;
+    int channels = 0;
+    uint32_t data_size = 0;  // bytes in the data chunk
+
+    size_t frames() const {
+        return channels > 0 ? data_size / (sizeof(int16_t) * static_cast<size_t>(channels)) : 0;
+    }
+};
+
+/** Interleaved PCM16 frames to mono float in [-1, 1), averaging the channels. */
+void downmix_pcm16(const int16_t* pcm, size_t frames, size_t channels, float* out);
+
+/** True if path starts with a RIFF/WAVE header; nothing is logged otherwise. */
+bool is_wav_file(const char* path);
+
+/**
+ * Parse the RIFF header up to the data chunk, leaving file positioned at
+ * the first sample. Only 16-bit integer PCM is accepted.
+ */
+bool read_wav_header(FILE* file, WavInfo& info);
+
+/**
+ * Read up to max_frames frames from the current position, downmixed to mono
+ * float in [-1, 1). Converts through a fixed stack buffer, so the only
+ * storage involved is out.
+ *
+ * @return Number of frames written
+ */
+size_t read_wav_frames(FILE* file, const WavInfo& info, float* out, size_t max_frames);
+
+/**
+ * Block reader over a 16-bit PCM WAV file, or a headerless little-endian
+ * 16-bit PCM file of known format, for inputs too long to hold in memory.
+ *
+ * Samples are fetched with pread into one fixed block buffer and downmixed
+ * to mono float straight into the caller's output, so a file of any length
+ * is read with a constant footprint. The descriptor is advised sequential
+ * so the kernel reads ahead and drops pages behind.
+ */
+class PcmFileReader {
+public:
+    PcmFileReader() = default;
+    ~PcmFileReader();
+
+    PcmFileReader(const PcmFileReader&) = delete;
+    PcmFileReader& operator=(const PcmFileReader&) = delete;
+
+    /**
+     * Open path as WAV, or as raw PCM with the given format when
+     * raw_sample_rate > 0. Returns false if the file can't be used.
+     */
+    bool open(const char* path, int raw_sample_rate = 0, int raw_channels = 1);
+
+    /** Format of the open file; data_size is not meaningful for raw files. */
+    const WavInfo& info() const { return info_; }
+
+    /** Frames not read yet. */
+    uint64_t frames_left() const;
+
+    /**
+     * Read up to max_frames frames, downmixed to mono float in [-1, 1).
+     *
+     * @return Number of frames written; 0 at the end of the data or on error
+     */
+    size_t read(float* out, size_t max_frames);
+
+private:
+    int fd_ = -1;
+    WavInfo info_;
+    uint64_t offset_ = 0;  // byte position of the next frame
+    uint64_t end_ = 0;     // byte position just past the last whole frame
+    std::vector<int16_t> block_;
+};
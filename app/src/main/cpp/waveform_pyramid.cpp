@@ -0,0 +1,106 @@
+#include "waveform_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+WaveformPyramid::WaveformPyramid(size_t base_bin_samples) : base_bin_samples_(base_bin_samples) {
+    uint64_t samples = base_bin_samples;
+    for (size_t level = 0; level < kLevels; ++level) {
+        bin_samples_[level] = samples;
+        samples *= kFanout;
+    }
+}
+
+void WaveformPyramid::append(const float* samples, size_t n) {
+    if (!is_valid()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Pieces never straddle a level-0 bin, so each lands wholly in one bin per level
+    while (n > 0) {
+        const size_t offset = static_cast<size_t>(total_ % base_bin_samples_);
+        const size_t m = std::min(n, base_bin_samples_ - offset);
+
+        Bin piece = {samples[0], samples[0], 0.0f};
+        for (size_t i = 0; i < m; ++i) {
+            const float x = samples[i];
+            piece.min = std::min(piece.min, x);
+            piece.max = std::max(piece.max, x);
+            piece.sum_sq += x * x;
+        }
+
+        for (size_t level = 0; level < kLevels; ++level) {
+            std::vector<Bin>& bins = levels_[level];
+            const uint64_t index = total_ / bin_samples_[level];
+            if (index == bins.size()) {
+                bins.push_back(piece);
+            } else {
+                Bin& bin = bins.back();
+                bin.min = std::min(bin.min, piece.min);
+                bin.max = std::max(bin.max, piece.max);
+                bin.sum_sq += piece.sum_sq;
+            }
+        }
+
+        total_ += m;
+        samples += m;
+        n -= m;
+    }
+}
+
+uint64_t WaveformPyramid::sample_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+size_t WaveformPyramid::query(uint64_t start, uint64_t end, size_t n_points, float* min_out, float* max_out,
+                              float* rms_out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end = std::min(end, total_);
+    if (n_points == 0 || start >= end) {
+        return 0;
+    }
+
+    // Coarsest level whose bins fit inside one point
+    const uint64_t span = end - start;
+    size_t level = 0;
+    while (level + 1 < kLevels && bin_samples_[level + 1] * n_points <= span) {
+        ++level;
+    }
+    const std::vector<Bin>& bins = levels_[level];
+    const uint64_t bin_samples = bin_samples_[level];
+
+    for (size_t p = 0; p < n_points; ++p) {
+        const uint64_t point_start = start + span * p / n_points;
+        const uint64_t point_end = std::max(start + span * (p + 1) / n_points, point_start + 1);
+        const size_t first = static_cast<size_t>(point_start / bin_samples);
+        const size_t last = static_cast<size_t>((point_end - 1) / bin_samples);
+
+        Bin merged = bins[first];
+        uint64_t count = 0;
+        for (size_t b = first; b <= last; ++b) {
+            const Bin& bin = bins[b];
+            merged.min = std::min(merged.min, bin.min);
+            merged.max = std::max(merged.max, bin.max);
+            if (b != first) {
+                merged.sum_sq += bin.sum_sq;
+            }
+            // Only the newest bin can be partial
+            count += std::min(bin_samples, total_ - b * bin_samples);
+        }
+
+        min_out[p] = merged.min;
+        max_out[p] = merged.max;
+        rms_out[p] = std::sqrt(merged.sum_sq / static_cast<float>(count));
+    }
+    return n_points;
+}
+
+void WaveformPyramid::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::vector<Bin>& bins : levels_) {
+        bins.clear();
+    }
+    total_ = 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Multi-resolution min/max/RMS summary of an audio stream for the
+ * waveform visualizer.
+ *
+ * Level 0 holds one bin per base_bin_samples; every level above merges
+ * kFanout bins of the one below. append() updates the open bin of every
+ * level as samples arrive, so the pyramid is always current and is never
+ * rebuilt. query() answers any zoom from the coarsest level whose bins are
+ * no wider than a point, touching at most kFanout + 1 bins per point: its
+ * cost is O(points) whatever the recording length.
+ *
+ * One thread may append while others query; a mutex covers both, and
+ * neither call allocates except when appending opens a new bin.
+ */
+class WaveformPyramid {
+public:
+    static constexpr size_t kFanout = 4;
+    static constexpr size_t kLevels = 10;
+
+    explicit WaveformPyramid(size_t base_bin_samples);
+
+    bool is_valid() const { return base_bin_samples_ > 0; }
+
+    void append(const float* samples, size_t n);
+
+    /** Samples appended since construction or reset(). */
+    uint64_t sample_count() const;
+
+    /**
+     * Summarize samples [start, end) as n_points evenly spaced points.
+     * end is clamped to sample_count(). Output arrays hold n_points; points
+     * narrower than a base bin repeat the bin they fall in.
+     *
+     * @return Points written; 0 when the range is empty
+     */
+    size_t query(uint64_t start, uint64_t end, size_t n_points, float* min_out, float* max_out,
+                 float* rms_out) const;
+
+    void reset();
+
+private:
+    struct Bin {
+        float min;
+        float max;
+        float sum_sq;
+    };
+
+    size_t base_bin_samples_;
+    uint64_t bin_samples_[kLevels];
+    std::vector<Bin> levels_[kLevels];
+    uint64_t total_ = 0;
+    mutable std::mutex mutex_;
+};
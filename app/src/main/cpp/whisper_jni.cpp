@@ -0,0 +1,1763 @@
+#include <jni.h>
+#include <android/log.h>
+#include <whisper.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "accelerator.h"
+#include "batch_transcriber.h"
+#include "capture_pipeline.h"
+#include "core_arbiter.h"
+#include "cpu_topology.h"
+#include "encoder_cache.h"
+#include "jni_arrays.h"
+#include "media_decoder.h"
+#include "model_cache.h"
+#include "packed_result.h"
+#include "parallel_transcriber.h"
+#include "perf_stats.h"
+#include "resampler.h"
+#include "scratch_arena.h"
+#include "transcription_control.h"
+#include "vad.h"
+#include "wav_reader.h"
+#include "whisper_stream.h"
+
+#define LOG_TAG "WhisperJNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kWhisperSampleRate = 16000;
+
+// transcribeFile decodes 30 s windows, whisper's own, with no partials
+constexpr int kFileWindowMs = 30000;
+
+// Longer input takes several encoder passes, which one state can't keep
+constexpr int kMaxCachedSamples = kWhisperSampleRate * 30;
+
+/**
+ * Native state behind WhisperNative's context pointer.
+ * Holds a reference on the cached model and keeps the thread count chosen
+ * at initContext so every transcription uses it instead of a hardcoded
+ * value. One-shot transcriptions decode on the context's own
+ * whisper_state, so contexts opened on the same model run concurrently,
+ * leasing their threads from core_arbiter(). The model's mutex still
+ * guards what the contexts share: warmup and the encoder cache.
+ */
+struct WhisperJniContext {
+    std::shared_ptr<SharedModel> model;
+    whisper_context* ctx = nullptr;
+    whisper_state* state = nullptr;  // guarded by job_mutex
+    int n_threads = 1;
+    InferenceBackend backend = InferenceBackend::Cpu;
+
+    WhisperJniContext() = default;
+    ~WhisperJniContext() {
+        if (state != nullptr) {
+            whisper_free_state(state);
+        }
+    }
+
+    WhisperJniContext(const WhisperJniContext&) = delete;
+    WhisperJniContext& operator=(const WhisperJniContext&) = delete;
+
+    // Per-job scratch, reused by back-to-back transcribeAudio calls instead
+    // of being reallocated; guarded by job_mutex
+    std::mutex job_mutex;
+    ScratchArena scratch;
+    std::unique_ptr<StreamingResampler> resampler;
+    int resampler_rate = 0;
+    VoiceActivityDetector vad;
+    std::vector<SpeechRegion> regions;
+    std::vector<uint8_t> packed;  // last transcribeAudioPacked result
+
+    // Cancel flag and progress of the one-shot transcription; used from any
+    // thread without job_mutex
+    TranscriptionControl control;
+
+    std::mutex& mutex() const { return model->mutex; }
+};
+
+/**
+ * Streaming session plus the context it decodes on, and the capture
+ * pipeline feeding it when attached. mutex serializes pushes from the
+ * capture worker with streamPush and streamFinish.
+ */
+struct WhisperJniStream {
+    WhisperJniContext* owner;
+    WhisperStream stream;
+    CapturePipeline* capture = nullptr;
+    std::mutex mutex;
+
+    WhisperJniStream(WhisperJniContext* context, const WhisperStreamParams& params)
+        : owner(context), stream(context->ctx, params) {}
+};
+
+WhisperJniContext* from_handle(jlong context_ptr) {
+    return reinterpret_cast<WhisperJniContext*>(context_ptr);
+}
+
+WhisperJniStream* stream_from_handle(jlong stream_ptr) {
+    return reinterpret_cast<WhisperJniStream*>(stream_ptr);
+}
+
+/**
+ * Decode pushed audio on the session's own state.
+ */
+bool push_stream(WhisperJniStream* handle, const float* samples, size_t n, std::vector<StreamSegment>& out) {
+    std::lock_guard<std::mutex> lock(handle->mutex);
+    return handle->stream.push(samples, n, out);
+}
+
+/**
+ * Global reference to a StreamingSegmentListener used from the capture
+ * worker thread, which attaches itself to the VM on first use.
+ */
+class WorkerListener {
+public:
+    WorkerListener(JNIEnv* env, jobject listener) : listener_(env->NewGlobalRef(listener)) {
+        env->GetJavaVM(&vm_);
+    }
+
+    ~WorkerListener() {
+        // The last owner may be a native worker thread; attach it rather than leak the ref
+        if (JNIEnv* jni = env()) {
+            jni->DeleteGlobalRef(listener_);
+        }
+    }
+
+    WorkerListener(const WorkerListener&) = delete;
+    WorkerListener& operator=(const WorkerListener&) = delete;
+
+    JNIEnv* env() const;
+    jobject listener() const { return listener_; }
+
+private:
+    JavaVM* vm_ = nullptr;
+    jobject listener_;
+};
+
+/**
+ * Deliver segments to StreamingSegmentListener.onSegment on the calling thread.
+ */
+void dispatch_segments(JNIEnv* env, jobject listener, const std::vector<StreamSegment>& segments) {
+    if (listener == nullptr || segments.empty()) {
+        return;
+    }
+    jclass listener_class = env->GetObjectClass(listener);
+    jmethodID on_segment = env->GetMethodID(listener_class, "onSegment", "(Ljava/lang/String;JJZ)V");
+    env->DeleteLocalRef(listener_class);
+    if (on_segment == nullptr) {
+        LOGE("StreamingSegmentListener.onSegment not found");
+        return;
+    }
+
+    for (const StreamSegment& segment : segments) {
+        jstring text = env->NewStringUTF(segment.text.c_str());
+        env->CallVoidMethod(listener, on_segment, text,
+                            static_cast<jlong>(segment.start_ms),
+                            static_cast<jlong>(segment.end_ms),
+                            segment.is_final ? JNI_TRUE : JNI_FALSE);
+        env->DeleteLocalRef(text);
+        if (env->ExceptionCheck()) {
+            return;  // let the exception propagate to the Kotlin caller
+        }
+    }
+}
+
+/**
+ * Detaches the worker thread from the VM when the thread exits.
+ */
+struct ThreadAttachment {
+    JavaVM* vm = nullptr;
+    JNIEnv* env = nullptr;
+
+    ~ThreadAttachment() {
+        if (vm != nullptr) {
+            vm->DetachCurrentThread();
+        }
+    }
+};
+
+JNIEnv* WorkerListener::env() const {
+    thread_local ThreadAttachment attachment;
+    if (attachment.env == nullptr) {
+        JNIEnv* env = nullptr;
+        if (vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK) {
+            attachment.env = env;  // already a Java thread, nothing to detach
+        } else if (vm_->AttachCurrentThread(&env, nullptr) == JNI_OK) {
+            attachment.vm = vm_;
+            attachment.env = env;
+        }
+    }
+    return attachment.env;
+}
+
+/**
+ * Capture pipeline sink feeding a streaming session. Runs on the
+ * pipeline's sink thread, so a decode that falls behind costs the live
+ * transcript samples but never stalls capture. Destroyed when the pipeline
+ * is released or the sink replaced, at which point the session forgets the
+ * pipeline so it never touches it again.
+ */
+class CaptureSink {
+public:
+    CaptureSink(JNIEnv* env, WhisperJniStream* stream, jobject listener)
+        : stream_(stream), listener_(env, listener) {}
+
+    ~CaptureSink() { stream_->capture = nullptr; }
+
+    void operator()(const float* samples, size_t n) {
+        std::vector<StreamSegment> segments;
+        if (!push_stream(stream_, samples, n, segments)) {
+            LOGE("Streaming decode failed on capture sink thread");
+        }
+
+        JNIEnv* env = listener_.env();
+        if (env != nullptr) {
+            dispatch_segments(env, listener_.listener(), segments);
+            if (env->ExceptionCheck()) {
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+            }
+        }
+    }
+
+private:
+    WhisperJniStream* stream_;
+    WorkerListener listener_;
+};
+
+/**
+ * Batch result sink calling BatchResultListener.onResult on the decode thread.
+ */
+class BatchListener {
+public:
+    BatchListener(JNIEnv* env, jobject listener) : listener_(env, listener) {
+        jclass listener_class = env->GetObjectClass(listener);
+        on_result_ = env->GetMethodID(listener_class, "onResult", "(JILjava/lang/String;)V");
+        env->DeleteLocalRef(listener_class);
+    }
+
+    bool is_valid() const { return on_result_ != nullptr; }
+
+    void operator()(int64_t id, int status, const char* text) const {
+        JNIEnv* env = listener_.env();
+        if (env == nullptr) {
+            return;
+        }
+        jstring result = env->NewStringUTF(text);
+        env->CallVoidMethod(listener_.listener(), on_result_, static_cast<jlong>(id),
+                            static_cast<jint>(status), result);
+        env->DeleteLocalRef(result);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+    }
+
+private:
+    WorkerListener listener_;
+    jmethodID on_result_ = nullptr;
+};
+
+BatchTranscriber* batch_from_handle(jlong batch_ptr) {
+    return reinterpret_cast<BatchTranscriber*>(batch_ptr);
+}
+
+/**
+ * Copy a Java audio array into the context's arena and resample it to
+ * 16 kHz there. Call under job_mutex with the arena freshly reset.
+ *
+ * @return The samples, valid until the next reset, or nullptr on failure
+ */
+const float* load_audio(JNIEnv* env, WhisperJniContext* handle, jfloatArray audio_data, jint sample_rate,
+                        int& n_samples) {
+    ScratchArena& scratch = handle->scratch;
+
+    // Copy audio data into the arena rather than letting ART pin or copy it
+    jsize audio_length = env->GetArrayLength(audio_data);
+    jfloat* audio = scratch.allocate<jfloat>(audio_length);
+
+    if (audio == nullptr || !copy_array_region(env, audio_data, audio_length, audio)) {
+        LOGE("Failed to get audio data");
+        return nullptr;
+    }
+
+    LOGI("Transcribing audio: %d samples at %d Hz", audio_length, sample_rate);
+
+    // Whisper expects 16 kHz input; the resampler is kept while the rate repeats
+    n_samples = audio_length;
+    if (sample_rate == kWhisperSampleRate) {
+        return audio;
+    }
+
+    ScopedStageTimer timer(Stage::Resample);
+    if (handle->resampler == nullptr || handle->resampler_rate != sample_rate) {
+        handle->resampler.reset(new StreamingResampler(sample_rate, kWhisperSampleRate));
+        handle->resampler_rate = sample_rate;
+    }
+    float* resampled = scratch.allocate<float>(resampled_length(audio_length, sample_rate, kWhisperSampleRate));
+    if (resampled == nullptr) {
+        LOGE("Failed to allocate resample buffer");
+        return nullptr;
+    }
+    n_samples = static_cast<int>(resample_buffer(*handle->resampler, audio, audio_length, resampled));
+    return resampled;
+}
+
+/**
+ * Load and optionally trim audio for a decode; the caller holds job_mutex.
+ * Returns 1 with samples and n_samples set, 0 when the VAD found no speech,
+ * -1 on failure. When only the VAD regions are kept, *compacted_regions
+ * points at them afterwards.
+ */
+int prepare_audio(JNIEnv* env, WhisperJniContext* handle, jfloatArray audio_data, jint sample_rate,
+                  jboolean trim_silence, const float*& samples, int& n_samples,
+                  const std::vector<SpeechRegion>** compacted_regions) {
+    if (handle->control.cancelled()) {
+        LOGI("Transcription cancelled before decoding");
+        return -1;
+    }
+
+    ScratchArena& scratch = handle->scratch;
+    scratch.reset();
+
+    n_samples = 0;
+    samples = load_audio(env, handle, audio_data, sample_rate, n_samples);
+    if (samples == nullptr) {
+        return -1;
+    }
+
+    // Only voiced spans reach the encoder; its cost scales with input length
+    if (trim_silence == JNI_TRUE) {
+        std::vector<SpeechRegion>& regions = handle->regions;
+        {
+            ScopedStageTimer timer(Stage::Vad);
+            handle->vad.detect(samples, n_samples, regions);
+        }
+        size_t voiced_length = speech_length(regions);
+        if (voiced_length == 0) {
+            LOGI("No speech detected, skipping inference");
+            return 0;
+        }
+        if (voiced_length < static_cast<size_t>(n_samples)) {
+            float* voiced = scratch.allocate<float>(voiced_length);
+            if (voiced != nullptr) {
+                n_samples = static_cast<int>(compact_speech(samples, regions, voiced));
+                samples = voiced;
+                if (compacted_regions != nullptr) {
+                    *compacted_regions = &regions;
+                }
+                LOGI("VAD kept %zu regions, %d samples", regions.size(), n_samples);
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * Configure whisper parameters for ARM v8 optimization, reporting progress
+ * and checking for cancellation through the context's control.
+ */
+whisper_full_params transcription_params(WhisperJniContext* handle, jboolean translate, bool token_timestamps,
+                                         int n_samples) {
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+
+    wparams.n_threads = handle->n_threads;
+    wparams.translate = translate;
+    wparams.token_timestamps = token_timestamps;
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+    handle->control.install(handle->ctx, wparams, n_samples);
+    return wparams;
+}
+
+/**
+ * Log a failed whisper_full; an abort from a cancel isn't an error.
+ */
+void log_decode_failure(const WhisperJniContext* handle, int result) {
+    if (handle->control.cancelled()) {
+        LOGI("Transcription cancelled");
+    } else {
+        LOGE("Transcription failed with error code: %d", result);
+    }
+}
+
+/**
+ * Load, optionally trim and decode audio on the context's own state; the
+ * caller holds job_mutex, which also keeps the results until it reads
+ * them. Returns 1 once decoded; 0 when the VAD found no speech; -1 on
+ * failure. When only the VAD regions were decoded, *compacted_regions
+ * points at them afterwards.
+ */
+int decode_audio(JNIEnv* env, WhisperJniContext* handle, jfloatArray audio_data, jint sample_rate,
+                 jstring language, jboolean translate, jboolean trim_silence, bool token_timestamps,
+                 const std::vector<SpeechRegion>** compacted_regions) {
+    const float* samples = nullptr;
+    int n_samples = 0;
+    const int prepared = prepare_audio(env, handle, audio_data, sample_rate, trim_silence, samples, n_samples,
+                                       compacted_regions);
+    if (prepared <= 0) {
+        return prepared;
+    }
+
+    whisper_full_params wparams = transcription_params(handle, translate, token_timestamps, n_samples);
+
+    // Set language if specified ("auto" enables whisper's language detection)
+    ScopedUtfChars lang(env, language);
+    if (lang.get() != nullptr) {
+        wparams.language = lang.get();
+    }
+
+    // Process audio; compute threads spawned by ggml inherit the lease's mask
+    int result;
+    {
+        CoreLease lease(handle->n_threads);
+        wparams.n_threads = lease.threads();
+        result = timed_whisper_full(handle->ctx, handle->state, wparams, samples, n_samples);
+    }
+
+    if (result != 0) {
+        log_decode_failure(handle, result);
+        return -1;
+    }
+    handle->control.set_progress(1.0f);
+    return 1;
+}
+
+/**
+ * Join segment texts with single spaces in the arena: size the text first,
+ * then copy it once. Returns nullptr if the arena is exhausted.
+ */
+template <typename SegmentText>
+const char* join_segments(ScratchArena& scratch, int n_segments, SegmentText segment_text) {
+    size_t text_length = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        const char* text = segment_text(i);
+        if (text != nullptr) {
+            text_length += std::strlen(text) + 1;
+        }
+    }
+
+    char* transcription = scratch.allocate<char>(text_length + 1);
+    if (transcription == nullptr) {
+        LOGE("Failed to allocate transcription buffer");
+        return nullptr;
+    }
+
+    size_t written = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        const char* text = segment_text(i);
+        if (text != nullptr) {
+            const size_t length = std::strlen(text);
+            std::memcpy(transcription + written, text, length);
+            written += length;
+            if (i < n_segments - 1) {
+                transcription[written++] = ' ';
+            }
+        }
+    }
+    transcription[written] = '\0';
+    return transcription;
+}
+
+bool count_encoder_pass(whisper_context* /* ctx */, whisper_state* /* state */, void* user_data) {
+    ++*static_cast<int*>(user_data);
+    return true;
+}
+
+/**
+ * Join the segments of a whisper_full run on a cache state into out.
+ */
+bool join_cached_segments(WhisperJniContext* handle, whisper_state* state, std::string& out) {
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    const char* text = join_segments(handle->scratch, n_segments, [state](int i) {
+        return whisper_full_get_segment_text_from_state(state, i);
+    });
+    if (text == nullptr) {
+        return false;
+    }
+    out = text;
+    handle->control.set_progress(1.0f);
+    LOGI("Transcription completed: %d segments", n_segments);
+    return true;
+}
+
+/**
+ * Transcribe at most 30 s of prepared audio through the model's encoder
+ * cache; the caller holds job_mutex. Both a hit and a miss run whisper_full
+ * with the same params, so they produce the same text: a hit on the cached
+ * state, decoding its encoding again; a miss on a fresh cache state, which
+ * keeps the encoding for the next call with the same audio.
+ *
+ * @return True with the text in out; false to fall back to the default state
+ */
+bool transcribe_cached(WhisperJniContext* handle, const float* samples, int n_samples, const char* language,
+                       jboolean translate, const char* prompt, std::string& out) {
+    EncoderCache& cache = *handle->model->encoder_cache;
+    const uint64_t key = EncoderCache::hash_audio(samples, static_cast<size_t>(n_samples));
+
+    whisper_full_params wparams = transcription_params(handle, translate, false, n_samples);
+    if (language != nullptr) {
+        wparams.language = language;
+    }
+    wparams.initial_prompt = prompt;
+
+    if (std::shared_ptr<CachedEncoding> hit = cache.find(key)) {
+        // Cached states are shared by every context on the model
+        std::lock_guard<std::mutex> lock(hit->mutex);
+        int result;
+        {
+            CoreLease lease(handle->n_threads);
+            wparams.n_threads = lease.threads();
+            result = decode_cached(handle->ctx, *hit, key, wparams);
+        }
+        if (result == 0) {
+            LOGI("Decoded from cached encoding %016llx", static_cast<unsigned long long>(key));
+            return join_cached_segments(handle, hit->state, out);
+        }
+        log_decode_failure(handle, result);
+        if (handle->control.cancelled()) {
+            return false;
+        }
+    }
+
+    std::shared_ptr<CachedEncoding> entry = cache.create();
+    if (entry == nullptr) {
+        return false;
+    }
+
+    // The entry is private until inserted, so no lock while it decodes
+    int n_encodes = 0;
+    wparams.encoder_begin_callback = count_encoder_pass;
+    wparams.encoder_begin_callback_user_data = &n_encodes;
+    int result;
+    {
+        CoreLease lease(handle->n_threads);
+        wparams.n_threads = lease.threads();
+        result = timed_whisper_full(handle->ctx, entry->state, wparams, samples, n_samples);
+    }
+    if (result != 0) {
+        log_decode_failure(handle, result);
+        return false;
+    }
+    if (!join_cached_segments(handle, entry->state, out)) {
+        return false;
+    }
+
+    // A decode that ended early encodes again from a later offset, and the
+    // last pass is what the state keeps
+    if (n_encodes == 1) {
+        const int lang_id = whisper_full_lang_id_from_state(entry->state);
+        cache.insert(std::move(entry), key, lang_id);
+    }
+    return true;
+}
+
+/**
+ * Copy the context's packed result into a direct ByteBuffer; the caller
+ * holds job_mutex.
+ *
+ * @return Bytes written, the negated size needed if the buffer is too
+ *         small, or 0 if buffer is not a direct buffer
+ */
+jint copy_packed(JNIEnv* env, WhisperJniContext* handle, jobject buffer) {
+    void* address = buffer != nullptr ? env->GetDirectBufferAddress(buffer) : nullptr;
+    if (address == nullptr) {
+        LOGE("Result buffer is not a direct ByteBuffer");
+        return 0;
+    }
+    const jint size = static_cast<jint>(handle->packed.size());
+    if (env->GetDirectBufferCapacity(buffer) < size) {
+        return -size;
+    }
+    std::memcpy(address, handle->packed.data(), handle->packed.size());
+    return size;
+}
+
+bool source_failed(const PcmFileReader& /* reader */) { return false; }
+bool source_failed(const MediaDecoder& decoder) { return decoder.failed(); }
+
+/**
+ * Body of transcribeFile for either file source: read one-second blocks
+ * from source through a 30 s streaming session and hand each committed
+ * segment to on_segment. A cancel on the context's control aborts the
+ * decode in progress; progress is the share of total_frames read, or jumps
+ * to 1 at the end when the length is unknown (0). Returns the number
+ * delivered, or -1.
+ */
+template <typename Source>
+jint transcribe_source(JNIEnv* env, WhisperJniContext* handle, Source& source, int sample_rate,
+                       uint64_t total_frames, WhisperStreamParams params, jobject listener,
+                       jmethodID on_segment) {
+    params.sample_rate = sample_rate;
+    params.control = &handle->control;
+    WhisperStream stream(handle->ctx, params);
+    if (!stream.is_valid()) {
+        LOGE("Cannot transcribe %d Hz audio", sample_rate);
+        return -1;
+    }
+
+    std::vector<float> block(static_cast<size_t>(sample_rate));
+    std::vector<StreamSegment> segments;
+    jint delivered = 0;
+    uint64_t read_frames = 0;
+    for (bool done = false; !done;) {
+        if (handle->control.cancelled()) {
+            LOGI("File transcription cancelled after %d segments", delivered);
+            return -1;
+        }
+        const size_t n = source.read(block.data(), block.size());
+        if (n == 0 && source_failed(source)) {
+            LOGE("Decoding failed after %d segments", delivered);
+            return -1;
+        }
+        bool ok;
+        if (n > 0) {
+            ok = stream.push(block.data(), n, segments);
+        } else {
+            ok = stream.finish(segments);
+            done = true;
+        }
+        if (!ok) {
+            if (handle->control.cancelled()) {
+                LOGI("File transcription cancelled after %d segments", delivered);
+            } else {
+                LOGE("File transcription failed after %d segments", delivered);
+            }
+            return -1;
+        }
+        read_frames += n;
+        if (total_frames > 0) {
+            handle->control.set_progress(static_cast<float>(read_frames) / static_cast<float>(total_frames));
+        }
+
+        for (const StreamSegment& segment : segments) {
+            jstring text = env->NewStringUTF(segment.text.c_str());
+            env->CallVoidMethod(listener, on_segment, text,
+                                static_cast<jlong>(segment.start_ms),
+                                static_cast<jlong>(segment.end_ms));
+            env->DeleteLocalRef(text);
+            if (env->ExceptionCheck()) {
+                return -1;  // let the exception propagate to the Kotlin caller
+            }
+            ++delivered;
+        }
+        segments.clear();
+    }
+
+    handle->control.set_progress(1.0f);
+    LOGI("File transcription completed: %d segments", delivered);
+    return delivered;
+}
+
+/**
+ * Load a model for a GPU device and check that it can decode, so a broken
+ * driver is caught here rather than by the first transcription.
+ */
+std::shared_ptr<SharedModel> acquire_gpu_model(const char* path, int gpu_device, int n_threads) {
+    const whisper_context_params cparams = backend_context_params(InferenceBackend::Gpu, gpu_device);
+    if (!cparams.use_gpu) {
+        return nullptr;
+    }
+    std::shared_ptr<SharedModel> model = acquire_model(path, cparams);
+    if (model == nullptr) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(model->mutex);
+    if (!model->verified) {
+        CoreLease lease(n_threads);
+        model->verified = warm_up_model(model->ctx, lease.threads());
+    }
+    return model->verified ? model : nullptr;
+}
+
+} // namespace
+
+extern "C" {
+
+/**
+ * Get version information from whisper.cpp
+ */
+JNIEXPORT jstring JNICALL
+Java_com_app_whisper_native_WhisperNative_getVersionInfo(
+    JNIEnv* env,
+    jobject /* this */) {
+
+    LOGI("Getting Whisper version info");
+
+    std::string version = "Whisper.cpp Android v1.0.0 - Build: ";
+    version += __DATE__;
+    version += " ";
+    version += __TIME__;
+    version += " - ";
+    version += whisper_print_system_info();
+
+    return env->NewStringUTF(version.c_str());
+}
+
+/**
+ * Number of performance cores detected from cpu_capacity.
+ * Returns 0 when the topology could not be read.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_getBigCoreCount(
+    JNIEnv* /* env */,
+    jobject /* this */) {
+
+    return static_cast<jint>(cpu_topology().big_cores.size());
+}
+
+/**
+ * Set the threads all decodes in the process share; 0 or less restores
+ * the default of one per core
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_setCoreBudget(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint threads) {
+
+    core_arbiter().set_budget(threads > 0 ? threads : cpu_topology().n_cpus);
+}
+
+/**
+ * Threads all decodes in the process share
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_getCoreBudget(
+    JNIEnv* /* env */,
+    jobject /* this */) {
+
+    return static_cast<jint>(core_arbiter().budget());
+}
+
+/**
+ * GPU devices whisper can use as [name, description] pairs, in gpu_device order
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_app_whisper_native_InferenceAccelerators_nativeProbeDevices(
+    JNIEnv* env,
+    jobject /* this */) {
+
+    const std::vector<AcceleratorDevice> devices = probe_accelerators();
+    jclass string_class = env->FindClass("java/lang/String");
+    if (string_class == nullptr) {
+        return nullptr;
+    }
+    jobjectArray array = env->NewObjectArray(static_cast<jsize>(devices.size() * 2), string_class, nullptr);
+    env->DeleteLocalRef(string_class);
+    if (array == nullptr) {
+        LOGE("Failed to create accelerator array");
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < devices.size(); ++i) {
+        jstring name = env->NewStringUTF(devices[i].name.c_str());
+        jstring description = env->NewStringUTF(devices[i].description.c_str());
+        env->SetObjectArrayElement(array, static_cast<jsize>(i * 2), name);
+        env->SetObjectArrayElement(array, static_cast<jsize>(i * 2 + 1), description);
+        env->DeleteLocalRef(name);
+        env->DeleteLocalRef(description);
+    }
+    return array;
+}
+
+/**
+ * Memory of the same devices as [free, total] byte pairs
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_app_whisper_native_InferenceAccelerators_nativeProbeMemory(
+    JNIEnv* env,
+    jobject /* this */) {
+
+    const std::vector<AcceleratorDevice> devices = probe_accelerators();
+    std::vector<jlong> values;
+    values.reserve(devices.size() * 2);
+    for (const AcceleratorDevice& device : devices) {
+        values.push_back(static_cast<jlong>(device.memory_free));
+        values.push_back(static_cast<jlong>(device.memory_total));
+    }
+
+    jlongArray array = env->NewLongArray(static_cast<jsize>(values.size()));
+    if (array == nullptr) {
+        LOGE("Failed to create accelerator memory array");
+        return nullptr;
+    }
+    env->SetLongArrayRegion(array, 0, static_cast<jsize>(values.size()), values.data());
+    return array;
+}
+
+/**
+ * Initialize Whisper context from model file, on the GPU when backend asks
+ * for it and the device loads and decodes, otherwise on the CPU
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WhisperNative_initContext(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring model_path,
+    jint n_threads,
+    jint backend,
+    jint gpu_device) {
+
+    const char* path = env->GetStringUTFChars(model_path, nullptr);
+    const int threads = n_threads > 0 ? n_threads : 1;
+    LOGI("Initializing Whisper context from: %s (threads=%d, backend=%d)", path, threads, backend);
+
+    // Memory-mapped load, or the already loaded model for this file
+    InferenceBackend selected = InferenceBackend::Cpu;
+    std::shared_ptr<SharedModel> model;
+    if (backend == static_cast<jint>(InferenceBackend::Gpu)) {
+        model = acquire_gpu_model(path, gpu_device, threads);
+        if (model != nullptr) {
+            selected = InferenceBackend::Gpu;
+        } else {
+            LOGE("GPU device %d unusable, falling back to CPU", gpu_device);
+        }
+    }
+    if (model == nullptr) {
+        model = acquire_model(path, backend_context_params(InferenceBackend::Cpu, 0));
+    }
+
+    env->ReleaseStringUTFChars(model_path, path);
+
+    if (model == nullptr) {
+        LOGE("Failed to initialize Whisper context");
+        return 0;
+    }
+
+    auto* handle = new WhisperJniContext();
+    handle->model = std::move(model);
+    handle->ctx = handle->model->ctx;
+    handle->state = whisper_init_state(handle->ctx);
+    handle->n_threads = threads;
+    handle->backend = selected;
+    if (handle->state == nullptr) {
+        LOGE("Failed to create decoder state");
+        delete handle;
+        return 0;
+    }
+
+    LOGI("Whisper context initialized successfully on %s", backend_name(selected));
+    return reinterpret_cast<jlong>(handle);
+}
+
+/**
+ * Backend a context ended up on after any fallback, as InferenceBackend's ordinal
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_getContextBackend(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr) {
+        return -1;
+    }
+    return static_cast<jint>(handle->backend);
+}
+
+/**
+ * Start reading a model file into the page cache without loading it
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_prefetchModel(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring model_path) {
+
+    const char* path = env->GetStringUTFChars(model_path, nullptr);
+    const bool prefetched = prefetch_model_file(path);
+    env->ReleaseStringUTFChars(model_path, path);
+    return prefetched ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Run a tiny decode on the context so the first transcription starts warm
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_warmupContext(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return JNI_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lock(handle->mutex());
+    CoreLease lease(handle->n_threads);
+    return warm_up_model(handle->ctx, lease.threads()) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Free cached models nobody holds, keeping at most max_idle of them
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_trimModelCache(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint max_idle) {
+
+    return static_cast<jint>(trim_model_cache(max_idle > 0 ? static_cast<size_t>(max_idle) : 0));
+}
+
+/**
+ * Set the memory each model's encoder cache may use; 0 disables it
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_setEncoderCacheCapacity(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong max_bytes) {
+
+    set_encoder_cache_capacity(max_bytes > 0 ? static_cast<size_t>(max_bytes) : 0);
+}
+
+/**
+ * Evict cached encodings until each model's cache holds at most max_bytes
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WhisperNative_trimEncoderCache(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong max_bytes) {
+
+    return static_cast<jlong>(trim_encoder_caches(max_bytes > 0 ? static_cast<size_t>(max_bytes) : 0));
+}
+
+/**
+ * Memory held by cached encodings across all models
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WhisperNative_getEncoderCacheBytes(
+    JNIEnv* /* env */,
+    jobject /* this */) {
+
+    return static_cast<jlong>(encoder_cache_bytes());
+}
+
+/**
+ * Start a new one-shot job on the context: clear a previous cancel and the
+ * progress. Called before transcribeAudio or transcribeAudioPacked, so a
+ * cancel arriving before the decode starts isn't lost.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_resetTranscription(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle != nullptr) {
+        handle->control.reset();
+    }
+}
+
+/**
+ * Abort the context's one-shot transcription within one encoder or decoder
+ * step; safe to call from any thread while it runs
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_cancelTranscription(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle != nullptr) {
+        handle->control.cancel();
+    }
+}
+
+/**
+ * Fraction of the audio the context's one-shot transcription has decoded
+ */
+JNIEXPORT jfloat JNICALL
+Java_com_app_whisper_native_WhisperNative_getTranscriptionProgress(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    return handle != nullptr ? handle->control.progress() : 0.0f;
+}
+
+/**
+ * Transcribe audio data using Whisper. A non-empty prompt conditions the
+ * decoder (whisper's initial prompt). Input of at most 30 s goes through
+ * the model's encoder cache when it has a capacity.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_app_whisper_native_WhisperNative_transcribeAudio(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jfloatArray audio_data,
+    jint sample_rate,
+    jstring language,
+    jboolean translate,
+    jboolean trim_silence,
+    jstring prompt) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return env->NewStringUTF("");
+    }
+
+    std::lock_guard<std::mutex> job(handle->job_mutex);
+    const float* samples = nullptr;
+    int n_samples = 0;
+    if (prepare_audio(env, handle, audio_data, sample_rate, trim_silence, samples, n_samples, nullptr) <= 0) {
+        return env->NewStringUTF("");
+    }
+
+    ScopedUtfChars lang(env, language);
+    ScopedUtfChars prompt_chars(env, prompt);
+    const char* initial_prompt =
+        prompt_chars.get() != nullptr && prompt_chars.get()[0] != '\0' ? prompt_chars.get() : nullptr;
+
+    if (n_samples <= kMaxCachedSamples && handle->model->encoder_cache->is_enabled()) {
+        std::string text;
+        if (transcribe_cached(handle, samples, n_samples, lang.get(), translate, initial_prompt, text)) {
+            LOGD("Transcription result: %s", text.c_str());
+            return env->NewStringUTF(text.c_str());
+        }
+        if (handle->control.cancelled()) {
+            return env->NewStringUTF("");
+        }
+    }
+
+    whisper_full_params wparams = transcription_params(handle, translate, false, n_samples);
+    if (lang.get() != nullptr) {
+        wparams.language = lang.get();
+    }
+    wparams.initial_prompt = initial_prompt;
+
+    int result;
+    {
+        CoreLease lease(handle->n_threads);
+        wparams.n_threads = lease.threads();
+        result = timed_whisper_full(handle->ctx, handle->state, wparams, samples, n_samples);
+    }
+    if (result != 0) {
+        log_decode_failure(handle, result);
+        return env->NewStringUTF("");
+    }
+    handle->control.set_progress(1.0f);
+
+    int n_segments = whisper_full_n_segments_from_state(handle->state);
+    LOGI("Transcription completed: %d segments", n_segments);
+
+    const char* transcription = join_segments(handle->scratch, n_segments, [handle](int i) {
+        return whisper_full_get_segment_text_from_state(handle->state, i);
+    });
+    if (transcription == nullptr) {
+        return env->NewStringUTF("");
+    }
+
+    LOGD("Transcription result: %s", transcription);
+    return env->NewStringUTF(transcription);
+}
+
+/**
+ * Transcribe audio like transcribeAudio, but return segments, their tokens,
+ * token timestamps and probabilities in the packed_result.h layout, written
+ * into a caller-supplied direct ByteBuffer instead of one joined string.
+ * Times are on the original audio even when silence was trimmed.
+ *
+ * If the buffer is too small the negated size needed is returned and the
+ * result is kept until copyPackedResult fetches it or the next call.
+ *
+ * @return Bytes written, the negated size needed, or 0 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_transcribeAudioPacked(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jfloatArray audio_data,
+    jint sample_rate,
+    jstring language,
+    jboolean translate,
+    jboolean trim_silence,
+    jobject buffer) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> job(handle->job_mutex);
+    handle->packed.clear();
+
+    const std::vector<SpeechRegion>* regions = nullptr;
+    const int decoded = decode_audio(env, handle, audio_data, sample_rate, language, translate, trim_silence,
+                                     true, &regions);
+    if (decoded < 0) {
+        return 0;
+    }
+    if (decoded == 0) {
+        const PackedHeader header = {kPackedResultVersion, 0, 0, 0};
+        handle->packed.resize(sizeof(header));
+        std::memcpy(handle->packed.data(), &header, sizeof(header));
+    } else {
+        pack_result(handle->ctx, handle->state, regions, handle->packed);
+        LOGI("Transcription completed: %d segments, %zu bytes packed",
+             whisper_full_n_segments_from_state(handle->state), handle->packed.size());
+    }
+    return copy_packed(env, handle, buffer);
+}
+
+/**
+ * Copy the result of the last transcribeAudioPacked call that didn't fit.
+ *
+ * @return Bytes written, the negated size needed, or 0 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_copyPackedResult(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jobject buffer) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr) {
+        LOGE("Invalid Whisper context");
+        return 0;
+    }
+    std::lock_guard<std::mutex> job(handle->job_mutex);
+    if (handle->packed.empty()) {
+        LOGE("No packed result to copy");
+        return 0;
+    }
+    return copy_packed(env, handle, buffer);
+}
+
+/**
+ * Transcribe a long recording as VAD-bounded chunks decoded concurrently on
+ * n_states whisper states of the context's model, delivering the stitched
+ * segments in order to TimedSegmentListener.onSegment on the calling thread.
+ * cancelTranscription aborts every chunk; progress advances per chunk.
+ *
+ * @return Number of segments delivered, or -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_transcribeParallel(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jfloatArray audio_data,
+    jint sample_rate,
+    jstring language,
+    jboolean translate,
+    jint n_states,
+    jobject listener) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return -1;
+    }
+
+    jclass listener_class = env->GetObjectClass(listener);
+    jmethodID on_segment = env->GetMethodID(listener_class, "onSegment", "(Ljava/lang/String;JJ)V");
+    env->DeleteLocalRef(listener_class);
+    if (on_segment == nullptr) {
+        LOGE("TimedSegmentListener.onSegment not found");
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> job(handle->job_mutex);
+    handle->scratch.reset();
+
+    int n_samples = 0;
+    const float* samples = load_audio(env, handle, audio_data, sample_rate, n_samples);
+    if (samples == nullptr) {
+        return -1;
+    }
+
+    std::vector<SpeechRegion>& regions = handle->regions;
+    {
+        ScopedStageTimer timer(Stage::Vad);
+        handle->vad.detect(samples, n_samples, regions);
+    }
+
+    ParallelParams params;
+    params.translate = translate == JNI_TRUE;
+    params.control = &handle->control;
+    params.n_states = std::max(static_cast<int>(n_states), 1);
+    // Independent states scale better than more threads on one, so the
+    // leased cores are split between them rather than pinned to the big cluster
+    CoreLease lease(cpu_topology().n_cpus, false);
+    params.n_threads = std::max(lease.threads() / params.n_states, 1);
+    if (language != nullptr) {
+        const char* lang = env->GetStringUTFChars(language, nullptr);
+        params.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
+    }
+
+    std::vector<ChunkSpan> chunks;
+    plan_chunks(regions,
+                static_cast<size_t>(params.target_chunk_ms) * kWhisperSampleRate / 1000,
+                static_cast<size_t>(params.max_chunk_ms) * kWhisperSampleRate / 1000,
+                chunks);
+
+    std::vector<TimedSegment> segments;
+    if (!transcribe_chunks(handle->ctx, params, samples, chunks, segments)) {
+        if (handle->control.cancelled()) {
+            LOGI("Parallel transcription cancelled");
+        } else {
+            LOGE("Parallel transcription failed");
+        }
+        return -1;
+    }
+    handle->control.set_progress(1.0f);
+    LOGI("Parallel transcription completed: %zu chunks, %zu segments", chunks.size(), segments.size());
+
+    for (const TimedSegment& segment : segments) {
+        jstring text = env->NewStringUTF(segment.text.c_str());
+        env->CallVoidMethod(listener, on_segment, text,
+                            static_cast<jlong>(segment.start_ms),
+                            static_cast<jlong>(segment.end_ms));
+        env->DeleteLocalRef(text);
+        if (env->ExceptionCheck()) {
+            return -1;  // let the exception propagate to the Kotlin caller
+        }
+    }
+    return static_cast<jint>(segments.size());
+}
+
+/**
+ * Transcribe an audio file without loading it: the file is read in
+ * one-second blocks through a streaming session with 30 s windows and no
+ * partial decodes, so memory stays constant whatever the length. WAV and
+ * raw 16-bit PCM are read directly; anything else (AAC/m4a, Opus, MP3, ...)
+ * is decoded by MediaDecoder on its own thread while the previous window is
+ * transcribed. Segments are delivered to TimedSegmentListener.onSegment on
+ * the calling thread as each window is committed. cancelTranscription
+ * aborts the window being decoded; progress follows the audio read.
+ *
+ * @param raw_sample_rate Format of a headerless PCM file, or 0 to detect it
+ * @return Number of segments delivered, or -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_transcribeFile(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jstring path,
+    jint raw_sample_rate,
+    jint raw_channels,
+    jstring language,
+    jboolean translate,
+    jobject listener) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr || path == nullptr) {
+        LOGE("Invalid Whisper context");
+        return -1;
+    }
+
+    jclass listener_class = env->GetObjectClass(listener);
+    jmethodID on_segment = env->GetMethodID(listener_class, "onSegment", "(Ljava/lang/String;JJ)V");
+    env->DeleteLocalRef(listener_class);
+    if (on_segment == nullptr) {
+        LOGE("TimedSegmentListener.onSegment not found");
+        return -1;
+    }
+
+    WhisperStreamParams params;
+    params.window_ms = kFileWindowMs;
+    params.step_ms = kFileWindowMs;
+    params.n_threads = handle->n_threads;
+    params.translate = translate == JNI_TRUE;
+    if (language != nullptr) {
+        const char* lang = env->GetStringUTFChars(language, nullptr);
+        params.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
+    }
+
+    const char* file_path = env->GetStringUTFChars(path, nullptr);
+    PcmFileReader reader;
+    // WAVs the reader rejects (24-bit, float) still go to the platform decoder
+    const bool pcm = (raw_sample_rate > 0 || is_wav_file(file_path)) &&
+                     reader.open(file_path, raw_sample_rate, raw_channels);
+    if (!pcm && raw_sample_rate > 0) {
+        env->ReleaseStringUTFChars(path, file_path);
+        return -1;
+    }
+    if (pcm) {
+        env->ReleaseStringUTFChars(path, file_path);
+        LOGI("Transcribing PCM file: %llu frames at %d Hz, %d channels",
+             static_cast<unsigned long long>(reader.frames_left()), reader.info().sample_rate,
+             reader.info().channels);
+        return transcribe_source(env, handle, reader, reader.info().sample_rate, reader.frames_left(), params,
+                                 listener, on_segment);
+    }
+
+    MediaDecoder decoder;
+    const bool opened = decoder.open(file_path);
+    env->ReleaseStringUTFChars(path, file_path);
+    if (!opened) {
+        return -1;
+    }
+    LOGI("Transcribing compressed file at %d Hz", decoder.sample_rate());
+    const uint64_t total_frames =
+        static_cast<uint64_t>(std::max<int64_t>(decoder.duration_us(), 0)) * decoder.sample_rate() / 1000000;
+    return transcribe_source(env, handle, decoder, decoder.sample_rate(), total_frames, params, listener,
+                             on_segment);
+}
+
+/**
+ * Release Whisper context and free resources
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_releaseContext(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle != nullptr) {
+        LOGI("Releasing Whisper context");
+        delete handle;  // drops the model reference; the cache decides when to free it
+    } else {
+        LOGD("Context already null, nothing to release");
+    }
+}
+
+/**
+ * Get model information
+ */
+JNIEXPORT jstring JNICALL
+Java_com_app_whisper_native_WhisperNative_getModelInfo(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        return env->NewStringUTF("No model loaded");
+    }
+    struct whisper_context* ctx = handle->ctx;
+
+    // Get model information (using available API functions)
+    int n_vocab = whisper_n_vocab(ctx);
+    int n_audio_ctx = whisper_n_audio_ctx(ctx);
+    int n_text_ctx = whisper_n_text_ctx(ctx);
+    int n_len = whisper_n_len(ctx);  // mel length
+    int ftype = whisper_model_ftype(ctx);
+
+    char info[512];
+    snprintf(info, sizeof(info),
+        "vocab: %d, audio_ctx: %d, text_ctx: %d, mel_length: %d, ftype: %d, threads: %d",
+        n_vocab, n_audio_ctx, n_text_ctx, n_len, ftype, handle->n_threads);
+
+    return env->NewStringUTF(info);
+}
+
+/**
+ * Check if model supports multilingual
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_isMultilingual(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        return JNI_FALSE;
+    }
+
+    return whisper_is_multilingual(handle->ctx) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * ggml_ftype of the loaded weights (1 = F16, 2 = Q4_0, 7 = Q8_0, 8 = Q5_0,
+ * 9 = Q5_1); -1 without a model. whisper.cpp picks the matching kernels
+ * per tensor, so this is informational.
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_getModelFileType(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong context_ptr) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        return -1;
+    }
+
+    return static_cast<jint>(whisper_model_ftype(handle->ctx));
+}
+
+/**
+ * Create a sliding-window streaming session on an initialized context
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WhisperNative_streamCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jint sample_rate,
+    jint window_ms,
+    jint step_ms,
+    jstring language,
+    jboolean translate) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return 0;
+    }
+    if (window_ms > kMaxStreamWindowMs) {
+        LOGE("Streaming window %d ms exceeds %d ms", window_ms, kMaxStreamWindowMs);
+        return 0;
+    }
+
+    WhisperStreamParams params;
+    params.sample_rate = sample_rate;
+    params.window_ms = window_ms;
+    params.step_ms = step_ms;
+    params.n_threads = handle->n_threads;
+    params.translate = translate;
+    if (language != nullptr) {
+        const char* lang = env->GetStringUTFChars(language, nullptr);
+        params.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
+    }
+
+    auto* stream = new WhisperJniStream(handle, params);
+    if (!stream->stream.is_valid()) {
+        LOGE("Invalid streaming parameters: %d Hz, window %d ms, step %d ms",
+             sample_rate, window_ms, step_ms);
+        delete stream;
+        return 0;
+    }
+
+    LOGI("Streaming session created: %d Hz, window %d ms, step %d ms", sample_rate, window_ms, step_ms);
+    return reinterpret_cast<jlong>(stream);
+}
+
+/**
+ * Push audio into a streaming session; returns 0 on success, -1 on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_streamPush(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong stream_ptr,
+    jfloatArray audio_data,
+    jobject listener) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream == nullptr) {
+        return -1;
+    }
+
+    jsize length = env->GetArrayLength(audio_data);
+    jfloat* audio = get_array_elements(env, audio_data);
+    if (audio == nullptr) {
+        LOGE("Failed to get audio data");
+        return -1;
+    }
+
+    std::vector<StreamSegment> segments;
+    bool ok = push_stream(stream, audio, length, segments);
+    release_array_elements(env, audio_data, audio, JNI_ABORT);
+
+    dispatch_segments(env, listener, segments);
+    return ok ? 0 : -1;
+}
+
+/**
+ * Feed a streaming session straight from a capture pipeline's worker thread.
+ * Segments are delivered to the listener on that thread. The pipeline must
+ * output at the session's sample rate (16 kHz).
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_streamAttach(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong stream_ptr,
+    jlong capture_ptr,
+    jobject listener) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    auto* capture = reinterpret_cast<CapturePipeline*>(capture_ptr);
+    if (stream == nullptr || capture == nullptr) {
+        return JNI_FALSE;
+    }
+    if (stream->capture != nullptr) {
+        stream->capture->set_sink(nullptr);
+    }
+
+    auto sink = std::make_shared<CaptureSink>(env, stream, listener);
+    capture->set_sink([sink](const float* samples, size_t n) { (*sink)(samples, n); });
+    stream->capture = capture;
+
+    LOGI("Streaming session attached to capture pipeline");
+    return JNI_TRUE;
+}
+
+/**
+ * Stop feeding a streaming session from its capture pipeline.
+ * Waits for a decode already running on the worker to finish.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_streamDetach(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong stream_ptr) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream != nullptr && stream->capture != nullptr) {
+        stream->capture->set_sink(nullptr);  // the sink's destructor clears stream->capture
+    }
+}
+
+/**
+ * Decode the remaining audio of a streaming session as final
+ */
+JNIEXPORT jint JNICALL
+Java_com_app_whisper_native_WhisperNative_streamFinish(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong stream_ptr,
+    jobject listener) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream == nullptr) {
+        return -1;
+    }
+
+    std::vector<StreamSegment> segments;
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        ok = stream->stream.finish(segments);
+    }
+
+    dispatch_segments(env, listener, segments);
+    return ok ? 0 : -1;
+}
+
+/**
+ * Change a streaming session's thread count, step and beam size; applied
+ * from its next push. Safe while the capture worker is decoding.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_streamSetTuning(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong stream_ptr,
+    jint n_threads,
+    jint step_ms,
+    jint beam_size) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream == nullptr) {
+        return JNI_FALSE;
+    }
+
+    WhisperStreamTuning tuning;
+    tuning.n_threads = n_threads;
+    tuning.step_ms = step_ms;
+    tuning.beam_size = beam_size;
+    return stream->stream.set_tuning(tuning) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Decode counters of a streaming session as
+ * [decodes, totalDecodeNs, lastDecodeNs, decodedAudioMs], or null
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_app_whisper_native_WhisperNative_streamGetStats(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong stream_ptr) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream == nullptr) {
+        return nullptr;
+    }
+
+    const WhisperStreamStats stats = stream->stream.stats();
+    const jlong values[] = {
+        static_cast<jlong>(stats.decodes),
+        static_cast<jlong>(stats.total_decode_ns),
+        static_cast<jlong>(stats.last_decode_ns),
+        static_cast<jlong>(stats.decoded_samples * 1000 / WHISPER_SAMPLE_RATE),
+    };
+    constexpr jsize kValueCount = sizeof(values) / sizeof(values[0]);
+
+    jlongArray array = env->NewLongArray(kValueCount);
+    if (array == nullptr) {
+        LOGE("Failed to create stream stats array");
+        return nullptr;
+    }
+    env->SetLongArrayRegion(array, 0, kValueCount, values);
+    return array;
+}
+
+/**
+ * Release a streaming session, detaching it from any capture pipeline first
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_streamRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong stream_ptr) {
+
+    WhisperJniStream* stream = stream_from_handle(stream_ptr);
+    if (stream != nullptr && stream->capture != nullptr) {
+        stream->capture->set_sink(nullptr);
+    }
+    delete stream;
+}
+
+/**
+ * Start a batch queue on the context's model. Results are delivered to
+ * listener on the native decode thread, one per submitted job, in order.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_app_whisper_native_WhisperNative_batchCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong context_ptr,
+    jstring language,
+    jboolean translate,
+    jboolean trim_silence,
+    jobject listener) {
+
+    WhisperJniContext* handle = from_handle(context_ptr);
+    if (handle == nullptr || handle->ctx == nullptr) {
+        LOGE("Invalid Whisper context");
+        return 0;
+    }
+
+    auto sink = std::make_shared<BatchListener>(env, listener);
+    if (!sink->is_valid()) {
+        LOGE("BatchResultListener.onResult not found");
+        return 0;
+    }
+
+    BatchParams params;
+    params.n_threads = handle->n_threads;
+    params.translate = translate == JNI_TRUE;
+    params.trim_silence = trim_silence == JNI_TRUE;
+    if (language != nullptr) {
+        const char* lang = env->GetStringUTFChars(language, nullptr);
+        params.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
+    }
+
+    // The batch holds its own model reference, so it may outlive the context
+    auto* batch = new BatchTranscriber(
+        handle->model, params,
+        [sink](int64_t id, int status, const char* text) { (*sink)(id, status, text); });
+    LOGI("Batch queue created (threads=%d)", params.n_threads);
+    return reinterpret_cast<jlong>(batch);
+}
+
+/**
+ * Queue in-memory audio; the samples are copied before returning
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_batchSubmitSamples(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong batch_ptr,
+    jlong job_id,
+    jfloatArray audio_data,
+    jint sample_rate) {
+
+    BatchTranscriber* batch = batch_from_handle(batch_ptr);
+    if (batch == nullptr || audio_data == nullptr || sample_rate <= 0) {
+        return JNI_FALSE;
+    }
+
+    BatchJob job;
+    job.id = job_id;
+    job.sample_rate = sample_rate;
+    job.samples.resize(static_cast<size_t>(env->GetArrayLength(audio_data)));
+    if (!copy_array_region(env, audio_data, static_cast<jsize>(job.samples.size()), job.samples.data())) {
+        LOGE("Failed to get audio data");
+        return JNI_FALSE;
+    }
+    return batch->submit(std::move(job)) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Queue a 16-bit PCM WAV file, read on the batch's prepare thread
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_app_whisper_native_WhisperNative_batchSubmitFile(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong batch_ptr,
+    jlong job_id,
+    jstring path) {
+
+    BatchTranscriber* batch = batch_from_handle(batch_ptr);
+    if (batch == nullptr || path == nullptr) {
+        return JNI_FALSE;
+    }
+
+    BatchJob job;
+    job.id = job_id;
+    const char* file_path = env->GetStringUTFChars(path, nullptr);
+    job.path = file_path;
+    env->ReleaseStringUTFChars(path, file_path);
+    return batch->submit(std::move(job)) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Drop queued jobs and abort the one decoding; they get no result
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_batchCancel(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong batch_ptr) {
+
+    BatchTranscriber* batch = batch_from_handle(batch_ptr);
+    if (batch != nullptr) {
+        batch->cancel();
+    }
+}
+
+/**
+ * Cancel outstanding jobs, join the batch threads and free the queue.
+ * Must not be called from the result listener.
+ */
+JNIEXPORT void JNICALL
+Java_com_app_whisper_native_WhisperNative_batchRelease(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong batch_ptr) {
+
+    delete batch_from_handle(batch_ptr);
+}
+
+} // extern "C"
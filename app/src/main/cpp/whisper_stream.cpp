@@ -0,0 +1,362 @@
+#include "whisper_stream.h"
+#include "core_arbiter.h"
+#include "perf_stats.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+#define LOG_TAG "WhisperStream"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+constexpr int kWhisperSampleRate = WHISPER_SAMPLE_RATE;
+
+// Cap on the prompt carried between windows; whisper limits it to half of
+// n_text_ctx anyway, and shorter prompts keep the decoder fast.
+constexpr size_t kMaxPromptTokens = 128;
+
+// whisper.cpp keeps at most this many beams
+constexpr int kMaxBeamSize = 8;
+
+// Longest run of tokens a window may repeat from the previous one. The
+// carried keep_ms audio holds a word or two, so this is generous.
+constexpr size_t kMaxOverlapTokens = 16;
+
+// The encoder sees one position per two mel frames. Round the context up
+// so short windows don't fall below what the model decodes reliably.
+constexpr int kAudioCtxGranularity = 64;
+
+size_t ms_to_samples(int ms) {
+    return static_cast<size_t>(std::max(ms, 0)) * kWhisperSampleRate / 1000;
+}
+
+/** Token text without surrounding spaces, lowercased, for overlap matching. */
+std::string token_key(whisper_context* ctx, whisper_token id) {
+    const char* text = whisper_token_to_str(ctx, id);
+    std::string key;
+    for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+        if (!std::isspace(static_cast<unsigned char>(*c))) {
+            key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(*c))));
+        }
+    }
+    return key;
+}
+
+/**
+ * Drop a UTF-8 sequence cut at either end of text. Tokens are byte-level
+ * BPE, so skipping a window's leading tokens, or a segment boundary, can
+ * split a character, and NewStringUTF must not be given the pieces.
+ */
+void trim_partial_utf8(std::string& text) {
+    auto is_continuation = [](unsigned char c) { return (c & 0xC0) == 0x80; };
+
+    size_t begin = 0;
+    while (begin < text.size() && is_continuation(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    text.erase(0, begin);
+
+    // Find the lead byte of the last sequence and check it is complete
+    size_t lead = text.size();
+    while (lead > 0 && text.size() - lead < 4 && is_continuation(static_cast<unsigned char>(text[lead - 1]))) {
+        --lead;
+    }
+    if (lead == 0) {
+        return;
+    }
+    --lead;
+    const unsigned char c = static_cast<unsigned char>(text[lead]);
+    const size_t length = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+    if (text.size() - lead < length) {
+        text.erase(lead);
+    }
+}
+
+} // namespace
+
+WhisperStream::WhisperStream(whisper_context* ctx, const WhisperStreamParams& params)
+    : ctx_(ctx),
+      params_(params),
+      window_samples_(ms_to_samples(params.window_ms)),
+      step_samples_(std::max<size_t>(ms_to_samples(params.step_ms), 1)),
+      keep_samples_(ms_to_samples(params.keep_ms)),
+      mel_(ctx != nullptr ? whisper_model_n_mels(ctx) : 80) {
+    if (params_.sample_rate != kWhisperSampleRate) {
+        resampler_ = std::make_unique<StreamingResampler>(params_.sample_rate, kWhisperSampleRate);
+    }
+    keep_samples_ = std::min(keep_samples_, window_samples_ / 2);
+    if (ctx_ != nullptr) {
+        state_ = whisper_init_state(ctx_);
+        if (state_ == nullptr) {
+            LOGE("Failed to create streaming decoder state");
+        }
+    }
+}
+
+WhisperStream::~WhisperStream() {
+    if (state_ != nullptr) {
+        whisper_free_state(state_);
+    }
+}
+
+bool WhisperStream::is_valid() const {
+    return state_ != nullptr && window_samples_ > 0 &&
+           window_samples_ <= ms_to_samples(kMaxStreamWindowMs) && mel_.is_valid() &&
+           (resampler_ == nullptr || resampler_->is_valid());
+}
+
+int64_t WhisperStream::samples_to_ms(int64_t samples) const {
+    return samples * 1000 / kWhisperSampleRate;
+}
+
+bool WhisperStream::set_tuning(const WhisperStreamTuning& tuning) {
+    if (tuning.n_threads < 1 || tuning.step_ms <= 0 || tuning.beam_size < 1 ||
+        tuning.beam_size > kMaxBeamSize || ms_to_samples(tuning.step_ms) > window_samples_) {
+        LOGE("Invalid streaming tuning: %d threads, step %d ms, beam %d",
+             tuning.n_threads, tuning.step_ms, tuning.beam_size);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(tuning_mutex_);
+    pending_tuning_ = tuning;
+    tuning_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void WhisperStream::apply_pending_tuning() {
+    if (!tuning_pending_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(tuning_mutex_);
+    tuning_pending_.store(false, std::memory_order_relaxed);
+    if (!pending_tuning_) {
+        return;
+    }
+    params_.n_threads = pending_tuning_->n_threads;
+    params_.step_ms = pending_tuning_->step_ms;
+    params_.beam_size = pending_tuning_->beam_size;
+    step_samples_ = std::max<size_t>(ms_to_samples(params_.step_ms), 1);
+    pending_tuning_.reset();
+    LOGD("Streaming tuning applied: %d threads, step %d ms, beam %d",
+         params_.n_threads, params_.step_ms, params_.beam_size);
+}
+
+WhisperStreamStats WhisperStream::stats() const {
+    WhisperStreamStats stats;
+    stats.decodes = decodes_.load(std::memory_order_relaxed);
+    stats.total_decode_ns = total_decode_ns_.load(std::memory_order_relaxed);
+    stats.last_decode_ns = last_decode_ns_.load(std::memory_order_relaxed);
+    stats.decoded_samples = decoded_samples_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool WhisperStream::push(const float* samples, size_t n, std::vector<StreamSegment>& out) {
+    apply_pending_tuning();
+    if (resampler_ != nullptr) {
+        resampled_.resize(resampler_->max_output(n));
+        size_t produced = resampler_->process(samples, n, resampled_.data());
+        if (!append(resampled_.data(), produced, out)) {
+            return false;
+        }
+    } else if (!append(samples, n, out)) {
+        return false;
+    }
+
+    if (undecoded_ >= step_samples_) {
+        return decode(false, out);
+    }
+    return true;
+}
+
+bool WhisperStream::finish(std::vector<StreamSegment>& out) {
+    apply_pending_tuning();
+    if (resampler_ != nullptr) {
+        resampled_.resize(resampler_->max_output(0));
+        size_t produced = resampler_->flush(resampled_.data());
+        if (!append(resampled_.data(), produced, out)) {
+            return false;
+        }
+    }
+
+    if (undecoded_ == 0) {
+        return true;
+    }
+    return decode(true, out);
+}
+
+bool WhisperStream::append(const float* samples, size_t n, std::vector<StreamSegment>& out) {
+    // Fill the window in pieces so a large push still finalizes every window
+    size_t offset = 0;
+    while (offset < n) {
+        size_t take = std::min(window_samples_ - window_length_, n - offset);
+        mel_.append(samples + offset, take);
+        window_length_ += take;
+        undecoded_ += take;
+        offset += take;
+
+        if (window_length_ >= window_samples_ && !decode(true, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t WhisperStream::overlap_tokens() const {
+    if (keep_samples_ == 0 || prompt_.empty()) {
+        return 0;
+    }
+    // Leading text tokens of this decode, as keys
+    const whisper_token eot = whisper_token_eot(ctx_);
+    std::vector<std::string> head;
+    const int n_segments = whisper_full_n_segments_from_state(state_);
+    for (int i = 0; i < n_segments && head.size() < kMaxOverlapTokens; ++i) {
+        const int n_tokens = whisper_full_n_tokens_from_state(state_, i);
+        for (int j = 0; j < n_tokens && head.size() < kMaxOverlapTokens; ++j) {
+            whisper_token id = whisper_full_get_token_id_from_state(state_, i, j);
+            if (id < eot) {
+                head.push_back(token_key(ctx_, id));
+            }
+        }
+    }
+
+    // Longest head that repeats the tail of the committed window
+    for (size_t n = std::min(head.size(), prompt_.size()); n > 0; --n) {
+        const size_t tail = prompt_.size() - n;
+        size_t i = 0;
+        while (i < n && head[i] == token_key(ctx_, prompt_[tail + i])) {
+            ++i;
+        }
+        if (i == n) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+bool WhisperStream::decode(bool final, std::vector<StreamSegment>& out) {
+    const bool beam_search = params_.beam_size > 1;
+    whisper_full_params wparams = whisper_full_default_params(
+        beam_search ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
+    if (beam_search) {
+        wparams.beam_search.beam_size = params_.beam_size;
+    }
+    wparams.language = params_.language.c_str();
+    wparams.translate = params_.translate;
+    wparams.no_context = true;  // context comes from prompt_ instead
+    wparams.prompt_tokens = prompt_.empty() ? nullptr : prompt_.data();
+    wparams.prompt_n_tokens = static_cast<int>(prompt_.size());
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+    if (params_.control != nullptr) {
+        wparams.abort_callback = TranscriptionControl::should_abort;
+        wparams.abort_callback_user_data = params_.control;
+    }
+
+    // With the mel already set and no samples, whisper_full skips its own
+    // frontend. The mel carries 30 s of padding like whisper's, so bound
+    // decoding to the frames that hold audio.
+    int n_len = 0;
+    const int n_audio_frames = mel_.window_mel(mel_window_, n_len);
+    wparams.duration_ms = n_audio_frames * 10;
+    // Encode only the window too; the full 30 s context would re-encode the
+    // padding on every partial decode
+    const int audio_ctx = (n_audio_frames + 1) / 2 + kAudioCtxGranularity - 1;
+    wparams.audio_ctx = std::min(audio_ctx - audio_ctx % kAudioCtxGranularity,
+                                 whisper_model_n_audio_ctx(ctx_));
+
+    const auto start = std::chrono::steady_clock::now();
+    int result = whisper_set_mel_with_state(ctx_, state_, mel_window_.data(), n_len, mel_.n_mel());
+    if (result == 0) {
+        CoreLease lease(params_.n_threads);
+        wparams.n_threads = lease.threads();
+        result = timed_whisper_full(ctx_, state_, wparams, nullptr, 0);
+    }
+    const auto elapsed_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    decodes_.fetch_add(1, std::memory_order_relaxed);
+    total_decode_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed);
+    last_decode_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    decoded_samples_.fetch_add(undecoded_, std::memory_order_relaxed);
+    undecoded_ = 0;
+    if (result != 0) {
+        LOGE("Streaming decode failed with error code: %d", result);
+        return false;
+    }
+
+    const int64_t window_start_ms = samples_to_ms(window_start_);
+    const int n_segments = whisper_full_n_segments_from_state(state_);
+    const whisper_token eot = whisper_token_eot(ctx_);
+    size_t skip = overlap_tokens();
+    int64_t window_end_ms = committed_end_ms_;
+    for (int i = 0; i < n_segments; ++i) {
+        StreamSegment segment;
+        if (skip == 0) {
+            const char* text = whisper_full_get_segment_text_from_state(state_, i);
+            segment.text = text != nullptr ? text : "";
+        } else {
+            // Rebuild the text without the tokens the last window committed
+            const int n_tokens = whisper_full_n_tokens_from_state(state_, i);
+            for (int j = 0; j < n_tokens; ++j) {
+                whisper_token id = whisper_full_get_token_id_from_state(state_, i, j);
+                if (id >= eot) {
+                    continue;
+                }
+                if (skip > 0) {
+                    --skip;
+                    continue;
+                }
+                const char* text = whisper_token_to_str(ctx_, id);
+                segment.text += text != nullptr ? text : "";
+            }
+        }
+        trim_partial_utf8(segment.text);
+        if (segment.text.empty()) {
+            continue;
+        }
+        // Segment timestamps are in 10 ms units relative to the window
+        segment.start_ms = window_start_ms + whisper_full_get_segment_t0_from_state(state_, i) * 10;
+        segment.end_ms = window_start_ms + whisper_full_get_segment_t1_from_state(state_, i) * 10;
+        segment.start_ms = std::max(segment.start_ms, committed_end_ms_);
+        segment.end_ms = std::max(segment.end_ms, segment.start_ms);
+        segment.is_final = final;
+        window_end_ms = std::max(window_end_ms, segment.end_ms);
+        out.push_back(std::move(segment));
+    }
+
+    if (!final) {
+        return true;
+    }
+
+    committed_end_ms_ = window_end_ms;
+
+    // Carry the committed text into the next window as its prompt
+    prompt_.clear();
+    for (int i = 0; i < n_segments; ++i) {
+        const int n_tokens = whisper_full_n_tokens_from_state(state_, i);
+        for (int j = 0; j < n_tokens; ++j) {
+            whisper_token id = whisper_full_get_token_id_from_state(state_, i, j);
+            if (id < eot) {
+                prompt_.push_back(id);
+            }
+        }
+    }
+    if (prompt_.size() > kMaxPromptTokens) {
+        prompt_.erase(prompt_.begin(), prompt_.end() - kMaxPromptTokens);
+    }
+
+    // Cut on a frame boundary so the frames kept stay valid
+    size_t keep = std::min(keep_samples_, window_length_);
+    size_t dropped = window_length_ - keep;
+    dropped -= dropped % kMelHop;
+    mel_.drop_frames(dropped / kMelHop);
+    window_length_ -= dropped;
+    window_start_ += static_cast<int64_t>(dropped);
+
+    LOGD("Committed window: %d segments, %zu prompt tokens", n_segments, prompt_.size());
+    return true;
+}
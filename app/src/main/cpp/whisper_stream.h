@@ -0,0 +1,149 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mel_frontend.h"
+#include "resampler.h"
+#include "transcription_control.h"
+
+/**
+ * A transcribed segment produced by a streaming session.
+ * Timestamps are in milliseconds from the start of the stream.
+ */
+struct StreamSegment {
+    std::string text;
+    int64_t start_ms = 0;
+    int64_t end_ms = 0;
+    bool is_final = false;
+};
+
+/** Longest window a stream decodes; whisper's encoder takes at most 30 s. */
+constexpr int kMaxStreamWindowMs = 30000;
+
+struct WhisperStreamParams {
+    int sample_rate = 16000;   // rate of the audio passed to push()
+    int window_ms = 10000;     // audio decoded per window, at most kMaxStreamWindowMs
+    int step_ms = 2000;        // new audio required before a partial decode
+    int keep_ms = 200;         // audio carried into the next window
+    int n_threads = 1;
+    int beam_size = 1;         // 1 decodes greedily, more runs beam search
+    std::string language = "auto";
+    bool translate = false;
+    TranscriptionControl* control = nullptr;  // a cancel on it aborts decodes, may be null
+};
+
+/** Decoder settings that can change while a session runs. */
+struct WhisperStreamTuning {
+    int n_threads = 1;
+    int step_ms = 2000;
+    int beam_size = 1;
+};
+
+/** Decode counters of a session since it was created. */
+struct WhisperStreamStats {
+    uint64_t decodes = 0;
+    uint64_t total_decode_ns = 0;
+    uint64_t last_decode_ns = 0;
+    uint64_t decoded_samples = 0;  // new audio consumed by those decodes, at 16 kHz
+};
+
+/**
+ * Sliding-window transcription over a live audio stream.
+ *
+ * Audio accumulates in a window of up to window_ms. Every step_ms of new
+ * audio the whole window is decoded and its segments are reported as
+ * partial results, which replace the previous partial result. Once the
+ * window is full it is decoded one last time, its segments are reported as
+ * final, the tokens become the prompt for the next window, and only the
+ * last keep_ms of audio is carried over so words straddling the boundary
+ * are not cut. Tokens a window repeats from the end of the committed one,
+ * which is what that carried audio usually decodes to, are dropped from its
+ * segments, and no segment starts before the committed text ends.
+ *
+ * Each decode encodes only the window's frames (audio_ctx), not whisper's
+ * full 30 s context.
+ *
+ * Audio is not kept as samples: a MelFrontend turns it into log-mel frames
+ * as it arrives, and each decode hands whisper the window's frames through
+ * whisper_set_mel, so the overlap between successive partial decodes never
+ * goes through the frontend twice.
+ *
+ * Thread count, step and beam size can be changed mid-stream with
+ * set_tuning(); the change is picked up by the next push() or finish().
+ * Every decode is timed, so a scheduler can compare decode time against
+ * the audio it covered and retune before the session falls behind.
+ *
+ * The session decodes on its own whisper_state of the borrowed
+ * whisper_context, so sessions on one model run concurrently with each
+ * other and with the context's other work; each decode leases its threads
+ * from core_arbiter(). Callers must serialize push() and finish() on one
+ * session. set_tuning() and stats() may be called from any thread.
+ */
+class WhisperStream {
+public:
+    WhisperStream(whisper_context* ctx, const WhisperStreamParams& params);
+    ~WhisperStream();
+
+    WhisperStream(const WhisperStream&) = delete;
+    WhisperStream& operator=(const WhisperStream&) = delete;
+
+    bool is_valid() const;
+    int n_threads() const { return params_.n_threads; }
+
+    /**
+     * Append audio and decode any windows that became due.
+     * Segments produced are appended to out. Returns false if whisper failed.
+     */
+    bool push(const float* samples, size_t n, std::vector<StreamSegment>& out);
+
+    /** Decode the remaining audio as final. The session can't be reused after. */
+    bool finish(std::vector<StreamSegment>& out);
+
+    /** Queue new decoder settings. Returns false if they are out of range. */
+    bool set_tuning(const WhisperStreamTuning& tuning);
+
+    WhisperStreamStats stats() const;
+
+private:
+    void apply_pending_tuning();
+    bool append(const float* samples, size_t n, std::vector<StreamSegment>& out);
+    bool decode(bool final, std::vector<StreamSegment>& out);
+    size_t overlap_tokens() const;
+    int64_t samples_to_ms(int64_t samples) const;
+
+    whisper_context* ctx_;
+    whisper_state* state_ = nullptr;
+    WhisperStreamParams params_;
+    std::unique_ptr<StreamingResampler> resampler_;
+    std::vector<float> resampled_;
+
+    size_t window_samples_;
+    size_t step_samples_;
+    size_t keep_samples_;
+
+    MelFrontend mel_;
+    std::vector<float> mel_window_;  // whisper_set_mel input, reused per decode
+    size_t window_length_ = 0;  // samples in the current window
+    int64_t window_start_ = 0;  // stream position of the window start, in samples
+    size_t undecoded_ = 0;      // samples appended since the last decode
+    std::vector<whisper_token> prompt_;  // text tokens of the last committed window
+    int64_t committed_end_ms_ = 0;       // end of the last committed segment
+
+    std::mutex tuning_mutex_;
+    std::optional<WhisperStreamTuning> pending_tuning_;  // guarded by tuning_mutex_
+    std::atomic<bool> tuning_pending_{false};
+
+    std::atomic<uint64_t> decodes_{0};
+    std::atomic<uint64_t> total_decode_ns_{0};
+    std::atomic<uint64_t> last_decode_ns_{0};
+    std::atomic<uint64_t> decoded_samples_{0};
+};
@@ -5,6 +5,7 @@ import android.util.Log
 import androidx.tracing.trace
 import com.app.whisper.BuildConfig
 import com.app.whisper.performance.PerformanceManager
+import com.app.whisper.performance.StartupWarmup
 import dagger.hilt.android.HiltAndroidApp
 import timber.log.Timber
 import javax.inject.Inject
@@ -24,6 +25,9 @@ class WhisperApplication : Application() {
     @Inject
     lateinit var performanceManager: PerformanceManager
 
+    @Inject
+    lateinit var startupWarmup: StartupWarmup
+
     override fun onCreate() {
         super.onCreate()
 
@@ -37,6 +41,9 @@ class WhisperApplication : Application() {
             // Initialize performance monitoring
             initializePerformanceMonitoring()
 
+            // Warm up the native library and last model in the background
+            startupWarmup.start()
+
             // Initialize crash reporting (if needed)
             initializeCrashReporting()
 
@@ -3,6 +3,10 @@ package com.app.whisper.data.audio
 import androidx.tracing.trace
 import com.app.whisper.data.model.AudioData
 import com.app.whisper.data.model.WaveformData
+import com.app.whisper.native.AudioProcessor as NativeAudioProcessor
+import com.app.whisper.native.RecordingFile
+import com.app.whisper.native.TimedSegment
+import com.app.whisper.native.WaveformPyramid
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import timber.log.Timber
@@ -28,7 +32,9 @@ import kotlin.math.sqrt
  * and waveform generation optimized for speech recognition.
  */
 @Singleton
-class AudioProcessorImpl @Inject constructor() : AudioProcessor {
+class AudioProcessorImpl @Inject constructor(
+    private val nativeAudioProcessor: NativeAudioProcessor
+) : AudioProcessor {
 
     companion object {
         private const val WHISPER_SAMPLE_RATE = 16000
@@ -120,20 +126,16 @@ class AudioProcessorImpl @Inject constructor() : AudioProcessor {
         trace("AudioProcessorImpl.generateWaveform") {
             try {
                 val samples = audioData.getSamples()
-                val samplesPerPoint = samples.size / targetPoints
-                val waveformPoints = mutableListOf<Float>()
+                val mins = FloatArray(targetPoints)
+                val maxs = FloatArray(targetPoints)
+                val rms = FloatArray(targetPoints)
                 
-                for (i in 0 until targetPoints) {
-                    val startIndex = i * samplesPerPoint
-                    val endIndex = min(startIndex + samplesPerPoint, samples.size)
-                    
-                    var maxAmplitude = 0f
-                    for (j in startIndex until endIndex) {
-                        maxAmplitude = max(maxAmplitude, abs(samples[j]))
-                    }
-                    
-                    waveformPoints.add(maxAmplitude)
+                // Per-point peaks come from the native min/max pyramid in one pass
+                val written = WaveformPyramid(audioData.sampleRate).use { pyramid ->
+                    pyramid.append(samples)
+                    pyramid.query(0L, samples.size.toLong(), mins, maxs, rms)
                 }
+                val waveformPoints = List(written) { max(-mins[it], maxs[it]) }
                 
                 val waveformData = WaveformData(
                     points = waveformPoints,
@@ -150,34 +152,20 @@ class AudioProcessorImpl @Inject constructor() : AudioProcessor {
         }
     }
 
-    override suspend fun trimSilence(audioData: AudioData, threshold: Float): Result<AudioData> = withContext(Dispatchers.IO) {
+    override suspend fun trimSilence(audioData: AudioData, minLevel: Float): Result<AudioData> = withContext(Dispatchers.IO) {
         trace("AudioProcessorImpl.trimSilence") {
             try {
                 val samples = audioData.getSamples()
-                
-                // Find start of audio content
-                var startIndex = 0
-                for (i in samples.indices) {
-                    if (abs(samples[i]) > threshold) {
-                        startIndex = i
-                        break
-                    }
-                }
-                
-                // Find end of audio content
-                var endIndex = samples.size - 1
-                for (i in samples.size - 1 downTo 0) {
-                    if (abs(samples[i]) > threshold) {
-                        endIndex = i
-                        break
-                    }
-                }
-                
-                if (startIndex >= endIndex) {
+
+                // Leading and trailing silence is whatever the VAD leaves outside its regions
+                val regions = nativeAudioProcessor.detectSpeech(samples, audioData.sampleRate, minLevel)
+                if (regions.isEmpty()) {
                     // Audio is all silence
                     return@trace Result.success(audioData.copy(samples = floatArrayOf()))
                 }
-                
+
+                val startIndex = regions.first().start
+                val endIndex = regions.last().end - 1
                 val trimmedSamples = samples.sliceArray(startIndex..endIndex)
                 val trimmedAudio = audioData.copy(samples = trimmedSamples)
                 
@@ -191,6 +179,9 @@ class AudioProcessorImpl @Inject constructor() : AudioProcessor {
     }
 
     override suspend fun saveToFile(audioData: AudioData, outputFile: File): Result<Unit> = withContext(Dispatchers.IO) {
+        if (outputFile.extension == RecordingFile.EXTENSION) {
+            return@withContext saveRecording(audioData, emptyList(), outputFile).map { }
+        }
         trace("AudioProcessorImpl.saveToFile") {
             try {
                 FileOutputStream(outputFile).use { fos ->
@@ -219,21 +210,37 @@ class AudioProcessorImpl @Inject constructor() : AudioProcessor {
         }
     }
 
-    private fun resampleAudio(samples: FloatArray, fromRate: Int, toRate: Int): FloatArray {
-        if (fromRate == toRate) return samples
-        
-        val ratio = fromRate.toDouble() / toRate.toDouble()
-        val newLength = (samples.size / ratio).toInt()
-        val resampled = FloatArray(newLength)
-        
-        for (i in resampled.indices) {
-            val srcIndex = (i * ratio).toInt()
-            if (srcIndex < samples.size) {
-                resampled[i] = samples[srcIndex]
+    override suspend fun saveRecording(
+        audioData: AudioData,
+        segments: List<TimedSegment>,
+        outputFile: File
+    ): Result<Long> = withContext(Dispatchers.IO) {
+        trace("AudioProcessorImpl.saveRecording") {
+            try {
+                val samples = convertToMono(audioData.samples, audioData.channelCount)
+                val codec = RecordingFile.write(outputFile, samples, audioData.sampleRate, segments)
+                if (codec < 0) {
+                    throw IllegalStateException("Failed to write recording: ${outputFile.absolutePath}")
+                }
+
+                Timber.d(
+                    "Recording saved to ${outputFile.absolutePath}: ${outputFile.length()} bytes, " +
+                        if (codec == RecordingFile.CODEC_OPUS) "Opus" else "PCM16"
+                )
+                Result.success(outputFile.length())
+            } catch (e: Exception) {
+                Timber.e(e, "Failed to save recording")
+                Result.failure(e)
             }
         }
+    }
+
+    private fun resampleAudio(samples: FloatArray, fromRate: Int, toRate: Int): FloatArray {
+        if (fromRate == toRate) return samples
         
-        return resampled
+        // Band-limited polyphase resampling in native code
+        return nativeAudioProcessor.resampleAudio(samples, fromRate, toRate)
+            ?: throw IllegalStateException("Native resampling failed: ${fromRate}Hz -> ${toRate}Hz")
     }
 
     private fun convertToMono(samples: FloatArray, channels: Int): FloatArray {
@@ -317,6 +324,29 @@ interface AudioProcessor {
     suspend fun normalizeAudio(audioData: AudioData): Result<AudioData>
     suspend fun reduceNoise(audioData: AudioData): Result<AudioData>
     suspend fun generateWaveform(audioData: AudioData, targetPoints: Int = 100): Result<WaveformData>
-    suspend fun trimSilence(audioData: AudioData, threshold: Float = 0.01f): Result<AudioData>
+
+    /**
+     * Cut the audio down to the span from the first to the last region of
+     * speech found by the native VAD ([NativeAudioProcessor.detectSpeech]),
+     * keeping its padding and the pauses in between.
+     *
+     * @param minLevel Absolute RMS level of a 20 ms frame below which nothing
+     *                 counts as speech, however far it clears the noise floor
+     * @return The trimmed audio, empty if there is no speech
+     */
+    suspend fun trimSilence(
+        audioData: AudioData,
+        minLevel: Float = NativeAudioProcessor.DEFAULT_VAD_MIN_LEVEL
+    ): Result<AudioData>
+
     suspend fun saveToFile(audioData: AudioData, outputFile: File): Result<Unit>
+
+    /**
+     * Save mono audio and its timed segments as a compact recording file
+     * (see [RecordingFile]). [saveToFile] does the same, without segments,
+     * for files with the recording extension.
+     *
+     * @return Size of the written file in bytes
+     */
+    suspend fun saveRecording(audioData: AudioData, segments: List<TimedSegment>, outputFile: File): Result<Long>
 }
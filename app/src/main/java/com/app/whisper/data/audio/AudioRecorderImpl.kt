@@ -11,7 +11,10 @@ import androidx.tracing.trace
 import com.app.whisper.data.model.AudioData
 import com.app.whisper.data.model.AudioRecorderConfig
 import com.app.whisper.data.model.RecordingState
+import com.app.whisper.data.model.WaveformData
 import com.app.whisper.domain.repository.AudioRecorderRepository
+import com.app.whisper.native.AudioProcessor as NativeAudioProcessor
+import com.app.whisper.native.WaveformPyramid
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
@@ -29,6 +32,7 @@ import timber.log.Timber
 import java.io.File
 import java.io.FileOutputStream
 import java.io.IOException
+import java.nio.ByteBuffer
 import javax.inject.Inject
 import javax.inject.Singleton
 
@@ -40,7 +44,8 @@ import javax.inject.Singleton
  */
 @Singleton
 class AudioRecorderImpl @Inject constructor(
-    private val context: Context
+    private val context: Context,
+    private val nativeAudioProcessor: NativeAudioProcessor
 ) : AudioRecorder {
 
     private val scope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
@@ -57,6 +62,11 @@ class AudioRecorderImpl @Inject constructor(
     
     private var config = AudioRecorderConfig.default()
     
+    // Level summary of the current recording; guarded by itself because the
+    // recording loop appends while the UI queries
+    private val waveformLock = Any()
+    private var waveform: WaveformPyramid? = null
+    
     override suspend fun initialize(config: AudioRecorderConfig): Result<Unit> = withContext(Dispatchers.IO) {
         trace("AudioRecorderImpl.initialize") {
             try {
@@ -90,6 +100,13 @@ class AudioRecorderImpl @Inject constructor(
                     return@trace Result.failure(IllegalStateException("Failed to initialize AudioRecord"))
                 }
                 
+                synchronized(waveformLock) {
+                    if (waveform?.sampleRate != config.sampleRate) {
+                        waveform?.close()
+                        waveform = WaveformPyramid(config.sampleRate)
+                    }
+                }
+                
                 Timber.d("AudioRecorder initialized with config: $config")
                 Result.success(Unit)
             } catch (e: Exception) {
@@ -111,6 +128,7 @@ class AudioRecorderImpl @Inject constructor(
                 )
                 
                 this@AudioRecorderImpl.outputFile = outputFile
+                synchronized(waveformLock) { waveform?.reset() }
                 _recordingState.value = RecordingState.RECORDING
                 
                 recorder.startRecording()
@@ -207,11 +225,21 @@ class AudioRecorderImpl @Inject constructor(
         recordingJob?.cancel()
         audioRecord?.release()
         audioRecord = null
+        synchronized(waveformLock) {
+            waveform?.close()
+            waveform = null
+        }
         _recordingState.value = RecordingState.IDLE
         _audioLevels.value = 0f
         Timber.d("AudioRecorder released")
     }
     
+    override fun getWaveform(startMs: Long, endMs: Long, points: Int): WaveformData? = synchronized(waveformLock) {
+        val pyramid = waveform ?: return null
+        val rate = pyramid.sampleRate.toLong()
+        pyramid.waveform(startMs * rate / 1000, endMs * rate / 1000, points)
+    }
+    
     private fun hasAudioPermission(): Boolean {
         return ContextCompat.checkSelfPermission(
             context,
@@ -226,25 +254,27 @@ class AudioRecorderImpl @Inject constructor(
             AudioFormat.ENCODING_PCM_16BIT
         )
         
-        val buffer = ShortArray(bufferSize)
+        // Direct buffers are reused for the whole session: AudioRecord fills the
+        // PCM buffer in place and native code reads it without any heap copy
+        val pcmBuffer = NativeAudioProcessor.allocateDirectBuffer(bufferSize, Short.SIZE_BYTES)
+        val levelBuffer = NativeAudioProcessor.allocateDirectBuffer(bufferSize)
         
         try {
             FileOutputStream(outputFile).use { fos ->
+                val channel = fos.channel
                 while (scope.isActive && _recordingState.value == RecordingState.RECORDING) {
-                    val bytesRead = recorder.read(buffer, 0, buffer.size)
+                    pcmBuffer.clear()
+                    val bytesRead = recorder.read(pcmBuffer, pcmBuffer.capacity())
                     
                     if (bytesRead > 0) {
-                        // Convert to byte array and write to file
-                        val byteBuffer = ByteArray(bytesRead * 2)
-                        for (i in 0 until bytesRead) {
-                            val sample = buffer[i]
-                            byteBuffer[i * 2] = (sample and 0xFF).toByte()
-                            byteBuffer[i * 2 + 1] = ((sample.toInt() shr 8) and 0xFF).toByte()
+                        // Write the PCM bytes straight from the direct buffer
+                        pcmBuffer.limit(bytesRead)
+                        while (pcmBuffer.hasRemaining()) {
+                            channel.write(pcmBuffer)
                         }
-                        fos.write(byteBuffer)
                         
                         // Calculate audio level for visualization
-                        val level = calculateAudioLevel(buffer, bytesRead)
+                        val level = calculateAudioLevel(pcmBuffer, levelBuffer, bytesRead / Short.SIZE_BYTES)
                         _audioLevels.value = level
                     }
                 }
@@ -255,13 +285,11 @@ class AudioRecorderImpl @Inject constructor(
         }
     }
     
-    private fun calculateAudioLevel(buffer: ShortArray, length: Int): Float {
-        var sum = 0.0
-        for (i in 0 until length) {
-            sum += (buffer[i] * buffer[i]).toDouble()
-        }
-        val rms = kotlin.math.sqrt(sum / length)
-        return (rms / Short.MAX_VALUE).toFloat()
+    private fun calculateAudioLevel(pcmBuffer: ByteBuffer, floatBuffer: ByteBuffer, sampleCount: Int): Float {
+        if (sampleCount <= 0) return 0f
+        if (nativeAudioProcessor.pcm16ToFloatDirect(pcmBuffer, sampleCount, floatBuffer) < 0) return 0f
+        synchronized(waveformLock) { waveform?.append(floatBuffer, sampleCount) }
+        return nativeAudioProcessor.calculateRMSDirect(floatBuffer, sampleCount)
     }
 }
 
@@ -277,5 +305,12 @@ interface AudioRecorder {
     suspend fun stopRecording(): Result<AudioData>
     suspend fun pauseRecording(): Result<Unit>
     suspend fun resumeRecording(): Result<Unit>
+    
+    /**
+     * Waveform of the current recording between [startMs] and [endMs] at
+     * [points] resolution, answered from a running summary in O(points);
+     * null before [initialize].
+     */
+    fun getWaveform(startMs: Long, endMs: Long, points: Int): WaveformData?
     fun release()
 }
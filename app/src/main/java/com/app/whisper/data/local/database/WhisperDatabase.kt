@@ -24,7 +24,7 @@ import android.content.Context
  */
 @Database(
         entities = [TranscriptionEntity::class, ModelEntity::class],
-        version = 1,
+        version = 2,
         exportSchema = true
 )
 @TypeConverters(Converters::class)
@@ -69,6 +69,7 @@ abstract class WhisperDatabase : RoomDatabase() {
          */
         private fun getAllMigrations(): Array<Migration> {
             return arrayOf(
+                    MIGRATION_1_2
                     // Future migrations will be added here
                     )
         }
@@ -96,12 +97,14 @@ abstract class WhisperDatabase : RoomDatabase() {
     }
 }
 
-/** Database migration from version 1 to 2 (example for future use). */
+/** Database migration from version 1 to 2: model quantization and measured real-time factor. */
 val MIGRATION_1_2 =
         object : Migration(1, 2) {
             override fun migrate(database: SupportSQLiteDatabase) {
-                // Example migration - add new column to transcriptions table
-                // database.execSQL("ALTER TABLE transcriptions ADD COLUMN new_column TEXT")
+                database.execSQL(
+                        "ALTER TABLE models ADD COLUMN quantization TEXT NOT NULL DEFAULT 'F16'"
+                )
+                database.execSQL("ALTER TABLE models ADD COLUMN real_time_factor REAL")
             }
         }
 
@@ -106,6 +106,23 @@ interface ModelDao {
     @Query("SELECT * FROM models WHERE status = :status ORDER BY name ASC")
     fun getModelsByStatus(status: String): Flow<List<ModelEntity>>
     
+    /**
+     * Get models by weight format.
+     * 
+     * @param quantization ModelQuantization name (e.g. "Q5_1")
+     * @return Flow of models with the specified quantization
+     */
+    @Query("SELECT * FROM models WHERE quantization = :quantization ORDER BY name ASC")
+    fun getModelsByQuantization(quantization: String): Flow<List<ModelEntity>>
+    
+    /**
+     * Get downloaded models that have a measured real-time factor.
+     * 
+     * @return Models ordered from fastest to slowest on this device
+     */
+    @Query("SELECT * FROM models WHERE status = 'Available' AND real_time_factor IS NOT NULL ORDER BY real_time_factor ASC")
+    suspend fun getMeasuredModels(): List<ModelEntity>
+    
     /**
      * Get downloading models.
      * 
@@ -234,6 +251,38 @@ interface ModelDao {
         updatedAt: Long = System.currentTimeMillis()
     )
     
+    /**
+     * Fold one measured real-time factor into the model's moving average.
+     * 
+     * @param modelId Model ID
+     * @param realTimeFactor Processing time divided by audio duration
+     * @param weight Weight of the new measurement (0-1)
+     */
+    @Query("""
+        UPDATE models SET 
+            real_time_factor = CASE 
+                WHEN real_time_factor IS NULL THEN :realTimeFactor
+                ELSE real_time_factor + (:realTimeFactor - real_time_factor) * :weight
+            END,
+            updated_at = :updatedAt
+        WHERE model_id = :modelId
+    """)
+    suspend fun updateModelRealTimeFactor(
+        modelId: String,
+        realTimeFactor: Float,
+        weight: Float = 0.2f,
+        updatedAt: Long = System.currentTimeMillis()
+    )
+    
+    /**
+     * Get the averaged real-time factor of a model.
+     * 
+     * @param modelId Model ID
+     * @return Real-time factor or null if never measured
+     */
+    @Query("SELECT real_time_factor FROM models WHERE model_id = :modelId")
+    suspend fun getModelRealTimeFactor(modelId: String): Float?
+    
     /**
      * Update model download information.
      * 
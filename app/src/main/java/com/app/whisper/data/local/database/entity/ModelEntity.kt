@@ -43,6 +43,12 @@ data class ModelEntity(
     @ColumnInfo(name = "version")
     val version: String? = null,
     
+    @ColumnInfo(name = "quantization")
+    val quantization: String = "F16", // ModelQuantization enum as string
+    
+    @ColumnInfo(name = "real_time_factor")
+    val realTimeFactor: Float? = null, // processing time / audio duration, moving average
+    
     @ColumnInfo(name = "is_multilingual")
     val isMultilingual: Boolean = false,
     
@@ -80,6 +86,15 @@ data class ModelEntity(
         return status == "Available" && !localPath.isNullOrBlank()
     }
     
+    /**
+     * Check if the model file uses quantized weights.
+     * 
+     * @return true for any format other than F16
+     */
+    fun isQuantized(): Boolean {
+        return quantization != "F16"
+    }
+    
     /**
      * Check if model is currently downloading.
      * 
@@ -2,6 +2,7 @@ package com.app.whisper.data.manager
 
 import android.content.Context
 import android.content.SharedPreferences
+import com.app.whisper.domain.entity.ModelSize
 import com.app.whisper.domain.entity.ModelStatus
 import com.app.whisper.domain.entity.WhisperModel
 import com.app.whisper.domain.repository.DownloadProgress
@@ -16,6 +17,8 @@ import okhttp3.OkHttpClient
 import okhttp3.Request
 import java.io.File
 import java.io.FileOutputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import java.security.MessageDigest
 import javax.inject.Inject
 import javax.inject.Singleton
@@ -33,6 +36,13 @@ class ModelManager @Inject constructor(
     private val preferences: SharedPreferences
 ) {
     
+    companion object {
+        private const val GGML_FILE_MAGIC = 0x67676d6c // "ggml"
+        private const val GGML_QNT_VERSION_FACTOR = 1000
+        private const val MODEL_FTYPE_OFFSET = 44      // after the magic and 10 hparams
+        private const val MODEL_HEADER_SIZE = 48
+    }
+    
     private val modelsDir = File(context.filesDir, "models")
     
     // Model states
@@ -179,8 +189,13 @@ class ModelManager @Inject constructor(
                 }
             }
             
-            // Verify checksum
-            if (!verifyChecksum(tempFile, model.checksum)) {
+            // Verify checksum, or the ggml header when no checksum is pinned
+            val verified = if (model.checksum.isBlank()) {
+                verifyModelHeader(tempFile, model)
+            } else {
+                verifyChecksum(tempFile, model.checksum)
+            }
+            if (!verified) {
                 tempFile.delete()
                 model.status = ModelStatus.Error
                 return@withContext Result.failure(Exception("Checksum verification failed"))
@@ -266,6 +281,13 @@ class ModelManager @Inject constructor(
         return WhisperModel.values().filter { it.isAvailable() }
     }
     
+    /**
+     * Get the downloaded variants of a model size, highest precision first.
+     */
+    fun getDownloadedVariants(size: ModelSize): List<WhisperModel> {
+        return WhisperModel.getVariants(size).filter { it.isAvailable() }
+    }
+    
     /**
      * Get model by ID.
      */
@@ -313,6 +335,26 @@ class ModelManager @Inject constructor(
         }
     }
     
+    /**
+     * Check that a file is a whisper ggml model with the expected weight format.
+     */
+    private fun verifyModelHeader(file: File, model: WhisperModel): Boolean {
+        return try {
+            val header = ByteArray(MODEL_HEADER_SIZE)
+            val read = file.inputStream().use { it.read(header) }
+            if (read != MODEL_HEADER_SIZE) {
+                return false
+            }
+            val buffer = ByteBuffer.wrap(header).order(ByteOrder.LITTLE_ENDIAN)
+            val magic = buffer.getInt(0)
+            // ftype carries the quantization format version in its thousands
+            val ggmlType = buffer.getInt(MODEL_FTYPE_OFFSET) % GGML_QNT_VERSION_FACTOR
+            magic == GGML_FILE_MAGIC && ggmlType == model.quantization.ggmlType
+        } catch (e: Exception) {
+            false
+        }
+    }
+    
     /**
      * Cancel model download.
      */
@@ -23,7 +23,11 @@ data class AudioRecorderConfig(
     val waveformWindowSizeMs: Int = 50,
     val voiceActivityThreshold: Float = 0.02f,
     val silenceTimeoutMs: Long = 3000L, // 3 seconds of silence
-    val enableVoiceActivityDetection: Boolean = false
+    val enableVoiceActivityDetection: Boolean = false,
+    val highPassCutoffHz: Float = 0f, // 0 leaves native capture unfiltered
+    val humNotchHz: Float = 0f, // mains frequency (50 or 60) to notch out, 0 for none
+    val noiseSuppressionStrength: Float = 0f, // native spectral subtraction, 0-1, 0 for none
+    val autoGainTargetLevel: Float = 0f // RMS the native AGC steers towards, 0 for none
 ) {
     
     /**
@@ -118,6 +122,18 @@ data class AudioRecorderConfig(
             silenceTimeoutMs < 0 -> 
                 Result.failure(IllegalArgumentException("Silence timeout must be non-negative: $silenceTimeoutMs"))
             
+            highPassCutoffHz < 0f || highPassCutoffHz >= 8000f -> 
+                Result.failure(IllegalArgumentException("High-pass cutoff out of range: $highPassCutoffHz (0-8000)"))
+            
+            humNotchHz < 0f || humNotchHz >= 8000f -> 
+                Result.failure(IllegalArgumentException("Hum notch frequency out of range: $humNotchHz (0-8000)"))
+            
+            noiseSuppressionStrength < 0f || noiseSuppressionStrength > 1f -> 
+                Result.failure(IllegalArgumentException("Noise suppression strength must be 0.0-1.0: $noiseSuppressionStrength"))
+            
+            autoGainTargetLevel < 0f || autoGainTargetLevel > 1f -> 
+                Result.failure(IllegalArgumentException("AGC target level must be 0.0-1.0: $autoGainTargetLevel"))
+            
             calculateBufferSize() == android.media.AudioRecord.ERROR_BAD_VALUE -> 
                 Result.failure(IllegalArgumentException("Invalid audio configuration"))
             
@@ -168,7 +184,8 @@ data class AudioRecorderConfig(
             bufferSizeMultiplier = 2,
             enableNoiseReduction = true,
             enableEchoCancellation = true,
-            enableAutomaticGainControl = true
+            enableAutomaticGainControl = true,
+            highPassCutoffHz = 80f
         )
         
         /**
@@ -226,6 +226,7 @@ class ModelRepositoryImpl @Inject constructor(
                     com.app.whisper.domain.entity.ModelStatus.valueOf(entity.status),
                     entity.localPath
                 )
+                model.measuredRealTimeFactor = entity.realTimeFactor
                 model
             }
         }
@@ -310,7 +311,8 @@ class ModelRepositoryImpl @Inject constructor(
                 localPath = file.absolutePath,
                 downloadedAt = System.currentTimeMillis(),
                 lastUsedAt = System.currentTimeMillis(),
-                fileSizeBytes = file.length()
+                fileSizeBytes = file.length(),
+                quantization = model.quantization.name
             )
             
             modelDao.insertModel(entity)
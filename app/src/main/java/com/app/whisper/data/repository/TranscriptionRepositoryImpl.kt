@@ -1,16 +1,20 @@
 package com.app.whisper.data.repository
 
-// import com.app.whisper.native.WhisperNative // TODO: Implement native integration
 import androidx.tracing.trace
 import com.app.whisper.data.audio.AudioProcessor
+import com.app.whisper.data.local.database.dao.ModelDao
 import com.app.whisper.data.local.database.dao.TranscriptionDao
 import com.app.whisper.data.local.database.entity.TranscriptionEntity
 import com.app.whisper.data.model.AudioData
+import com.app.whisper.domain.entity.ModelQuantization
 import com.app.whisper.domain.entity.TranscriptionResult
 import com.app.whisper.domain.entity.TranscriptionSession
 import com.app.whisper.domain.entity.WhisperModel
 import com.app.whisper.domain.repository.TranscriptionRepository
-import java.io.File
+import com.app.whisper.native.WhisperNative
+import com.app.whisper.performance.EncoderCacheMemory
+import com.app.whisper.performance.PerformanceManager
+import com.app.whisper.performance.StartupWarmup
 import java.util.UUID
 import javax.inject.Inject
 import javax.inject.Singleton
@@ -25,20 +29,30 @@ import timber.log.Timber
  * Implementation of TranscriptionRepository using Whisper.cpp native library.
  *
  * Handles audio transcription operations with native Whisper integration, session management,
- * result caching, and performance optimization.
+ * result caching, and performance optimization. Models are memory-mapped and cached natively by
+ * path, so switching back to a model that was loaded before does not read the file again.
  */
 @Singleton
 class TranscriptionRepositoryImpl
 @Inject
 constructor(
         private val transcriptionDao: TranscriptionDao,
-        private val audioProcessor: AudioProcessor
-// private val whisperNative: WhisperNative // TODO: Implement native integration
+        private val modelDao: ModelDao,
+        private val audioProcessor: AudioProcessor,
+        private val whisperNative: WhisperNative,
+        private val performanceManager: PerformanceManager,
+        private val startupWarmup: StartupWarmup,
+        private val encoderCacheMemory: EncoderCacheMemory
 ) : TranscriptionRepository {
 
     private var currentModel: WhisperModel? = null
     private var isModelLoaded = false
 
+    companion object {
+        // Shorter clips are dominated by fixed per-call overhead
+        private const val MIN_RTF_AUDIO_MS = 1_000L
+    }
+
     override suspend fun transcribeAudio(
             audioData: AudioData,
             model: WhisperModel,
@@ -50,7 +64,7 @@ constructor(
                 Timber.d("Starting transcription with model: ${model.name}, language: $language")
 
                 // Ensure model is loaded
-                if (currentModel != model || !isModelLoaded) {
+                if (currentModel != model || !isModelLoaded || !whisperNative.isReady()) {
                     loadModel(model)
                 }
 
@@ -69,57 +83,65 @@ constructor(
                         )
                 )
 
-                // Save processed audio to temporary file
-                val tempFile = File.createTempFile("whisper_audio", ".wav")
-                try {
-                    audioProcessor.saveToFile(processedAudio, tempFile).getOrThrow()
+                emit(
+                        TranscriptionResult.InProgress(
+                                sessionId = actualSessionId,
+                                progress = 0.2f,
+                                message = "Starting transcription..."
+                        )
+                )
 
-                    emit(
-                            TranscriptionResult.InProgress(
-                                    sessionId = actualSessionId,
-                                    progress = 0.2f,
-                                    message = "Starting transcription..."
-                            )
-                    )
+                // Long recordings on capable devices decode in parallel chunks
+                val parallelism =
+                        if (processedAudio.getDurationMs() > WhisperNative.PARALLEL_MIN_AUDIO_MS) {
+                            performanceManager.getParallelTranscriptionContexts(model)
+                        } else {
+                            1
+                        }
 
-                    // TODO: Implement native transcription
-                    // For now, use mock transcription
-                    val transcriptionText =
-                            mockTranscription(tempFile, language ?: "auto") { progress ->
-                                // Emit progress updates
-                                kotlinx.coroutines.runBlocking {
-                                    emit(
-                                            TranscriptionResult.InProgress(
-                                                    sessionId = actualSessionId,
-                                                    progress = 0.2f + (progress * 0.8f),
-                                                    message =
-                                                            "Transcribing... ${(progress * 100).toInt()}%"
-                                            )
+                val startTime = System.currentTimeMillis()
+                val transcriptionText =
+                        if (parallelism > 1) {
+                            whisperNative
+                                    .transcribeParallel(
+                                            audioData = processedAudio.samples,
+                                            language = language ?: "auto",
+                                            sampleRate = processedAudio.sampleRate,
+                                            parallelism = parallelism
+                                    )
+                                    .getOrThrow()
+                                    .joinToString(" ") { it.text.trim() }
+                        } else {
+                            whisperNative
+                                    .transcribe(
+                                            audioData = processedAudio.samples,
+                                            language = language ?: "auto",
+                                            sampleRate = processedAudio.sampleRate
                                     )
-                                }
-                            }
+                                    .getOrThrow()
+                                    .trim()
+                        }
+                val processingTimeMs = System.currentTimeMillis() - startTime
+                // Parallel runs would overstate the model's speed for model selection
+                if (parallelism == 1) {
+                    recordRealTimeFactor(model, processedAudio.getDurationMs(), processingTimeMs)
+                }
 
-                    // Create final result
-                    val result =
-                            TranscriptionResult.Success(
-                                    sessionId = actualSessionId,
-                                    text = transcriptionText,
-                                    confidence = calculateConfidence(transcriptionText),
-                                    language = language ?: detectLanguage(transcriptionText),
-                                    processingTimeMs =
-                                            System.currentTimeMillis(), // This should be actual
-                                    // processing time
-                                    model = model
-                            )
+                // Create final result
+                val result =
+                        TranscriptionResult.Success(
+                                sessionId = actualSessionId,
+                                text = transcriptionText,
+                                confidence = calculateConfidence(transcriptionText),
+                                language = language ?: detectLanguage(transcriptionText),
+                                processingTimeMs = processingTimeMs,
+                                model = model
+                        )
 
-                    // Save to database
-                    saveTranscriptionResult(result, audioData)
+                // Save to database
+                saveTranscriptionResult(result, audioData)
 
-                    emit(result)
-                } finally {
-                    // Clean up temporary file
-                    tempFile.delete()
-                }
+                emit(result)
             } catch (e: Exception) {
                 Timber.e(e, "Transcription failed")
                 emit(
@@ -223,6 +245,27 @@ constructor(
         return Result.success(Unit)
     }
 
+    /**
+     * Fold this run's processing time / audio duration into the model's
+     * measured real-time factor, which model auto-selection prefers over
+     * static estimates.
+     */
+    private suspend fun recordRealTimeFactor(
+            model: WhisperModel,
+            audioDurationMs: Long,
+            processingTimeMs: Long
+    ) {
+        if (audioDurationMs < MIN_RTF_AUDIO_MS) return
+        try {
+            val realTimeFactor = processingTimeMs.toFloat() / audioDurationMs
+            modelDao.updateModelRealTimeFactor(model.id, realTimeFactor)
+            model.measuredRealTimeFactor =
+                    modelDao.getModelRealTimeFactor(model.id) ?: realTimeFactor
+        } catch (e: Exception) {
+            Timber.w(e, "Failed to record real-time factor for ${model.name}")
+        }
+    }
+
     private suspend fun loadModel(model: WhisperModel) =
             withContext(Dispatchers.IO) {
                 trace("TranscriptionRepositoryImpl.loadModel") {
@@ -233,13 +276,28 @@ constructor(
                                                 "Model not downloaded: ${model.name}"
                                         )
 
-                        // TODO: Implement native model loading
-                        // For now, just simulate model loading
-                        kotlinx.coroutines.delay(1000) // Simulate loading time
+                        // Reuses the natively cached context when this model was loaded before
+                        whisperNative.initialize(
+                                modelPath,
+                                backend = performanceManager.getPreferredBackend()
+                        ).getOrThrow()
                         currentModel = model
                         isModelLoaded = true
+                        startupWarmup.recordModelUsed(modelPath)
+                        encoderCacheMemory.configure(model)
 
-                        Timber.d("Loaded model: ${model.name}")
+                        val weightType = whisperNative.getModelWeightType()
+                        val loadedQuantization = ModelQuantization.fromGgmlType(weightType)
+                        if (loadedQuantization != model.quantization) {
+                            Timber.w(
+                                    "Model ${model.name} declares ${model.quantization} " +
+                                            "but its file holds ggml type $weightType"
+                            )
+                        }
+                        Timber.d(
+                                "Loaded model: ${model.name} ($loadedQuantization) " +
+                                        "on ${whisperNative.getActiveBackend()}"
+                        )
                     } catch (e: Exception) {
                         Timber.e(e, "Failed to load model: ${model.name}")
                         throw e
@@ -294,28 +352,4 @@ constructor(
             else -> "en"
         }
     }
-
-    private suspend fun mockTranscription(
-            audioFile: File,
-            language: String,
-            progressCallback: (Float) -> Unit
-    ): String {
-        // Simulate transcription progress
-        for (i in 1..10) {
-            kotlinx.coroutines.delay(200)
-            progressCallback(i / 10f)
-        }
-
-        // Return mock transcription based on language
-        return when (language) {
-            "tr" -> "Bu bir test transkripsiyon metnidir. Ses dosyası başarıyla işlendi."
-            "de" ->
-                    "Dies ist ein Test-Transkriptionstext. Die Audiodatei wurde erfolgreich verarbeitet."
-            "fr" ->
-                    "Ceci est un texte de transcription de test. Le fichier audio a été traité avec succès."
-            "es" ->
-                    "Este es un texto de transcripción de prueba. El archivo de audio se procesó correctamente."
-            else -> "This is a test transcription text. The audio file was processed successfully."
-        }
-    }
 }
@@ -10,12 +10,17 @@ import com.app.whisper.data.model.AudioData
 import com.app.whisper.data.model.AudioRecorderConfig
 import com.app.whisper.data.model.RecordingState
 import com.app.whisper.data.model.WaveformData
+import com.app.whisper.native.AudioCaptureBuffer
+import com.app.whisper.native.AudioProcessor as NativeAudioProcessor
 import dagger.hilt.android.qualifiers.ApplicationContext
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.cancel
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.cancelAndJoin
+import kotlinx.coroutines.currentCoroutineContext
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.MutableSharedFlow
@@ -27,6 +32,7 @@ import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
 import javax.inject.Inject
 import javax.inject.Singleton
 
@@ -34,7 +40,8 @@ import javax.inject.Singleton
  * Audio recorder implementation for capturing real-time audio data.
  *
  * This class provides a comprehensive audio recording solution with:
- * - Real-time audio capture using Android AudioRecord
+ * - Real-time audio capture using Android AudioRecord, handed to native
+ *   processing through a lock-free [AudioCaptureBuffer]
  * - Thread-safe state management
  * - Waveform data generation for visualization
  * - Voice activity detection
@@ -49,12 +56,15 @@ class AudioRecorder @Inject constructor(
     companion object {
         private const val TAG = "AudioRecorder"
         private const val AUDIO_BUFFER_READ_TIMEOUT_MS = 100L
+        private const val PROCESSED_AUDIO_POLL_MS = 20L
     }
 
     // Configuration and state
     private var config = AudioRecorderConfig.forWhisper()
     private var audioRecord: AudioRecord? = null
     private var recordingJob: Job? = null
+    private var processingJob: Job? = null
+    private var captureBuffer: AudioCaptureBuffer? = null
     private val recordingScope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
 
     // Thread safety
@@ -146,6 +156,24 @@ class AudioRecorder @Inject constructor(
                 return Result.failure(error)
             }
 
+            if (config.getChannelCount() != 1) {
+                val error = IllegalStateException("Native capture requires mono input")
+                _recordingState.value = RecordingState.error(error, canRecover = true)
+                return Result.failure(error)
+            }
+            releaseCaptureBuffer()
+            captureBuffer = AudioCaptureBuffer(config.sampleRate).also { buffer ->
+                if (config.highPassCutoffHz > 0f || config.humNotchHz > 0f) {
+                    buffer.setFilter(highPassHz = config.highPassCutoffHz, notchHz = config.humNotchHz)
+                }
+                if (config.noiseSuppressionStrength > 0f) {
+                    buffer.setNoiseSuppression(config.noiseSuppressionStrength)
+                }
+                if (config.autoGainTargetLevel > 0f) {
+                    buffer.setAutoGain(config.autoGainTargetLevel)
+                }
+            }
+
             // Start recording
             audioRecord?.startRecording()
 
@@ -157,10 +185,8 @@ class AudioRecorder @Inject constructor(
             // Update state
             _recordingState.value = RecordingState.Recording()
 
-            // Start recording coroutine
-            recordingJob = recordingScope.launch {
-                runRecordingLoop()
-            }
+            // Start capture and processed-audio coroutines
+            startCaptureJobs()
 
             Log.i(TAG, "Audio recording started")
             Result.success(Unit)
@@ -186,12 +212,13 @@ class AudioRecorder @Inject constructor(
                 )
             }
 
-            // Cancel recording job
-            recordingJob?.cancel()
-            recordingJob = null
+            // Stop AudioRecord and wait for the capture loop to finish writing
+            stopRecordingJob()
 
-            // Stop AudioRecord
-            audioRecord?.stop()
+            // Process what is still queued natively, then let the pipeline go
+            captureBuffer?.stop()
+            stopProcessing()
+            releaseCaptureBuffer()
 
             // Calculate final statistics
             val totalDuration = System.currentTimeMillis() - recordingStartTime
@@ -226,12 +253,9 @@ class AudioRecorder @Inject constructor(
                 )
             }
 
-            // Pause AudioRecord
-            audioRecord?.stop()
-
-            // Cancel recording job but keep AudioRecord initialized
-            recordingJob?.cancel()
-            recordingJob = null
+            // Pause AudioRecord, keeping it and the capture pipeline initialized
+            stopRecordingJob()
+            stopProcessing()
 
             // Calculate current duration
             val currentDuration = System.currentTimeMillis() - recordingStartTime
@@ -275,10 +299,8 @@ class AudioRecorder @Inject constructor(
                 samplesRecorded = currentState.getSampleCount()
             )
 
-            // Restart recording coroutine
-            recordingJob = recordingScope.launch {
-                runRecordingLoop()
-            }
+            // Restart capture coroutines
+            startCaptureJobs()
 
             Log.i(TAG, "Audio recording resumed")
             Result.success(Unit)
@@ -297,6 +319,15 @@ class AudioRecorder @Inject constructor(
      */
     fun getConfiguration(): AudioRecorderConfig = config
 
+    /**
+     * Native capture pipeline of the active recording, for consumers that want
+     * the processed 16 kHz audio without going through [audioDataFlow]
+     * (e.g. [com.app.whisper.native.StreamingTranscriptionSession.attach]).
+     *
+     * @return Capture buffer, or null when not recording
+     */
+    fun getCaptureBuffer(): AudioCaptureBuffer? = captureBuffer
+
     /**
      * Check if microphone permission is granted.
      *
@@ -316,12 +347,14 @@ class AudioRecorder @Inject constructor(
         recordingScope.launch {
             recordingMutex.withLock {
                 try {
-                    // Cancel recording job
-                    recordingJob?.cancel()
-                    recordingJob = null
+                    // Stop the capture and consumer loops
+                    stopRecordingJob()
+                    processingJob?.cancelAndJoin()
+                    processingJob = null
 
-                    // Release AudioRecord
+                    // Release AudioRecord and the capture pipeline
                     releaseAudioRecord()
+                    releaseCaptureBuffer()
 
                     // Update state
                     _recordingState.value = RecordingState.Idle
@@ -386,23 +419,79 @@ class AudioRecorder @Inject constructor(
     }
 
     /**
-     * Main recording loop that runs in a coroutine.
+     * Release the native capture pipeline.
+     */
+    private fun releaseCaptureBuffer() {
+        captureBuffer?.close()
+        captureBuffer = null
+    }
+
+    /**
+     * Launch the capture loop and the processed-audio consumer.
+     */
+    private fun startCaptureJobs() {
+        val capture = captureBuffer ?: return
+        recordingJob = recordingScope.launch {
+            runRecordingLoop(capture)
+        }
+        processingJob = recordingScope.launch {
+            runProcessingLoop(capture)
+        }
+    }
+
+    /**
+     * Stop AudioRecord and the capture loop. Waits for the loop so nothing is
+     * still writing when the capture pipeline is stopped or released, unless
+     * called from the loop itself (maximum duration reached).
+     */
+    private suspend fun stopRecordingJob() {
+        val caller = currentCoroutineContext()[Job]
+        val job = recordingJob
+        recordingJob = null
+        job?.cancel()
+        audioRecord?.stop()  // also unblocks a pending read
+        if (job != null && job != caller) {
+            withContext(NonCancellable) { job.join() }
+        }
+    }
+
+    /**
+     * Stop the processed-audio consumer and emit whatever it had not read yet.
+     */
+    private suspend fun stopProcessing() = withContext(NonCancellable) {
+        processingJob?.cancelAndJoin()
+        processingJob = null
+
+        val capture = captureBuffer ?: return@withContext
+        val block = FloatArray(config.getSamplesPerBuffer())
+        while (true) {
+            val read = capture.read(block)
+            if (read == 0) break
+            processAudioBuffer(block, read, capture)
+        }
+    }
+
+    /**
+     * Capture loop: moves AudioRecord data into the native ring through a
+     * reused direct buffer. Nothing is allocated per read.
      */
-    private suspend fun runRecordingLoop() {
+    private suspend fun runRecordingLoop(capture: AudioCaptureBuffer) {
         val audioRecord = this.audioRecord ?: return
         val bufferSize = config.getSamplesPerBuffer()
-        val audioBuffer = ShortArray(bufferSize)
+        val bufferBytes = bufferSize * Short.SIZE_BYTES
+        val audioBuffer = NativeAudioProcessor.allocateDirectBuffer(bufferSize, Short.SIZE_BYTES)
 
         Log.d(TAG, "Recording loop started with buffer size: $bufferSize")
 
         try {
             while (recordingScope.isActive && _recordingState.value is RecordingState.Recording) {
                 // Read audio data
-                val samplesRead = audioRecord.read(audioBuffer, 0, bufferSize)
+                val bytesRead = audioRecord.read(audioBuffer, bufferBytes)
+                val samplesRead = if (bytesRead > 0) bytesRead / Short.SIZE_BYTES else bytesRead
 
                 if (samplesRead > 0) {
-                    // Process audio data
-                    processAudioBuffer(audioBuffer, samplesRead)
+                    // Hand off to the native worker
+                    capture.write(audioBuffer, samplesRead)
 
                     // Update statistics
                     totalSamplesRecorded += samplesRead
@@ -450,20 +539,38 @@ class AudioRecorder @Inject constructor(
             _recordingState.value = RecordingState.error(e, canRecover = true)
         }
 
+        val dropped = capture.droppedSamples()
+        if (dropped > 0) {
+            Log.w(TAG, "Capture pipeline dropped $dropped samples")
+        }
         Log.d(TAG, "Recording loop ended")
     }
 
+    /**
+     * Consumer loop: emits the natively converted and resampled audio.
+     */
+    private suspend fun runProcessingLoop(capture: AudioCaptureBuffer) {
+        val block = FloatArray(config.getSamplesPerBuffer())
+        while (recordingScope.isActive) {
+            val read = capture.read(block)
+            if (read > 0) {
+                processAudioBuffer(block, read, capture)
+            } else {
+                delay(PROCESSED_AUDIO_POLL_MS)
+            }
+        }
+    }
+
     /**
      * Process audio buffer and emit audio data.
      */
-    private suspend fun processAudioBuffer(buffer: ShortArray, samplesRead: Int) {
+    private fun processAudioBuffer(buffer: FloatArray, samplesRead: Int, capture: AudioCaptureBuffer) {
         try {
-            // Create audio data from buffer
-            val audioData = AudioData.fromPCM16(
-                pcmSamples = buffer.copyOf(samplesRead),
-                sampleRate = config.sampleRate,
-                channelCount = config.getChannelCount()
-            ).copy(
+            // Create audio data from the processed 16 kHz samples
+            val audioData = AudioData(
+                samples = buffer.copyOf(samplesRead),
+                sampleRate = AudioCaptureBuffer.OUTPUT_SAMPLE_RATE,
+                channelCount = 1,
                 timestampMs = System.currentTimeMillis(),
                 sequenceNumber = sequenceNumber++
             )
@@ -480,7 +587,7 @@ class AudioRecorder @Inject constructor(
 
             // Voice activity detection if enabled
             if (config.enableVoiceActivityDetection) {
-                val hasVoiceActivity = audioData.hasActivity(config.voiceActivityThreshold)
+                val hasVoiceActivity = capture.isSpeechActive()
                 if (!hasVoiceActivity) {
                     // TODO: Implement silence timeout logic
                 }
@@ -1,6 +1,10 @@
 package com.app.whisper.di
 
 import android.content.Context
+import android.content.SharedPreferences
+import com.app.whisper.native.AudioProcessor as NativeAudioProcessor
+import com.app.whisper.native.InferenceAccelerators
+import com.app.whisper.native.NativeStats
 import com.app.whisper.performance.AudioOptimizer
 import com.app.whisper.performance.MemoryOptimizer
 import com.app.whisper.performance.PerformanceManager
@@ -27,9 +31,12 @@ object PerformanceModule {
     @Provides
     @Singleton
     fun providePerformanceManager(
-        @ApplicationContext context: Context
+        @ApplicationContext context: Context,
+        nativeStats: NativeStats,
+        accelerators: InferenceAccelerators,
+        @CachePreferences preferences: SharedPreferences
     ): PerformanceManager {
-        return PerformanceManager(context)
+        return PerformanceManager(context, nativeStats, accelerators, preferences)
     }
     
     /**
@@ -38,9 +45,10 @@ object PerformanceModule {
     @Provides
     @Singleton
     fun provideAudioOptimizer(
-        performanceManager: PerformanceManager
+        performanceManager: PerformanceManager,
+        nativeAudioProcessor: NativeAudioProcessor
     ): AudioOptimizer {
-        return AudioOptimizer(performanceManager)
+        return AudioOptimizer(performanceManager, nativeAudioProcessor)
     }
     
     /**
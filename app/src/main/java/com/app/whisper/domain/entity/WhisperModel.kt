@@ -19,7 +19,8 @@ enum class WhisperModel(
         val checksum: String,
         val isMultilingual: Boolean,
         val supportedLanguages: List<String>,
-        val recommendedUseCase: String
+        val recommendedUseCase: String,
+        val quantization: ModelQuantization = ModelQuantization.F16
 ) {
     TINY(
             id = "tiny",
@@ -495,6 +496,161 @@ enum class WhisperModel(
                             "su"
                     ),
             recommendedUseCase = "State-of-the-art multilingual transcription"
+    ),
+
+    // Quantized variants. whisper.cpp reads the weight type from the file
+    // header and runs the matching integer kernels; no load-time flag is needed.
+    // Checksums are left empty until the published hashes are pinned, so
+    // downloads are verified by their ggml header instead.
+    TINY_Q5_1(
+            id = "tiny-q5_1",
+            displayName = "Tiny (Q5_1)",
+            description = "5-bit quantized Tiny: much smaller and faster, with a small accuracy cost.",
+            size = ModelSize.TINY,
+            fileSizeBytes = 32_200_000L, // ~32MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-tiny-q5_1.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = TINY.isMultilingual,
+            supportedLanguages = TINY.supportedLanguages,
+            recommendedUseCase = TINY.recommendedUseCase,
+            quantization = ModelQuantization.Q5_1
+    ),
+    TINY_Q8_0(
+            id = "tiny-q8_0",
+            displayName = "Tiny (Q8_0)",
+            description = "8-bit quantized Tiny: about half the size, with accuracy close to full precision.",
+            size = ModelSize.TINY,
+            fileSizeBytes = 43_500_000L, // ~44MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-tiny-q8_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = TINY.isMultilingual,
+            supportedLanguages = TINY.supportedLanguages,
+            recommendedUseCase = TINY.recommendedUseCase,
+            quantization = ModelQuantization.Q8_0
+    ),
+    BASE_Q5_1(
+            id = "base-q5_1",
+            displayName = "Base (Q5_1)",
+            description = "5-bit quantized Base: much smaller and faster, with a small accuracy cost.",
+            size = ModelSize.BASE,
+            fileSizeBytes = 59_700_000L, // ~60MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-base-q5_1.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = BASE.isMultilingual,
+            supportedLanguages = BASE.supportedLanguages,
+            recommendedUseCase = BASE.recommendedUseCase,
+            quantization = ModelQuantization.Q5_1
+    ),
+    BASE_Q8_0(
+            id = "base-q8_0",
+            displayName = "Base (Q8_0)",
+            description = "8-bit quantized Base: about half the size, with accuracy close to full precision.",
+            size = ModelSize.BASE,
+            fileSizeBytes = 81_800_000L, // ~82MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-base-q8_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = BASE.isMultilingual,
+            supportedLanguages = BASE.supportedLanguages,
+            recommendedUseCase = BASE.recommendedUseCase,
+            quantization = ModelQuantization.Q8_0
+    ),
+    SMALL_Q5_1(
+            id = "small-q5_1",
+            displayName = "Small (Q5_1)",
+            description = "5-bit quantized Small: much smaller and faster, with a small accuracy cost.",
+            size = ModelSize.SMALL,
+            fileSizeBytes = 190_000_000L, // ~190MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-small-q5_1.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = SMALL.isMultilingual,
+            supportedLanguages = SMALL.supportedLanguages,
+            recommendedUseCase = SMALL.recommendedUseCase,
+            quantization = ModelQuantization.Q5_1
+    ),
+    SMALL_Q8_0(
+            id = "small-q8_0",
+            displayName = "Small (Q8_0)",
+            description = "8-bit quantized Small: about half the size, with accuracy close to full precision.",
+            size = ModelSize.SMALL,
+            fileSizeBytes = 264_000_000L, // ~264MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-small-q8_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = SMALL.isMultilingual,
+            supportedLanguages = SMALL.supportedLanguages,
+            recommendedUseCase = SMALL.recommendedUseCase,
+            quantization = ModelQuantization.Q8_0
+    ),
+    MEDIUM_Q5_0(
+            id = "medium-q5_0",
+            displayName = "Medium (Q5_0)",
+            description = "5-bit quantized Medium: much smaller and faster, with a small accuracy cost.",
+            size = ModelSize.MEDIUM,
+            fileSizeBytes = 539_000_000L, // ~539MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-medium-q5_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = MEDIUM.isMultilingual,
+            supportedLanguages = MEDIUM.supportedLanguages,
+            recommendedUseCase = MEDIUM.recommendedUseCase,
+            quantization = ModelQuantization.Q5_0
+    ),
+    MEDIUM_Q8_0(
+            id = "medium-q8_0",
+            displayName = "Medium (Q8_0)",
+            description = "8-bit quantized Medium: about half the size, with accuracy close to full precision.",
+            size = ModelSize.MEDIUM,
+            fileSizeBytes = 823_000_000L, // ~823MB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-medium-q8_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = MEDIUM.isMultilingual,
+            supportedLanguages = MEDIUM.supportedLanguages,
+            recommendedUseCase = MEDIUM.recommendedUseCase,
+            quantization = ModelQuantization.Q8_0
+    ),
+    LARGE_Q5_0(
+            id = "large-v2-q5_0",
+            displayName = "Large (Q5_0)",
+            description = "5-bit quantized Large: much smaller and faster, with a small accuracy cost.",
+            size = ModelSize.LARGE,
+            fileSizeBytes = 1_080_000_000L, // ~1.08GB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-large-v2-q5_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = LARGE.isMultilingual,
+            supportedLanguages = LARGE.supportedLanguages,
+            recommendedUseCase = LARGE.recommendedUseCase,
+            quantization = ModelQuantization.Q5_0
+    ),
+    LARGE_Q8_0(
+            id = "large-v2-q8_0",
+            displayName = "Large (Q8_0)",
+            description = "8-bit quantized Large: about half the size, with accuracy close to full precision.",
+            size = ModelSize.LARGE,
+            fileSizeBytes = 1_660_000_000L, // ~1.66GB
+            downloadUrl =
+                    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-large-v2-q8_0.bin",
+            version = "1.0.0",
+            checksum = "",
+            isMultilingual = LARGE.isMultilingual,
+            supportedLanguages = LARGE.supportedLanguages,
+            recommendedUseCase = LARGE.recommendedUseCase,
+            quantization = ModelQuantization.Q8_0
     );
 
     /** Get formatted file size string. */
@@ -528,6 +684,13 @@ enum class WhisperModel(
     var metadata: ModelMetadata? = null
         internal set
 
+    /**
+     * Measured processing time divided by audio duration on this device,
+     * averaged over recent transcriptions (set by the transcription repository).
+     */
+    var measuredRealTimeFactor: Float? = null
+        internal set
+
     /** Check if model is currently selected. */
     var isCurrent: Boolean = false
         internal set
@@ -581,7 +744,7 @@ enum class WhisperModel(
                 ModelSize.SMALL -> 2.0f
                 ModelSize.MEDIUM -> 1.0f
                 ModelSize.LARGE -> 0.5f
-            }
+            } * quantization.speedFactor
 
     /**
      * Check if this model is recommended for the current device.
@@ -607,13 +770,13 @@ enum class WhisperModel(
      * @return Required memory in MB
      */
     fun getRequiredMemoryMB(): Long =
-            when (size) {
+            (when (size) {
                 ModelSize.TINY -> 64L
                 ModelSize.BASE -> 128L
                 ModelSize.SMALL -> 256L
                 ModelSize.MEDIUM -> 512L
                 ModelSize.LARGE -> 1024L
-            }
+            } * quantization.memoryFactor).toLong()
 
     /**
      * Update status (modifies the enum instance).
@@ -640,7 +803,18 @@ enum class WhisperModel(
          *
          * @return List of all available models
          */
-        fun getAllModels(): List<WhisperModel> = listOf(TINY, BASE, SMALL, MEDIUM, LARGE)
+        fun getAllModels(): List<WhisperModel> = values().toList()
+
+        /**
+         * Get every variant (full precision and quantized) of a model size.
+         *
+         * @param size Model size
+         * @return Variants ordered from highest to lowest precision
+         */
+        fun getVariants(size: ModelSize): List<WhisperModel> =
+                getAllModels()
+                        .filter { it.size == size }
+                        .sortedByDescending { it.quantization.bitsPerWeight }
 
         /**
          * Get the recommended model for a device with specific constraints.
@@ -676,6 +850,51 @@ enum class ModelSize {
     LARGE
 }
 
+/**
+ * Weight format of a ggml model file.
+ *
+ * @param ggmlType ggml_ftype value stored in the model header
+ * @param bitsPerWeight Storage per weight including block scales
+ */
+enum class ModelQuantization(val ggmlType: Int, val bitsPerWeight: Float) {
+    F16(1, 16.0f),
+    Q8_0(7, 8.5f),
+    Q5_1(9, 6.0f),
+    Q5_0(8, 5.5f),
+    Q4_0(2, 4.5f);
+
+    val isQuantized: Boolean
+        get() = this != F16
+
+    /**
+     * Approximate decode speed relative to F16 on NEON dot-product cores,
+     * where inference is bound by the bandwidth of streaming the weights.
+     */
+    val speedFactor: Float
+        get() = when (this) {
+            F16 -> 1.0f
+            Q8_0 -> 1.3f
+            Q5_1, Q5_0 -> 1.5f
+            Q4_0 -> 1.7f
+        }
+
+    /**
+     * Share of the F16 memory requirement. Weights shrink with the bit width;
+     * the KV cache and compute buffers, roughly 40%, do not.
+     */
+    val memoryFactor: Float
+        get() = 0.4f + 0.6f * bitsPerWeight / 16.0f
+
+    companion object {
+        /**
+         * Map a ggml_ftype from a model header.
+         *
+         * @return The quantization, or null for formats the app doesn't ship
+         */
+        fun fromGgmlType(type: Int): ModelQuantization? = values().find { it.ggmlType == type }
+    }
+}
+
 /** Enumeration of model download/availability status. */
 enum class ModelStatus {
     NotDownloaded,
@@ -274,6 +274,7 @@ sealed class TranscriptionProgress {
     data class ModelLoaded(val modelName: String) : TranscriptionProgress()
     data class SessionCreated(val sessionId: String) : TranscriptionProgress()
     object Processing : TranscriptionProgress()
+    data class Transcribing(val fraction: Float) : TranscriptionProgress() // 0.0 to 1.0 of the audio decoded
     data class Completed(
         val result: TranscriptionResult,
         val session: TranscriptionSession? = null
@@ -286,7 +287,14 @@ sealed class TranscriptionProgress {
      * @return true if transcription is active
      */
     fun isInProgress(): Boolean = this is Started || this is ModelLoaded || 
-                                 this is SessionCreated || this is Processing
+                                 this is SessionCreated || isDecoding()
+    
+    /**
+     * Check if the audio is being decoded.
+     * 
+     * @return true while processing or transcribing
+     */
+    fun isDecoding(): Boolean = this is Processing || this is Transcribing
     
     /**
      * Check if transcription completed successfully.
@@ -312,6 +320,7 @@ sealed class TranscriptionProgress {
         is ModelLoaded -> "Model loaded: $modelName"
         is SessionCreated -> "Session created: $sessionId"
         is Processing -> "Processing audio..."
+        is Transcribing -> "Transcribing... ${(fraction * 100).toInt()}%"
         is Completed -> "Transcription completed"
         is Failed -> "Transcription failed: ${error.message}"
     }
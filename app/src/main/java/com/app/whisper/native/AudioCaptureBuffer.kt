@@ -0,0 +1,198 @@
+package com.app.whisper.native
+
+import android.util.Log
+import com.app.whisper.data.model.WaveformData
+import java.nio.ByteBuffer
+
+/**
+ * Lock-free hand-off from the audio capture thread to native processing.
+ *
+ * [write] copies PCM16 from a direct buffer into a single-producer/single-consumer
+ * ring and returns immediately; it never locks or allocates, so it is safe on
+ * the AudioRecord thread. A native worker drains the ring, converts and
+ * resamples to 16 kHz, applies the filters, noise suppression and AGC set
+ * by [setFilter], [setNoiseSuppression] and [setAutoGain], runs voice
+ * activity detection and feeds any attached
+ * [StreamingTranscriptionSession]. Processed audio is available to one
+ * consumer through [read], and its level summary to any thread through
+ * [waveform].
+ *
+ * [write] must only be called from one thread and [read] from one other thread.
+ *
+ * @param sourceRate Sample rate of the captured PCM16
+ * @param capacitySamples Input ring size; writes beyond it are dropped and counted
+ */
+class AudioCaptureBuffer(
+    val sourceRate: Int,
+    capacitySamples: Int = sourceRate * DEFAULT_CAPACITY_SECONDS
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "AudioCaptureBuffer"
+        private const val DEFAULT_CAPACITY_SECONDS = 4
+
+        /** Rate of the audio returned by [read]. */
+        const val OUTPUT_SAMPLE_RATE = AudioProcessor.WHISPER_SAMPLE_RATE
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native audio processing library", e)
+            }
+        }
+    }
+
+    internal var handle: Long = nativeCreate(sourceRate, capacitySamples)
+        private set
+
+    init {
+        require(handle != 0L) { "Unsupported capture configuration: $sourceRate Hz, $capacitySamples samples" }
+    }
+
+    private external fun nativeCreate(sourceRate: Int, capacity: Int): Long
+    private external fun nativeWrite(handle: Long, pcmBuffer: ByteBuffer, sampleCount: Int): Int
+    private external fun nativeRead(handle: Long, output: FloatArray): Int
+    private external fun nativeIsSpeechActive(handle: Long): Boolean
+    private external fun nativeDroppedSamples(handle: Long): Long
+    private external fun nativeProcessedSamples(handle: Long): Long
+    private external fun nativeSetNoiseSuppression(handle: Long, strength: Float): Boolean
+    private external fun nativeSetAutoGain(
+        handle: Long,
+        targetLevel: Float,
+        attackMs: Float,
+        releaseMs: Float,
+        maxGain: Float
+    ): Boolean
+    private external fun nativeSetFilter(
+        handle: Long,
+        highPassHz: Float,
+        highPassOrder: Int,
+        notchHz: Float,
+        notchQ: Float,
+        preEmphasis: Float
+    ): Boolean
+    private external fun nativeWaveform(
+        handle: Long,
+        start: Long,
+        end: Long,
+        minOut: FloatArray,
+        maxOut: FloatArray,
+        rmsOut: FloatArray
+    ): Int
+    private external fun nativeStop(handle: Long)
+    private external fun nativeRelease(handle: Long)
+
+    /**
+     * Enqueue captured audio. Capture thread only.
+     *
+     * @param pcmBuffer Direct buffer in native byte order holding PCM16 from offset 0
+     * @param sampleCount Number of samples to enqueue
+     * @return Number of samples accepted (less than [sampleCount] on overrun)
+     */
+    fun write(pcmBuffer: ByteBuffer, sampleCount: Int): Int {
+        if (handle == 0L) return 0
+        return nativeWrite(handle, pcmBuffer, sampleCount)
+    }
+
+    /**
+     * Dequeue processed 16 kHz audio.
+     *
+     * @param output Destination array
+     * @return Number of samples copied into [output]
+     */
+    fun read(output: FloatArray): Int {
+        if (handle == 0L) return 0
+        return nativeRead(handle, output).coerceAtLeast(0)
+    }
+
+    /**
+     * Whether the native VAD currently considers the input to be speech.
+     */
+    fun isSpeechActive(): Boolean = handle != 0L && nativeIsSpeechActive(handle)
+
+    /**
+     * Samples lost because a ring was full.
+     */
+    fun droppedSamples(): Long = if (handle != 0L) nativeDroppedSamples(handle) else 0L
+
+    /**
+     * Filter the processed audio inline on the native worker; parameters are
+     * as for [BiquadFilterBank]. All zeros (the initial state) disables
+     * filtering. Takes effect from the next processed block.
+     *
+     * @return false, keeping the current filters, if the parameters are invalid
+     */
+    fun setFilter(
+        highPassHz: Float = BiquadFilterBank.DEFAULT_HIGH_PASS_HZ,
+        highPassOrder: Int = 2,
+        notchHz: Float = 0f,
+        notchQ: Float = BiquadFilterBank.DEFAULT_NOTCH_Q,
+        preEmphasis: Float = 0f
+    ): Boolean = handle != 0L &&
+        nativeSetFilter(handle, highPassHz, highPassOrder, notchHz, notchQ, preEmphasis)
+
+    /**
+     * Spectral noise suppression on the native worker, from 0 (off, the
+     * initial state) to 1 (strongest). While on, processed audio lags the
+     * input by 25 ms; set it before the first [write].
+     *
+     * @return false if [strength] is outside [0, 1]
+     */
+    fun setNoiseSuppression(strength: Float): Boolean =
+        handle != 0L && nativeSetNoiseSuppression(handle, strength)
+
+    /**
+     * Look-ahead AGC on the native worker, steering the RMS level towards
+     * [targetLevel] (full scale = 1); 0 (the initial state) disables it.
+     * While on, processed audio lags the input by 10 ms; set it before the
+     * first [write].
+     *
+     * @return false, keeping the current AGC, if the parameters are invalid
+     */
+    fun setAutoGain(
+        targetLevel: Float,
+        attackMs: Float = 10f,
+        releaseMs: Float = 500f,
+        maxGain: Float = 10f
+    ): Boolean = handle != 0L && nativeSetAutoGain(handle, targetLevel, attackMs, releaseMs, maxGain)
+
+    /**
+     * 16 kHz samples processed so far, whether or not they have been [read].
+     */
+    fun processedSamples(): Long = if (handle != 0L) nativeProcessedSamples(handle) else 0L
+
+    /**
+     * Waveform of the processed audio between [startMs] and [endMs] at
+     * [points] resolution. Served from a native min/max/RMS pyramid kept
+     * current by the worker, so it costs O(points) however long the
+     * recording is and can be called on every redraw.
+     */
+    fun waveform(startMs: Long, endMs: Long, points: Int): WaveformData {
+        val mins = FloatArray(points)
+        val maxs = FloatArray(points)
+        val rms = FloatArray(points)
+        val start = startMs * OUTPUT_SAMPLE_RATE / 1000
+        val end = minOf(endMs * OUTPUT_SAMPLE_RATE / 1000, processedSamples())
+        val written = if (handle != 0L) nativeWaveform(handle, start, end, mins, maxs, rms).coerceAtLeast(0) else 0
+        val durationMs = (end - start).coerceAtLeast(0L) * 1000L / OUTPUT_SAMPLE_RATE
+        return WaveformPyramid.toWaveformData(mins, maxs, rms, written, OUTPUT_SAMPLE_RATE, durationMs)
+    }
+
+    /**
+     * Process everything written so far and stop the native worker.
+     * Remaining output can still be [read] afterwards.
+     */
+    fun stop() {
+        if (handle != 0L) {
+            nativeStop(handle)
+        }
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+}
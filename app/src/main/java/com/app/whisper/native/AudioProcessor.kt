@@ -3,6 +3,8 @@ package com.app.whisper.native
 import android.util.Log
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import javax.inject.Inject
 import javax.inject.Singleton
 import kotlin.math.abs
@@ -29,6 +31,7 @@ class AudioProcessor @Inject constructor() {
         const val DEFAULT_NORMALIZE_LEVEL = 0.95f
         const val MIN_AUDIO_LENGTH = 1600 // 0.1 seconds at 16kHz
         const val MAX_AUDIO_LENGTH = 480000 // 30 seconds at 16kHz
+        const val DEFAULT_VAD_MIN_LEVEL = 0.002f // ~-54 dBFS
 
         init {
             try {
@@ -38,6 +41,23 @@ class AudioProcessor @Inject constructor() {
                 Log.e(TAG, "Failed to load native audio processing library", e)
             }
         }
+
+        /**
+         * Allocate a direct buffer in native byte order for the *Direct natives.
+         *
+         * @param sampleCount Number of samples the buffer must hold
+         * @param bytesPerSample 2 for PCM16, 4 for float samples
+         * @return Direct ByteBuffer sized for the samples
+         */
+        fun allocateDirectBuffer(sampleCount: Int, bytesPerSample: Int = Float.SIZE_BYTES): ByteBuffer =
+            ByteBuffer.allocateDirect(sampleCount * bytesPerSample).order(ByteOrder.nativeOrder())
+
+        /**
+         * Number of output samples produced when resampling between rates.
+         */
+        fun resampledLength(sampleCount: Int, sourceRate: Int, targetRate: Int): Int =
+            if (sourceRate == targetRate) sampleCount
+            else (sampleCount.toLong() * targetRate / sourceRate).toInt()
     }
 
     // Native method declarations
@@ -46,6 +66,66 @@ class AudioProcessor @Inject constructor() {
     external fun highPassFilter(audioData: FloatArray, cutoffFreq: Float, sampleRate: Int): FloatArray?
     external fun normalizeAudio(audioData: FloatArray, targetLevel: Float): FloatArray?
     external fun calculateRMS(audioData: FloatArray): Float
+    /** Spectral subtraction over the whole buffer; [strength] in [0, 1]. */
+    external fun reduceNoisePcm16(pcmData: ShortArray, strength: Float): ShortArray?
+    /** Look-ahead AGC over the whole buffer; [targetLevel] is the RMS to steer towards. */
+    external fun automaticGainControlPcm16(
+        pcmData: ShortArray,
+        sampleRate: Int,
+        targetLevel: Float,
+        attackMs: Float,
+        releaseMs: Float,
+        maxGain: Float
+    ): ShortArray?
+    external fun preprocessPcm16(
+        pcmData: ShortArray,
+        sourceRate: Int,
+        targetRate: Int,
+        applyFiltering: Boolean,
+        cutoffFreq: Float,
+        applyNormalization: Boolean,
+        targetLevel: Float
+    ): FloatArray?
+
+    // Zero-copy variants operating on direct ByteBuffers in native byte order.
+    // Data always starts at offset 0; buffer position and limit are ignored.
+    // Int results are the number of samples written, or -1 on error.
+    external fun pcm16ToFloatDirect(pcmBuffer: ByteBuffer, sampleCount: Int, floatBuffer: ByteBuffer): Int
+    external fun resampleAudioDirect(
+        inputBuffer: ByteBuffer,
+        sampleCount: Int,
+        sourceRate: Int,
+        targetRate: Int,
+        outputBuffer: ByteBuffer
+    ): Int
+    external fun highPassFilterDirect(
+        audioBuffer: ByteBuffer,
+        sampleCount: Int,
+        cutoffFreq: Float,
+        sampleRate: Int
+    ): Boolean
+    external fun normalizeAudioDirect(audioBuffer: ByteBuffer, sampleCount: Int, targetLevel: Float): Boolean
+    external fun calculateRMSDirect(audioBuffer: ByteBuffer, sampleCount: Int): Float
+    external fun preprocessPcm16Direct(
+        pcmBuffer: ByteBuffer,
+        sampleCount: Int,
+        sourceRate: Int,
+        targetRate: Int,
+        applyFiltering: Boolean,
+        cutoffFreq: Float,
+        applyNormalization: Boolean,
+        targetLevel: Float,
+        outputBuffer: ByteBuffer
+    ): Int
+
+    // Frame-based VAD; regions are sample offsets flattened as [start0, end0, start1, end1, ...]
+    external fun detectSpeechRegions(audioData: FloatArray, sampleRate: Int, minLevel: Float): IntArray?
+    external fun detectSpeechRegionsDirect(
+        audioBuffer: ByteBuffer,
+        sampleCount: Int,
+        sampleRate: Int,
+        minLevel: Float
+    ): IntArray?
 
     /**
      * Convert PCM16 audio data to float array suitable for Whisper.
@@ -231,7 +311,8 @@ class AudioProcessor @Inject constructor() {
 
     /**
      * Complete audio preprocessing pipeline for Whisper transcription.
-     * Applies all necessary processing steps in the correct order.
+     * Conversion, resampling, filtering and normalization run in a single
+     * native pass with one output allocation.
      * This operation is performed on a background thread.
      *
      * @param pcmData Raw PCM16 audio data
@@ -247,75 +328,140 @@ class AudioProcessor @Inject constructor() {
         applyNormalization: Boolean = true
     ): Result<FloatArray> = withContext(Dispatchers.Default) {
         try {
-            Log.d(TAG, "Starting audio preprocessing pipeline: ${pcmData.size} samples at ${sourceRate}Hz")
+            if (pcmData.isEmpty()) {
+                return@withContext Result.failure(
+                    IllegalArgumentException("PCM data is empty")
+                )
+            }
 
-            // Step 1: Convert PCM16 to float
-            val floatResult = convertPcm16ToFloat(pcmData)
-            if (floatResult.isFailure) {
+            if (sourceRate <= 0) {
                 return@withContext Result.failure(
-                    Exception("PCM16 conversion failed", floatResult.exceptionOrNull())
+                    IllegalArgumentException("Invalid sample rate: $sourceRate")
                 )
             }
-            var audioData = floatResult.getOrNull() ?: return@withContext Result.failure(
-                Exception("PCM16 conversion returned null")
+
+            Log.d(TAG, "Starting audio preprocessing pipeline: ${pcmData.size} samples at ${sourceRate}Hz")
+
+            val result = preprocessPcm16(
+                pcmData,
+                sourceRate,
+                WHISPER_SAMPLE_RATE,
+                applyFiltering,
+                DEFAULT_HIGH_PASS_CUTOFF,
+                applyNormalization,
+                DEFAULT_NORMALIZE_LEVEL
             )
 
-            // Step 2: Resample to 16kHz if needed
-            if (sourceRate != WHISPER_SAMPLE_RATE) {
-                val resampleResult = resampleToWhisperRate(audioData, sourceRate)
-                if (resampleResult.isFailure) {
-                    return@withContext Result.failure(
-                        Exception("Resampling failed", resampleResult.exceptionOrNull())
-                    )
-                }
-                audioData = resampleResult.getOrNull() ?: return@withContext Result.failure(
-                    Exception("Resampling returned null")
-                )
+            if (result != null) {
+                Log.d(TAG, "Audio preprocessing completed successfully: ${result.size} samples")
+                Result.success(result)
+            } else {
+                Log.e(TAG, "Audio preprocessing failed - native function returned null")
+                Result.failure(Exception("Audio preprocessing failed"))
             }
+        } catch (e: Exception) {
+            Log.e(TAG, "Exception during audio preprocessing", e)
+            Result.failure(e)
+        }
+    }
 
-            // Step 3: Apply high-pass filter to remove low-frequency noise
-            if (applyFiltering) {
-                val filterResult = applyHighPassFilter(audioData)
-                if (filterResult.isFailure) {
-                    Log.w(TAG, "High-pass filtering failed, continuing without filtering",
-                          filterResult.exceptionOrNull())
-                    // Continue without filtering rather than failing
-                } else {
-                    filterResult.getOrNull()?.let { audioData = it }
-                }
+    /**
+     * Zero-copy variant of [preprocessAudioForWhisper] for direct buffers.
+     * No Java arrays are allocated; the output buffer is written in place.
+     *
+     * @param pcmBuffer Direct buffer holding PCM16 samples in native byte order
+     * @param sampleCount Number of PCM16 samples in [pcmBuffer]
+     * @param sourceRate Original sample rate
+     * @param outputBuffer Direct buffer receiving float samples; must hold
+     *        [resampledLength] floats
+     * @param applyFiltering Whether to apply high-pass filtering
+     * @param applyNormalization Whether to normalize amplitude
+     * @return Result containing the number of float samples written
+     */
+    suspend fun preprocessAudioForWhisper(
+        pcmBuffer: ByteBuffer,
+        sampleCount: Int,
+        sourceRate: Int,
+        outputBuffer: ByteBuffer,
+        applyFiltering: Boolean = true,
+        applyNormalization: Boolean = true
+    ): Result<Int> = withContext(Dispatchers.Default) {
+        try {
+            if (!pcmBuffer.isDirect || !outputBuffer.isDirect) {
+                return@withContext Result.failure(
+                    IllegalArgumentException("Buffers must be direct ByteBuffers")
+                )
             }
 
-            // Step 4: Normalize amplitude
-            if (applyNormalization) {
-                val normalizeResult = normalizeAmplitude(audioData)
-                if (normalizeResult.isFailure) {
-                    Log.w(TAG, "Normalization failed, continuing without normalization",
-                          normalizeResult.exceptionOrNull())
-                    // Continue without normalization rather than failing
-                } else {
-                    normalizeResult.getOrNull()?.let { audioData = it }
-                }
+            if (sampleCount <= 0 || sourceRate <= 0) {
+                return@withContext Result.failure(
+                    IllegalArgumentException("Invalid parameters: samples=$sampleCount, sourceRate=$sourceRate")
+                )
             }
 
-            Log.d(TAG, "Audio preprocessing completed successfully: ${audioData.size} samples")
-            Result.success(audioData)
+            val written = preprocessPcm16Direct(
+                pcmBuffer,
+                sampleCount,
+                sourceRate,
+                WHISPER_SAMPLE_RATE,
+                applyFiltering,
+                DEFAULT_HIGH_PASS_CUTOFF,
+                applyNormalization,
+                DEFAULT_NORMALIZE_LEVEL,
+                outputBuffer
+            )
 
+            if (written >= 0) {
+                Result.success(written)
+            } else {
+                Log.e(TAG, "Direct audio preprocessing failed")
+                Result.failure(Exception("Direct audio preprocessing failed"))
+            }
         } catch (e: Exception) {
-            Log.e(TAG, "Exception during audio preprocessing", e)
+            Log.e(TAG, "Exception during direct audio preprocessing", e)
             Result.failure(e)
         }
     }
 
     /**
-     * Check if audio contains sufficient energy for transcription.
+     * Find the spans of speech in the audio.
+     * Frames are classified on energy against an adaptive noise floor,
+     * zero-crossing rate and spectral flatness, then smoothed with
+     * onset/hangover logic and padded with a little context.
      *
      * @param audioData Audio samples to analyze
-     * @param threshold Minimum RMS threshold (default: 0.01)
-     * @return true if audio has sufficient energy
+     * @param sampleRate Sample rate of the audio
+     * @param minLevel Absolute RMS level below which nothing counts as speech
+     * @return Speech regions in ascending order, empty if there is no speech
      */
-    fun hasAudioActivity(audioData: FloatArray, threshold: Float = 0.01f): Boolean {
-        val rms = calculateAudioRMS(audioData)
-        return rms > threshold
+    fun detectSpeech(
+        audioData: FloatArray,
+        sampleRate: Int = WHISPER_SAMPLE_RATE,
+        minLevel: Float = DEFAULT_VAD_MIN_LEVEL
+    ): List<SpeechRegion> {
+        if (audioData.isEmpty()) return emptyList()
+        val flat = detectSpeechRegions(audioData, sampleRate, minLevel) ?: return emptyList()
+        return List(flat.size / 2) { SpeechRegion(flat[it * 2], flat[it * 2 + 1]) }
+    }
+
+    /**
+     * Check if audio contains speech worth transcribing.
+     *
+     * @param audioData Audio samples to analyze
+     * @param threshold Minimum RMS level for a frame to count as speech (default: 0.01)
+     * @param sampleRate Sample rate of the audio
+     * @return true if the VAD finds at least one speech region
+     */
+    fun hasAudioActivity(
+        audioData: FloatArray,
+        threshold: Float = 0.01f,
+        sampleRate: Int = WHISPER_SAMPLE_RATE
+    ): Boolean {
+        return try {
+            detectSpeech(audioData, sampleRate, threshold).isNotEmpty()
+        } catch (e: UnsatisfiedLinkError) {
+            calculateAudioRMS(audioData) > threshold
+        }
     }
 
     /**
@@ -340,3 +486,14 @@ class AudioProcessor @Inject constructor() {
         )
     }
 }
+
+/**
+ * Half-open span of speech, in samples.
+ *
+ * @param start First sample of the region
+ * @param end Sample after the last one in the region
+ */
+data class SpeechRegion(val start: Int, val end: Int) {
+    val length: Int
+        get() = end - start
+}
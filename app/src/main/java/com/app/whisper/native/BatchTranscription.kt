@@ -0,0 +1,61 @@
+package com.app.whisper.native
+
+import kotlinx.coroutines.CompletableDeferred
+import java.io.IOException
+
+/**
+ * Callback invoked from the native decode thread once per batch job, in
+ * submission order.
+ */
+fun interface BatchResultListener {
+    fun onResult(jobId: Long, status: Int, text: String)
+}
+
+/**
+ * Audio to transcribe as part of a batch.
+ */
+sealed class BatchInput {
+    /**
+     * In-memory mono samples; copied natively when submitted.
+     */
+    class Samples(val audioData: FloatArray, val sampleRate: Int = 16000) : BatchInput()
+
+    /**
+     * 16-bit PCM WAV file, read natively while the previous job decodes.
+     */
+    data class WavFile(val path: String) : BatchInput()
+}
+
+/**
+ * Outcome of one batch job.
+ *
+ * @param index Position of the job in the submitted list
+ * @param input The submitted input
+ * @param result Transcribed text, or the reason the job failed
+ */
+data class BatchTranscriptionResult(
+    val index: Int,
+    val input: BatchInput,
+    val result: Result<String>
+)
+
+/**
+ * A native batch queue in flight, tracked so releasing the context can
+ * cancel it and wake its caller.
+ */
+internal class ActiveBatch(val handle: Long) {
+    val done = CompletableDeferred<Unit>()
+
+    companion object {
+        // Must match BatchStatus in batch_transcriber.h
+        const val STATUS_OK = 0
+        const val STATUS_LOAD_FAILED = -1
+        const val STATUS_DECODE_FAILED = -2
+
+        fun toResult(status: Int, text: String): Result<String> = when (status) {
+            STATUS_OK -> Result.success(text.trim())
+            STATUS_LOAD_FAILED -> Result.failure(IOException("Failed to read audio"))
+            else -> Result.failure(Exception("Transcription failed with status $status"))
+        }
+    }
+}
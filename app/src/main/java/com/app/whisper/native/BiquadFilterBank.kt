@@ -0,0 +1,100 @@
+package com.app.whisper.native
+
+import android.util.Log
+import java.nio.ByteBuffer
+
+/**
+ * Stateful speech conditioning filters backed by native code: a
+ * Butterworth high-pass, an optional mains hum notch and optional
+ * pre-emphasis, run as one cascade of biquads.
+ *
+ * Filter state carries across [process] calls, so audio can be filtered
+ * chunk by chunk as it arrives with exactly the result of filtering it in
+ * one go. Samples are filtered in place and nothing is allocated per call.
+ *
+ * Instances are not thread-safe and must be [close]d to free native memory.
+ *
+ * @param sampleRate Rate of the audio being filtered
+ * @param highPassHz High-pass corner frequency; 0 disables the high-pass
+ * @param highPassOrder 2 or 4
+ * @param notchHz Hum frequency to remove (50 or 60 Hz); 0 disables the notch
+ * @param notchQ Notch quality factor; higher is narrower
+ * @param preEmphasis Pre-emphasis coefficient in [0, 1); 0 disables it
+ */
+class BiquadFilterBank(
+    val sampleRate: Int,
+    highPassHz: Float = DEFAULT_HIGH_PASS_HZ,
+    highPassOrder: Int = 2,
+    notchHz: Float = 0f,
+    notchQ: Float = DEFAULT_NOTCH_Q,
+    preEmphasis: Float = 0f
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "BiquadFilterBank"
+
+        const val DEFAULT_HIGH_PASS_HZ = 80f
+        const val DEFAULT_NOTCH_Q = 30f
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native audio processing library", e)
+            }
+        }
+    }
+
+    private var handle: Long = nativeCreate(sampleRate, highPassHz, highPassOrder, notchHz, notchQ, preEmphasis)
+
+    init {
+        require(handle != 0L) {
+            "Invalid filter bank: $sampleRate Hz, highPass=$highPassHz/$highPassOrder, " +
+                "notch=$notchHz, preEmphasis=$preEmphasis"
+        }
+    }
+
+    private external fun nativeCreate(
+        sampleRate: Int,
+        highPassHz: Float,
+        highPassOrder: Int,
+        notchHz: Float,
+        notchQ: Float,
+        preEmphasis: Float
+    ): Long
+    private external fun nativeProcess(handle: Long, samples: FloatArray, count: Int): Boolean
+    private external fun nativeProcessDirect(handle: Long, buffer: ByteBuffer, count: Int): Boolean
+    private external fun nativeReset(handle: Long)
+    private external fun nativeRelease(handle: Long)
+
+    /**
+     * Filter the first [count] samples of [samples] in place.
+     */
+    fun process(samples: FloatArray, count: Int = samples.size) {
+        check(handle != 0L) { "BiquadFilterBank has been closed" }
+        require(nativeProcess(handle, samples, count)) { "Invalid sample count: $count" }
+    }
+
+    /**
+     * Filter [count] floats of a direct buffer (native byte order, offset 0) in place.
+     */
+    fun process(buffer: ByteBuffer, count: Int) {
+        check(handle != 0L) { "BiquadFilterBank has been closed" }
+        require(nativeProcessDirect(handle, buffer, count)) { "Invalid filter buffer for $count samples" }
+    }
+
+    /**
+     * Discard filter history so a new stream can start.
+     */
+    fun reset() {
+        check(handle != 0L) { "BiquadFilterBank has been closed" }
+        nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+}
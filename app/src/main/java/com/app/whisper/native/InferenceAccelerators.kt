@@ -0,0 +1,99 @@
+package com.app.whisper.native
+
+import android.util.Log
+import javax.inject.Inject
+import javax.inject.Singleton
+
+/**
+ * Compute backend a Whisper context runs on.
+ * Order must match InferenceBackend in accelerator.h.
+ */
+enum class InferenceBackend {
+    CPU,
+    GPU
+}
+
+/**
+ * A GPU device the native library can run whisper on.
+ *
+ * @param index Device number to pass to [WhisperNative.initialize]
+ * @param name Backend device name, e.g. "Vulkan0"
+ * @param description Driver's name for the device
+ * @param memoryFreeBytes Device memory currently free, as reported by the driver
+ * @param memoryTotalBytes Total device memory
+ */
+data class AcceleratorInfo(
+    val index: Int,
+    val name: String,
+    val description: String,
+    val memoryFreeBytes: Long,
+    val memoryTotalBytes: Long
+)
+
+/**
+ * Capability probe for accelerated inference.
+ *
+ * Lists the GPU devices ggml registered in this build of the native library
+ * (Vulkan or OpenCL). CPU-only builds, and devices without a usable driver,
+ * report none. The list doesn't change while the process runs, so it is
+ * probed once.
+ */
+@Singleton
+class InferenceAccelerators @Inject constructor() {
+
+    companion object {
+        private const val TAG = "InferenceAccelerators"
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native library", e)
+            }
+        }
+    }
+
+    private val devices: List<AcceleratorInfo> by lazy { probeDevices() }
+
+    private external fun nativeProbeDevices(): Array<String>?
+    private external fun nativeProbeMemory(): LongArray?
+
+    /**
+     * GPU devices available for inference, empty if none.
+     */
+    fun probe(): List<AcceleratorInfo> = devices
+
+    /**
+     * Whether [WhisperNative.initialize] can be asked for [InferenceBackend.GPU].
+     */
+    fun isGpuAvailable(): Boolean = devices.isNotEmpty()
+
+    private fun probeDevices(): List<AcceleratorInfo> {
+        val names: Array<String>
+        val memory: LongArray
+        try {
+            names = nativeProbeDevices() ?: return emptyList()
+            memory = nativeProbeMemory() ?: return emptyList()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            return emptyList()
+        }
+
+        val count = names.size / 2
+        if (memory.size != count * 2) {
+            Log.e(TAG, "Unexpected accelerator probe layout: ${names.size} names, ${memory.size} values")
+            return emptyList()
+        }
+        return List(count) { i ->
+            AcceleratorInfo(
+                index = i,
+                name = names[i * 2],
+                description = names[i * 2 + 1],
+                memoryFreeBytes = memory[i * 2],
+                memoryTotalBytes = memory[i * 2 + 1]
+            )
+        }.also { found ->
+            found.forEach { Log.i(TAG, "GPU ${it.index}: ${it.name} (${it.description})") }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+package com.app.whisper.native
+
+import android.util.Log
+import javax.inject.Inject
+import javax.inject.Singleton
+
+/**
+ * Native processing stages with their own timers.
+ * Order must match the Stage enum in perf_stats.h.
+ */
+enum class NativeStage(val label: String) {
+    JNI_COPY("jni_copy"),
+    CONVERT("convert"),
+    RESAMPLE("resample"),
+    FILTER("filter"),
+    DENOISE("denoise"),
+    NORMALIZE("normalize"),
+    VAD("vad"),
+    MEL("mel"),
+    ENCODE("encode"),
+    DECODE("decode"),
+    WHISPER_FULL("whisper_full")
+}
+
+/**
+ * Accumulated timing of one native stage across all threads.
+ *
+ * @param stage Stage the samples belong to
+ * @param count Number of timed calls
+ * @param totalNs Total time spent in the stage
+ * @param maxNs Longest single call
+ */
+data class NativeStageStats(
+    val stage: NativeStage,
+    val count: Long,
+    val totalNs: Long,
+    val maxNs: Long
+) {
+    val averageNs: Long
+        get() = if (count > 0) totalNs / count else 0L
+}
+
+/**
+ * Access to the native per-stage timers.
+ *
+ * Native code records each stage into lock-free per-thread counters;
+ * [snapshot] sums them in a single JNI call. The same stages appear as
+ * "whisper:<stage>" sections in system traces while tracing is enabled.
+ */
+@Singleton
+class NativeStats @Inject constructor() {
+
+    companion object {
+        private const val TAG = "NativeStats"
+        private const val FIELDS_PER_STAGE = 3
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native library", e)
+            }
+        }
+    }
+
+    private external fun nativeSnapshot(): LongArray?
+    private external fun nativeReset()
+
+    /**
+     * Current totals for every stage since start-up or the last [reset].
+     *
+     * @return One entry per stage, empty if the native library is unavailable
+     */
+    fun snapshot(): List<NativeStageStats> {
+        val flat = try {
+            nativeSnapshot()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            null
+        } ?: return emptyList()
+
+        val stages = NativeStage.values()
+        if (flat.size != stages.size * FIELDS_PER_STAGE) {
+            Log.e(TAG, "Unexpected native stats layout: ${flat.size} values")
+            return emptyList()
+        }
+
+        return stages.mapIndexed { index, stage ->
+            val base = index * FIELDS_PER_STAGE
+            NativeStageStats(stage, flat[base], flat[base + 1], flat[base + 2])
+        }
+    }
+
+    /**
+     * Zero all stage counters.
+     */
+    fun reset() {
+        try {
+            nativeReset()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+        }
+    }
+}
@@ -0,0 +1,161 @@
+package com.app.whisper.native
+
+import com.app.whisper.domain.entity.TranscriptionSegment
+import com.app.whisper.domain.entity.TranscriptionWord
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Read-only view of a transcription packed natively by
+ * [WhisperNative.transcribeDetailed]. Nothing is decoded up front: each
+ * accessor reads its record straight from the buffer, and text is only
+ * turned into Strings when asked for, so a caller that wants segment times
+ * or one segment's words doesn't pay for the rest.
+ *
+ * The view reads the buffer in place; don't reuse the buffer for another
+ * transcription while this object is still in use.
+ *
+ * Layout (native byte order) mirrors packed_result.h:
+ * header, segment records, token records, then one UTF-8 text blob.
+ */
+class PackedTranscription internal constructor(buffer: ByteBuffer, size: Int) {
+
+    companion object {
+        const val VERSION = 1
+
+        private const val HEADER_BYTES = 16
+        private const val SEGMENT_BYTES = 24
+        private const val TOKEN_BYTES = 24
+    }
+
+    private val data: ByteBuffer = buffer.duplicate().order(ByteOrder.nativeOrder())
+
+    val segmentCount: Int
+    val tokenCount: Int
+
+    private val segmentsOffset = HEADER_BYTES
+    private val tokensOffset: Int
+    private val textOffset: Int
+
+    init {
+        require(size >= HEADER_BYTES) { "Packed result truncated: $size bytes" }
+        val version = data.getInt(0)
+        require(version == VERSION) { "Unsupported packed result version $version" }
+        segmentCount = data.getInt(4)
+        tokenCount = data.getInt(8)
+        val textBytes = data.getInt(12)
+        tokensOffset = segmentsOffset + segmentCount * SEGMENT_BYTES
+        textOffset = tokensOffset + tokenCount * TOKEN_BYTES
+        require(textOffset + textBytes <= size) { "Packed result truncated: $size bytes" }
+    }
+
+    /** All segment texts joined with single spaces, as [WhisperNative.transcribe] returns. */
+    val text: String by lazy {
+        (0 until segmentCount).joinToString(" ") { segmentText(it).trim() }
+    }
+
+    fun segmentStartMs(segment: Int): Long = segmentInt(segment, 0).toLong()
+
+    fun segmentEndMs(segment: Int): Long = segmentInt(segment, 4).toLong()
+
+    fun segmentText(segment: Int): String = decodeText(segmentInt(segment, 16), segmentInt(segment, 20))
+
+    /** Index of the segment's first token in the token records. */
+    fun segmentFirstToken(segment: Int): Int = segmentInt(segment, 8)
+
+    fun segmentTokenCount(segment: Int): Int = segmentInt(segment, 12)
+
+    fun tokenId(token: Int): Int = tokenInt(token, 0)
+
+    fun tokenStartMs(token: Int): Long = tokenInt(token, 4).toLong()
+
+    fun tokenEndMs(token: Int): Long = tokenInt(token, 8).toLong()
+
+    fun tokenProbability(token: Int): Float = data.getFloat(tokenRecord(token) + 12)
+
+    fun tokenText(token: Int): String = decodeText(tokenInt(token, 16), tokenInt(token, 20))
+
+    /** Mean token probability of the segment, or 0 for a segment without tokens. */
+    fun segmentConfidence(segment: Int): Float {
+        val first = segmentFirstToken(segment)
+        val count = segmentTokenCount(segment)
+        if (count == 0) return 0f
+        var sum = 0f
+        for (token in first until first + count) {
+            sum += tokenProbability(token)
+        }
+        return sum / count
+    }
+
+    /**
+     * Words of a segment, for highlighting during playback. A word starts at
+     * each token that begins with a space, so punctuation and word pieces
+     * join the word before them; its text is decoded from the tokens' bytes
+     * together, which keeps characters split across tokens intact.
+     */
+    fun words(segment: Int): List<TranscriptionWord> {
+        val first = segmentFirstToken(segment)
+        val end = first + segmentTokenCount(segment)
+        val words = mutableListOf<TranscriptionWord>()
+        var start = first
+        while (start < end) {
+            var next = start + 1
+            while (next < end && !startsWithSpace(next)) {
+                next++
+            }
+            val textStart = tokenInt(start, 16)
+            val textEnd = tokenInt(next - 1, 16) + tokenInt(next - 1, 20)
+            val wordText = decodeText(textStart, textEnd - textStart).trim()
+            if (wordText.isNotEmpty()) {
+                var probability = 0f
+                for (token in start until next) {
+                    probability += tokenProbability(token)
+                }
+                words += TranscriptionWord(
+                    text = wordText,
+                    startTime = tokenStartMs(start),
+                    endTime = tokenEndMs(next - 1),
+                    confidence = probability / (next - start)
+                )
+            }
+            start = next
+        }
+        return words
+    }
+
+    /** Decode everything into domain segments with their words. */
+    fun toSegments(): List<TranscriptionSegment> = (0 until segmentCount).map { segment ->
+        TranscriptionSegment(
+            id = segment,
+            text = segmentText(segment).trim(),
+            startTime = segmentStartMs(segment),
+            endTime = segmentEndMs(segment),
+            confidence = segmentConfidence(segment),
+            words = words(segment)
+        )
+    }
+
+    private fun segmentInt(segment: Int, field: Int): Int {
+        if (segment !in 0 until segmentCount) throw IndexOutOfBoundsException("Segment $segment of $segmentCount")
+        return data.getInt(segmentsOffset + segment * SEGMENT_BYTES + field)
+    }
+
+    private fun tokenRecord(token: Int): Int {
+        if (token !in 0 until tokenCount) throw IndexOutOfBoundsException("Token $token of $tokenCount")
+        return tokensOffset + token * TOKEN_BYTES
+    }
+
+    private fun tokenInt(token: Int, field: Int): Int = data.getInt(tokenRecord(token) + field)
+
+    private fun startsWithSpace(token: Int): Boolean =
+        tokenInt(token, 20) > 0 && data.get(textOffset + tokenInt(token, 16)) == ' '.code.toByte()
+
+    private fun decodeText(offset: Int, length: Int): String {
+        if (length <= 0) return ""
+        val bytes = ByteArray(length)
+        val view = data.duplicate()
+        view.position(textOffset + offset)
+        view.get(bytes)
+        return String(bytes, Charsets.UTF_8)
+    }
+}
@@ -0,0 +1,23 @@
+package com.app.whisper.native
+
+/**
+ * Callback invoked from native code, on the calling thread, for each segment
+ * of a parallel transcription once all chunks have been decoded, or of a
+ * file transcription as each window is committed.
+ */
+fun interface TimedSegmentListener {
+    fun onSegment(text: String, startMs: Long, endMs: Long)
+}
+
+/**
+ * A transcribed segment with timestamps from the start of the recording.
+ *
+ * @param text Segment text
+ * @param startMs Start time in milliseconds
+ * @param endMs End time in milliseconds
+ */
+data class TimedSegment(
+    val text: String,
+    val startMs: Long,
+    val endMs: Long
+)
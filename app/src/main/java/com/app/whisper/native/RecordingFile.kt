@@ -0,0 +1,148 @@
+package com.app.whisper.native
+
+import android.util.Log
+import java.io.File
+
+/**
+ * Read-only view of a recording stored in the compact `.wrec` format:
+ * Opus-compressed audio in 5 s chunks plus a binary segment index, in one
+ * file that native code memory-maps.
+ *
+ * Opening a recording reads only its header; [segments], [findSegment] and
+ * [search] read only the index and text, and [readRange] decodes only the
+ * chunks overlapping the range, so seeking, search highlighting and
+ * re-transcribing part of an hour-long recording never decode the rest.
+ *
+ * Methods may be called from any thread. Instances must be [close]d to
+ * unmap the file.
+ *
+ * @param file Recording written by [write]
+ * @throws IllegalArgumentException if the file is missing or not a recording
+ */
+class RecordingFile(file: File) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "RecordingFile"
+
+        /** File extension of recordings. */
+        const val EXTENSION = "wrec"
+
+        /** Codecs [write] may store audio with. */
+        const val CODEC_PCM16 = 0
+        const val CODEC_OPUS = 1
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native recording library", e)
+            }
+        }
+
+        /**
+         * Write mono [samples] at [sampleRate] and their [segments] to [file],
+         * replacing it atomically.
+         *
+         * Audio is Opus-compressed when [compress] is set and the platform has
+         * an Opus encoder (Android 10+), and stored as PCM16 otherwise.
+         *
+         * @return [CODEC_OPUS] or [CODEC_PCM16], or -1 if the file couldn't be written
+         */
+        fun write(
+            file: File,
+            samples: FloatArray,
+            sampleRate: Int,
+            segments: List<TimedSegment>,
+            compress: Boolean = true
+        ): Int {
+            val starts = LongArray(segments.size) { segments[it].startMs }
+            val ends = LongArray(segments.size) { segments[it].endMs }
+            val texts = Array(segments.size) { segments[it].text }
+            return nativeWrite(file.absolutePath, samples, sampleRate, starts, ends, texts, compress)
+        }
+
+        @JvmStatic
+        private external fun nativeWrite(
+            path: String,
+            samples: FloatArray,
+            sampleRate: Int,
+            starts: LongArray,
+            ends: LongArray,
+            texts: Array<String>,
+            compress: Boolean
+        ): Int
+    }
+
+    private var handle: Long = nativeOpen(file.absolutePath)
+
+    init {
+        require(handle != 0L) { "Not a recording file: ${file.absolutePath}" }
+    }
+
+    private external fun nativeOpen(path: String): Long
+    private external fun nativeSampleRate(handle: Long): Int
+    private external fun nativeDurationMs(handle: Long): Long
+    private external fun nativeSegmentTimes(handle: Long): LongArray?
+    private external fun nativeSegmentText(handle: Long, index: Int): String?
+    private external fun nativeFindSegment(handle: Long, timeMs: Long): Int
+    private external fun nativeSearch(handle: Long, query: String): IntArray?
+    private external fun nativeReadRange(handle: Long, startMs: Long, endMs: Long): FloatArray?
+    private external fun nativeRelease(handle: Long)
+
+    /** Rate of the stored audio. */
+    val sampleRate: Int
+        get() = if (handle != 0L) nativeSampleRate(handle) else 0
+
+    val durationMs: Long
+        get() = if (handle != 0L) nativeDurationMs(handle) else 0L
+
+    /**
+     * All segments in time order.
+     */
+    fun segments(): List<TimedSegment> {
+        check(handle != 0L) { "RecordingFile has been closed" }
+        val times = nativeSegmentTimes(handle) ?: return emptyList()
+        return List(times.size / 2) { index ->
+            TimedSegment(
+                text = nativeSegmentText(handle, index) ?: "",
+                startMs = times[index * 2],
+                endMs = times[index * 2 + 1]
+            )
+        }
+    }
+
+    /**
+     * Index into [segments] of the segment playing at [timeMs], or of the
+     * last one before it when [timeMs] falls in a gap; -1 before the first.
+     */
+    fun findSegment(timeMs: Long): Int {
+        check(handle != 0L) { "RecordingFile has been closed" }
+        return nativeFindSegment(handle, timeMs)
+    }
+
+    /**
+     * Indices into [segments] of the segments containing [query], ignoring
+     * ASCII case.
+     */
+    fun search(query: String): IntArray {
+        check(handle != 0L) { "RecordingFile has been closed" }
+        return nativeSearch(handle, query) ?: IntArray(0)
+    }
+
+    /**
+     * Audio in [startMs, endMs) at [sampleRate], clamped to the recording.
+     *
+     * @return The samples, or null if a chunk failed to decode
+     */
+    fun readRange(startMs: Long, endMs: Long): FloatArray? {
+        check(handle != 0L) { "RecordingFile has been closed" }
+        return nativeReadRange(handle, startMs, endMs)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+}
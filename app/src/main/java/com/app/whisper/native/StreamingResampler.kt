@@ -0,0 +1,82 @@
+package com.app.whisper.native
+
+import android.util.Log
+
+/**
+ * Chunked polyphase resampler backed by native code.
+ *
+ * Filter history and phase are carried across [process] calls, so audio can be
+ * resampled as it arrives from the recorder instead of over the whole buffer
+ * once recording stops. Concatenating the outputs of [process] followed by
+ * [flush] gives exactly the same samples as resampling the full input at once.
+ *
+ * Instances are not thread-safe and must be [close]d to free native memory.
+ *
+ * @param sourceRate Sample rate of the incoming audio
+ * @param targetRate Output sample rate (default: 16000 Hz for Whisper)
+ */
+class StreamingResampler(
+    val sourceRate: Int,
+    val targetRate: Int = AudioProcessor.WHISPER_SAMPLE_RATE
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "StreamingResampler"
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native audio processing library", e)
+            }
+        }
+    }
+
+    private var handle: Long = nativeCreate(sourceRate, targetRate)
+
+    init {
+        require(handle != 0L) { "Unsupported resampling rates: $sourceRate -> $targetRate" }
+    }
+
+    private external fun nativeCreate(sourceRate: Int, targetRate: Int): Long
+    private external fun nativeProcess(handle: Long, audioData: FloatArray): FloatArray?
+    private external fun nativeFlush(handle: Long): FloatArray?
+    private external fun nativeReset(handle: Long)
+    private external fun nativeRelease(handle: Long)
+
+    /**
+     * Resample the next chunk of audio.
+     *
+     * @param chunk Input samples at [sourceRate]
+     * @return Output samples that became available (may be empty)
+     */
+    fun process(chunk: FloatArray): FloatArray {
+        check(handle != 0L) { "StreamingResampler has been closed" }
+        return nativeProcess(handle, chunk) ?: FloatArray(0)
+    }
+
+    /**
+     * Emit the remaining filter tail at the end of the stream.
+     *
+     * @return Final output samples
+     */
+    fun flush(): FloatArray {
+        check(handle != 0L) { "StreamingResampler has been closed" }
+        return nativeFlush(handle) ?: FloatArray(0)
+    }
+
+    /**
+     * Discard all filter history so a new stream can start.
+     */
+    fun reset() {
+        check(handle != 0L) { "StreamingResampler has been closed" }
+        nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+}
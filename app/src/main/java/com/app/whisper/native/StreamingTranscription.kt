@@ -0,0 +1,206 @@
+package com.app.whisper.native
+
+import kotlinx.coroutines.flow.MutableSharedFlow
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.SharedFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.flow.asStateFlow
+
+/**
+ * Callback invoked from native code for every segment a streaming session decodes.
+ * Called on the thread that pushed the audio, or on the capture buffer's native
+ * sink thread when the session is attached to an [AudioCaptureBuffer].
+ */
+fun interface StreamingSegmentListener {
+    fun onSegment(text: String, startMs: Long, endMs: Long, isFinal: Boolean)
+}
+
+/**
+ * A segment decoded by a streaming session.
+ *
+ * @param text Segment text
+ * @param startMs Start time from the beginning of the stream
+ * @param endMs End time from the beginning of the stream
+ * @param isFinal Whether the segment is committed; partial segments are
+ *                superseded by the next decode of the same window
+ */
+data class StreamingSegment(
+    val text: String,
+    val startMs: Long,
+    val endMs: Long,
+    val isFinal: Boolean
+)
+
+/**
+ * Running transcript of a streaming session.
+ *
+ * @param finalText Text of all committed windows
+ * @param partialText Latest tentative text for the window still being filled
+ */
+data class StreamingTranscript(
+    val finalText: String = "",
+    val partialText: String = ""
+) {
+    /** Committed and tentative text joined for display. */
+    val text: String
+        get() = listOf(finalText, partialText)
+            .filter { it.isNotBlank() }
+            .joinToString(" ")
+}
+
+/**
+ * Decoder settings of a streaming session that can change while it runs.
+ *
+ * @param threads Decoder threads
+ * @param stepMs New audio required before the window is decoded again; at most the window length
+ * @param beamSize 1 decodes greedily, 2 to 8 runs beam search with that many beams
+ */
+data class StreamingTuning(
+    val threads: Int,
+    val stepMs: Int,
+    val beamSize: Int = 1
+) {
+    val isGreedy: Boolean
+        get() = beamSize <= 1
+}
+
+/**
+ * Decode counters of a streaming session since it started.
+ *
+ * @param decodes Window decodes run, partial and final
+ * @param totalDecodeNs Time spent in those decodes
+ * @param lastDecodeNs Time of the most recent decode
+ * @param decodedAudioMs New audio those decodes consumed
+ */
+data class StreamingDecodeStats(
+    val decodes: Long,
+    val totalDecodeNs: Long,
+    val lastDecodeNs: Long,
+    val decodedAudioMs: Long
+)
+
+/**
+ * Sliding-window transcription session created by [WhisperNative.startStreaming].
+ *
+ * Audio pushed with [push], or fed natively after [attach], is decoded in
+ * overlapping windows on the native side, so text becomes available every step
+ * instead of after recording stops.
+ * The session shares the [WhisperNative] context and is released automatically
+ * when that context is released.
+ */
+class StreamingTranscriptionSession internal constructor(
+    private val whisperNative: WhisperNative,
+    internal var handle: Long
+) {
+
+    private val _segments = MutableSharedFlow<StreamingSegment>(extraBufferCapacity = 64)
+    val segments: SharedFlow<StreamingSegment> = _segments.asSharedFlow()
+
+    private val _transcript = MutableStateFlow(StreamingTranscript())
+    val transcript: StateFlow<StreamingTranscript> = _transcript.asStateFlow()
+
+    private val committed = StringBuilder()
+    private val partial = StringBuilder()
+    private var lastPartialStartMs = -1L
+
+    internal val listener = StreamingSegmentListener { text, startMs, endMs, isFinal ->
+        onSegment(StreamingSegment(text.trim(), startMs, endMs, isFinal))
+    }
+
+    /**
+     * Whether the session can still accept audio.
+     */
+    fun isActive(): Boolean = handle != 0L
+
+    /**
+     * Push newly captured audio.
+     *
+     * @param audioData Samples at the session's sample rate
+     * @return Result indicating success or failure
+     */
+    suspend fun push(audioData: FloatArray): Result<Unit> {
+        if (audioData.isEmpty()) return Result.success(Unit)
+        return whisperNative.pushStream(this, audioData)
+    }
+
+    /**
+     * Feed the session directly from a capture buffer's native pipeline, so
+     * captured audio reaches the decoder without passing through Kotlin.
+     * Decodes run on the pipeline's sink thread, behind a queue of its own,
+     * so a decode slower than real time never stalls capture; if the decoder
+     * falls more than 10 s behind, the live transcript skips audio instead.
+     * Segments are delivered on the sink thread. [push] must not be used
+     * while attached.
+     *
+     * @param capture Capture buffer recording at [AudioCaptureBuffer.OUTPUT_SAMPLE_RATE]
+     * @return Result indicating success or failure
+     */
+    suspend fun attach(capture: AudioCaptureBuffer): Result<Unit> =
+        whisperNative.attachStream(this, capture)
+
+    /**
+     * Change thread count, step and beam size. Takes effect from the next
+     * decode, including while attached to a capture buffer.
+     *
+     * @return Result indicating success or failure
+     */
+    suspend fun setTuning(tuning: StreamingTuning): Result<Unit> =
+        whisperNative.tuneStream(this, tuning)
+
+    /**
+     * Decode counters so far, for comparing decode time with the audio decoded.
+     */
+    suspend fun decodeStats(): Result<StreamingDecodeStats> =
+        whisperNative.streamStats(this)
+
+    /**
+     * Decode the remaining audio as final and release the session.
+     *
+     * @return Final transcript
+     */
+    suspend fun finish(): Result<StreamingTranscript> =
+        whisperNative.finishStream(this).map { transcript.value }
+
+    /**
+     * Release the session without decoding the remaining audio. Waits for a
+     * decode in progress, off the calling thread.
+     */
+    suspend fun release() {
+        whisperNative.releaseStream(this)
+    }
+
+    /**
+     * Release the session like [release] on a background scope of
+     * [WhisperNative], for callers that can't suspend or whose scope is
+     * going away, e.g. ViewModel.onCleared.
+     */
+    fun releaseInBackground() {
+        whisperNative.releaseStreamInBackground(this)
+    }
+
+    @Synchronized
+    private fun onSegment(segment: StreamingSegment) {
+        if (segment.isFinal) {
+            committed.appendSegment(segment.text)
+            partial.clear()
+            lastPartialStartMs = -1L
+        } else {
+            // Each partial decode restarts at the window start and replaces the previous one
+            if (segment.startMs <= lastPartialStartMs) {
+                partial.clear()
+            }
+            lastPartialStartMs = segment.startMs
+            partial.appendSegment(segment.text)
+        }
+
+        _transcript.value = StreamingTranscript(committed.toString(), partial.toString())
+        _segments.tryEmit(segment)
+    }
+
+    private fun StringBuilder.appendSegment(text: String) {
+        if (text.isEmpty()) return
+        if (isNotEmpty()) append(' ')
+        append(text)
+    }
+}
@@ -0,0 +1,138 @@
+package com.app.whisper.native
+
+import android.util.Log
+import com.app.whisper.data.model.WaveformData
+import java.nio.ByteBuffer
+
+/**
+ * Incremental min/max/RMS summary of an audio stream for waveform drawing.
+ *
+ * Samples are folded into a native multi-level pyramid as they are
+ * [append]ed, so [query] costs O(points) at any zoom and never rereads the
+ * audio: drawing the last second or the whole of an hour-long recording
+ * costs the same.
+ *
+ * One thread may append while others query. Instances must be [close]d to
+ * free native memory.
+ *
+ * @param sampleRate Rate of the appended audio
+ * @param baseBinSamples Samples per finest bin (default: 10 ms)
+ */
+class WaveformPyramid(
+    val sampleRate: Int,
+    baseBinSamples: Int = sampleRate / 100
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "WaveformPyramid"
+
+        init {
+            try {
+                System.loadLibrary("whisper-jni")
+            } catch (e: UnsatisfiedLinkError) {
+                Log.e(TAG, "Failed to load native audio processing library", e)
+            }
+        }
+
+        /**
+         * Build [WaveformData] from raw min/max/RMS points covering [durationMs].
+         */
+        internal fun toWaveformData(
+            mins: FloatArray,
+            maxs: FloatArray,
+            rms: FloatArray,
+            points: Int,
+            sampleRate: Int,
+            durationMs: Long
+        ): WaveformData {
+            val peaks = FloatArray(points) { maxOf(-mins[it], maxs[it]) }
+            return WaveformData(
+                amplitudes = peaks,
+                rmsValues = if (points == rms.size) rms else rms.copyOf(points),
+                peakValues = peaks.copyOf(),
+                sampleRate = sampleRate,
+                windowSizeMs = if (points > 0) (durationMs / points).toInt().coerceAtLeast(1) else 1
+            )
+        }
+    }
+
+    private var handle: Long = nativeCreate(baseBinSamples)
+
+    init {
+        require(handle != 0L) { "Invalid waveform bin size: $baseBinSamples" }
+    }
+
+    private external fun nativeCreate(baseBinSamples: Int): Long
+    private external fun nativeAppend(handle: Long, samples: FloatArray, count: Int)
+    private external fun nativeAppendDirect(handle: Long, buffer: ByteBuffer, count: Int)
+    private external fun nativeSampleCount(handle: Long): Long
+    private external fun nativeQuery(
+        handle: Long,
+        start: Long,
+        end: Long,
+        minOut: FloatArray,
+        maxOut: FloatArray,
+        rmsOut: FloatArray
+    ): Int
+    private external fun nativeReset(handle: Long)
+    private external fun nativeRelease(handle: Long)
+
+    /** Samples appended since creation or [reset]. */
+    val sampleCount: Long
+        get() = if (handle != 0L) nativeSampleCount(handle) else 0L
+
+    /**
+     * Fold the first [count] samples of [samples] into the summary.
+     */
+    fun append(samples: FloatArray, count: Int = samples.size) {
+        check(handle != 0L) { "WaveformPyramid has been closed" }
+        nativeAppend(handle, samples, count)
+    }
+
+    /**
+     * Fold [count] floats from a direct buffer (native byte order, offset 0).
+     */
+    fun append(buffer: ByteBuffer, count: Int) {
+        check(handle != 0L) { "WaveformPyramid has been closed" }
+        nativeAppendDirect(handle, buffer, count)
+    }
+
+    /**
+     * Raw per-point minimum, maximum and RMS of samples [startSample, endSample).
+     * The point count is the shortest array; [endSample] is clamped to
+     * [sampleCount].
+     *
+     * @return Points written (0 for an empty range)
+     */
+    fun query(startSample: Long, endSample: Long, minOut: FloatArray, maxOut: FloatArray, rmsOut: FloatArray): Int {
+        check(handle != 0L) { "WaveformPyramid has been closed" }
+        return nativeQuery(handle, startSample, endSample, minOut, maxOut, rmsOut).coerceAtLeast(0)
+    }
+
+    /**
+     * Waveform of samples [startSample, endSample) at [points] resolution, with
+     * amplitudes and peaks taken from the per-point absolute peak.
+     */
+    fun waveform(startSample: Long = 0L, endSample: Long = sampleCount, points: Int): WaveformData {
+        val mins = FloatArray(points)
+        val maxs = FloatArray(points)
+        val rms = FloatArray(points)
+        val end = minOf(endSample, sampleCount)
+        val written = query(startSample, end, mins, maxs, rms)
+        val durationMs = (end - startSample).coerceAtLeast(0L) * 1000L / sampleRate
+        return toWaveformData(mins, maxs, rms, written, sampleRate, durationMs)
+    }
+
+    /** Discard everything appended so a new recording can start. */
+    fun reset() {
+        check(handle != 0L) { "WaveformPyramid has been closed" }
+        nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeRelease(handle)
+            handle = 0L
+        }
+    }
+}
@@ -1,12 +1,26 @@
 package com.app.whisper.native
 
 import android.util.Log
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.CoroutineStart
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.launch
 import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
 import kotlinx.coroutines.withContext
 import java.io.File
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
 import java.util.concurrent.atomic.AtomicLong
 import javax.inject.Inject
 import javax.inject.Singleton
@@ -37,10 +51,32 @@ class WhisperNative @Inject constructor() {
         const val THREADS_DUAL = 2
         const val THREADS_QUAD = 4
         const val THREADS_OCTA = 8
+
+        // Streaming defaults: decode a 10 s window every 2 s of new audio
+        const val STREAM_WINDOW_MS = 10_000
+        const val STREAM_STEP_MS = 2_000
+        // Whisper's encoder takes at most 30 s of audio per window
+        const val STREAM_MAX_WINDOW_MS = 30_000
+
+        // Parallel transcription: shorter audio is one whisper window anyway
+        const val PARALLEL_MIN_AUDIO_MS = 30_000L
+        const val MAX_PARALLEL_CONTEXTS = 3
+
+        // Packed results: a minute of speech is around 10 KB
+        const val DEFAULT_RESULT_BUFFER_BYTES = 64 * 1024
+
+        // How often transcriptionProgress is refreshed from the native side
+        private const val PROGRESS_POLL_MS = 100L
     }
 
-    // Thread safety and state management
+    // Thread safety and state management. Streams decode on states of their
+    // own, so their calls take streamMutex rather than contextMutex; code
+    // taking both takes contextMutex first
     private val contextMutex = Mutex()
+    private val streamMutex = Mutex()
+
+    // Runs releases handed off by callers that can't suspend, outliving their scopes
+    private val releaseScope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
     private val contextPtr = AtomicLong(0L)
     private val isInitialized = AtomicBoolean(false)
     private val isReleased = AtomicBoolean(false)
@@ -48,8 +84,27 @@ class WhisperNative @Inject constructor() {
     // Model information cache
     private var currentModelPath: String? = null
     private var currentThreadCount: Int = THREADS_QUAD
+    private var requestedBackend: InferenceBackend = InferenceBackend.CPU
+    private var requestedGpuDevice: Int = 0
+    private var activeBackend: InferenceBackend = InferenceBackend.CPU
     private var modelInfo: String? = null
 
+    // Progress of the running transcribe or transcribeDetailed call
+    private val _transcriptionProgress = MutableStateFlow(0f)
+
+    /**
+     * Fraction, 0 to 1, of the audio decoded by the running [transcribe] or
+     * [transcribeDetailed] call. Reset to 0 when a call starts and refreshed
+     * every [PROGRESS_POLL_MS] while it runs.
+     */
+    val transcriptionProgress: StateFlow<Float> = _transcriptionProgress.asStateFlow()
+
+    // Streaming sessions borrowing the current context
+    private val activeStreams = mutableSetOf<StreamingTranscriptionSession>()
+
+    // Batch queues running on the current model
+    private val activeBatches = mutableSetOf<ActiveBatch>()
+
     init {
         try {
             System.loadLibrary("whisper-jni")
@@ -62,29 +117,111 @@ class WhisperNative @Inject constructor() {
 
     // Native method declarations
     external fun getVersionInfo(): String
-    external fun initContext(modelPath: String, nThreads: Int): Long
+    external fun initContext(modelPath: String, nThreads: Int, backend: Int, gpuDevice: Int): Long
+    external fun getContextBackend(contextPtr: Long): Int
     external fun transcribeAudio(
         contextPtr: Long,
         audioData: FloatArray,
         sampleRate: Int,
         language: String,
-        translate: Boolean
+        translate: Boolean,
+        trimSilence: Boolean,
+        prompt: String?
     ): String
+    external fun transcribeAudioPacked(
+        contextPtr: Long,
+        audioData: FloatArray,
+        sampleRate: Int,
+        language: String,
+        translate: Boolean,
+        trimSilence: Boolean,
+        buffer: ByteBuffer
+    ): Int
+    external fun copyPackedResult(contextPtr: Long, buffer: ByteBuffer): Int
+    external fun transcribeParallel(
+        contextPtr: Long,
+        audioData: FloatArray,
+        sampleRate: Int,
+        language: String,
+        translate: Boolean,
+        nStates: Int,
+        listener: TimedSegmentListener
+    ): Int
+    external fun transcribeFile(
+        contextPtr: Long,
+        path: String,
+        rawSampleRate: Int,
+        rawChannels: Int,
+        language: String,
+        translate: Boolean,
+        listener: TimedSegmentListener
+    ): Int
     external fun releaseContext(contextPtr: Long)
     external fun getModelInfo(contextPtr: Long): String
     external fun isMultilingual(contextPtr: Long): Boolean
+    external fun getModelFileType(contextPtr: Long): Int
+    external fun getBigCoreCount(): Int
+    external fun setCoreBudget(threads: Int)
+    external fun getCoreBudget(): Int
+    external fun trimModelCache(maxIdle: Int): Int
+    external fun setEncoderCacheCapacity(maxBytes: Long)
+    external fun trimEncoderCache(maxBytes: Long): Long
+    external fun getEncoderCacheBytes(): Long
+    external fun resetTranscription(contextPtr: Long)
+    external fun cancelTranscription(contextPtr: Long)
+    external fun getTranscriptionProgress(contextPtr: Long): Float
+    external fun prefetchModel(modelPath: String): Boolean
+    external fun warmupContext(contextPtr: Long): Boolean
+    external fun streamCreate(
+        contextPtr: Long,
+        sampleRate: Int,
+        windowMs: Int,
+        stepMs: Int,
+        language: String,
+        translate: Boolean
+    ): Long
+    external fun streamPush(streamPtr: Long, audioData: FloatArray, listener: StreamingSegmentListener): Int
+    external fun streamFinish(streamPtr: Long, listener: StreamingSegmentListener): Int
+    external fun streamAttach(streamPtr: Long, capturePtr: Long, listener: StreamingSegmentListener): Boolean
+    external fun streamDetach(streamPtr: Long)
+    external fun streamSetTuning(streamPtr: Long, nThreads: Int, stepMs: Int, beamSize: Int): Boolean
+    external fun streamGetStats(streamPtr: Long): LongArray?
+    external fun streamRelease(streamPtr: Long)
+    external fun batchCreate(
+        contextPtr: Long,
+        language: String,
+        translate: Boolean,
+        trimSilence: Boolean,
+        listener: BatchResultListener
+    ): Long
+    external fun batchSubmitSamples(batchPtr: Long, jobId: Long, audioData: FloatArray, sampleRate: Int): Boolean
+    external fun batchSubmitFile(batchPtr: Long, jobId: Long, path: String): Boolean
+    external fun batchCancel(batchPtr: Long)
+    external fun batchRelease(batchPtr: Long)
 
     /**
      * Initialize the Whisper context with a model file.
      * This method is thread-safe and can be called multiple times.
+     * Models are memory-mapped and cached natively by path, so initializing
+     * with a model that was loaded before (here or by another instance) does
+     * not read the file again.
+     *
+     * With [InferenceBackend.GPU] the model runs on that GPU device if the
+     * native build has a GPU backend and the device loads the model and
+     * completes a test decode; otherwise it silently falls back to the CPU.
+     * [getActiveBackend] tells which one was used.
      *
      * @param modelPath Path to the Whisper model file (.bin)
-     * @param threadCount Number of threads to use (default: THREADS_QUAD)
+     * @param threadCount Number of threads to use (default: THREADS_AUTO, one per big core)
+     * @param backend Preferred compute backend
+     * @param gpuDevice Device index from [InferenceAccelerators.probe], used with GPU
      * @return Result indicating success or failure
      */
     suspend fun initialize(
         modelPath: String,
-        threadCount: Int = THREADS_QUAD
+        threadCount: Int = THREADS_AUTO,
+        backend: InferenceBackend = InferenceBackend.CPU,
+        gpuDevice: Int = 0
     ): Result<Unit> = withContext(Dispatchers.IO) {
         contextMutex.withLock {
             try {
@@ -103,29 +240,40 @@ class WhisperNative @Inject constructor() {
                     )
                 }
 
-                // Release existing context if any
-                if (isInitialized.get()) {
-                    Log.i(TAG, "Releasing existing context before reinitializing")
-                    releaseContextInternal()
-                }
-
                 // Determine optimal thread count
                 val optimalThreads = when (threadCount) {
                     THREADS_AUTO -> determineOptimalThreadCount()
                     else -> threadCount.coerceIn(1, 8)
                 }
 
-                Log.i(TAG, "Initializing Whisper context: model=$modelPath, threads=$optimalThreads")
+                if (isReady() && currentModelPath == modelPath && currentThreadCount == optimalThreads &&
+                    requestedBackend == backend && requestedGpuDevice == gpuDevice
+                ) {
+                    Log.d(TAG, "Model already loaded: $modelPath")
+                    return@withContext Result.success(Unit)
+                }
+
+                // Release existing context if any
+                if (isInitialized.get()) {
+                    Log.i(TAG, "Releasing existing context before reinitializing")
+                    streamMutex.withLock { releaseContextInternal() }
+                }
+
+                Log.i(TAG, "Initializing Whisper context: model=$modelPath, threads=$optimalThreads, backend=$backend")
 
-                val newContextPtr = initContext(modelPath, optimalThreads)
+                val newContextPtr = initContext(modelPath, optimalThreads, backend.ordinal, gpuDevice)
                 if (newContextPtr != 0L) {
                     contextPtr.set(newContextPtr)
                     currentModelPath = modelPath
                     currentThreadCount = optimalThreads
+                    requestedBackend = backend
+                    requestedGpuDevice = gpuDevice
+                    activeBackend = InferenceBackend.values()
+                        .getOrElse(getContextBackend(newContextPtr)) { InferenceBackend.CPU }
                     isInitialized.set(true)
                     modelInfo = null // Reset cached model info
 
-                    Log.i(TAG, "Whisper context initialized successfully")
+                    Log.i(TAG, "Whisper context initialized successfully on $activeBackend")
                     Result.success(Unit)
                 } else {
                     Log.e(TAG, "Failed to initialize Whisper context")
@@ -138,6 +286,34 @@ class WhisperNative @Inject constructor() {
         }
     }
 
+    /**
+     * Run one tiny decode on the loaded model so the first real
+     * transcription doesn't pay for ggml's kernel and buffer setup. Takes a
+     * fraction of a second; meant for a background thread after
+     * [initialize].
+     *
+     * @return Result indicating success or failure
+     */
+    suspend fun warmUp(): Result<Unit> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                if (!isReady()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+                if (warmupContext(contextPtr.get())) {
+                    Result.success(Unit)
+                } else {
+                    Result.failure(Exception("Warmup decode failed"))
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during warmup", e)
+                Result.failure(e)
+            }
+        }
+    }
+
     /**
      * Transcribe audio data to text.
      * This method is thread-safe and validates input parameters.
@@ -146,13 +322,18 @@ class WhisperNative @Inject constructor() {
      * @param language Language code (e.g., "en", "auto", "tr")
      * @param translate Whether to translate to English
      * @param sampleRate Sample rate of the audio (default: 16000)
+     * @param trimSilence Run the native VAD and decode only the voiced spans
+     * @param prompt Text conditioning the decoder, e.g. vocabulary or the
+     *               previous transcript; null for none
      * @return Result containing transcribed text or error
      */
     suspend fun transcribe(
         audioData: FloatArray,
         language: String = "auto",
         translate: Boolean = false,
-        sampleRate: Int = 16000
+        sampleRate: Int = 16000,
+        trimSilence: Boolean = true,
+        prompt: String? = null
     ): Result<String> = withContext(Dispatchers.IO) {
         contextMutex.withLock {
             try {
@@ -185,17 +366,15 @@ class WhisperNative @Inject constructor() {
                 Log.d(TAG, "Transcribing audio: ${audioData.size} samples, " +
                           "language=$language, translate=$translate, sampleRate=$sampleRate")
 
-                val result = transcribeAudio(
-                    contextPtr.get(),
-                    audioData,
-                    sampleRate,
-                    language,
-                    translate
-                )
+                val result = runCancellable(contextPtr.get()) { ptr ->
+                    transcribeAudio(ptr, audioData, sampleRate, language, translate, trimSilence, prompt)
+                }
 
                 Log.d(TAG, "Transcription completed: ${result.length} characters")
                 Result.success(result)
 
+            } catch (e: CancellationException) {
+                throw e
             } catch (e: Exception) {
                 Log.e(TAG, "Exception during transcription", e)
                 Result.failure(e)
@@ -203,6 +382,590 @@ class WhisperNative @Inject constructor() {
         }
     }
 
+    /**
+     * Transcribe audio to segments with word timings and token
+     * probabilities. The native side writes everything into [resultBuffer]
+     * in one pass, without creating a String per segment, and the returned
+     * [PackedTranscription] decodes records only when they're read. Times
+     * are on the original audio even when silence is trimmed.
+     *
+     * Pass the same direct buffer on every call to avoid allocating; if it
+     * is too small a larger one is allocated for this result. The result
+     * reads the buffer in place, so finish with it before reusing the
+     * buffer.
+     *
+     * @param audioData Audio samples as FloatArray (mono)
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param sampleRate Sample rate of the audio (default: 16000)
+     * @param trimSilence Run the native VAD and decode only the voiced spans
+     * @param resultBuffer Direct buffer to decode into; allocated when null
+     * @return Result containing the packed transcription or error
+     */
+    suspend fun transcribeDetailed(
+        audioData: FloatArray,
+        language: String = "auto",
+        translate: Boolean = false,
+        sampleRate: Int = 16000,
+        trimSilence: Boolean = true,
+        resultBuffer: ByteBuffer? = null
+    ): Result<PackedTranscription> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                if (isReleased.get()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("WhisperNative has been released")
+                    )
+                }
+
+                if (!isInitialized.get() || contextPtr.get() == 0L) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+
+                if (audioData.isEmpty() || sampleRate <= 0) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Invalid audio: ${audioData.size} samples at $sampleRate Hz")
+                    )
+                }
+
+                if (resultBuffer != null && !resultBuffer.isDirect) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Result buffer must be a direct ByteBuffer")
+                    )
+                }
+
+                var buffer = resultBuffer ?: ByteBuffer.allocateDirect(DEFAULT_RESULT_BUFFER_BYTES)
+                var size = runCancellable(contextPtr.get()) { ptr ->
+                    transcribeAudioPacked(ptr, audioData, sampleRate, language, translate, trimSilence, buffer)
+                }
+                if (size < 0) {
+                    buffer = ByteBuffer.allocateDirect(-size)
+                    size = copyPackedResult(contextPtr.get(), buffer)
+                }
+                if (size <= 0) {
+                    return@withContext Result.failure(Exception("Native transcription failed"))
+                }
+
+                val packed = PackedTranscription(buffer, size)
+                Log.d(TAG, "Detailed transcription completed: ${packed.segmentCount} segments, " +
+                          "${packed.tokenCount} tokens, $size bytes")
+                Result.success(packed)
+
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during detailed transcription", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    /**
+     * Run a blocking one-shot transcription on [ptr] so that cancelling the
+     * calling coroutine aborts it natively, within one encoder or decoder
+     * step, instead of letting it run to completion. Publishes the native
+     * progress to [progress] meanwhile. Call under the mutex serializing
+     * calls on [ptr]: contextMutex, or a [WhisperSession]'s own.
+     *
+     * The watcher is a child of this scope, so a late cancel it sends always
+     * lands before the mutex is released and the next call resets it.
+     *
+     * @throws CancellationException if the coroutine was cancelled
+     */
+    internal suspend fun <T> runCancellable(
+        ptr: Long,
+        progress: MutableStateFlow<Float> = _transcriptionProgress,
+        block: (Long) -> T
+    ): T = coroutineScope {
+        resetTranscription(ptr)
+        progress.value = 0f
+        val finished = AtomicBoolean(false)
+        val watcher = launch(Dispatchers.Default, start = CoroutineStart.ATOMIC) {
+            try {
+                while (true) {
+                    progress.value = getTranscriptionProgress(ptr)
+                    delay(PROGRESS_POLL_MS)
+                }
+            } finally {
+                if (!finished.get()) {
+                    cancelTranscription(ptr)
+                    Log.i(TAG, "Transcription cancelled")
+                }
+            }
+        }
+        try {
+            block(ptr).also { progress.value = getTranscriptionProgress(ptr) }
+        } finally {
+            finished.set(true)
+            watcher.cancel()
+            ensureActive()
+        }
+    }
+
+    /**
+     * Transcribe a long recording by splitting it at pauses found by the
+     * native VAD and decoding the chunks concurrently on [parallelism]
+     * decoder states of the loaded model. The states share the model
+     * weights, so each extra one only costs its KV cache and compute
+     * buffers; they exist for the duration of the call. Silence between
+     * chunks is skipped, and chunks are decoded without each other's text
+     * as context.
+     *
+     * Worth it on devices with many cores and spare memory; below
+     * [PARALLEL_MIN_AUDIO_MS] there is nothing to split.
+     *
+     * Cancelling the calling coroutine aborts every chunk, and
+     * [transcriptionProgress] advances as chunks complete.
+     *
+     * @param audioData Audio samples as FloatArray (mono)
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param sampleRate Sample rate of the audio (default: 16000)
+     * @param parallelism Decoder states to run at once, 1 to [MAX_PARALLEL_CONTEXTS]
+     * @return Result containing the segments in order, timed from the start of the audio
+     */
+    suspend fun transcribeParallel(
+        audioData: FloatArray,
+        language: String = "auto",
+        translate: Boolean = false,
+        sampleRate: Int = 16000,
+        parallelism: Int = 2
+    ): Result<List<TimedSegment>> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                if (isReleased.get()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("WhisperNative has been released")
+                    )
+                }
+
+                if (!isInitialized.get() || contextPtr.get() == 0L) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+
+                if (audioData.isEmpty()) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Audio data is empty")
+                    )
+                }
+
+                if (sampleRate <= 0) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Invalid sample rate: $sampleRate")
+                    )
+                }
+
+                val states = parallelism.coerceIn(1, MAX_PARALLEL_CONTEXTS)
+                Log.d(TAG, "Transcribing ${audioData.size} samples on $states parallel states")
+
+                val segments = mutableListOf<TimedSegment>()
+                val count = runCancellable(contextPtr.get()) { ptr ->
+                    transcribeParallel(ptr, audioData, sampleRate, language, translate, states) { text, startMs, endMs ->
+                        segments.add(TimedSegment(text, startMs, endMs))
+                    }
+                }
+
+                if (count < 0) {
+                    return@withContext Result.failure(Exception("Parallel transcription failed"))
+                }
+                Log.d(TAG, "Parallel transcription completed: $count segments")
+                Result.success(segments)
+
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during parallel transcription", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    /**
+     * Transcribe an audio file without loading it into the Java heap. The
+     * file is read natively in small fixed blocks, downmixed, resampled and
+     * turned into mel frames as it goes, and decoded in 30 s windows with
+     * the previous window's text as the prompt, so memory use does not grow
+     * with the file's length.
+     *
+     * Compressed files (AAC/m4a, Opus, MP3, FLAC, ... whatever the device's
+     * extractors support) are decoded by the platform codec on a native
+     * thread that stays ahead of transcription; their PCM never reaches Java.
+     *
+     * Cancelling the calling coroutine aborts the window being decoded, and
+     * [transcriptionProgress] follows the share of the file read, when its
+     * length is known.
+     *
+     * @param path Audio file in any supported format, or headerless 16-bit
+     *             little-endian PCM when [rawSampleRate] is set
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param rawSampleRate Sample rate of a headerless file; 0 to detect the format
+     * @param rawChannels Interleaved channels of a headerless file
+     * @param onSegment Called on the calling thread as each window is committed
+     * @return Result containing all segments in order, timed from the start of the file
+     */
+    suspend fun transcribeFile(
+        path: String,
+        language: String = "auto",
+        translate: Boolean = false,
+        rawSampleRate: Int = 0,
+        rawChannels: Int = 1,
+        onSegment: ((TimedSegment) -> Unit)? = null
+    ): Result<List<TimedSegment>> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                if (isReleased.get()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("WhisperNative has been released")
+                    )
+                }
+
+                if (!isInitialized.get() || contextPtr.get() == 0L) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+
+                if (!File(path).isFile) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Audio file not found: $path")
+                    )
+                }
+
+                if (rawSampleRate < 0 || rawChannels < 1) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Invalid raw PCM format: $rawSampleRate Hz, $rawChannels channels")
+                    )
+                }
+
+                Log.d(TAG, "Transcribing file: $path")
+
+                val segments = mutableListOf<TimedSegment>()
+                val count = runCancellable(contextPtr.get()) { ptr ->
+                    transcribeFile(ptr, path, rawSampleRate, rawChannels, language, translate) { text, startMs, endMs ->
+                        val segment = TimedSegment(text, startMs, endMs)
+                        segments.add(segment)
+                        onSegment?.invoke(segment)
+                    }
+                }
+
+                if (count < 0) {
+                    return@withContext Result.failure(Exception("File transcription failed"))
+                }
+                Log.d(TAG, "File transcription completed: $count segments")
+                Result.success(segments)
+
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during file transcription", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    /**
+     * Transcribe many inputs through one native queue on the loaded model.
+     * A native prepare thread reads, resamples and trims job N+1 while job N
+     * decodes, so a batch takes about the sum of its inference times instead
+     * of paying setup and preprocessing per call. Other transcriptions on the
+     * same model interleave between jobs.
+     *
+     * @param inputs Audio to transcribe, in order
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param trimSilence Run the native VAD and decode only the voiced spans
+     * @param onResult Called on the native decode thread as each job finishes;
+     *                 must not block or call back into this instance
+     * @return Result containing one entry per input, in input order
+     */
+    suspend fun transcribeBatch(
+        inputs: List<BatchInput>,
+        language: String = "auto",
+        translate: Boolean = false,
+        trimSilence: Boolean = true,
+        onResult: (BatchTranscriptionResult) -> Unit = {}
+    ): Result<List<BatchTranscriptionResult>> = withContext(Dispatchers.IO) {
+        if (inputs.isEmpty()) {
+            return@withContext Result.success(emptyList())
+        }
+
+        val results = arrayOfNulls<BatchTranscriptionResult>(inputs.size)
+        val remaining = AtomicInteger(inputs.size)
+        var batch: ActiveBatch? = null
+
+        fun complete(index: Int, result: Result<String>) {
+            val entry = BatchTranscriptionResult(index, inputs[index], result)
+            results[index] = entry
+            try {
+                onResult(entry)
+            } catch (e: Exception) {
+                Log.e(TAG, "Batch result callback failed", e)
+            }
+            if (remaining.decrementAndGet() == 0) {
+                batch?.done?.complete(Unit)
+            }
+        }
+
+        val listener = BatchResultListener { jobId, status, text ->
+            complete(jobId.toInt(), ActiveBatch.toResult(status, text))
+        }
+
+        batch = contextMutex.withLock {
+            try {
+                if (!isReady()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+                val handle = batchCreate(contextPtr.get(), language, translate, trimSilence, listener)
+                if (handle == 0L) {
+                    return@withContext Result.failure(Exception("Failed to create batch queue"))
+                }
+                ActiveBatch(handle).also { activeBatches.add(it) }
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception creating batch queue", e)
+                return@withContext Result.failure(e)
+            }
+        }
+        val active = batch!!
+
+        try {
+            Log.i(TAG, "Batch transcription started: ${inputs.size} jobs")
+            inputs.forEachIndexed { index, input ->
+                val queued = when (input) {
+                    is BatchInput.Samples ->
+                        batchSubmitSamples(active.handle, index.toLong(), input.audioData, input.sampleRate)
+                    is BatchInput.WavFile ->
+                        batchSubmitFile(active.handle, index.toLong(), input.path)
+                }
+                if (!queued) {
+                    complete(index, Result.failure(IllegalStateException("Batch job was not queued")))
+                }
+            }
+
+            active.done.await()
+            Result.success(results.map { it!! })
+        } catch (e: CancellationException) {
+            throw e
+        } catch (e: Exception) {
+            Log.e(TAG, "Batch transcription failed", e)
+            Result.failure(e)
+        } finally {
+            withContext(NonCancellable) {
+                contextMutex.withLock {
+                    batchRelease(active.handle)
+                    activeBatches.remove(active)
+                }
+            }
+        }
+    }
+
+    /**
+     * Start a streaming transcription session on the loaded model.
+     * Audio pushed into the session is decoded in overlapping windows and
+     * partial/final segments are published as they become available.
+     *
+     * @param sampleRate Sample rate of the audio that will be pushed
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param windowMs Length of each decoded window, at most [STREAM_MAX_WINDOW_MS]
+     * @param stepMs New audio required before the window is decoded again
+     * @return Result containing the session or error
+     */
+    suspend fun startStreaming(
+        sampleRate: Int = 16000,
+        language: String = "auto",
+        translate: Boolean = false,
+        windowMs: Int = STREAM_WINDOW_MS,
+        stepMs: Int = STREAM_STEP_MS
+    ): Result<StreamingTranscriptionSession> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                if (!isReady()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+
+                if (sampleRate <= 0 || stepMs <= 0 || windowMs < stepMs || windowMs > STREAM_MAX_WINDOW_MS) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException(
+                            "Invalid streaming parameters: sampleRate=$sampleRate, " +
+                            "windowMs=$windowMs, stepMs=$stepMs"
+                        )
+                    )
+                }
+
+                val streamPtr = streamCreate(
+                    contextPtr.get(), sampleRate, windowMs, stepMs, language, translate
+                )
+                if (streamPtr == 0L) {
+                    return@withContext Result.failure(Exception("Failed to create streaming session"))
+                }
+
+                val session = StreamingTranscriptionSession(this@WhisperNative, streamPtr)
+                streamMutex.withLock { activeStreams.add(session) }
+                Log.i(TAG, "Streaming session started: window=${windowMs}ms, step=${stepMs}ms")
+                Result.success(session)
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception starting streaming session", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun pushStream(
+        session: StreamingTranscriptionSession,
+        audioData: FloatArray
+    ): Result<Unit> = withContext(Dispatchers.IO) {
+        streamMutex.withLock {
+            try {
+                if (!session.isActive()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Streaming session has been released")
+                    )
+                }
+
+                if (streamPush(session.handle, audioData, session.listener) == 0) {
+                    Result.success(Unit)
+                } else {
+                    Result.failure(Exception("Streaming decode failed"))
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during streaming decode", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun attachStream(
+        session: StreamingTranscriptionSession,
+        capture: AudioCaptureBuffer
+    ): Result<Unit> = withContext(Dispatchers.IO) {
+        streamMutex.withLock {
+            try {
+                if (!session.isActive()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Streaming session has been released")
+                    )
+                }
+                if (capture.handle == 0L) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Capture buffer has been closed")
+                    )
+                }
+
+                if (streamAttach(session.handle, capture.handle, session.listener)) {
+                    Result.success(Unit)
+                } else {
+                    Result.failure(Exception("Failed to attach streaming session to capture"))
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception attaching streaming session", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun finishStream(
+        session: StreamingTranscriptionSession
+    ): Result<Unit> = withContext(Dispatchers.IO) {
+        streamMutex.withLock {
+            try {
+                if (!session.isActive()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Streaming session has been released")
+                    )
+                }
+
+                streamDetach(session.handle)
+                val status = streamFinish(session.handle, session.listener)
+                releaseStreamInternal(session)
+                if (status == 0) Result.success(Unit) else Result.failure(Exception("Streaming decode failed"))
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception finishing streaming session", e)
+                releaseStreamInternal(session)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun tuneStream(
+        session: StreamingTranscriptionSession,
+        tuning: StreamingTuning
+    ): Result<Unit> = withContext(Dispatchers.IO) {
+        streamMutex.withLock {
+            try {
+                if (!session.isActive()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Streaming session has been released")
+                    )
+                }
+
+                if (streamSetTuning(session.handle, tuning.threads, tuning.stepMs, tuning.beamSize)) {
+                    Result.success(Unit)
+                } else {
+                    Result.failure(IllegalArgumentException("Invalid streaming tuning: $tuning"))
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception tuning streaming session", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun streamStats(
+        session: StreamingTranscriptionSession
+    ): Result<StreamingDecodeStats> = withContext(Dispatchers.IO) {
+        streamMutex.withLock {
+            try {
+                if (!session.isActive()) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Streaming session has been released")
+                    )
+                }
+
+                val values = streamGetStats(session.handle)
+                    ?: return@withContext Result.failure(Exception("Failed to read streaming stats"))
+                Result.success(
+                    StreamingDecodeStats(
+                        decodes = values[0],
+                        totalDecodeNs = values[1],
+                        lastDecodeNs = values[2],
+                        decodedAudioMs = values[3]
+                    )
+                )
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception reading streaming stats", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    internal suspend fun releaseStream(session: StreamingTranscriptionSession) = withContext(Dispatchers.IO) {
+        // Waits for a decode the capture sink thread is running on the session
+        streamMutex.withLock {
+            releaseStreamInternal(session)
+        }
+    }
+
+    internal fun releaseStreamInBackground(session: StreamingTranscriptionSession) {
+        releaseScope.launch { releaseStream(session) }
+    }
+
+    private fun releaseStreamInternal(session: StreamingTranscriptionSession) {
+        if (session.handle != 0L) {
+            streamRelease(session.handle)
+            session.handle = 0L
+        }
+        activeStreams.remove(session)
+    }
+
     /**
      * Get version information from the native library.
      *
@@ -226,16 +989,26 @@ class WhisperNative @Inject constructor() {
         contextMutex.withLock {
             if (!isReleased.get()) {
                 Log.i(TAG, "Releasing WhisperNative resources")
-                releaseContextInternal()
+                streamMutex.withLock { releaseContextInternal() }
                 isReleased.set(true)
             }
         }
     }
 
     /**
-     * Internal method to release context without mutex (already protected).
+     * Internal method to release context; call under contextMutex and streamMutex.
      */
     private fun releaseContextInternal() {
+        // Streams borrow the context, so they must go first
+        activeStreams.toList().forEach { releaseStreamInternal(it) }
+
+        // Batches hold their own model reference; stop them and wake their callers,
+        // which free them
+        activeBatches.forEach { batch ->
+            batchCancel(batch.handle)
+            batch.done.completeExceptionally(IllegalStateException("Whisper context released"))
+        }
+
         val currentPtr = contextPtr.get()
         if (currentPtr != 0L) {
             try {
@@ -252,6 +1025,121 @@ class WhisperNative @Inject constructor() {
         }
     }
 
+    /**
+     * Free natively cached models that no context is using, e.g. under memory
+     * pressure. The model of a loaded context is never freed.
+     *
+     * @param keepIdle Number of unused models to keep cached
+     * @return Number of models freed
+     */
+    fun releaseCachedModels(keepIdle: Int = 0): Int {
+        return try {
+            trimModelCache(keepIdle)
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            0
+        }
+    }
+
+    /**
+     * Let each loaded model keep encoder passes of up to [maxBytes], so
+     * transcribing the same clip of at most 30 s again, e.g. with another
+     * language, translate setting or prompt, runs only the decoder. 0
+     * disables the cache and frees what it holds.
+     */
+    fun setEncoderCacheBudget(maxBytes: Long) {
+        try {
+            setEncoderCacheCapacity(maxBytes.coerceAtLeast(0L))
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+        }
+    }
+
+    /**
+     * Evict cached encodings until each model's cache holds at most
+     * [maxBytes], e.g. under memory pressure.
+     *
+     * @return Bytes freed
+     */
+    fun trimEncoderCaches(maxBytes: Long = 0L): Long {
+        return try {
+            trimEncoderCache(maxBytes.coerceAtLeast(0L))
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            0L
+        }
+    }
+
+    /**
+     * Memory held by cached encodings across all loaded models.
+     */
+    fun encoderCacheBytes(): Long {
+        return try {
+            getEncoderCacheBytes()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            0L
+        }
+    }
+
+    /**
+     * Limit the compute threads all decodes in the process share, across
+     * this context, its streams, batches and [WhisperSession]s. Each decode
+     * leases its threads from the budget when it starts, so two running at
+     * once split it instead of oversubscribing the cores. 0 restores the
+     * default of one thread per core.
+     */
+    fun setThreadBudget(threads: Int) {
+        try {
+            setCoreBudget(threads.coerceAtLeast(0))
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+        }
+    }
+
+    /**
+     * Compute threads all decodes in the process share.
+     */
+    fun threadBudget(): Int {
+        return try {
+            getCoreBudget()
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library not available", e)
+            0
+        }
+    }
+
+    /**
+     * Open another context on the loaded model, with the same thread count
+     * and backend, for transcribing concurrently with this one. The model's
+     * weights are shared; the session only adds a decoder state of a few
+     * tens of MB.
+     *
+     * @return Result containing the session or error
+     */
+    suspend fun openSession(): Result<WhisperSession> = withContext(Dispatchers.IO) {
+        contextMutex.withLock {
+            try {
+                val modelPath = currentModelPath
+                if (!isReady() || modelPath == null) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper context not initialized")
+                    )
+                }
+
+                val sessionPtr = initContext(modelPath, currentThreadCount, activeBackend.ordinal, requestedGpuDevice)
+                if (sessionPtr == 0L) {
+                    return@withContext Result.failure(Exception("Failed to open Whisper session"))
+                }
+                Log.i(TAG, "Whisper session opened on $modelPath")
+                Result.success(WhisperSession(this@WhisperNative, sessionPtr))
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception opening Whisper session", e)
+                Result.failure(e)
+            }
+        }
+    }
+
     /**
      * Check if the native context is initialized and ready for use.
      *
@@ -301,6 +1189,25 @@ class WhisperNative @Inject constructor() {
         }
     }
 
+    /**
+     * Get the weight format of the loaded model as a ggml_ftype
+     * (see ModelQuantization.fromGgmlType).
+     *
+     * @return ggml_ftype value, or -1 if no model is loaded
+     */
+    fun getModelWeightType(): Int {
+        if (!isReady()) {
+            return -1
+        }
+
+        return try {
+            getModelFileType(contextPtr.get())
+        } catch (e: Exception) {
+            Log.w(TAG, "Error reading model weight type", e)
+            -1
+        }
+    }
+
     /**
      * Get current model path.
      *
@@ -308,6 +1215,11 @@ class WhisperNative @Inject constructor() {
      */
     fun getCurrentModelPath(): String? = currentModelPath
 
+    /**
+     * Backend the current context runs on, after any fallback to the CPU.
+     */
+    fun getActiveBackend(): InferenceBackend = activeBackend
+
     /**
      * Get current thread count.
      *
@@ -317,19 +1229,29 @@ class WhisperNative @Inject constructor() {
 
     /**
      * Determine optimal thread count based on device capabilities.
-     * This is a heuristic based on available processors.
+     * Uses one thread per performance core when the native layer can read the
+     * CPU topology, since whisper compute threads are pinned to those cores and
+     * spilling onto efficiency cores only adds stragglers. Falls back to a
+     * heuristic based on available processors.
      *
      * @return Recommended thread count
      */
     private fun determineOptimalThreadCount(): Int {
         val availableProcessors = Runtime.getRuntime().availableProcessors()
+        val bigCores = try {
+            getBigCoreCount()
+        } catch (e: UnsatisfiedLinkError) {
+            0
+        }
         return when {
+            bigCores >= 2 -> bigCores.coerceAtMost(THREADS_OCTA)
             availableProcessors >= 8 -> THREADS_QUAD  // Use 4 threads on octa-core
             availableProcessors >= 4 -> THREADS_QUAD  // Use 4 threads on quad-core
             availableProcessors >= 2 -> THREADS_DUAL  // Use 2 threads on dual-core
             else -> THREADS_SINGLE                    // Use 1 thread on single-core
         }.also {
-            Log.d(TAG, "Determined optimal thread count: $it (available processors: $availableProcessors)")
+            Log.d(TAG, "Determined optimal thread count: $it " +
+                      "(available processors: $availableProcessors, big cores: $bigCores)")
         }
     }
 
@@ -0,0 +1,112 @@
+package com.app.whisper.native
+
+import android.util.Log
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+
+/**
+ * Independent one-shot transcription context created by
+ * [WhisperNative.openSession], for running a transcription alongside the
+ * main context's, e.g. a notification reply while streaming dictation.
+ *
+ * The session shares the loaded model's weights with every other context
+ * on the same file but decodes on its own decoder state, so its calls don't
+ * wait for the main context or for other sessions. Concurrent decodes split
+ * the process's core budget ([WhisperNative.setThreadBudget]) between them
+ * rather than each using its full thread count.
+ *
+ * Calls on one session are serialized. The session holds its own reference
+ * on the model, so it stays usable after the main context is released or
+ * reinitialized, until [release] is called.
+ */
+class WhisperSession internal constructor(
+    private val whisperNative: WhisperNative,
+    private var handle: Long
+) {
+
+    companion object {
+        private const val TAG = "WhisperSession"
+    }
+
+    private val mutex = Mutex()
+
+    private val _progress = MutableStateFlow(0f)
+
+    /**
+     * Fraction, 0 to 1, of the audio decoded by the running [transcribe]
+     * call on this session.
+     */
+    val progress: StateFlow<Float> = _progress.asStateFlow()
+
+    /**
+     * Whether the session can still transcribe.
+     */
+    fun isActive(): Boolean = handle != 0L
+
+    /**
+     * Transcribe audio data to text on this session, like
+     * [WhisperNative.transcribe]. Cancelling the calling coroutine aborts
+     * the native decode.
+     *
+     * @param audioData Audio samples as FloatArray (mono)
+     * @param language Language code (e.g., "en", "auto", "tr")
+     * @param translate Whether to translate to English
+     * @param sampleRate Sample rate of the audio (default: 16000)
+     * @param trimSilence Run the native VAD and decode only the voiced spans
+     * @param prompt Text conditioning the decoder; null for none
+     * @return Result containing transcribed text or error
+     */
+    suspend fun transcribe(
+        audioData: FloatArray,
+        language: String = "auto",
+        translate: Boolean = false,
+        sampleRate: Int = 16000,
+        trimSilence: Boolean = true,
+        prompt: String? = null
+    ): Result<String> = withContext(Dispatchers.IO) {
+        mutex.withLock {
+            try {
+                if (handle == 0L) {
+                    return@withContext Result.failure(
+                        IllegalStateException("Whisper session has been released")
+                    )
+                }
+
+                if (audioData.isEmpty() || sampleRate <= 0) {
+                    return@withContext Result.failure(
+                        IllegalArgumentException("Invalid audio: ${audioData.size} samples at $sampleRate Hz")
+                    )
+                }
+
+                val text = whisperNative.runCancellable(handle, _progress) { ptr ->
+                    whisperNative.transcribeAudio(ptr, audioData, sampleRate, language, translate, trimSilence, prompt)
+                }
+                Result.success(text)
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                Log.e(TAG, "Exception during session transcription", e)
+                Result.failure(e)
+            }
+        }
+    }
+
+    /**
+     * Release the session's native context, waiting for a running
+     * [transcribe] to finish. Safe to call more than once.
+     */
+    suspend fun release() {
+        mutex.withLock {
+            if (handle != 0L) {
+                whisperNative.releaseContext(handle)
+                handle = 0L
+            }
+        }
+    }
+}
@@ -4,6 +4,8 @@ import android.media.AudioFormat
 import android.media.AudioRecord
 import android.os.Build
 import androidx.tracing.trace
+import com.app.whisper.native.AudioProcessor as NativeAudioProcessor
+import com.app.whisper.native.WaveformPyramid
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import timber.log.Timber
@@ -19,9 +21,15 @@ import kotlin.math.*
  */
 @Singleton
 class AudioOptimizer @Inject constructor(
-    private val performanceManager: PerformanceManager
+    private val performanceManager: PerformanceManager,
+    private val nativeAudioProcessor: NativeAudioProcessor
 ) {
     
+    companion object {
+        // Same bound as the old window-based AGC
+        private const val MAX_AGC_GAIN = 10f
+    }
+    
     /**
      * Optimize audio buffer size based on device performance.
      */
@@ -68,17 +76,11 @@ class AudioOptimizer @Inject constructor(
                 return@trace audioData // Skip on low-end devices
             }
             
-            val result = audioData.copyOf()
-            val windowSize = min(512, audioData.size / 4)
-            
-            // Simple spectral subtraction noise reduction
-            for (i in 0 until result.size - windowSize step windowSize / 2) {
-                val window = result.sliceArray(i until min(i + windowSize, result.size))
-                val processedWindow = processAudioWindow(window, intensity)
-                processedWindow.copyInto(result, i)
+            // Native spectral subtraction: one FFT plan, no per-window allocation
+            nativeAudioProcessor.reduceNoisePcm16(audioData, intensity.coerceIn(0f, 1f)) ?: run {
+                Timber.w("Native noise reduction failed, returning input")
+                audioData
             }
-            
-            result
         }
     }
     
@@ -121,30 +123,16 @@ class AudioOptimizer @Inject constructor(
         trace("AudioOptimizer.generateWaveformData") {
             if (audioData.isEmpty()) return@trace FloatArray(0)
             
-            val result = FloatArray(targetPoints)
-            val samplesPerPoint = audioData.size / targetPoints
+            val samples = nativeAudioProcessor.pcm16ToFloat(audioData) ?: return@trace FloatArray(0)
             
-            if (samplesPerPoint <= 1) {
-                // If we have fewer samples than target points, interpolate
-                for (i in result.indices) {
-                    val index = (i * audioData.size / targetPoints.toFloat()).toInt()
-                        .coerceIn(0, audioData.size - 1)
-                    result[i] = abs(audioData[index].toFloat()) / Short.MAX_VALUE
-                }
-            } else {
-                // Downsample by taking RMS of each segment
-                for (i in result.indices) {
-                    val startIndex = i * samplesPerPoint
-                    val endIndex = min(startIndex + samplesPerPoint, audioData.size)
-                    
-                    var sum = 0.0
-                    for (j in startIndex until endIndex) {
-                        val sample = audioData[j].toFloat()
-                        sum += sample * sample
-                    }
-                    
-                    result[i] = sqrt(sum / (endIndex - startIndex)).toFloat() / Short.MAX_VALUE
-                }
+            // RMS per point from the native pyramid; points narrower than its
+            // 10 ms base bin repeat the bin they fall in
+            val mins = FloatArray(targetPoints)
+            val maxs = FloatArray(targetPoints)
+            val result = FloatArray(targetPoints)
+            WaveformPyramid(NativeAudioProcessor.WHISPER_SAMPLE_RATE).use { pyramid ->
+                pyramid.append(samples)
+                pyramid.query(0L, samples.size.toLong(), mins, maxs, result)
             }
             
             result
@@ -153,6 +141,8 @@ class AudioOptimizer @Inject constructor(
     
     /**
      * Detect voice activity in audio data.
+     * Uses the native frame-based VAD (energy, zero-crossing rate and
+     * spectral flatness with hangover) rather than a whole-buffer threshold.
      */
     suspend fun detectVoiceActivity(
         audioData: ShortArray,
@@ -161,24 +151,9 @@ class AudioOptimizer @Inject constructor(
     ): Boolean = withContext(Dispatchers.Default) {
         trace("AudioOptimizer.detectVoiceActivity") {
             if (audioData.isEmpty()) return@trace false
-            
-            // Calculate RMS energy
-            val rms = sqrt(audioData.map { it.toDouble() * it }.average()).toFloat()
-            val normalizedRms = rms / Short.MAX_VALUE
-            
-            // Simple energy-based VAD
-            val hasVoice = normalizedRms > threshold
-            
-            // Additional zero-crossing rate check for better accuracy
-            if (hasVoice && performanceManager.optimizeForDevice().enableAdvancedFeatures) {
-                val zcr = calculateZeroCrossingRate(audioData)
-                val normalizedZcr = zcr / (sampleRate / 2.0f)
-                
-                // Voice typically has moderate ZCR (not too high like noise, not too low like silence)
-                return@trace normalizedZcr in 0.01f..0.3f
-            }
-            
-            hasVoice
+
+            val samples = nativeAudioProcessor.pcm16ToFloat(audioData) ?: return@trace false
+            nativeAudioProcessor.detectSpeech(samples, sampleRate, threshold).isNotEmpty()
         }
     }
     
@@ -197,79 +172,18 @@ class AudioOptimizer @Inject constructor(
                 return@trace audioData
             }
             
-            val result = audioData.copyOf()
-            val attackSamples = (attackTime * sampleRate).toInt()
-            val releaseSamples = (releaseTime * sampleRate).toInt()
-            
-            var currentGain = 1.0f
-            val windowSize = min(1024, audioData.size / 10)
-            
-            for (i in 0 until result.size - windowSize step windowSize / 2) {
-                val window = result.sliceArray(i until min(i + windowSize, result.size))
-                val rms = sqrt(window.map { it.toDouble() * it }.average()).toFloat()
-                val normalizedRms = rms / Short.MAX_VALUE
-                
-                if (normalizedRms > 0.001f) { // Avoid division by zero
-                    val targetGain = targetLevel / normalizedRms
-                    val clampedTargetGain = targetGain.coerceIn(0.1f, 10.0f)
-                    
-                    // Smooth gain changes
-                    val gainDiff = clampedTargetGain - currentGain
-                    val maxChange = if (gainDiff > 0) {
-                        1.0f / attackSamples * windowSize
-                    } else {
-                        1.0f / releaseSamples * windowSize
-                    }
-                    
-                    currentGain += gainDiff.coerceIn(-maxChange, maxChange)
-                    
-                    // Apply gain to window
-                    for (j in window.indices) {
-                        val sampleIndex = i + j
-                        if (sampleIndex < result.size) {
-                            result[sampleIndex] = (result[sampleIndex] * currentGain).toInt()
-                                .coerceIn(Short.MIN_VALUE.toInt(), Short.MAX_VALUE.toInt())
-                                .toShort()
-                        }
-                    }
-                }
-            }
-            
-            result
-        }
-    }
-    
-    /**
-     * Process audio window for noise reduction.
-     */
-    private fun processAudioWindow(window: ShortArray, intensity: Float): ShortArray {
-        val result = window.copyOf()
-        
-        // Simple high-pass filter to remove low-frequency noise
-        if (window.size >= 3) {
-            for (i in 1 until window.size - 1) {
-                val filtered = (window[i] - 0.5f * (window[i - 1] + window[i + 1]) * intensity).toInt()
-                result[i] = filtered.coerceIn(Short.MIN_VALUE.toInt(), Short.MAX_VALUE.toInt()).toShort()
-            }
-        }
-        
-        return result
-    }
-    
-    /**
-     * Calculate zero-crossing rate.
-     */
-    private fun calculateZeroCrossingRate(audioData: ShortArray): Float {
-        if (audioData.size < 2) return 0f
-        
-        var crossings = 0
-        for (i in 1 until audioData.size) {
-            if ((audioData[i] >= 0) != (audioData[i - 1] >= 0)) {
-                crossings++
+            nativeAudioProcessor.automaticGainControlPcm16(
+                audioData,
+                sampleRate,
+                targetLevel,
+                attackTime * 1000f,
+                releaseTime * 1000f,
+                MAX_AGC_GAIN
+            ) ?: run {
+                Timber.w("Native AGC failed, returning input")
+                audioData
             }
         }
-        
-        return crossings.toFloat()
     }
     
     /**
@@ -0,0 +1,55 @@
+package com.app.whisper.performance
+
+import com.app.whisper.domain.entity.WhisperModel
+import com.app.whisper.native.WhisperNative
+import timber.log.Timber
+import javax.inject.Inject
+import javax.inject.Singleton
+
+/**
+ * The native encoder cache as a [MemoryCache], so [MemoryOptimizer] trims
+ * it with the app's other caches under memory pressure.
+ *
+ * The native side keeps, per loaded model, whole decoder states holding the
+ * encoder pass of recent clips. [configure] sizes it for the model just
+ * loaded from [PerformanceManager.getEncoderCacheBudgetBytes]; until then it
+ * is disabled.
+ */
+@Singleton
+class EncoderCacheMemory @Inject constructor(
+    private val whisperNative: WhisperNative,
+    private val performanceManager: PerformanceManager,
+    private val memoryOptimizer: MemoryOptimizer
+) : MemoryCache {
+
+    companion object {
+        private const val CACHE_NAME = "native_encoder_cache"
+    }
+
+    @Volatile
+    private var budgetBytes = 0L
+
+    /**
+     * Size the cache for [model] and register it for trimming.
+     */
+    fun configure(model: WhisperModel) {
+        budgetBytes = performanceManager.getEncoderCacheBudgetBytes(model)
+        whisperNative.setEncoderCacheBudget(budgetBytes)
+        memoryOptimizer.registerCache(CACHE_NAME, this)
+        Timber.d("Encoder cache budget: ${budgetBytes / (1024 * 1024)} MB")
+    }
+
+    override fun getSize(): Long = whisperNative.encoderCacheBytes()
+
+    override fun clear() {
+        whisperNative.trimEncoderCaches(0L)
+    }
+
+    override fun clearHalf() {
+        whisperNative.trimEncoderCaches(getSize() / 2)
+    }
+
+    override fun clearExpired() {
+        // Entries don't expire; the budget already bounds them
+    }
+}
@@ -0,0 +1,210 @@
+package com.app.whisper.performance
+
+import android.content.Context
+import android.os.Build
+import android.os.PowerManager
+import com.app.whisper.domain.entity.WhisperModel
+import com.app.whisper.native.StreamingDecodeStats
+import com.app.whisper.native.StreamingTranscriptionSession
+import com.app.whisper.native.StreamingTuning
+import com.app.whisper.native.WhisperNative
+import dagger.hilt.android.qualifiers.ApplicationContext
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import timber.log.Timber
+import javax.inject.Inject
+import javax.inject.Singleton
+
+/**
+ * Adaptive decoder scheduling for streaming transcription.
+ *
+ * [PerformanceManager.optimizeForDevice] picks settings once, but on long
+ * sessions phones throttle and the same settings stop keeping up. While a
+ * session runs, this polls its native decode timers and the device's
+ * thermal and battery saver state, and retunes the session within a
+ * latency budget: the time spent decoding per second of new audio.
+ *
+ * Settings move along a ladder from beam search at the stock step, through
+ * greedy decoding, to greedy with longer steps (fewer decodes of the same
+ * window). Over budget steps down at once; stepping back up needs
+ * [UPGRADE_POLLS] consecutive polls well under budget, so it doesn't
+ * oscillate. Thermal status and battery saver cap the thread count and rule
+ * out beam search; fewer threads run cooler, and if that costs too much
+ * speed the latency measurements push the ladder down.
+ *
+ * A running session can't swap models, so when the last rung is still over
+ * budget the scheduler reports [isSaturated] and [recommendModel] offers a
+ * faster model for the next session.
+ */
+@Singleton
+class InferenceScheduler @Inject constructor(
+    @ApplicationContext context: Context,
+    private val whisperNative: WhisperNative
+) {
+
+    companion object {
+        /** Decode time per second of new audio the scheduler aims to stay under. */
+        const val DEFAULT_LATENCY_BUDGET = 0.8f
+
+        private const val POLL_INTERVAL_MS = 2_000L
+
+        // Load below budget * this counts towards stepping back up
+        private const val UPGRADE_HEADROOM = 0.5f
+        private const val UPGRADE_POLLS = 3
+
+        private const val BEAM_SIZE = 4
+        private val LADDER_STEPS_MS = intArrayOf(2_000, 3_000, 4_000, 6_000)
+    }
+
+    private val powerManager = context.getSystemService(Context.POWER_SERVICE) as PowerManager
+
+    private val _tuning = MutableStateFlow<StreamingTuning?>(null)
+    /** Settings last applied to the scheduled session, null when none runs. */
+    val tuning: StateFlow<StreamingTuning?> = _tuning.asStateFlow()
+
+    private val _load = MutableStateFlow(0f)
+    /** Decode time per second of audio over the last poll. */
+    val load: StateFlow<Float> = _load.asStateFlow()
+
+    private val _isSaturated = MutableStateFlow(false)
+    /** Whether the cheapest settings were still over budget on the last poll. */
+    val isSaturated: StateFlow<Boolean> = _isSaturated.asStateFlow()
+
+    /**
+     * Retune [session] until it is released or the returned job is cancelled.
+     *
+     * @param session Session to schedule; start it before scheduling
+     * @param scope Scope the polling runs in, e.g. the one feeding the session
+     * @param windowMs Session window length; steps never exceed it
+     * @param latencyBudget Decode time per second of new audio to stay under
+     */
+    fun schedule(
+        session: StreamingTranscriptionSession,
+        scope: CoroutineScope,
+        windowMs: Int = WhisperNative.STREAM_WINDOW_MS,
+        latencyBudget: Float = DEFAULT_LATENCY_BUDGET
+    ): Job = scope.launch {
+        val maxThreads = whisperNative.getCurrentThreadCount().coerceAtLeast(1)
+        val ladder = buildLadder(windowMs)
+        // Start where sessions started before scheduling: greedy at the stock step
+        var level = 1.coerceAtMost(ladder.lastIndex)
+        var applied: StreamingTuning? = null
+        var previous: StreamingDecodeStats? = null
+        var calmPolls = 0
+
+        try {
+            while (isActive && session.isActive()) {
+                val throttled = isThrottled()
+                val minLevel = if (throttled) 1.coerceAtMost(ladder.lastIndex) else 0
+                level = level.coerceAtLeast(minLevel)
+
+                val stats = session.decodeStats().getOrNull() ?: break
+                val load = previous?.let { loadBetween(it, stats) }
+                previous = stats
+                if (load != null) {
+                    _load.value = load
+                    when {
+                        load > latencyBudget -> {
+                            calmPolls = 0
+                            _isSaturated.value = level == ladder.lastIndex
+                            level = (level + 1).coerceAtMost(ladder.lastIndex)
+                        }
+                        load < latencyBudget * UPGRADE_HEADROOM -> {
+                            _isSaturated.value = false
+                            if (++calmPolls >= UPGRADE_POLLS && level > minLevel) {
+                                level--
+                                calmPolls = 0
+                            }
+                        }
+                        else -> {
+                            _isSaturated.value = false
+                            calmPolls = 0
+                        }
+                    }
+                }
+
+                val tuning = ladder[level].copy(threads = threadCap(maxThreads))
+                if (tuning != applied && session.setTuning(tuning).isSuccess) {
+                    Timber.d("Streaming tuning: $tuning, load=${load ?: "n/a"}, thermal=${thermalStatus()}")
+                    applied = tuning
+                    _tuning.value = tuning
+                }
+
+                delay(POLL_INTERVAL_MS)
+            }
+        } finally {
+            _tuning.value = null
+        }
+    }
+
+    /**
+     * Model to use for the next session: when the last one couldn't keep up
+     * even on the cheapest settings, the slowest of [candidates] that is
+     * still faster than [current]; otherwise [current].
+     */
+    fun recommendModel(current: WhisperModel, candidates: List<WhisperModel>): WhisperModel {
+        if (!_isSaturated.value) {
+            return current
+        }
+        return candidates
+            .filter { it.getExpectedSpeed() > current.getExpectedSpeed() }
+            .minByOrNull { it.getExpectedSpeed() }
+            ?: current
+    }
+
+    /**
+     * [PowerManager] thermal status, or THERMAL_STATUS_NONE before API 29.
+     */
+    fun thermalStatus(): Int =
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            powerManager.currentThermalStatus
+        } else {
+            PowerManager.THERMAL_STATUS_NONE
+        }
+
+    private fun isThrottled(): Boolean =
+        powerManager.isPowerSaveMode || thermalStatus() >= PowerManager.THERMAL_STATUS_MODERATE
+
+    /**
+     * Threads allowed at the current thermal status, out of [maxThreads].
+     */
+    private fun threadCap(maxThreads: Int): Int {
+        val status = thermalStatus()
+        val cap = when {
+            status >= PowerManager.THERMAL_STATUS_CRITICAL -> 1
+            status >= PowerManager.THERMAL_STATUS_SEVERE -> maxThreads / 2
+            status >= PowerManager.THERMAL_STATUS_MODERATE || powerManager.isPowerSaveMode ->
+                maxThreads * 3 / 4
+            else -> maxThreads
+        }
+        return cap.coerceIn(1, maxThreads)
+    }
+
+    /**
+     * Beam search at the first step, then greedy at each step that fits the window.
+     */
+    private fun buildLadder(windowMs: Int): List<StreamingTuning> {
+        val steps = LADDER_STEPS_MS.filter { it <= windowMs }.ifEmpty { listOf(windowMs) }
+        return listOf(StreamingTuning(threads = 1, stepMs = steps.first(), beamSize = BEAM_SIZE)) +
+            steps.map { StreamingTuning(threads = 1, stepMs = it) }
+    }
+
+    /**
+     * Decode time per second of new audio between two snapshots, or null
+     * when nothing was decoded in between.
+     */
+    private fun loadBetween(before: StreamingDecodeStats, after: StreamingDecodeStats): Float? {
+        val audioMs = after.decodedAudioMs - before.decodedAudioMs
+        if (after.decodes == before.decodes || audioMs <= 0L) {
+            return null
+        }
+        val decodeMs = (after.totalDecodeNs - before.totalDecodeNs) / 1_000_000f
+        return decodeMs / audioMs
+    }
+}
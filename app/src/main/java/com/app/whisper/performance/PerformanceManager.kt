@@ -2,10 +2,18 @@ package com.app.whisper.performance
 
 import android.app.ActivityManager
 import android.content.Context
+import android.content.SharedPreferences
 import android.os.Build
 import android.os.Debug
 import android.os.PowerManager
 import androidx.tracing.trace
+import com.app.whisper.di.CachePreferences
+import com.app.whisper.domain.entity.WhisperModel
+import com.app.whisper.native.InferenceAccelerators
+import com.app.whisper.native.InferenceBackend
+import com.app.whisper.native.NativeStageStats
+import com.app.whisper.native.NativeStats
+import com.app.whisper.native.WhisperNative
 import dagger.hilt.android.qualifiers.ApplicationContext
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
@@ -21,12 +29,38 @@ import javax.inject.Singleton
  */
 @Singleton
 class PerformanceManager @Inject constructor(
-    @ApplicationContext private val context: Context
+    @ApplicationContext private val context: Context,
+    private val nativeStats: NativeStats,
+    private val accelerators: InferenceAccelerators,
+    @CachePreferences private val preferences: SharedPreferences
 ) {
     
+    companion object {
+        private const val KEY_GPU_INFERENCE = "gpu_inference_enabled"
+        
+        // Processing may take at most half the audio duration
+        private const val TARGET_REAL_TIME_FACTOR = 0.5f
+        
+        // Memory of one extra decoder state relative to the model's footprint
+        private const val DECODER_STATE_MEMORY_SHARE = 0.5f
+        
+        // Share of the memory left beside the model given to cached encodings
+        private const val ENCODER_CACHE_MEMORY_SHARE = 0.25f
+        private const val MAX_ENCODER_CACHE_BYTES_MEDIUM = 128L * 1024 * 1024
+        private const val MAX_ENCODER_CACHE_BYTES_HIGH = 512L * 1024 * 1024
+    }
+    
     private val activityManager = context.getSystemService(Context.ACTIVITY_SERVICE) as ActivityManager
     private val powerManager = context.getSystemService(Context.POWER_SERVICE) as PowerManager
     
+    /**
+     * Whether inference may run on the GPU where one is available.
+     * Persisted, off by default.
+     */
+    var isGpuInferenceEnabled: Boolean
+        get() = preferences.getBoolean(KEY_GPU_INFERENCE, false)
+        set(value) = preferences.edit().putBoolean(KEY_GPU_INFERENCE, value).apply()
+    
     /**
      * Get current memory usage information.
      */
@@ -116,7 +150,7 @@ class PerformanceManager @Inject constructor(
                     audioBufferSize = 8192,
                     waveformUpdateInterval = 16L, // 60 FPS
                     enableAdvancedFeatures = true,
-                    useHardwareAcceleration = true,
+                    useHardwareAcceleration = supportsHardwareAcceleration(),
                     maxCacheSize = 100L * 1024 * 1024, // 100MB
                     enableBackgroundProcessing = true,
                     audioProcessingThreads = 4
@@ -127,7 +161,7 @@ class PerformanceManager @Inject constructor(
                     audioBufferSize = 4096,
                     waveformUpdateInterval = 33L, // 30 FPS
                     enableAdvancedFeatures = true,
-                    useHardwareAcceleration = true,
+                    useHardwareAcceleration = supportsHardwareAcceleration(),
                     maxCacheSize = 50L * 1024 * 1024, // 50MB
                     enableBackgroundProcessing = true,
                     audioProcessingThreads = 2
@@ -205,24 +239,150 @@ class PerformanceManager @Inject constructor(
     }
     
     /**
-     * Check if device supports hardware acceleration.
+     * Check if the native library found a GPU it can run inference on.
      */
-    fun supportsHardwareAcceleration(): Boolean {
-        return Build.VERSION.SDK_INT >= Build.VERSION_CODES.LOLLIPOP &&
-                getCpuInfo().supportedAbis.any { it.contains("arm64") || it.contains("x86_64") }
-    }
+    fun supportsHardwareAcceleration(): Boolean = accelerators.isGpuAvailable()
+    
+    /**
+     * Backend to load models on: the GPU when the user opted in, the device
+     * isn't LOW tier and a GPU was found, otherwise the CPU. Initialization
+     * still falls back to the CPU if the GPU can't run the model.
+     */
+    fun getPreferredBackend(): InferenceBackend =
+        if (isGpuInferenceEnabled && getPerformanceTier() != PerformanceTier.LOW &&
+            supportsHardwareAcceleration()
+        ) {
+            InferenceBackend.GPU
+        } else {
+            InferenceBackend.CPU
+        }
     
     /**
      * Get recommended model based on device performance.
+     * 
+     * Picks the largest model, full precision or quantized, that fits in
+     * available memory and is expected to process audio within
+     * TARGET_REAL_TIME_FACTOR. Expected speed comes from each model's
+     * nominal speed scaled to this device: by the tier until a model has
+     * been used, then by the real-time factors measured here. Within a size,
+     * HIGH tier devices prefer precision and the others prefer the fastest
+     * (quantized) variant. While the device is thermally throttled or in
+     * battery saver the expected speed is derated, so a session started then
+     * gets a model it can keep up with.
+     * 
+     * @param candidates Models to choose from, e.g. only downloaded ones
+     * @return Recommended model
      */
-    fun getRecommendedModel(): String {
-        return when (getPerformanceTier()) {
-            PerformanceTier.HIGH -> "large"
-            PerformanceTier.MEDIUM -> "medium"
-            PerformanceTier.LOW -> "tiny"
+    fun getRecommendedModel(candidates: List<WhisperModel> = WhisperModel.getAllModels()): WhisperModel {
+        val tier = getPerformanceTier()
+        val availableMemoryMB = getMemoryInfo().availableMemory / (1024 * 1024)
+        val throttling = throttlingSpeedFactor()
+        val deviceSpeed = estimateDeviceSpeed(tier) * throttling
+        
+        fun realTimeFactor(model: WhisperModel): Float =
+            (model.measuredRealTimeFactor?.div(throttling))
+                ?: (1f / (model.getExpectedSpeed() * deviceSpeed))
+        
+        val fitting = candidates.filter { availableMemoryMB >= it.getRequiredMemoryMB() * 1.5 }
+        val fastEnough = fitting.filter { realTimeFactor(it) <= TARGET_REAL_TIME_FACTOR }
+        val withinSize = if (tier == PerformanceTier.HIGH) {
+            compareBy<WhisperModel> { it.quantization.bitsPerWeight }
+        } else {
+            compareByDescending<WhisperModel> { realTimeFactor(it) }
         }
+        
+        return fastEnough.maxWithOrNull(compareBy<WhisperModel> { it.size }.then(withinSize))
+            ?: fitting.minByOrNull { realTimeFactor(it) }
+            ?: candidates.minByOrNull { it.getRequiredMemoryMB() }
+            ?: WhisperModel.TINY
     }
     
+    /**
+     * Number of decoder states to run in parallel for long recordings with
+     * [model]: 1 (sequential) below HIGH tier, otherwise as many extra
+     * states as available memory allows on top of the model, up to
+     * [WhisperNative.MAX_PARALLEL_CONTEXTS].
+     */
+    fun getParallelTranscriptionContexts(model: WhisperModel): Int {
+        if (getPerformanceTier() != PerformanceTier.HIGH) {
+            return 1
+        }
+        val availableMemoryMB = getMemoryInfo().availableMemory / (1024 * 1024)
+        val modelMemoryMB = model.getRequiredMemoryMB()
+        val stateMemoryMB = (modelMemoryMB * DECODER_STATE_MEMORY_SHARE).toLong().coerceAtLeast(1L)
+        val spareMB = availableMemoryMB - (modelMemoryMB * 1.5).toLong()
+        return (1 + spareMB / stateMemoryMB).toInt().coerceIn(1, WhisperNative.MAX_PARALLEL_CONTEXTS)
+    }
+    
+    /**
+     * Memory the native encoder cache may use with [model] loaded: none on
+     * LOW tier devices, otherwise a share of what is left beside the model,
+     * capped by tier. A cached encoding is a whole decoder state, so a
+     * budget below one state's size leaves the cache disabled.
+     */
+    fun getEncoderCacheBudgetBytes(model: WhisperModel): Long {
+        val cap = when (getPerformanceTier()) {
+            PerformanceTier.LOW -> return 0L
+            PerformanceTier.MEDIUM -> MAX_ENCODER_CACHE_BYTES_MEDIUM
+            PerformanceTier.HIGH -> MAX_ENCODER_CACHE_BYTES_HIGH
+        }
+        val modelBytes = model.getRequiredMemoryMB() * 1024 * 1024
+        val spareBytes = getMemoryInfo().availableMemory - (modelBytes * 1.5).toLong()
+        return (spareBytes * ENCODER_CACHE_MEMORY_SHARE).toLong().coerceIn(0L, cap)
+    }
+    
+    /**
+     * Speed of this device relative to the nominal model speeds. Measured
+     * real-time factors, when any model has them, replace the tier guess.
+     */
+    private fun estimateDeviceSpeed(tier: PerformanceTier): Float {
+        val measured = WhisperModel.getAllModels().mapNotNull { model ->
+            model.measuredRealTimeFactor
+                ?.takeIf { it > 0f }
+                ?.let { rtf -> 1f / (rtf * model.getExpectedSpeed()) }
+        }
+        if (measured.isNotEmpty()) {
+            return measured.sorted()[measured.size / 2]
+        }
+        return when (tier) {
+            PerformanceTier.HIGH -> 1.0f
+            PerformanceTier.MEDIUM -> 0.5f
+            PerformanceTier.LOW -> 0.25f
+        }
+    }
+    
+    /**
+     * Share of full speed expected at the current thermal status and battery
+     * saver state (1 when unthrottled).
+     */
+    private fun throttlingSpeedFactor(): Float {
+        val thermal = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            when (powerManager.currentThermalStatus) {
+                PowerManager.THERMAL_STATUS_NONE, PowerManager.THERMAL_STATUS_LIGHT -> 1.0f
+                PowerManager.THERMAL_STATUS_MODERATE -> 0.75f
+                PowerManager.THERMAL_STATUS_SEVERE -> 0.5f
+                else -> 0.25f
+            }
+        } else {
+            1.0f
+        }
+        return if (powerManager.isPowerSaveMode) thermal * 0.75f else thermal
+    }
+    
+    /**
+     * Per-stage timings of the native audio and inference path (JNI copies,
+     * resampling, filtering, mel, encoder, decoder), summed over all threads.
+     *
+     * @param reset Zero the native counters after reading them
+     */
+    fun getNativeStageStats(reset: Boolean = false): List<NativeStageStats> {
+        val stats = nativeStats.snapshot()
+        if (reset) {
+            nativeStats.reset()
+        }
+        return stats
+    }
+
     /**
      * Log performance metrics.
      */
@@ -243,7 +403,20 @@ class PerformanceManager @Inject constructor(
         Timber.i("Supported ABIs: ${cpuInfo.supportedAbis}")
         Timber.i("Low Power Mode: ${cpuInfo.isLowPowerMode}")
         Timber.i("Hardware Acceleration: ${supportsHardwareAcceleration()}")
-        Timber.i("Recommended Model: ${getRecommendedModel()}")
+        accelerators.probe().forEach { gpu ->
+            Timber.i("GPU ${gpu.index}: ${gpu.description}, ${gpu.memoryTotalBytes / (1024 * 1024)} MB")
+        }
+        Timber.i("Preferred Backend: ${getPreferredBackend()}")
+        Timber.i("Recommended Model: ${getRecommendedModel().id}")
+        getNativeStageStats()
+            .filter { it.count > 0 }
+            .forEach { stats ->
+                Timber.i(
+                    "Native ${stats.stage.label}: ${stats.count} calls, " +
+                        "total ${stats.totalNs / 1_000_000} ms, " +
+                        "avg ${stats.averageNs / 1_000} µs, max ${stats.maxNs / 1_000} µs"
+                )
+            }
         Timber.i("========================")
     }
 }
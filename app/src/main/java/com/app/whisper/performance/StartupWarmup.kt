@@ -0,0 +1,97 @@
+package com.app.whisper.performance
+
+import android.content.SharedPreferences
+import android.os.Process
+import androidx.tracing.trace
+import com.app.whisper.di.CachePreferences
+import com.app.whisper.native.WhisperNative
+import dagger.Lazy
+import kotlinx.coroutines.runBlocking
+import timber.log.Timber
+import java.io.File
+import java.util.concurrent.atomic.AtomicBoolean
+import javax.inject.Inject
+import javax.inject.Singleton
+
+/**
+ * Optional warmup of the native path at app start, so the first
+ * transcription after launch runs at close to steady-state latency instead
+ * of paying for library loading, model reads and ggml setup.
+ *
+ * On a background-priority thread it loads the JNI library (by creating
+ * [WhisperNative]), asks the kernel to read the last used model into the
+ * page cache, and, except on LOW tier devices where holding the model
+ * before it's needed costs too much memory, loads it and runs one tiny
+ * decode. Later initialize() calls for the same model reuse the loaded
+ * context.
+ */
+@Singleton
+class StartupWarmup @Inject constructor(
+    @CachePreferences private val preferences: SharedPreferences,
+    private val whisperNative: Lazy<WhisperNative>,
+    private val performanceManager: PerformanceManager
+) {
+
+    companion object {
+        private const val KEY_ENABLED = "startup_warmup_enabled"
+        private const val KEY_LAST_MODEL_PATH = "startup_warmup_model_path"
+    }
+
+    private val started = AtomicBoolean(false)
+
+    /** Whether [start] does anything; persisted, on by default. */
+    var isEnabled: Boolean
+        get() = preferences.getBoolean(KEY_ENABLED, true)
+        set(value) = preferences.edit().putBoolean(KEY_ENABLED, value).apply()
+
+    /** Remember the model to warm up on the next launch. */
+    fun recordModelUsed(modelPath: String) {
+        if (preferences.getString(KEY_LAST_MODEL_PATH, null) != modelPath) {
+            preferences.edit().putString(KEY_LAST_MODEL_PATH, modelPath).apply()
+        }
+    }
+
+    /** Start the warmup thread; later calls do nothing. */
+    fun start() {
+        if (!isEnabled || !started.compareAndSet(false, true)) {
+            return
+        }
+        Thread({
+            Process.setThreadPriority(Process.THREAD_PRIORITY_BACKGROUND)
+            warmUp()
+        }, "whisper-warmup").start()
+    }
+
+    private fun warmUp() = trace("StartupWarmup.warmUp") {
+        try {
+            val startTime = System.currentTimeMillis()
+            // Creating the instance runs System.loadLibrary off the main thread
+            val native = whisperNative.get()
+
+            val modelPath = preferences.getString(KEY_LAST_MODEL_PATH, null)
+            if (modelPath == null || !File(modelPath).isFile) {
+                Timber.d("Startup warmup: no previous model")
+                return@trace
+            }
+            native.prefetchModel(modelPath)
+
+            if (performanceManager.getPerformanceTier() == PerformanceTier.LOW) {
+                Timber.d("Startup warmup: prefetched $modelPath")
+                return@trace
+            }
+            runBlocking {
+                // Same backend the repository will ask for, so its initialize reuses this context
+                native.initialize(modelPath, backend = performanceManager.getPreferredBackend())
+                    .mapCatching { native.warmUp().getOrThrow() }
+                    .onSuccess {
+                        Timber.i("Startup warmup done in ${System.currentTimeMillis() - startTime} ms")
+                    }
+                    .onFailure { Timber.w(it, "Startup warmup failed") }
+            }
+        } catch (e: UnsatisfiedLinkError) {
+            Timber.w(e, "Startup warmup: native library unavailable")
+        } catch (e: Exception) {
+            Timber.w(e, "Startup warmup failed")
+        }
+    }
+}
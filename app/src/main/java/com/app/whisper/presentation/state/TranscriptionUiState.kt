@@ -51,13 +51,15 @@ sealed class TranscriptionUiState {
      * @param duration Recording duration in milliseconds
      * @param canStop Whether recording can be stopped
      * @param canPause Whether recording can be paused
+     * @param liveTranscript Text decoded so far by the streaming session
      */
     data class Recording(
         val recordingState: RecordingState,
         val waveformData: WaveformData? = null,
         val duration: Long = 0L,
         val canStop: Boolean = true,
-        val canPause: Boolean = true
+        val canPause: Boolean = true,
+        val liveTranscript: String = ""
     ) : TranscriptionUiState()
 
     /**
@@ -17,6 +17,7 @@ import androidx.compose.ui.graphics.vector.ImageVector
 import androidx.compose.ui.text.font.FontWeight
 import androidx.compose.ui.text.style.TextAlign
 import androidx.compose.ui.unit.dp
+import com.app.whisper.domain.usecase.TranscriptionProgress
 import com.app.whisper.presentation.state.TranscriptionUiState
 
 /**
@@ -87,11 +88,21 @@ fun StatusCard(
             
             // Progress indicator for processing states
             if (statusInfo.showProgress) {
-                CircularProgressIndicator(
-                    modifier = Modifier.size(24.dp),
-                    color = statusInfo.iconColor,
-                    strokeWidth = 2.dp
-                )
+                val fraction = statusInfo.progressFraction
+                if (fraction != null) {
+                    CircularProgressIndicator(
+                        progress = fraction,
+                        modifier = Modifier.size(24.dp),
+                        color = statusInfo.iconColor,
+                        strokeWidth = 2.dp
+                    )
+                } else {
+                    CircularProgressIndicator(
+                        modifier = Modifier.size(24.dp),
+                        color = statusInfo.iconColor,
+                        strokeWidth = 2.dp
+                    )
+                }
             }
         }
     }
@@ -235,7 +246,8 @@ private fun getStatusInfo(uiState: TranscriptionUiState): StatusInfo {
                 textColor = MaterialTheme.colorScheme.onPrimaryContainer,
                 backgroundColor = MaterialTheme.colorScheme.primaryContainer,
                 isAnimated = true,
-                showProgress = true
+                showProgress = true,
+                progressFraction = (uiState.progress as? TranscriptionProgress.Transcribing)?.fraction
             )
         }
         
@@ -286,5 +298,6 @@ private data class StatusInfo(
     val textColor: Color,
     val backgroundColor: Color,
     val isAnimated: Boolean,
-    val showProgress: Boolean
+    val showProgress: Boolean,
+    val progressFraction: Float? = null // determinate progress when known
 )
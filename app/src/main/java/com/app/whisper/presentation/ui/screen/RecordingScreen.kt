@@ -254,6 +254,27 @@ private fun TranscriptionResultSection(
     modifier: Modifier = Modifier
 ) {
     when (uiState) {
+        is TranscriptionUiState.Recording -> {
+            if (uiState.liveTranscript.isNotBlank()) {
+                Card(
+                    modifier = modifier,
+                    shape = RoundedCornerShape(16.dp),
+                    colors = CardDefaults.cardColors(
+                        containerColor = MaterialTheme.colorScheme.surfaceVariant
+                    )
+                ) {
+                    Text(
+                        text = uiState.liveTranscript,
+                        style = MaterialTheme.typography.bodyLarge,
+                        color = MaterialTheme.colorScheme.onSurfaceVariant,
+                        modifier = Modifier
+                            .fillMaxSize()
+                            .padding(16.dp)
+                    )
+                }
+            }
+        }
+
         is TranscriptionUiState.Success -> {
             Card(
                 modifier = modifier,
@@ -9,6 +9,10 @@ import com.app.whisper.domain.entity.ProcessingParameters
 import com.app.whisper.domain.repository.ModelRepository
 import com.app.whisper.domain.usecase.TranscribeAudioUseCase
 import com.app.whisper.domain.usecase.TranscriptionProgress
+import com.app.whisper.native.AudioCaptureBuffer
+import com.app.whisper.native.StreamingTranscriptionSession
+import com.app.whisper.native.WhisperNative
+import com.app.whisper.performance.InferenceScheduler
 import com.app.whisper.presentation.state.TranscriptionUiState
 import dagger.hilt.android.lifecycle.HiltViewModel
 import kotlinx.coroutines.Job
@@ -35,7 +39,9 @@ import javax.inject.Inject
 class TranscriptionViewModel @Inject constructor(
     private val audioRecorder: AudioRecorder,
     private val transcribeAudioUseCase: TranscribeAudioUseCase,
-    private val modelRepository: ModelRepository
+    private val modelRepository: ModelRepository,
+    private val whisperNative: WhisperNative,
+    private val inferenceScheduler: InferenceScheduler
 ) : ViewModel() {
 
     // UI State
@@ -53,6 +59,11 @@ class TranscriptionViewModel @Inject constructor(
     // Current jobs
     private var transcriptionJob: Job? = null
     private var recordingObservationJob: Job? = null
+    private var streamingJob: Job? = null
+
+    // Live transcription while recording
+    private var streamingSession: StreamingTranscriptionSession? = null
+    private val _liveTranscript = MutableStateFlow("")
 
     // Audio data buffer
     private val audioDataBuffer = mutableListOf<AudioData>()
@@ -124,6 +135,7 @@ class TranscriptionViewModel @Inject constructor(
 
                 // Observe recording state and audio data
                 observeRecording()
+                startLiveTranscription()
 
                 _events.emit(TranscriptionEvent.RecordingStarted)
 
@@ -156,6 +168,7 @@ class TranscriptionViewModel @Inject constructor(
 
                 // Stop observing recording
                 recordingObservationJob?.cancel()
+                stopLiveTranscription()
 
                 // Combine audio data
                 val combinedAudioData = combineAudioData(audioDataBuffer)
@@ -233,6 +246,16 @@ class TranscriptionViewModel @Inject constructor(
     private fun startTranscription(audioData: AudioData) {
         transcriptionJob?.cancel()
         transcriptionJob = viewModelScope.launch {
+            // Native decode progress, shown once the use case reports processing
+            val progressUpdates = whisperNative.transcriptionProgress
+                .onEach { fraction ->
+                    val state = _uiState.value
+                    if (state is TranscriptionUiState.Processing && state.progress.isDecoding()) {
+                        _uiState.value = state.copy(progress = TranscriptionProgress.Transcribing(fraction))
+                    }
+                }
+                .launchIn(this)
+
             transcribeAudioUseCase.execute(audioData, _processingParameters.value)
                 .onEach { progress ->
                     _uiState.value = TranscriptionUiState.Processing(
@@ -243,6 +266,7 @@ class TranscriptionViewModel @Inject constructor(
 
                     when (progress) {
                         is TranscriptionProgress.Completed -> {
+                            progressUpdates.cancel()
                             _uiState.value = TranscriptionUiState.Success(
                                 result = progress.result,
                                 session = progress.session,
@@ -252,6 +276,7 @@ class TranscriptionViewModel @Inject constructor(
                             _events.emit(TranscriptionEvent.TranscriptionCompleted(progress.result))
                         }
                         is TranscriptionProgress.Failed -> {
+                            progressUpdates.cancel()
                             _uiState.value = TranscriptionUiState.Error(
                                 error = progress.error,
                                 canRetry = true,
@@ -266,6 +291,7 @@ class TranscriptionViewModel @Inject constructor(
                     }
                 }
                 .catch { error ->
+                    progressUpdates.cancel()
                     _uiState.value = TranscriptionUiState.Error(
                         error = error,
                         canRetry = true,
@@ -350,12 +376,68 @@ class TranscriptionViewModel @Inject constructor(
                     waveformData = waveformData,
                     duration = recordingState.getDurationMs(),
                     canStop = recordingState.canStop(),
-                    canPause = recordingState.canPause()
+                    canPause = recordingState.canPause(),
+                    liveTranscript = _liveTranscript.value
                 )
             }
         }
     }
 
+    /**
+     * Stream captured audio into the loaded model so text appears while recording.
+     * The session is fed by the recorder's native capture pipeline, so audio never
+     * round-trips through Kotlin. It decodes on the pipeline's sink thread, never
+     * on the worker that drains capture, so the recorded audio behind the final
+     * transcription is not dropped when a decode is slow. While it runs, the
+     * inference scheduler retunes it to keep up as the device heats up. Skipped
+     * when no native model is loaded.
+     */
+    private fun startLiveTranscription() {
+        stopLiveTranscription()
+        if (!whisperNative.isReady()) return
+        val capture = audioRecorder.getCaptureBuffer() ?: return
+
+        streamingJob = viewModelScope.launch {
+            val parameters = _processingParameters.value
+            val session = whisperNative.startStreaming(
+                sampleRate = AudioCaptureBuffer.OUTPUT_SAMPLE_RATE,
+                language = parameters.language,
+                translate = parameters.translate
+            ).getOrElse { return@launch }
+            streamingSession = session
+
+            session.transcript
+                .onEach { transcript ->
+                    _liveTranscript.value = transcript.text
+                    val currentState = _uiState.value
+                    if (currentState is TranscriptionUiState.Recording) {
+                        _uiState.value = currentState.copy(liveTranscript = transcript.text)
+                    }
+                }
+                .launchIn(this)
+
+            if (session.attach(capture).isFailure) {
+                stopLiveTranscription()
+                return@launch
+            }
+            inferenceScheduler.schedule(session, this)
+        }
+    }
+
+    /**
+     * Stop live transcription and release its native session.
+     */
+    private fun stopLiveTranscription() {
+        streamingJob?.cancel()
+        streamingJob = null
+        _liveTranscript.value = ""
+
+        streamingSession?.let { session ->
+            streamingSession = null
+            session.releaseInBackground()
+        }
+    }
+
     /**
      * Observe model changes.
      */
@@ -412,6 +494,10 @@ class TranscriptionViewModel @Inject constructor(
         super.onCleared()
         transcriptionJob?.cancel()
         recordingObservationJob?.cancel()
+        streamingJob?.cancel()
+        // viewModelScope is already cancelled here
+        streamingSession?.releaseInBackground()
+        streamingSession = null
         audioRecorder.release()
     }
 }
@@ -2,21 +2,32 @@ package com.app.whisper.presentation.viewmodel
 
 import androidx.arch.core.executor.testing.InstantTaskExecutorRule
 import com.app.whisper.CoroutineTestRule
-import com.app.whisper.TestConfiguration
 import com.app.whisper.TestDataFactory
-import com.app.whisper.data.audio.AudioRecorder
+import com.app.whisper.data.model.AudioData
 import com.app.whisper.data.model.RecordingState
-import com.app.whisper.domain.entity.TranscriptionResult
+import com.app.whisper.data.model.WaveformData
+import com.app.whisper.data.source.AudioRecorder
+import com.app.whisper.domain.entity.ProcessingParameters
 import com.app.whisper.domain.entity.WhisperModel
-import com.app.whisper.domain.usecase.DownloadModelUseCase
+import com.app.whisper.domain.repository.ModelRepository
 import com.app.whisper.domain.usecase.TranscribeAudioUseCase
+import com.app.whisper.domain.usecase.TranscriptionProgress
+import com.app.whisper.native.AudioCaptureBuffer
+import com.app.whisper.native.StreamingTranscript
+import com.app.whisper.native.StreamingTranscriptionSession
+import com.app.whisper.native.WhisperNative
+import com.app.whisper.performance.InferenceScheduler
 import com.app.whisper.presentation.state.TranscriptionUiState
 import com.google.common.truth.Truth.assertThat
 import io.mockk.*
 import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.flow.MutableSharedFlow
 import kotlinx.coroutines.flow.MutableStateFlow
-import kotlinx.coroutines.flow.first
 import kotlinx.coroutines.flow.flowOf
+import kotlinx.coroutines.flow.toList
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.test.UnconfinedTestDispatcher
 import kotlinx.coroutines.test.runTest
 import org.junit.Before
 import org.junit.Rule
@@ -24,270 +35,367 @@ import org.junit.Test
 
 /**
  * Unit tests for TranscriptionViewModel.
- * 
- * Tests UI state management, recording operations, and transcription workflow.
+ *
+ * Tests UI state management, live transcription while recording, native
+ * progress wiring and the release of native streaming sessions.
  */
 @ExperimentalCoroutinesApi
 class TranscriptionViewModelTest {
-    
+
     @get:Rule
     val instantTaskExecutorRule = InstantTaskExecutorRule()
-    
+
     @get:Rule
     val coroutineTestRule = CoroutineTestRule()
-    
+
     private lateinit var viewModel: TranscriptionViewModel
     private lateinit var mockAudioRecorder: AudioRecorder
     private lateinit var mockTranscribeAudioUseCase: TranscribeAudioUseCase
-    private lateinit var mockDownloadModelUseCase: DownloadModelUseCase
-    
-    private val mockRecordingState = MutableStateFlow(RecordingState.IDLE)
-    private val mockAudioLevel = MutableStateFlow(0.0f)
-    
+    private lateinit var mockModelRepository: ModelRepository
+    private lateinit var mockWhisperNative: WhisperNative
+    private lateinit var mockInferenceScheduler: InferenceScheduler
+    private lateinit var mockSession: StreamingTranscriptionSession
+    private lateinit var mockCapture: AudioCaptureBuffer
+
+    private val recordingState = MutableStateFlow<RecordingState>(RecordingState.Idle)
+    private val audioDataFlow = MutableSharedFlow<AudioData>()
+    private val waveformDataFlow = MutableSharedFlow<WaveformData>()
+    private val nativeProgress = MutableStateFlow(0f)
+    private val liveTranscript = MutableStateFlow(StreamingTranscript())
+
     @Before
     fun setUp() {
         // Setup mocks
         mockAudioRecorder = mockk(relaxed = true)
         mockTranscribeAudioUseCase = mockk(relaxed = true)
-        mockDownloadModelUseCase = mockk(relaxed = true)
-        
-        // Setup audio recorder flows
-        every { mockAudioRecorder.recordingState } returns mockRecordingState
-        every { mockAudioRecorder.audioLevel } returns mockAudioLevel
-        
+        mockModelRepository = mockk(relaxed = true)
+        mockWhisperNative = mockk(relaxed = true)
+        mockInferenceScheduler = mockk(relaxed = true)
+        mockSession = mockk(relaxed = true)
+        mockCapture = mockk(relaxed = true)
+
+        val model = mockk<WhisperModel>(relaxed = true)
+        every { model.isAvailable() } returns true
+        coEvery { mockModelRepository.getCurrentModel() } returns model
+        every { mockModelRepository.observeCurrentModel() } returns flowOf(model)
+        coEvery { mockTranscribeAudioUseCase.getRecentResults(any()) } returns Result.success(emptyList())
+
+        // Setup audio recorder
+        every { mockAudioRecorder.recordingState } returns recordingState
+        every { mockAudioRecorder.audioDataFlow } returns audioDataFlow
+        every { mockAudioRecorder.waveformDataFlow } returns waveformDataFlow
+        every { mockAudioRecorder.hasAudioPermission() } returns true
+        every { mockAudioRecorder.getCaptureBuffer() } returns mockCapture
+        coEvery { mockAudioRecorder.startRecording() } returns Result.success(Unit)
+        coEvery { mockAudioRecorder.stopRecording() } returns Result.success(Unit)
+
+        // Setup native streaming
+        every { mockWhisperNative.isReady() } returns true
+        every { mockWhisperNative.transcriptionProgress } returns nativeProgress
+        coEvery {
+            mockWhisperNative.startStreaming(any(), any(), any(), any(), any())
+        } returns Result.success(mockSession)
+        every { mockSession.transcript } returns liveTranscript
+        coEvery { mockSession.attach(any()) } returns Result.success(Unit)
+        every { mockInferenceScheduler.schedule(any(), any(), any(), any()) } returns Job()
+
         // Create ViewModel
         viewModel = TranscriptionViewModel(
             audioRecorder = mockAudioRecorder,
             transcribeAudioUseCase = mockTranscribeAudioUseCase,
-            downloadModelUseCase = mockDownloadModelUseCase
+            modelRepository = mockModelRepository,
+            whisperNative = mockWhisperNative,
+            inferenceScheduler = mockInferenceScheduler
         )
     }
-    
+
+    /** Start recording and deliver one block of audio, as the recorder does. */
+    private suspend fun startRecordingWithAudio() {
+        viewModel.startRecording()
+        recordingState.value = RecordingState.Recording(duration = 1000L)
+        audioDataFlow.emit(AudioData(samples = FloatArray(1600), sampleRate = 16000))
+        waveformDataFlow.emit(mockk(relaxed = true))
+    }
+
+    private fun clearViewModel() {
+        // onCleared is protected; the framework calls it through ViewModelStore
+        TranscriptionViewModel::class.java.getDeclaredMethod("onCleared").apply {
+            isAccessible = true
+        }.invoke(viewModel)
+    }
+
     @Test
-    fun `initial state is Initial`() = runTest {
+    fun `initializes to Ready with the current model`() = runTest {
+        // Then
+        val currentState = viewModel.uiState.value
+        assertThat(currentState).isInstanceOf(TranscriptionUiState.Ready::class.java)
+        assertThat((currentState as TranscriptionUiState.Ready).canRecord).isTrue()
+    }
+
+    @Test
+    fun `startRecording streams capture into a scheduled live session`() = runTest {
+        // Given
+        viewModel.updateProcessingParameters(ProcessingParameters(language = "de", translate = true))
+
         // When
-        val initialState = viewModel.uiState.first()
-        
+        viewModel.startRecording()
+
         // Then
-        assertThat(initialState).isInstanceOf(TranscriptionUiState.Initial::class.java)
+        coVerify {
+            mockWhisperNative.startStreaming(AudioCaptureBuffer.OUTPUT_SAMPLE_RATE, "de", true, any(), any())
+        }
+        coVerify { mockSession.attach(mockCapture) }
+        verify { mockInferenceScheduler.schedule(mockSession, any(), any(), any()) }
     }
-    
+
     @Test
-    fun `startRecording changes state to Recording`() = runTest {
+    fun `live transcription is skipped without a loaded model`() = runTest {
         // Given
-        coEvery { mockAudioRecorder.startRecording() } returns Result.success(Unit)
-        mockRecordingState.value = RecordingState.RECORDING
-        
+        every { mockWhisperNative.isReady() } returns false
+
         // When
         viewModel.startRecording()
-        
+
         // Then
-        val currentState = viewModel.uiState.value
-        assertThat(currentState).isInstanceOf(TranscriptionUiState.Recording::class.java)
-        
-        // Verify audio recorder was called
         coVerify { mockAudioRecorder.startRecording() }
+        coVerify(exactly = 0) { mockWhisperNative.startStreaming(any(), any(), any(), any(), any()) }
+        verify(exactly = 0) { mockInferenceScheduler.schedule(any(), any(), any(), any()) }
     }
-    
+
     @Test
-    fun `startRecording handles error gracefully`() = runTest {
+    fun `failed attach releases the session and skips the scheduler`() = runTest {
         // Given
-        val error = RuntimeException("Recording failed")
-        coEvery { mockAudioRecorder.startRecording() } returns Result.failure(error)
-        
+        coEvery { mockSession.attach(any()) } returns Result.failure(IllegalStateException("detached"))
+
         // When
         viewModel.startRecording()
-        
+
         // Then
-        val currentState = viewModel.uiState.value
-        assertThat(currentState).isInstanceOf(TranscriptionUiState.Error::class.java)
-        
-        val errorState = currentState as TranscriptionUiState.Error
-        assertThat(errorState.error).isEqualTo(error)
+        verify { mockSession.releaseInBackground() }
+        coVerify(exactly = 0) { mockSession.release() }
+        verify(exactly = 0) { mockInferenceScheduler.schedule(any(), any(), any(), any()) }
     }
-    
+
     @Test
-    fun `stopRecording triggers transcription`() = runTest {
-        // Given - Setup recording state
-        mockRecordingState.value = RecordingState.RECORDING
-        viewModel.startRecording()
-        
-        val testAudioData = TestDataFactory.createTestAudioData()
-        val testResult = TestDataFactory.createTestTranscriptionResult()
-        
-        coEvery { mockAudioRecorder.stopRecording() } returns Result.success(testAudioData)
-        coEvery { 
-            mockTranscribeAudioUseCase.execute(any(), any()) 
-        } returns flowOf(
-            com.app.whisper.domain.usecase.TranscriptionProgress.Started,
-            com.app.whisper.domain.usecase.TranscriptionProgress.Completed(testResult)
-        )
-        
+    fun `startRecording handles error gracefully`() = runTest {
+        // Given
+        val error = RuntimeException("Recording failed")
+        coEvery { mockAudioRecorder.startRecording() } returns Result.failure(error)
+        val events = mutableListOf<TranscriptionEvent>()
+        backgroundScope.launch(UnconfinedTestDispatcher(testScheduler)) {
+            viewModel.events.toList(events)
+        }
+
         // When
-        viewModel.stopRecording()
-        
+        viewModel.startRecording()
+
         // Then
-        // Verify recording was stopped
-        coVerify { mockAudioRecorder.stopRecording() }
-        
-        // Verify transcription was started
-        coVerify { mockTranscribeAudioUseCase.execute(any(), any()) }
-        
-        // Check final state
-        val finalState = viewModel.uiState.value
-        assertThat(finalState).isInstanceOf(TranscriptionUiState.Success::class.java)
-        
-        val successState = finalState as TranscriptionUiState.Success
-        assertThat(successState.result).isEqualTo(testResult)
+        assertThat(events).containsExactly(TranscriptionEvent.Error("Recording failed"))
+        assertThat(viewModel.uiState.value).isInstanceOf(TranscriptionUiState.Ready::class.java)
+        coVerify(exactly = 0) { mockWhisperNative.startStreaming(any(), any(), any(), any(), any()) }
     }
-    
+
     @Test
     fun `pauseRecording updates state correctly`() = runTest {
-        // Given - Setup recording state
-        mockRecordingState.value = RecordingState.RECORDING
-        viewModel.startRecording()
-        
+        // Given
+        startRecordingWithAudio()
         coEvery { mockAudioRecorder.pauseRecording() } returns Result.success(Unit)
-        mockRecordingState.value = RecordingState.PAUSED
-        
+
         // When
         viewModel.pauseRecording()
-        
+        recordingState.value = RecordingState.Paused(duration = 1000L, samplesRecorded = 16000L)
+
         // Then
         coVerify { mockAudioRecorder.pauseRecording() }
-        
         val currentState = viewModel.uiState.value
         assertThat(currentState).isInstanceOf(TranscriptionUiState.Recording::class.java)
-        
-        val recordingState = currentState as TranscriptionUiState.Recording
-        assertThat(recordingState.recordingState).isEqualTo(RecordingState.PAUSED)
+        assertThat((currentState as TranscriptionUiState.Recording).recordingState)
+            .isInstanceOf(RecordingState.Paused::class.java)
     }
-    
+
     @Test
     fun `resumeRecording updates state correctly`() = runTest {
-        // Given - Setup paused state
-        mockRecordingState.value = RecordingState.PAUSED
-        
+        // Given
+        startRecordingWithAudio()
+        recordingState.value = RecordingState.Paused(duration = 1000L, samplesRecorded = 16000L)
         coEvery { mockAudioRecorder.resumeRecording() } returns Result.success(Unit)
-        mockRecordingState.value = RecordingState.RECORDING
-        
+
         // When
         viewModel.resumeRecording()
-        
+        recordingState.value = RecordingState.Recording(duration = 2000L)
+
         // Then
         coVerify { mockAudioRecorder.resumeRecording() }
-        
         val currentState = viewModel.uiState.value
         assertThat(currentState).isInstanceOf(TranscriptionUiState.Recording::class.java)
-        
-        val recordingState = currentState as TranscriptionUiState.Recording
-        assertThat(recordingState.recordingState).isEqualTo(RecordingState.RECORDING)
+        assertThat((currentState as TranscriptionUiState.Recording).recordingState)
+            .isEqualTo(RecordingState.Recording(duration = 2000L))
     }
-    
+
     @Test
-    fun `clearResult resets to Ready state`() = runTest {
-        // Given - Setup success state
-        val testResult = TestDataFactory.createTestTranscriptionResult()
-        // Manually set success state
-        viewModel.setUiState(TranscriptionUiState.Success(testResult, 1000L))
-        
-        // When
-        viewModel.clearResult()
-        
+    fun `audio level updates are reflected in Recording state`() = runTest {
+        // Given
+        startRecordingWithAudio()
+
+        // When - the recorder reports levels through its waveform
+        val waveform = WaveformData(
+            amplitudes = floatArrayOf(0.75f),
+            rmsValues = floatArrayOf(0.5f),
+            peakValues = floatArrayOf(0.75f)
+        )
+        waveformDataFlow.emit(waveform)
+
         // Then
         val currentState = viewModel.uiState.value
-        assertThat(currentState).isInstanceOf(TranscriptionUiState.Ready::class.java)
+        assertThat(currentState).isInstanceOf(TranscriptionUiState.Recording::class.java)
+        assertThat((currentState as TranscriptionUiState.Recording).waveformData).isSameInstanceAs(waveform)
     }
-    
+
     @Test
-    fun `audio level updates are reflected in Recording state`() = runTest {
-        // Given - Setup recording state
-        mockRecordingState.value = RecordingState.RECORDING
-        viewModel.startRecording()
-        
-        // When - Update audio level
-        val testLevel = 0.75f
-        mockAudioLevel.value = testLevel
-        
+    fun `live transcript is reflected in Recording state`() = runTest {
+        // Given
+        startRecordingWithAudio()
+
+        // When
+        liveTranscript.value = StreamingTranscript(finalText = "Hello", partialText = "world")
+
         // Then
         val currentState = viewModel.uiState.value
         assertThat(currentState).isInstanceOf(TranscriptionUiState.Recording::class.java)
-        
-        val recordingState = currentState as TranscriptionUiState.Recording
-        assertThat(recordingState.audioLevel).isEqualTo(testLevel)
+        assertThat((currentState as TranscriptionUiState.Recording).liveTranscript).isEqualTo("Hello world")
     }
-    
+
     @Test
-    fun `transcription progress updates state correctly`() = runTest {
-        // Given - Setup for transcription
-        val testAudioData = TestDataFactory.createTestAudioData()
-        coEvery { mockAudioRecorder.stopRecording() } returns Result.success(testAudioData)
-        
-        // Setup progress flow
-        coEvery { 
-            mockTranscribeAudioUseCase.execute(any(), any()) 
-        } returns flowOf(
-            com.app.whisper.domain.usecase.TranscriptionProgress.Started,
-            com.app.whisper.domain.usecase.TranscriptionProgress.ModelLoaded("test-model"),
-            com.app.whisper.domain.usecase.TranscriptionProgress.Processing
-        )
-        
+    fun `stopRecording releases the live session off the main thread`() = runTest {
+        // Given
+        startRecordingWithAudio()
+
         // When
         viewModel.stopRecording()
-        
-        // Then - Check that processing state is reached
+
+        // Then - the suspending release would run on viewModelScope's Main dispatcher
+        verify(exactly = 1) { mockSession.releaseInBackground() }
+        coVerify(exactly = 0) { mockSession.release() }
+    }
+
+    @Test
+    fun `onCleared releases the live session off the main thread`() = runTest {
+        // Given
+        startRecordingWithAudio()
+
+        // When
+        clearViewModel()
+
+        // Then - viewModelScope is cancelled, so only a background release can run
+        verify(exactly = 1) { mockSession.releaseInBackground() }
+        coVerify(exactly = 0) { mockSession.release() }
+        verify { mockAudioRecorder.release() }
+    }
+
+    @Test
+    fun `ViewModel cleanup stops recording`() = runTest {
+        // Given
+        startRecordingWithAudio()
+
+        // When
+        clearViewModel()
+        recordingState.value = RecordingState.Recording(duration = 5000L)
+
+        // Then - the recorder is released and its updates no longer reach the UI
+        verify { mockAudioRecorder.release() }
+        val currentState = viewModel.uiState.value as TranscriptionUiState.Recording
+        assertThat(currentState.duration).isEqualTo(1000L)
+    }
+
+    @Test
+    fun `native progress updates the Processing state`() = runTest {
+        // Given
+        coEvery {
+            mockTranscribeAudioUseCase.execute(any(), any())
+        } returns flowOf(TranscriptionProgress.Started, TranscriptionProgress.Processing)
+        startRecordingWithAudio()
+        viewModel.stopRecording()
+
+        // When
+        nativeProgress.value = 0.5f
+
+        // Then
         val currentState = viewModel.uiState.value
         assertThat(currentState).isInstanceOf(TranscriptionUiState.Processing::class.java)
-        
-        val processingState = currentState as TranscriptionUiState.Processing
-        assertThat(processingState.progress).isInstanceOf(
-            com.app.whisper.domain.usecase.TranscriptionProgress.Processing::class.java
-        )
+        assertThat((currentState as TranscriptionUiState.Processing).progress)
+            .isEqualTo(TranscriptionProgress.Transcribing(0.5f))
     }
-    
+
     @Test
-    fun `transcription failure updates to Error state`() = runTest {
-        // Given - Setup for transcription failure
-        val testAudioData = TestDataFactory.createTestAudioData()
-        val testError = RuntimeException("Transcription failed")
-        
-        coEvery { mockAudioRecorder.stopRecording() } returns Result.success(testAudioData)
-        coEvery { 
-            mockTranscribeAudioUseCase.execute(any(), any()) 
-        } returns flowOf(
-            com.app.whisper.domain.usecase.TranscriptionProgress.Started,
-            com.app.whisper.domain.usecase.TranscriptionProgress.Failed(testError)
-        )
-        
+    fun `native progress is ignored before decoding starts`() = runTest {
+        // Given
+        coEvery {
+            mockTranscribeAudioUseCase.execute(any(), any())
+        } returns flowOf(TranscriptionProgress.Started, TranscriptionProgress.ModelLoaded("base"))
+        startRecordingWithAudio()
+        viewModel.stopRecording()
+
+        // When
+        nativeProgress.value = 0.5f
+
+        // Then
+        val currentState = viewModel.uiState.value as TranscriptionUiState.Processing
+        assertThat(currentState.progress).isEqualTo(TranscriptionProgress.ModelLoaded("base"))
+    }
+
+    @Test
+    fun `transcription result updates to Success state`() = runTest {
+        // Given
+        val testResult = TestDataFactory.createTestTranscriptionResult()
+        coEvery {
+            mockTranscribeAudioUseCase.execute(any(), any())
+        } returns flowOf(TranscriptionProgress.Started, TranscriptionProgress.Completed(testResult))
+        startRecordingWithAudio()
+
         // When
         viewModel.stopRecording()
-        
+
         // Then
         val currentState = viewModel.uiState.value
-        assertThat(currentState).isInstanceOf(TranscriptionUiState.Error::class.java)
-        
-        val errorState = currentState as TranscriptionUiState.Error
-        assertThat(errorState.error).isEqualTo(testError)
+        assertThat(currentState).isInstanceOf(TranscriptionUiState.Success::class.java)
+        assertThat((currentState as TranscriptionUiState.Success).result).isEqualTo(testResult)
     }
-    
+
     @Test
-    fun `ViewModel cleanup stops recording`() = runTest {
-        // Given - Setup recording state
-        mockRecordingState.value = RecordingState.RECORDING
-        viewModel.startRecording()
-        
-        coEvery { mockAudioRecorder.stopRecording() } returns Result.success(ByteArray(0))
-        
-        // When - Clear ViewModel (simulate onCleared)
-        viewModel.onCleared()
-        
+    fun `clearResult resets to Ready state`() = runTest {
+        // Given
+        coEvery {
+            mockTranscribeAudioUseCase.execute(any(), any())
+        } returns flowOf(
+            TranscriptionProgress.Started,
+            TranscriptionProgress.Completed(TestDataFactory.createTestTranscriptionResult())
+        )
+        startRecordingWithAudio()
+        viewModel.stopRecording()
+        assertThat(viewModel.uiState.value).isInstanceOf(TranscriptionUiState.Success::class.java)
+
+        // When
+        viewModel.clearResult()
+
         // Then
-        coVerify { mockAudioRecorder.stopRecording() }
+        assertThat(viewModel.uiState.value).isInstanceOf(TranscriptionUiState.Ready::class.java)
     }
-    
-    // Helper method to set UI state for testing
-    private fun TranscriptionViewModel.setUiState(state: TranscriptionUiState) {
-        // This would require making _uiState internal or adding a test-only method
-        // For now, we'll work with the public interface
+
+    @Test
+    fun `transcription failure updates to Error state`() = runTest {
+        // Given
+        val testError = RuntimeException("Transcription failed")
+        coEvery {
+            mockTranscribeAudioUseCase.execute(any(), any())
+        } returns flowOf(TranscriptionProgress.Started, TranscriptionProgress.Failed(testError))
+        startRecordingWithAudio()
+
+        // When
+        viewModel.stopRecording()
+
+        // Then
+        val currentState = viewModel.uiState.value
+        assertThat(currentState).isInstanceOf(TranscriptionUiState.Error::class.java)
+        assertThat((currentState as TranscriptionUiState.Error).error).isEqualTo(testError)
     }
 }
@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# ==============================================================================
+# Whisper Android Native Benchmark
+# ==============================================================================
+# Pushes the whisper_bench executable (plus optional model and WAV fixtures)
+# to a connected device, runs it and pulls the JSON report.
+#
+#   scripts/run_bench.sh [--abi arm64-v8a] [--model model.bin] [--out report.json] [fixture.wav ...]
+#
+# Build first with ./gradlew :app:externalNativeBuildRelease; the executable
+# is picked up from app/build/intermediates/cxx. Extra whisper_bench flags can
+# be passed through BENCH_ARGS, e.g. BENCH_ARGS="--threads 4".
+
+set -euo pipefail
+
+ABI="arm64-v8a"
+MODEL=""
+OUT="whisper_bench.json"
+FIXTURES=()
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --abi) ABI="$2"; shift 2 ;;
+        --model) MODEL="$2"; shift 2 ;;
+        --out) OUT="$2"; shift 2 ;;
+        *) FIXTURES+=("$1"); shift ;;
+    esac
+done
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT="$(dirname "$SCRIPT_DIR")"
+BIN="$(find "$ROOT/app/build/intermediates/cxx" -path "*/$ABI/whisper_bench" -type f 2>/dev/null | head -n 1)"
+if [[ -z "$BIN" ]]; then
+    echo "whisper_bench for $ABI not found; build the native targets first" >&2
+    exit 1
+fi
+
+DEVICE_DIR="/data/local/tmp/whisper_bench"
+adb shell mkdir -p "$DEVICE_DIR"
+adb push "$BIN" "$DEVICE_DIR/whisper_bench" >/dev/null
+adb shell chmod 755 "$DEVICE_DIR/whisper_bench"
+
+# The executable links the shared C++ runtime like the JNI library does
+STL="$(find "$ROOT/app/build/intermediates" -path "*/$ABI/libc++_shared.so" -type f 2>/dev/null | head -n 1)"
+if [[ -n "$STL" ]]; then
+    adb push "$STL" "$DEVICE_DIR/" >/dev/null
+fi
+
+ARGS=(--output "$DEVICE_DIR/report.json")
+if [[ -n "$MODEL" ]]; then
+    adb push "$MODEL" "$DEVICE_DIR/model.bin" >/dev/null
+    ARGS+=(--model "$DEVICE_DIR/model.bin")
+fi
+for fixture in "${FIXTURES[@]+"${FIXTURES[@]}"}"; do
+    name="$(basename "$fixture")"
+    adb push "$fixture" "$DEVICE_DIR/$name" >/dev/null
+    ARGS+=("$DEVICE_DIR/$name")
+done
+
+adb shell "cd $DEVICE_DIR && LD_LIBRARY_PATH=$DEVICE_DIR ./whisper_bench ${BENCH_ARGS:-} ${ARGS[*]}"
+adb pull "$DEVICE_DIR/report.json" "$OUT" >/dev/null
+echo "Report written to $OUT"
@@ -0,0 +1,90 @@
+#!/bin/bash
+
+# ==============================================================================
+# Whisper Android Replay Regression Gate
+# ==============================================================================
+# Pushes the whisper_replay executable, a model and WAV fixtures (with their
+# .txt reference transcripts) to a connected device, replays them through the
+# native capture and streaming pipeline and pulls the JSON report. Exits
+# non-zero when a fixture regresses against the baseline.
+#
+#   scripts/run_replay.sh --model model.bin [--abi arm64-v8a] [--out report.json]
+#                         [--baseline baseline.tsv] [--write-baseline baseline.tsv]
+#                         fixture.wav ...
+#
+# Build first with ./gradlew :app:externalNativeBuildRelease; the executable
+# is picked up from app/build/intermediates/cxx. Extra whisper_replay flags
+# can be passed through REPLAY_ARGS, e.g. REPLAY_ARGS="--realtime --high-pass 80".
+
+set -euo pipefail
+
+ABI="arm64-v8a"
+MODEL=""
+OUT="whisper_replay.json"
+BASELINE=""
+WRITE_BASELINE=""
+FIXTURES=()
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --abi) ABI="$2"; shift 2 ;;
+        --model) MODEL="$2"; shift 2 ;;
+        --out) OUT="$2"; shift 2 ;;
+        --baseline) BASELINE="$2"; shift 2 ;;
+        --write-baseline) WRITE_BASELINE="$2"; shift 2 ;;
+        *) FIXTURES+=("$1"); shift ;;
+    esac
+done
+
+if [[ -z "$MODEL" || ${#FIXTURES[@]} -eq 0 ]]; then
+    echo "usage: $0 --model model.bin [--baseline FILE] [--write-baseline FILE] fixture.wav ..." >&2
+    exit 2
+fi
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT="$(dirname "$SCRIPT_DIR")"
+BIN="$(find "$ROOT/app/build/intermediates/cxx" -path "*/$ABI/whisper_replay" -type f 2>/dev/null | head -n 1)"
+if [[ -z "$BIN" ]]; then
+    echo "whisper_replay for $ABI not found; build the native targets first" >&2
+    exit 1
+fi
+
+DEVICE_DIR="/data/local/tmp/whisper_replay"
+adb shell mkdir -p "$DEVICE_DIR"
+adb push "$BIN" "$DEVICE_DIR/whisper_replay" >/dev/null
+adb shell chmod 755 "$DEVICE_DIR/whisper_replay"
+
+# The executable links the shared C++ runtime like the JNI library does
+STL="$(find "$ROOT/app/build/intermediates" -path "*/$ABI/libc++_shared.so" -type f 2>/dev/null | head -n 1)"
+if [[ -n "$STL" ]]; then
+    adb push "$STL" "$DEVICE_DIR/" >/dev/null
+fi
+
+adb push "$MODEL" "$DEVICE_DIR/model.bin" >/dev/null
+ARGS=(--model "$DEVICE_DIR/model.bin" --output "$DEVICE_DIR/report.json")
+if [[ -n "$BASELINE" ]]; then
+    adb push "$BASELINE" "$DEVICE_DIR/baseline.tsv" >/dev/null
+    ARGS+=(--baseline "$DEVICE_DIR/baseline.tsv")
+fi
+if [[ -n "$WRITE_BASELINE" ]]; then
+    ARGS+=(--write-baseline "$DEVICE_DIR/new_baseline.tsv")
+fi
+for fixture in "${FIXTURES[@]}"; do
+    name="$(basename "$fixture")"
+    adb push "$fixture" "$DEVICE_DIR/$name" >/dev/null
+    reference="${fixture%.*}.txt"
+    if [[ -f "$reference" ]]; then
+        adb push "$reference" "$DEVICE_DIR/$(basename "$reference")" >/dev/null
+    fi
+    ARGS+=("$DEVICE_DIR/$name")
+done
+
+# Pull the report even when the gate fails, then pass its status on
+STATUS=0
+adb shell "cd $DEVICE_DIR && LD_LIBRARY_PATH=$DEVICE_DIR ./whisper_replay ${REPLAY_ARGS:-} ${ARGS[*]}" || STATUS=$?
+adb pull "$DEVICE_DIR/report.json" "$OUT" >/dev/null
+echo "Report written to $OUT"
+if [[ -n "$WRITE_BASELINE" ]]; then
+    adb pull "$DEVICE_DIR/new_baseline.tsv" "$WRITE_BASELINE" >/dev/null
+    echo "Baseline written to $WRITE_BASELINE"
+fi
+exit $STATUS